@@ -45,6 +45,17 @@ template <typename T>
         */
         virtual bool insert(const T& element) = 0;
 
+        /**
+        * \brief
+        * Insert an element into the AbstractTree, moving it into place
+        *
+        * \param element The element to insert
+        *
+        * \returns true if the element was inserted, false if it was
+        * already present
+        */
+        virtual bool insert(T&& element) = 0;
+
         /**
         * \brief
         * Check if an element is present in the AbstractTree
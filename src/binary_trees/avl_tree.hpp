@@ -10,6 +10,12 @@
 #ifndef AVL_TREE_INCLUDED
 #define AVL_TREE_INCLUDED 1
 #include "abstracttree.hpp"
+#include "node_pool.hpp"
+#include "key_compare.hpp"
+#include "iterator_range.hpp"
+#include "in_order.hpp"
+#include "order_statistics.hpp"
+#include "work_stealing_pool.hpp"
 #include <cstddef>
 #include <cassert>
 #include <iostream>
@@ -19,15 +25,25 @@
 #include <list>
 #include <iomanip>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <functional>
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>,
+          typename Allocator = NodePool<T>,
+          typename Statistics = NoOrderStatistics>
 
 /**
 * \class AvlTree
 * \brief A templated random tree
+*
+* \details Statistics is NoOrderStatistics or OrderStatistics, the latter
+* keeps subtree sizes so select, rank and countRange can be used
 */
 
-class AvlTree : public BinaryTree<T>{
+class AvlTree : public AbstractTree<T> {
 
 private:
    class Iterator; // Forward declaration1
@@ -41,19 +57,64 @@ public:
     */
     AvlTree();
 
+    /**
+    * \brief
+    * Comparator Constructor
+    *
+    * \param comp the comparator to order the elements with
+    */
+    explicit AvlTree(const Compare& comp);
+
+    /**
+    * \brief
+    * Range Constructor
+    *
+    * \details Sorts the elements in [first, last) and builds a perfectly
+    * balanced tree out of them.
+    *
+    * \note O(n) time after the sort
+    */
+    template <typename InputIterator>
+    AvlTree(InputIterator first, InputIterator last,
+             const Compare& comp = Compare());
+
     /**
     * \brief
     * Copy Constructor
     *
+    * \details Copies the tree node by node, so the copy has exactly the same
+    * shape as the original.
+    *
+    * \note O(n) time
     */
-    AvlTree<T>(const AvlTree<T>& orig);
+    AvlTree<T, Compare, Allocator, Statistics>(const AvlTree<T, Compare, Allocator, Statistics>& orig);
 
     /**
     * \brief
     * Assignment Operator
     *
+    * \details Reuses the nodes the tree already holds before allocating new
+    * ones.
     */
-    AvlTree<T>& operator=(const AvlTree<T>& rhs);
+    AvlTree<T, Compare, Allocator, Statistics>& operator=(const AvlTree<T, Compare, Allocator, Statistics>& rhs);
+
+    /**
+    * \brief
+    * Move Constructor
+    *
+    * \details Takes over the nodes of orig, leaving it empty
+    *
+    * \note constant time
+    */
+    AvlTree<T, Compare, Allocator, Statistics>(AvlTree<T, Compare, Allocator, Statistics>&& orig);
+
+    /**
+    * \brief
+    * Move Assignment Operator
+    *
+    * \note constant time, apart from freeing the tree's old nodes
+    */
+    AvlTree<T, Compare, Allocator, Statistics>& operator=(AvlTree<T, Compare, Allocator, Statistics>&& rhs);
 
     /**
     * \brief
@@ -61,7 +122,20 @@ public:
     *
     *
     */
-    void swap(AvlTree<T>& rhs);
+    void swap(AvlTree<T, Compare, Allocator, Statistics>& rhs);
+
+    /**
+    * \brief
+    * Replaces the contents of the tree with the elements in [first, last)
+    *
+    * \details The range must already be sorted; repeated elements are only
+    * stored once. The tree is rebuilt perfectly balanced without any
+    * comparisons or rotations.
+    *
+    * \note O(n) time
+    */
+    template <typename InputIterator>
+    void assignSorted(InputIterator first, InputIterator last);
 
     /**
     * \brief 
@@ -75,6 +149,17 @@ public:
     iterator begin() const; ///< An iterator that refers to the first element
     iterator end() const;   ///< A "past-the-end" iterator
 
+    /**
+    * \brief calls visit(element) for every element, in order
+    *
+    * \details a tight loop, much faster than the iterators over a whole
+    * tree
+    *
+    * \note visit mustn't change the tree
+    */
+    template <typename Function>
+    void forEach(Function&& visit) const;
+
     /**
     * \brief 
     * Size function
@@ -94,6 +179,19 @@ public:
     *
     */
     bool insert(const T& element);
+    bool insert(T&& element);
+
+    /**
+    * \brief
+    * Constructs an element out of args and inserts it into the tree
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \returns true if the element was inserted, false if it was already
+    * present
+    */
+    template <typename... Args>
+    bool emplace(Args&&... args);
 
     /**
     * \brief 
@@ -113,19 +211,164 @@ public:
     */
     bool contains(const T& element) const;
 
+    /**
+    * \brief
+    * Checks if an element equivalent to key is in the tree
+    *
+    * \note only available if Compare defines is_transparent, so keys of
+    * other types can be looked up without converting them to T
+    */
+    template <typename K, typename C = Compare,
+              typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    /**
+    * \brief returns a copy of the comparator that orders the tree
+    */
+    Compare key_comp() const;
+
+    /**
+    * \brief
+    * Finds an element in the tree
+    *
+    * \returns an iterator to the element, end() if it isn't in the tree
+    */
+    iterator find(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that doesn't sort before element
+    *
+    * \returns end() if every element sorts before element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator lower_bound(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that sorts after element
+    *
+    * \returns end() if no element sorts after element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator upper_bound(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements equivalent to element as a pair of iterators, so
+    * the range is empty if element isn't in the tree
+    */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements in [lower, upper), for use in a range-based for
+    * loop
+    *
+    * \note log(n) time to find the ends of the range, then the scan costs
+    * amortized constant time per element
+    */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
+
+    /**
+    * \brief
+    * Finds the element with exactly k smaller elements in the tree
+    *
+    * \note only available with the OrderStatistics policy, log(n) time
+    */
+    const T& select(size_t k) const;
+
+    /**
+    * \brief
+    * Counts the elements in the tree that sort before element
+    *
+    * \note only available with the OrderStatistics policy, log(n) time
+    */
+    size_t rank(const T& element) const;
+
+    /**
+    * \brief
+    * Counts the elements in the tree in the range [lower, upper)
+    *
+    * \note only available with the OrderStatistics policy, log(n) time
+    */
+    size_t countRange(const T& lower, const T& upper) const;
+
+    /**
+    * \brief
+    * Splits off the elements that don't sort before pivot
+    *
+    * \returns a tree holding every element that doesn't sort before pivot,
+    * while this tree keeps the rest
+    *
+    * \note only available with the OrderStatistics policy, which gives the
+    * size of each half without counting it, log(n) time
+    */
+    AvlTree<T, Compare, Allocator, Statistics> split(const T& pivot);
+
+    /**
+    * \brief
+    * Moves every element of greater onto the end of this tree
+    *
+    * \details every element in greater must sort after every element in
+    * this tree, greater is left empty
+    *
+    * \note log(n) time
+    */
+    void join(AvlTree<T, Compare, Allocator, Statistics>& greater);
+
+    /**
+    * \brief
+    * Adds every element of other to this tree
+    *
+    * \details other is left empty, elements already in this tree are kept
+    * over their equivalents in other. Each half of the work is split again
+    * and the halves run on pool's threads.
+    *
+    * \note O(m log(n/m + 1)) work and O(log^2 n) span, where m is the size
+    * of the smaller tree and n of the larger one
+    */
+    void unionWith(AvlTree<T, Compare, Allocator, Statistics>& other,
+                   WorkStealingPool& pool = WorkStealingPool::shared());
+
+    /**
+    * \brief
+    * Keeps only the elements that are also in other
+    *
+    * \details other is left empty
+    *
+    * \note the same bounds as unionWith, plus freeing the nodes that are
+    * dropped on the calling thread
+    */
+    void intersect(AvlTree<T, Compare, Allocator, Statistics>& other,
+                   WorkStealingPool& pool = WorkStealingPool::shared());
+
+    /**
+    * \brief
+    * Removes every element that is also in other
+    *
+    * \details other is left empty
+    *
+    * \note the same bounds as intersect
+    */
+    void difference(AvlTree<T, Compare, Allocator, Statistics>& other,
+                    WorkStealingPool& pool = WorkStealingPool::shared());
+
     /**
     * \brief
     * Random Tree equality operator
     *
     */
-    bool operator==(const AvlTree<T>& rhs) const;
+    bool operator==(const AvlTree<T, Compare, Allocator, Statistics>& rhs) const;
 
     /**
     * \brief
     * Random Tree inequality operator
     *
     */
-    bool operator!=(const AvlTree<T>& rhs) const;
+    bool operator!=(const AvlTree<T, Compare, Allocator, Statistics>& rhs) const;
 
     /**
     * \brief
@@ -161,7 +404,7 @@ public:
 
 
 private:
-    struct Node {
+    struct Node : public Statistics::NodeCount {
         T element_;          ///> the element at this node
         Node* left_;         ///> this node's left child
         Node* right_;        ///> this node's right child
@@ -174,6 +417,7 @@ private:
         *
         */
         Node(const T& element, Node* left, Node* right, Node* parent);
+        Node(T&& element, Node* left, Node* right, Node* parent);
         /**
         * \brief default destructor
         *
@@ -195,6 +439,12 @@ private:
         Node() = delete; // disable default constructor
         Node& operator=(const Node&) = delete; // disable assignment operator
     };
+
+    using NodeAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator alloc_; ///> where the tree's nodes come from
+    Compare comp_;        ///> orders the elements
     size_t size_;
     Node* root_;
 
@@ -231,9 +481,10 @@ private:
      * Inserts a node into the tree
      *
      * \param here The node to insert at
-     * \param element The element to insert
+     * \param element The element to insert, forwarded to the new node
      */
-    bool insertNode(Node*& here, const T& element);
+    template <typename U>
+    bool insertNode(Node*& here, U&& element);
 
     /**
     * \brief
@@ -254,7 +505,8 @@ private:
      *
      * \returns True if the element is present in the tree, false if otherwise
      */
-    Node* findNode(Node* here, const T& element) const;
+    template <typename K>
+    Node* findNode(Node* here, const K& element) const;
 
     Node* getNextNode(Node* here);
 
@@ -290,10 +542,169 @@ private:
     */
     bool deleteOneElementTree(const T& element);
 
+    /**
+    * \brief replaces the tree with a perfectly balanced tree holding the
+    * sorted elements
+    *
+    * \param elements sorted elements, repeated elements are removed
+    */
+    void buildFromSorted(std::vector<T>& elements);
+
+    /**
+    * \brief builds a perfectly balanced subtree out of the sorted elements in
+    * [lower, upper)
+    *
+    * \returns the root of the new subtree
+    */
+    Node* buildSubtree(const std::vector<T>& elements, size_t lower,
+                       size_t upper, Node* parent);
+
+    /**
+    * \brief copies the tree rooted at source node by node, keeping its shape
+    * and heights
+    *
+    * \param spares nodes to reuse before allocating new ones, linked through
+    * their right_ pointers
+    *
+    * \returns the root of the copy
+    */
+    Node* cloneTree(const Node* source, Node*& spares);
+
+    /**
+    * \brief makes a childless copy of source below parent, reusing a spare
+    * node if there is one
+    */
+    Node* cloneNode(const Node* source, Node* parent, Node*& spares);
+
+    /**
+    * \brief takes apart the tree rooted at here into a list of nodes linked
+    * through their right_ pointers
+    *
+    * \returns the head of the list
+    */
+    static Node* unlinkNodes(Node* here);
+
+    /**
+    * \brief frees a list of nodes made by unlinkNodes
+    */
+    void deleteSpares(Node* spares);
+
+    /**
+    * \brief allocates a node from the tree's allocator and constructs it
+    * out of args
+    */
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+
+    /**
+    * \brief destroys a single node and gives its memory back, the node's
+    * children are left alone
+    */
+    void destroyNode(Node* node);
+
+    /**
+    * \brief destroys every node in the subtree rooted at here, without
+    * recursing
+    */
+    void destroyTree(Node* here);
+
     void checkBalanced(Node* startingNode, bool afterInsert);
 
+    /**
+    * \brief joins left, middle and right into one balanced tree, where left
+    * sorts before middle and right sorts after it
+    *
+    * \details the taller side is rebalanced through root_, so root_ is left
+    * pointing at the joined tree unless both sides are about as tall
+    *
+    * \returns the root of the joined tree
+    *
+    * \note time proportional to the difference in height of left and right
+    */
+    Node* joinWithMiddle(Node* left, Node* middle, Node* right);
+
+    /**
+    * \brief takes the smallest node out of the tree without freeing it
+    */
+    Node* unlinkMinimum();
+
     bool isBalancedNode(Node* here);
 
+    enum class SetOperation {
+        UNION,
+        INTERSECTION,
+        DIFFERENCE
+    };
+
+    /**
+    * \brief subtrees taken out by a set operation, to be freed once the
+    * threads are done with them, linked through their roots' parent_
+    * pointers
+    */
+    struct DroppedNodes {
+        Node* first_;
+        Node* last_;
+
+        DroppedNodes();
+
+        /**
+        * \brief adds the subtree rooted at here, if there is one
+        */
+        void add(Node* here);
+
+        /**
+        * \brief moves everything in other onto the end of this list
+        */
+        void append(DroppedNodes& other);
+    };
+
+    /**
+    * \brief subtrees shorter than this on either side are combined on a
+    * single thread, since handing them off would cost more than it saves
+    */
+    static const int PARALLEL_HEIGHT = 10;
+
+    /**
+    * \brief applies operation to this tree and other, leaving other empty
+    */
+    void combine(AvlTree<T, Compare, Allocator, Statistics>& other,
+                 SetOperation operation, WorkStealingPool& pool);
+
+    /**
+    * \brief applies operation to the subtrees mine and theirs
+    *
+    * \details root_ is used as scratch space by the joins, so each thread
+    * works through a tree object of its own
+    *
+    * \returns the root of the combined subtree
+    */
+    Node* combineNodes(Node* mine, Node* theirs, SetOperation operation,
+                       WorkStealingPool& pool, DroppedNodes& dropped);
+
+    /**
+    * \brief splits the subtree rooted at here into the nodes that sort
+    * before pivot and the ones that sort after it
+    *
+    * \returns the node equivalent to pivot, unlinked from both halves, or
+    * nullptr if there isn't one
+    */
+    Node* splitNodes(Node* here, const T& pivot, Node*& less, Node*& greater);
+
+    /**
+    * \brief joins two subtrees where everything in left sorts before
+    * everything in right
+    *
+    * \returns the root of the joined subtree
+    */
+    Node* joinNodes(Node* left, Node* right);
+
+    /**
+    * \brief frees every dropped subtree
+    *
+    * \returns the number of nodes freed
+    */
+    size_t destroyDropped(DroppedNodes& dropped);
+
     class Iterator
     {
     public:
@@ -320,10 +731,10 @@ private:
 
 };
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 /// Provide a non-member version of swap to allow standard swap(x,y) usage.
-void swap(AvlTree<T>& lhs, AvlTree<T>& rhs);
+void swap(AvlTree<T, Compare, Allocator, Statistics>& lhs, AvlTree<T, Compare, Allocator, Statistics>& rhs);
 
-#include "avltree-private.hpp"
+#include "avl_tree_private.hpp"
 
 #endif // AVL_TREE_INCLUDED
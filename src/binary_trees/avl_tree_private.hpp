@@ -5,70 +5,130 @@
  * \brief implementation of templated avl tree class
  */
 
-template<typename T>
-AvlTree<T>::AvlTree()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::AvlTree()
             : size_{0}, root_{nullptr}
 {
     // nothing else to do
 }
 
-template<typename T>
-AvlTree<T>::~AvlTree()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::AvlTree(const Compare& comp)
+            : comp_{comp}, size_{0}, root_{nullptr}
 {
-    delete root_;
+    // nothing else to do
 }
 
-template<typename T>
-AvlTree<T>::AvlTree(const AvlTree<T>& orig)
-            : size_{0}, root_{nullptr}
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::~AvlTree()
+{
+    destroyTree(root_);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::AvlTree(const AvlTree<T, Compare, Allocator, Statistics>& orig)
+            : alloc_{NodeTraits::select_on_container_copy_construction(
+                  orig.alloc_)}, comp_{orig.comp_}, size_{orig.size_},
+              root_{nullptr}
 {
-    for (iterator i = orig.begin(); i != orig.end(); ++i) {
-        insert(*i);
+    Node* spares = nullptr;
+    root_ = cloneTree(orig.root_, spares);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>& AvlTree<T, Compare, Allocator, Statistics>::operator=(const AvlTree<T, Compare, Allocator, Statistics>& rhs)
+{
+    if (this != &rhs) {
+        // reuse the nodes we already have and free whatever is left over
+        Node* spares = unlinkNodes(root_);
+        root_ = cloneTree(rhs.root_, spares);
+        deleteSpares(spares);
+        comp_ = rhs.comp_;
+        size_ = rhs.size_;
     }
+    return *this;
 }
 
-template<typename T>
-AvlTree<T>& AvlTree<T>::operator=(const AvlTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::AvlTree(AvlTree<T, Compare, Allocator, Statistics>&& orig)
+            : alloc_{std::move(orig.alloc_)}, comp_{orig.comp_},
+              size_{orig.size_},
+              root_{orig.root_}
 {
-    AvlTree<T> copy{rhs};
-    swap(copy);
+    orig.size_ = 0;
+    orig.root_ = nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>& AvlTree<T, Compare, Allocator, Statistics>::operator=(AvlTree<T, Compare, Allocator, Statistics>&& rhs)
+{
+    AvlTree<T, Compare, Allocator, Statistics> moved{std::move(rhs)};
+    swap(moved);
     return *this;
 }
 
-template<typename T>
-void AvlTree<T>::swap(AvlTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::swap(AvlTree<T, Compare, Allocator, Statistics>& rhs)
 {
     using std::swap;
     swap(root_, rhs.root_);
     swap(size_, rhs.size_);
+    swap(alloc_, rhs.alloc_);
+    swap(comp_, rhs.comp_);
 }
 
-template<typename T>
-void swap(AvlTree<T>& lhs, AvlTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void swap(AvlTree<T, Compare, Allocator, Statistics>& lhs, AvlTree<T, Compare, Allocator, Statistics>& rhs)
 {
     lhs.swap(rhs);
 }
 
-template<typename T>
-size_t AvlTree<T>::size() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename InputIterator>
+AvlTree<T, Compare, Allocator, Statistics>::AvlTree(InputIterator first, InputIterator last,
+                                        const Compare& comp)
+            : comp_{comp}, size_{0}, root_{nullptr}
+{
+    std::vector<T> elements(first, last);
+    std::sort(elements.begin(), elements.end(),
+              [this](const T& a, const T& b) {
+                  return keyLess(comp_, a, b);
+              });
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename InputIterator>
+void AvlTree<T, Compare, Allocator, Statistics>::assignSorted(InputIterator first, InputIterator last)
+{
+    std::vector<T> elements(first, last);
+    assert(std::is_sorted(elements.begin(), elements.end(),
+                          [this](const T& a, const T& b) {
+                              return keyLess(comp_, a, b);
+                          }));
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::size() const
 {
     return size_;
 }
 
-template<typename T>
-size_t AvlTree<T>::height() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::height() const
 {
     return subtreeHeight(root_);
 }
 
-template<typename T>
-bool AvlTree<T>::empty()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::empty()
 {
     return (size_ == 0);
 }
 
-template<typename T>
-bool AvlTree<T>::operator==(const AvlTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::operator==(const AvlTree<T, Compare, Allocator, Statistics>& rhs) const
 {
     // if the sizes are different the trees are not equal
     if (size() != rhs.size()) {
@@ -88,29 +148,39 @@ bool AvlTree<T>::operator==(const AvlTree<T>& rhs) const
     return true;
 }
 
-template<typename T>
-bool AvlTree<T>::operator!=(const AvlTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::operator!=(const AvlTree<T, Compare, Allocator, Statistics>& rhs) const
 {
     return !(*this == rhs);
 }
 
-template<typename T>
-size_t AvlTree<T>::subtreeHeight(Node* here) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::subtreeHeight(Node* here) const
 {
-    // recursive base case
-    if (here == nullptr) {
-        return 0;
+    // walk the subtree with an explicit stack of nodes and their depths,
+    // a path-shaped tree is as deep as it is big
+    size_t height = 0;
+    std::stack<std::pair<Node*, size_t>> toVisit;
+    if (here != nullptr) {
+        toVisit.push(std::make_pair(here, 1));
     }
-    // recursively get the left and right subtree heights
-    size_t leftSize = subtreeHeight(here->left_);
-    size_t rightSize = subtreeHeight(here->right_);
-
-    // the taller of the two subtrees is the height of the overall subtree
-    return 1 + std::max(leftSize, rightSize);
+    while (!toVisit.empty()) {
+        Node* node = toVisit.top().first;
+        size_t depth = toVisit.top().second;
+        toVisit.pop();
+        height = std::max(height, depth);
+        if (node->left_ != nullptr) {
+            toVisit.push(std::make_pair(node->left_, depth + 1));
+        }
+        if (node->right_ != nullptr) {
+            toVisit.push(std::make_pair(node->right_, depth + 1));
+        }
+    }
+    return height;
 }
 
-template<typename T>
-bool AvlTree<T>::contains(const T& element) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::contains(const T& element) const
 {
     if (findNode(root_, element) == nullptr) {
         return false;
@@ -119,29 +189,94 @@ bool AvlTree<T>::contains(const T& element) const
     }
 }
 
-template<typename T>
-typename AvlTree<T>::Node* AvlTree<T>::findNode(Node* here, const T& element) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename K, typename C, typename>
+bool AvlTree<T, Compare, Allocator, Statistics>::contains(const K& key) const
 {
-    if (here == nullptr) {
-        return nullptr;
-    } 
-    // continue searching to the left
-    else if (element < here->element_) {
-        return findNode(here->left_, element);
+    return findNode(root_, key) != nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+Compare AvlTree<T, Compare, Allocator, Statistics>::key_comp() const
+{
+    return comp_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::iterator AvlTree<T, Compare, Allocator, Statistics>::find(const T& element) const
+{
+    return Iterator(findNode(root_, element));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::iterator AvlTree<T, Compare, Allocator, Statistics>::lower_bound(const T& element) const
+{
+    return Iterator(lowerBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::iterator AvlTree<T, Compare, Allocator, Statistics>::upper_bound(const T& element) const
+{
+    return Iterator(upperBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+std::pair<typename AvlTree<T, Compare, Allocator, Statistics>::iterator, typename AvlTree<T, Compare, Allocator, Statistics>::iterator>
+AvlTree<T, Compare, Allocator, Statistics>::equal_range(const T& element) const
+{
+    iterator first = lower_bound(element);
+    iterator last = first;
+    // the elements are unique, so at most one of them can be equivalent
+    if (last != end() && !keyLess(comp_, element, *last)) {
+        ++last;
     }
-    // continue searching to the right
-    else if (element > here->element_) {
-        return findNode(here->right_, element);
-    } 
-    // element is not less than or greater than here->element_, so it must
-    // be equal to here->element_
-    else {
-        return here;
+    return std::make_pair(first, last);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+IteratorRange<typename AvlTree<T, Compare, Allocator, Statistics>::iterator> AvlTree<T, Compare, Allocator, Statistics>::range(const T& lower, const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return IteratorRange<iterator>(end(), end());
     }
+    return IteratorRange<iterator>(lower_bound(lower), lower_bound(upper));
 }
 
-template<typename T>
-bool AvlTree<T>::insert(const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+const T& AvlTree<T, Compare, Allocator, Statistics>::select(size_t k) const
+{
+    static_assert(std::is_same<Statistics, OrderStatistics>::value,
+                  "select needs the OrderStatistics policy");
+    assert(k < size_);
+    return Statistics::select(root_, k)->element_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::rank(const T& element) const
+{
+    static_assert(std::is_same<Statistics, OrderStatistics>::value,
+                  "rank needs the OrderStatistics policy");
+    return Statistics::rank(root_, element, comp_);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::countRange(const T& lower, const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return 0;
+    }
+    return rank(upper) - rank(lower);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename K>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::findNode(Node* here, const K& element) const
+{
+    return searchKey(here, element, comp_).match_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::insert(const T& element)
 {
     if (insertNode(root_, element)) {
         ++size_;
@@ -150,91 +285,428 @@ bool AvlTree<T>::insert(const T& element)
     return false;
 }
 
-template<typename T>
-bool AvlTree<T>::insertNode(Node*& here, const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::insert(T&& element)
+{
+    if (insertNode(root_, std::move(element))) {
+        ++size_;
+        return true;
+    }
+    return false;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename... Args>
+bool AvlTree<T, Compare, Allocator, Statistics>::emplace(Args&&... args)
+{
+    return insert(T(std::forward<Args>(args)...));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename U>
+bool AvlTree<T, Compare, Allocator, Statistics>::insertNode(Node*& here, U&& element)
 {
     // if we have an empty tree, make a new node
     if (here == nullptr) {
-        here = new Node(element, nullptr, nullptr, nullptr);
+        here = createNode(std::forward<U>(element), nullptr, nullptr, nullptr);
         return true;
     }
-    // otherwise go down to the next level in the tree
-    else if (element < here->element_) {
-        if (here->left_ == nullptr) {
-            here->left_ = new Node(element, nullptr, nullptr, here);
-            if (here->right_ == nullptr) {
-                ++here->height_;
-            }
-            checkBalanced(here->parent_, true);
-            return true;
+    KeySearch<Node> spot = searchKey(here, element, comp_);
+    // if the element is already in the tree we can't insert
+    if (spot.match_ != nullptr) {
+        return false;
+    }
+    Node* parent = spot.parent_;
+    Node* newNode = createNode(std::forward<U>(element), nullptr, nullptr, parent);
+    if (spot.left_) {
+        parent->left_ = newNode;
+    } else {
+        parent->right_ = newNode;
+    }
+    // a new only child makes its parent one taller
+    if (parent->left_ == nullptr || parent->right_ == nullptr) {
+        ++parent->height_;
+    }
+    Statistics::recountPath(parent);
+    checkBalanced(parent->parent_, true);
+    return true;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics> AvlTree<T, Compare, Allocator, Statistics>::split(const T& pivot)
+{
+    static_assert(std::is_same<Statistics, OrderStatistics>::value,
+                  "split needs the OrderStatistics policy");
+    AvlTree<T, Compare, Allocator, Statistics> greater{comp_};
+    shareAllocator(greater.alloc_, alloc_);
+    // remember the path down to where pivot would go
+    std::vector<Node*> path;
+    for (Node* here = root_; here != nullptr;) {
+        path.push_back(here);
+        here = keyLess(comp_, here->element_, pivot) ? here->right_ : here->left_;
+    }
+    // then build both halves back up from the bottom, each node on the path
+    // joining its half together with the subtree off the path
+    Node* less = nullptr;
+    Node* notLess = nullptr;
+    for (size_t i = path.size(); i > 0; --i) {
+        Node* here = path[i - 1];
+        if (keyLess(comp_, here->element_, pivot)) {
+            less = joinWithMiddle(here->left_, here, less);
         } else {
-            return insertNode(here->left_, element);
+            notLess = joinWithMiddle(notLess, here, here->right_);
         }
-    } else if (element > here->element_) {
-        if (here->right_ == nullptr) {
-            here->right_ = new Node(element, nullptr, nullptr, here);
-            if (here->left_ == nullptr){
-                ++here->height_;
-            }
-            checkBalanced(here->parent_, true);
-            return true;
-        } else {
-            return insertNode(here->right_, element);
+    }
+    root_ = less;
+    greater.root_ = notLess;
+    greater.size_ = Statistics::count(notLess);
+    size_ -= greater.size_;
+    return greater;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::join(AvlTree<T, Compare, Allocator, Statistics>& greater)
+{
+    if (greater.root_ == nullptr || this == &greater) {
+        return;
+    }
+    shareAllocator(alloc_, greater.alloc_);
+    if (root_ == nullptr) {
+        std::swap(root_, greater.root_);
+        std::swap(size_, greater.size_);
+        return;
+    }
+    size_t joinedSize = size_ + greater.size_;
+    // greater's smallest element goes between the two trees
+    Node* middle = greater.unlinkMinimum();
+    Node* largest = root_;
+    while (largest->right_ != nullptr) {
+        largest = largest->right_;
+    }
+    assert(keyLess(comp_, largest->element_, middle->element_));
+    root_ = joinWithMiddle(root_, middle, greater.root_);
+    size_ = joinedSize;
+    greater.root_ = nullptr;
+    greater.size_ = 0;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::joinWithMiddle(Node* left, Node* middle, Node* right)
+{
+    if (left != nullptr) {
+        left->parent_ = nullptr;
+    }
+    if (right != nullptr) {
+        right->parent_ = nullptr;
+    }
+    int leftHeight = nodeHeight(left);
+    int rightHeight = nodeHeight(right);
+    if (leftHeight > rightHeight + 1) {
+        // go down the right side of left until the subtree there is short
+        // enough to sit next to right
+        Node* parent = nullptr;
+        Node* spine = left;
+        while (nodeHeight(spine) > rightHeight + 1) {
+            parent = spine;
+            spine = spine->right_;
         }
-    } 
-    // if we aren't less than or greater than the element, we must be equal
-    // and thus we can't insert
-    else {
-        return false;
+        middle->left_ = spine;
+        middle->right_ = right;
+        parent->right_ = middle;
+        middle->parent_ = parent;
+    } else if (rightHeight > leftHeight + 1) {
+        // likewise down the left side of right
+        Node* parent = nullptr;
+        Node* spine = right;
+        while (nodeHeight(spine) > leftHeight + 1) {
+            parent = spine;
+            spine = spine->left_;
+        }
+        middle->left_ = left;
+        middle->right_ = spine;
+        parent->left_ = middle;
+        middle->parent_ = parent;
+    } else {
+        // the heights are close enough for middle to be the root
+        middle->left_ = left;
+        middle->right_ = right;
+        middle->parent_ = nullptr;
+    }
+    if (middle->left_ != nullptr) {
+        middle->left_->parent_ = middle;
+    }
+    if (middle->right_ != nullptr) {
+        middle->right_->parent_ = middle;
+    }
+    middle->updateHeight();
+    Statistics::recountPath(middle);
+    if (middle->parent_ == nullptr) {
+        return middle;
     }
+    // middle made the side it joined at most one taller, just like an
+    // insert would
+    root_ = leftHeight > rightHeight ? left : right;
+    checkBalanced(middle->parent_, true);
+    return root_;
 }
 
-template<typename T>
-void AvlTree<T>::checkBalanced(Node* startingNode, bool afterInsert)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::unlinkMinimum()
 {
-    if (startingNode == nullptr) {
+    Node* minimum = root_;
+    while (minimum->left_ != nullptr) {
+        minimum = minimum->left_;
+    }
+    Node* parent = minimum->parent_;
+    Node* child = minimum->right_;
+    if (child != nullptr) {
+        child->parent_ = parent;
+    }
+    if (parent == nullptr) {
+        root_ = child;
+    } else {
+        parent->left_ = child;
+    }
+    minimum->right_ = nullptr;
+    minimum->parent_ = nullptr;
+    Statistics::recountPath(parent);
+    checkBalanced(parent, false);
+    --size_;
+    return minimum;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::unionWith(AvlTree<T, Compare, Allocator, Statistics>& other, WorkStealingPool& pool)
+{
+    combine(other, SetOperation::UNION, pool);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::intersect(AvlTree<T, Compare, Allocator, Statistics>& other, WorkStealingPool& pool)
+{
+    combine(other, SetOperation::INTERSECTION, pool);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::difference(AvlTree<T, Compare, Allocator, Statistics>& other, WorkStealingPool& pool)
+{
+    combine(other, SetOperation::DIFFERENCE, pool);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::combine(AvlTree<T, Compare, Allocator, Statistics>& other, SetOperation operation, WorkStealingPool& pool)
+{
+    if (this == &other) {
+        // a tree combined with itself only changes if it loses everything
+        if (operation == SetOperation::DIFFERENCE) {
+            destroyTree(root_);
+            root_ = nullptr;
+            size_ = 0;
+        }
         return;
     }
+    shareAllocator(alloc_, other.alloc_);
+    size_t combinedSize = size_ + other.size_;
+    DroppedNodes dropped;
+    Node* combined = combineNodes(root_, other.root_, operation, pool, dropped);
+    root_ = combined;
+    other.root_ = nullptr;
+    other.size_ = 0;
+    // the pool isn't safe to use from several threads, so nothing is freed
+    // until they are all done
+    size_ = combinedSize - destroyDropped(dropped);
+}
 
-    startingNode->updateHeight();
-    int balance = startingNode->getBalance();
-    // left subtree has height 2 greater than right subtree
-    if (balance < -1) {
-        int leftBalance = startingNode->left_->getBalance();
-        if (leftBalance == 1) {
-            leftRotate(startingNode->left_);
-            rightRotate(startingNode);
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::combineNodes(Node* mine, Node* theirs, SetOperation operation, WorkStealingPool& pool, DroppedNodes& dropped)
+{
+    if (mine == nullptr || theirs == nullptr) {
+        // with nothing left to match up, each side is kept or dropped whole
+        Node* kept = nullptr;
+        if (operation == SetOperation::INTERSECTION) {
+            dropped.add(mine);
+        } else {
+            kept = mine;
         }
-        else if (leftBalance == -1 || leftBalance == 0) {
-            rightRotate(startingNode);
+        if (operation == SetOperation::UNION && kept == nullptr) {
+            kept = theirs;
+        } else {
+            dropped.add(theirs);
         }
-        if (startingNode->parent_ != nullptr) {
-            checkBalanced(startingNode->parent_, afterInsert);
+        if (kept != nullptr) {
+            kept->parent_ = nullptr;
         }
+        return kept;
     }
-    // right subtree has a height 2 greater than left subtree
-    else if (balance > 1) {
-        int rightBalance = startingNode->right_->getBalance();
-        if (rightBalance == -1) {
-            rightRotate(startingNode->right_);
-            leftRotate(startingNode);
+    bool parallel = mine->height_ >= PARALLEL_HEIGHT &&
+                    theirs->height_ >= PARALLEL_HEIGHT;
+    // split both sides around our root, which for our side just takes the
+    // root off
+    Node* mineLess;
+    Node* mineGreater;
+    Node* theirsLess;
+    Node* theirsGreater;
+    Node* middle = splitNodes(mine, mine->element_, mineLess, mineGreater);
+    Node* match = splitNodes(theirs, middle->element_, theirsLess,
+                             theirsGreater);
+    Node* left = nullptr;
+    Node* right = nullptr;
+    if (parallel) {
+        AvlTree<T, Compare, Allocator, Statistics> scratch{comp_};
+        DroppedNodes rightDropped;
+        pool.invoke(
+            [&] {
+                left = combineNodes(mineLess, theirsLess, operation, pool,
+                                    dropped);
+            },
+            [&] {
+                right = scratch.combineNodes(mineGreater, theirsGreater,
+                                             operation, pool, rightDropped);
+            });
+        // the scratch tree's root_ points into the result by now
+        scratch.root_ = nullptr;
+        dropped.append(rightDropped);
+    } else {
+        left = combineNodes(mineLess, theirsLess, operation, pool, dropped);
+        right = combineNodes(mineGreater, theirsGreater, operation, pool,
+                             dropped);
+    }
+    bool keep = operation == SetOperation::INTERSECTION ? match != nullptr :
+                operation == SetOperation::UNION || match == nullptr;
+    dropped.add(match);
+    if (!keep) {
+        dropped.add(middle);
+        return joinNodes(left, right);
+    }
+    return joinWithMiddle(left, middle, right);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::splitNodes(Node* here, const T& pivot, Node*& less, Node*& greater)
+{
+    // remember the path down to pivot, or to where it would go
+    std::vector<Node*> path;
+    Node* match = nullptr;
+    while (here != nullptr) {
+        if (keyLess(comp_, here->element_, pivot)) {
+            path.push_back(here);
+            here = here->right_;
+        } else if (keyLess(comp_, pivot, here->element_)) {
+            path.push_back(here);
+            here = here->left_;
+        } else {
+            match = here;
+            break;
         }
-        else if (rightBalance == 1 || rightBalance == 0) {
-            leftRotate(startingNode);
+    }
+    less = nullptr;
+    greater = nullptr;
+    if (match != nullptr) {
+        less = match->left_;
+        greater = match->right_;
+        match->left_ = nullptr;
+        match->right_ = nullptr;
+        match->parent_ = nullptr;
+        match->height_ = 0;
+        Statistics::recount(match);
+    }
+    // then build both halves back up from the bottom, as split does
+    for (size_t i = path.size(); i > 0; --i) {
+        Node* node = path[i - 1];
+        if (keyLess(comp_, node->element_, pivot)) {
+            less = joinWithMiddle(node->left_, node, less);
+        } else {
+            greater = joinWithMiddle(greater, node, node->right_);
         }
-        if (startingNode->parent_ != nullptr) {
-            checkBalanced(startingNode->parent_, afterInsert);
+    }
+    if (less != nullptr) {
+        less->parent_ = nullptr;
+    }
+    if (greater != nullptr) {
+        greater->parent_ = nullptr;
+    }
+    return match;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::joinNodes(Node* left, Node* right)
+{
+    if (left == nullptr || right == nullptr) {
+        Node* joined = left != nullptr ? left : right;
+        if (joined != nullptr) {
+            joined->parent_ = nullptr;
         }
+        return joined;
     }
-    else if (balance == 0 && !afterInsert) {
-        checkBalanced(startingNode->parent_, afterInsert);
-    } else if (balance != 0 && afterInsert) {
-        checkBalanced(startingNode->parent_, afterInsert);
+    // right's smallest node goes between the two
+    right->parent_ = nullptr;
+    root_ = right;
+    Node* middle = unlinkMinimum();
+    return joinWithMiddle(left, middle, root_);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::destroyDropped(DroppedNodes& dropped)
+{
+    size_t freed = 0;
+    Node* subtree = dropped.first_;
+    while (subtree != nullptr) {
+        Node* next = subtree->parent_;
+        Node* spares = unlinkNodes(subtree);
+        while (spares != nullptr) {
+            Node* spare = spares->right_;
+            destroyNode(spares);
+            spares = spare;
+            ++freed;
+        }
+        subtree = next;
+    }
+    dropped.first_ = nullptr;
+    dropped.last_ = nullptr;
+    return freed;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::checkBalanced(Node* startingNode, bool afterInsert)
+{
+    // walk up towards the root until the heights stop changing
+    while (startingNode != nullptr) {
+        startingNode->updateHeight();
+        int balance = startingNode->getBalance();
+        // left subtree has height 2 greater than right subtree
+        if (balance < -1) {
+            int leftBalance = startingNode->left_->getBalance();
+            if (leftBalance == 1) {
+                leftRotate(startingNode->left_);
+                rightRotate(startingNode);
+            }
+            else if (leftBalance == -1 || leftBalance == 0) {
+                rightRotate(startingNode);
+            }
+        }
+        // right subtree has a height 2 greater than left subtree
+        else if (balance > 1) {
+            int rightBalance = startingNode->right_->getBalance();
+            if (rightBalance == -1) {
+                rightRotate(startingNode->right_);
+                leftRotate(startingNode);
+            }
+            else if (rightBalance == 1 || rightBalance == 0) {
+                leftRotate(startingNode);
+            }
+        }
+        // otherwise stop once the subtree's height is the same as before
+        else if (afterInsert ? balance == 0 : balance != 0) {
+            return;
+        }
+        // after a rotation startingNode has moved down a level, so its new
+        // parent is the next node to check
+        startingNode = startingNode->parent_;
     }
 }
 
-template<typename T>
-bool AvlTree<T>::deleteElement(const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::deleteElement(const T& element)
 {
     if (empty()) {
         return false;
@@ -242,18 +714,16 @@ bool AvlTree<T>::deleteElement(const T& element)
     if (size_ == 1) {
         return deleteOneElementTree(element);
     }
-    Node* deletee;    // the node to delete
-    if (root_->element_ == element) {
+    Node* deletee = findNode(root_, element);    // the node to delete
+    // if we couldn't find a node holding the element, we can't delete
+    if (deletee == nullptr) {
+        return false;
+    }
+    if (deletee == root_) {
         deletee = getNextNode(root_);
         // set the root's value to be it's replacement's value, then proceed to
         // delete the old node containing the replacement
         root_->element_ = deletee->element_;
-    } else {
-        deletee = findNode(root_, element);
-        // if we couldn't find a node holding the element, we can't delete
-        if (deletee == nullptr) {
-            return false;
-        }
     }
     // if the element to delete is a leaf, just remove the leaf
     if (deletee->left_ == nullptr && deletee->right_ == nullptr) {
@@ -273,8 +743,8 @@ bool AvlTree<T>::deleteElement(const T& element)
     }
 }
 
-template<typename T>
-typename AvlTree<T>::Node* AvlTree<T>::getNextNode(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::getNextNode(Node* here)
 {
     iterator nextNode = Iterator(here);
     // go one to the right if we can
@@ -283,14 +753,152 @@ typename AvlTree<T>::Node* AvlTree<T>::getNextNode(Node* here)
         // go to the right)
         nextNode = --(Iterator(root_));
     }
-    return findNode(root_, *nextNode);
+    return nextNode.current_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::buildFromSorted(std::vector<T>& elements)
+{
+    // a set only holds each element once
+    elements.erase(std::unique(elements.begin(), elements.end(),
+                               [this](const T& a, const T& b) {
+                                   return keyEquivalent(comp_, a, b);
+                               }),
+                   elements.end());
+    destroyTree(root_);
+    root_ = buildSubtree(elements, 0, elements.size(), nullptr);
+    size_ = elements.size();
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::buildSubtree(
+    const std::vector<T>& elements, size_t lower, size_t upper, Node* parent)
+{
+    if (lower == upper) {
+        return nullptr;
+    }
+    // the middle element becomes the root so both halves differ in size by
+    // at most one, which always satisfies the avl property
+    size_t middle = lower + (upper - lower) / 2;
+    Node* here = createNode(elements[middle], nullptr, nullptr, parent);
+    here->left_ = buildSubtree(elements, lower, middle, here);
+    here->right_ = buildSubtree(elements, middle + 1, upper, here);
+    here->updateHeight();
+    Statistics::recount(here);
+    return here;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::cloneTree(const Node* source, Node*& spares)
+{
+    if (source == nullptr) {
+        return nullptr;
+    }
+    Node* root = cloneNode(source, nullptr, spares);
+    // walk both trees together using the parent pointers, so deep trees
+    // can't overflow the stack
+    Node* copy = root;
+    while (copy != nullptr) {
+        if (source->left_ != nullptr && copy->left_ == nullptr) {
+            copy->left_ = cloneNode(source->left_, copy, spares);
+            source = source->left_;
+            copy = copy->left_;
+        } else if (source->right_ != nullptr && copy->right_ == nullptr) {
+            copy->right_ = cloneNode(source->right_, copy, spares);
+            source = source->right_;
+            copy = copy->right_;
+        } else {
+            // both subtrees are done, go back up
+            source = source->parent_;
+            copy = copy->parent_;
+        }
+    }
+    return root;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::cloneNode(const Node* source, Node* parent,
+                                                 Node*& spares)
+{
+    Node* copy;
+    if (spares == nullptr) {
+        copy = createNode(source->element_, nullptr, nullptr, parent);
+    } else {
+        copy = spares;
+        spares = spares->right_;
+        copy->element_ = source->element_;
+        copy->left_ = nullptr;
+        copy->right_ = nullptr;
+        copy->parent_ = parent;
+    }
+    copy->height_ = source->height_;
+    Statistics::copyCount(copy, source);
+    return copy;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::unlinkNodes(Node* here)
+{
+    Node* spares = nullptr;
+    while (here != nullptr) {
+        if (here->left_ != nullptr) {
+            // rotate the left child up until there is nothing on the left
+            Node* left = here->left_;
+            here->left_ = left->right_;
+            left->right_ = here;
+            here = left;
+        } else {
+            Node* next = here->right_;
+            here->right_ = spares;
+            spares = here;
+            here = next;
+        }
+    }
+    return spares;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::deleteSpares(Node* spares)
+{
+    while (spares != nullptr) {
+        Node* next = spares->right_;
+        destroyNode(spares);
+        spares = next;
+    }
 }
 
-template<typename T>
-bool AvlTree<T>::deleteOneElementTree(const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename... Args>
+typename AvlTree<T, Compare, Allocator, Statistics>::Node* AvlTree<T, Compare, Allocator, Statistics>::createNode(Args&&... args)
 {
-    if (root_->element_ == element) {
-        delete root_;
+    Node* node = NodeTraits::allocate(alloc_, 1);
+    try {
+        NodeTraits::construct(alloc_, node, std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc_, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::destroyNode(Node* node)
+{
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::destroyTree(Node* here)
+{
+    deleteSpares(unlinkNodes(here));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::deleteOneElementTree(const T& element)
+{
+    if (keyEquivalent(comp_, root_->element_, element)) {
+        destroyNode(root_);
         root_ = nullptr;
         --size_;
         return true;
@@ -299,33 +907,24 @@ bool AvlTree<T>::deleteOneElementTree(const T& element)
     }
 }
 
-template<typename T>
-void AvlTree<T>::deleteLeaf(Node* deletee)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::deleteLeaf(Node* deletee)
 {
     Node* parent = deletee->parent_;
-    if (deletee->element_ < parent->element_) {
-        delete parent->left_;
+    if (parent->left_ == deletee) {
+        destroyNode(parent->left_);
         parent->left_ = nullptr;
-    } else if (deletee->element_ > parent->element_) {
-        delete parent->right_;
+    } else {
+        destroyNode(parent->right_);
         parent->right_ = nullptr;
-    } 
-    // if the deletee is equal to its parent (can happen when deleting root)
-    else {
-        if (parent->right_ == nullptr) {
-            delete parent->left_;
-            parent->left_ = nullptr;
-        } else {
-            delete parent->right_;
-            parent->right_ = nullptr;
-        }
     }
+    Statistics::recountPath(parent);
     checkBalanced(parent, false);
     --size_;
 }
 
-template<typename T>
-void AvlTree<T>::deleteStick(Node* deletee, bool deleteLeft)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::deleteStick(Node* deletee, bool deleteLeft)
 {
     Node* newChild;
     // find the element to delete's child
@@ -347,13 +946,14 @@ void AvlTree<T>::deleteStick(Node* deletee, bool deleteLeft)
     // when deleting the deletee
     deletee->left_ = nullptr;
     deletee->right_ = nullptr;
-    delete deletee;
+    destroyNode(deletee);
+    Statistics::recountPath(newChild->parent_);
     checkBalanced(newChild->parent_, false);
     --size_;
 }
 
-template<typename T>
-void AvlTree<T>::deleteTwoChildNode(Node* deletee)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::deleteTwoChildNode(Node* deletee)
 {
     // replace the node to delete with the next node, then delete that
     // replacement's old node location
@@ -375,8 +975,8 @@ void AvlTree<T>::deleteTwoChildNode(Node* deletee)
 //    b   E  ->    A   d
 //   / \              / \
 //  A   C            C   E
-template <typename T> 
-void AvlTree<T>::rightRotate(Node* top)
+template <typename T, typename Compare, typename Allocator, typename Statistics> 
+void AvlTree<T, Compare, Allocator, Statistics>::rightRotate(Node* top)
 {
     Node* newRoot = top->left_;          // b is d's left child
     // if C exists, we need to change it's parent to be d
@@ -391,12 +991,14 @@ void AvlTree<T>::rightRotate(Node* top)
 
     top->updateHeight();
     newRoot->updateHeight();
+    Statistics::recount(top);
+    Statistics::recount(newRoot);
     
     // we then need to update the node pointing to our new top
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -410,8 +1012,8 @@ void AvlTree<T>::rightRotate(Node* top)
 //    A   d     ->    b   E
 //       / \         / \
 //      C   E       A   C
-template <typename T> 
-void AvlTree<T>::leftRotate(Node* top) 
+template <typename T, typename Compare, typename Allocator, typename Statistics> 
+void AvlTree<T, Compare, Allocator, Statistics>::leftRotate(Node* top) 
 {
     Node* newRoot = top->right_;      // d is b's right child
     // if C exists, we need to change it's parent to be b
@@ -426,12 +1028,14 @@ void AvlTree<T>::leftRotate(Node* top)
 
     top->updateHeight();
     newRoot->updateHeight();
+    Statistics::recount(top);
+    Statistics::recount(newRoot);
 
     // we then need to update the node pointing to our new top
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -439,8 +1043,8 @@ void AvlTree<T>::leftRotate(Node* top)
     }
 }
 
-template<typename T>
-int AvlTree<T>::nodeHeight(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+int AvlTree<T, Compare, Allocator, Statistics>::nodeHeight(Node* here)
 {
     if (here == nullptr) {
         return -1;
@@ -448,37 +1052,59 @@ int AvlTree<T>::nodeHeight(Node* here)
     return here->height_;
 }
 
-template<typename T>
-bool AvlTree<T>::isBalanced()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::isBalanced()
 {
     return isBalancedNode(root_);
 }
 
-template<typename T>
-bool AvlTree<T>::isBalancedNode(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::isBalancedNode(Node* here)
 {
-    if (here == nullptr) {
-        return true;
+    // check every node below here, along with the height it has stored
+    std::stack<Node*> pending;
+    if (here != nullptr) {
+        pending.push(here);
     }
-    return (std::abs(nodeHeight(here->left_) - nodeHeight(here->right_)) < 2);
+    while (!pending.empty()) {
+        Node* next = pending.top();
+        pending.pop();
+        int leftHeight = nodeHeight(next->left_);
+        int rightHeight = nodeHeight(next->right_);
+        if (std::abs(leftHeight - rightHeight) > 1 ||
+            next->height_ != std::max(leftHeight, rightHeight) + 1) {
+            return false;
+        }
+        if (next->left_ != nullptr) {
+            pending.push(next->left_);
+        }
+        if (next->right_ != nullptr) {
+            pending.push(next->right_);
+        }
+    }
+    return true;
 }
 
-template<typename T>
-std::ostream& AvlTree<T>::printStatistics(std::ostream& out) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+std::ostream& AvlTree<T, Compare, Allocator, Statistics>::printStatistics(std::ostream& out) const
 {
     out << "height " << height() << std::endl;
+    out << "node memory " << size() * sizeof(Node) << " bytes" << std::endl;
+    out << "allocated memory "
+        << allocatorBytes(alloc_, size() * sizeof(Node)) << " bytes"
+        << std::endl;
     return out;
 }
 
-template <typename T>
-std::ostream& AvlTree<T>::print(std::ostream& out) const
+template <typename T, typename Compare, typename Allocator, typename Statistics>
+std::ostream& AvlTree<T, Compare, Allocator, Statistics>::print(std::ostream& out) const
 {
     printPretty(root_, 1, 1, out);
     return out;
 }
 
-template<typename T>
-typename AvlTree<T>::iterator AvlTree<T>::begin() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::iterator AvlTree<T, Compare, Allocator, Statistics>::begin() const
 {
     Node* current = root_;
     // if tree is empty, we don't want to dereference current
@@ -491,21 +1117,28 @@ typename AvlTree<T>::iterator AvlTree<T>::begin() const
     return Iterator(current);
 }
 
-template<typename T>
-typename AvlTree<T>::iterator AvlTree<T>::end() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::iterator AvlTree<T, Compare, Allocator, Statistics>::end() const
 {
     return Iterator(nullptr);
 }
 
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template <typename Function>
+void AvlTree<T, Compare, Allocator, Statistics>::forEach(Function&& visit) const
+{
+    forEachInOrder(root_, visit);
+}
+
 // --------------------------------------
 //
 // Implementation of Pretty Print
 // (taken from http://articles.leetcode.com/2010/09/how-to-pretty-print-binary-tree.html)
 //
 // --------------------------------------
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Print the arm branches (eg, /    \ ) on a line
-void AvlTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void AvlTree<T, Compare, Allocator, Statistics>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel / 2; i++) {  
     out << ((i == 0) ? std::setw(startLen-1) : std::setw(nodeSpaceLen-2)) << "" << ((*iter++) ? "/" : " ");
@@ -514,9 +1147,9 @@ void AvlTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, in
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Print the branches and node (eg, ___10___ )
-void AvlTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void AvlTree<T, Compare, Allocator, Statistics>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(startLen) : std::setw(nodeSpaceLen)) << "" << ((*iter && (*iter)->left_) ? std::setfill('_') : std::setfill(' '));
@@ -536,9 +1169,9 @@ void AvlTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int n
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Print the leaves only (just for the bottom row)
-void AvlTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void AvlTree<T, Compare, Allocator, Statistics>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(indentSpace+2) : std::setw(2*level+2)) << ((*iter) ? std::to_string((*iter)->element_)/* + " " + std::to_string((*iter)->height_) */: "");
@@ -546,12 +1179,12 @@ void AvlTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, c
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Pretty formatting of a binary tree to the output stream
 // @ param
 // level  Control how wide you want the tree to sparse (eg, level 1 has the minimum space between nodes, while level 2 has a larger space between nodes)
 // indentSpace  Change this to add some indent space to the left (eg, indentSpace of 0 means the lowest level of the left node will stick to the left margin)
-void AvlTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
+void AvlTree<T, Compare, Allocator, Statistics>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
   int h = subtreeHeight(root_); //maxHeight(root);
   int nodesInThisLevel = 1;
 
@@ -590,22 +1223,28 @@ void AvlTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostrea
 // Implementation of AvlTree::Node
 //
 // --------------------------------------
-template<typename T>
-AvlTree<T>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
     :element_{element}, left_{left}, right_{right}, parent_{parent}, height_{0}
 {
     // nothing else to do
 }
 
-template<typename T>
-AvlTree<T>::Node::~Node()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::Node::Node(T&& element, Node* left, Node* right, Node* parent)
+    :element_{std::move(element)}, left_{left}, right_{right}, parent_{parent}, height_{0}
+{
+    // nothing else to do
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::Node::~Node()
 {
-    delete left_;
-    delete right_;
+    // the tree frees the children itself
 }
 
-template<typename T>
-size_t AvlTree<T>::Node::size() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t AvlTree<T, Compare, Allocator, Statistics>::Node::size() const
 {
     size_t size = 1;
 
@@ -618,8 +1257,8 @@ size_t AvlTree<T>::Node::size() const
     return size;
 }
 
-template<typename T>
-int AvlTree<T>::Node::getBalance()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+int AvlTree<T, Compare, Allocator, Statistics>::Node::getBalance()
 {
     /*int leftHeight = 0;
     if (left_ != nullptr) {
@@ -632,15 +1271,15 @@ int AvlTree<T>::Node::getBalance()
     return nodeHeight(right_) - nodeHeight(left_);
 }
 
-template<typename T>
-void AvlTree<T>::Node::updateHeight()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::Node::updateHeight()
 {
     int newHeight = std::max(nodeHeight(left_), nodeHeight(right_)) + 1;
     height_ = newHeight != -1 ? newHeight : 0;
 }
 
 /*template<typename T>
-size_t AvlTree<T>::Node::subtreeHeight() const
+size_t AvlTree<T, Compare, Allocator, Statistics>::Node::subtreeHeight() const
 {
     // recursive base case (at a leaf)
     if (left_ == nullptr && right_ == nullptr) {
@@ -659,32 +1298,64 @@ size_t AvlTree<T>::Node::subtreeHeight() const
     return 1 + std::max(leftSize, rightSize);
 }*/
 
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::DroppedNodes::DroppedNodes()
+    : first_{nullptr}, last_{nullptr}
+{
+    // nothing else to do
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::DroppedNodes::add(Node* here)
+{
+    if (here == nullptr) {
+        return;
+    }
+    here->parent_ = nullptr;
+    if (last_ == nullptr) {
+        first_ = here;
+    } else {
+        last_->parent_ = here;
+    }
+    last_ = here;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void AvlTree<T, Compare, Allocator, Statistics>::DroppedNodes::append(DroppedNodes& other)
+{
+    if (other.first_ == nullptr) {
+        return;
+    }
+    if (last_ == nullptr) {
+        first_ = other.first_;
+    } else {
+        last_->parent_ = other.first_;
+    }
+    last_ = other.last_;
+    other.first_ = nullptr;
+    other.last_ = nullptr;
+}
+
 // --------------------------------------
 //
 // Implementation of AvlTree::Iterator
 //
 // --------------------------------------
 
-template<typename T>
-AvlTree<T>::Iterator::Iterator(Node* index)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+AvlTree<T, Compare, Allocator, Statistics>::Iterator::Iterator(Node* index)
     : current_{index}
 {
     // Nothing else to do.
 }
 
-template<typename T>
-typename AvlTree<T>::Iterator& AvlTree<T>::Iterator::operator++()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Iterator& AvlTree<T, Compare, Allocator, Statistics>::Iterator::operator++()
 {
-    bool lastElement = false;
-    // empty tree
+    // empty tree, or already past the end
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
-    }
     // if there's something to the right, we go there then go as far to the left
     // as we can, for example to get from 10 to 11 in this tree
     //            10
@@ -701,120 +1372,67 @@ typename AvlTree<T>::Iterator& AvlTree<T>::Iterator::operator++()
         while (current_->left_ != nullptr) {
             current_ = current_->left_;
         }
-    } 
-    // nothing to the right and at the root node, which means we are at the
-    // last element in the tree
-    else if (current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
     }
-    // at this point we must go back up the tree to get to the next largest 
-    // value
-    // if stepping back up to the parent gives us a larger value, then we stop
-    else if (current_->parent_->element_ > current_->element_) {
+    // otherwise we go back up the tree until we step up out of a left
+    // subtree, that parent is the next largest value. If we step off the top
+    // of the tree we were at the largest element, and end up at end()
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    } 
-    // if stepping back up to the parent gives us a smaller value, then we keep
-    // going up until we hit a larger value
-    else if (current_->parent_->element_ < current_->element_) {
-        while (current_->parent_->element_ < current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                lastElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!lastElement) {
+        while (current_ != nullptr && current_->right_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the last element, return the equivalent of the end()
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-typename AvlTree<T>::Iterator& AvlTree<T>::Iterator::operator--()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename AvlTree<T, Compare, Allocator, Statistics>::Iterator& AvlTree<T, Compare, Allocator, Statistics>::Iterator::operator--()
 {
     // maybe something to handle -- on end()?
 
-    bool firstElement = false;
     // empty tree
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    else if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
     // if there is something to the left, we go there and then go to the right
     // as far as we can
-    else if (current_->left_ != nullptr) {
+    if (current_->left_ != nullptr) {
         current_ = current_->left_;
         while (current_->right_ != nullptr) {
             current_ = current_->right_;
         }
     }
-    // nothing to the left and at the root node, which means we are at the
-    // first element in the tree
-    else if (current_->left_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // at this point we must go back up the tree to get to the next smallest 
-    // value
-    // if stepping back up to the parent gives us a smaller value, then we stop
-    else if (current_->parent_->element_ < current_->element_) {
+    // otherwise we go back up the tree until we step up out of a right
+    // subtree, that parent is the next smallest value. If we step off the top
+    // of the tree we were at the smallest element, and end up at null
+    // (-- on begin())
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    }
-    // if stepping back up to the parent gives us a larger value, then we keep
-    // going up until we hit a smaller value
-    else if (current_->parent_->element_ > current_->element_) {
-        while (current_->parent_->element_ > current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                firstElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!firstElement) {
+        while (current_ != nullptr && current_->left_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the first element, return null (-- on begin())
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-T& AvlTree<T>::Iterator::operator*() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+T& AvlTree<T, Compare, Allocator, Statistics>::Iterator::operator*() const
 {
     return current_->element_;
 }
 
-template<typename T>
-bool AvlTree<T>::Iterator::operator==(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::Iterator::operator==(const Iterator& rhs) const
 {
     return (current_ == rhs.current_);
 }
 
-template<typename T>
-bool AvlTree<T>::Iterator::operator!=(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool AvlTree<T, Compare, Allocator, Statistics>::Iterator::operator!=(const Iterator& rhs) const
 {
     return !(*this == rhs);
 }
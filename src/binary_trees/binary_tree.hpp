@@ -11,6 +11,10 @@
 #ifndef BINARY_TREE_INCLUDED
 #define BINARY_TREE_INCLUDED 1
 #include <cstddef>
+#include "node_pool.hpp"
+#include "key_compare.hpp"
+#include "iterator_range.hpp"
+#include "in_order.hpp"
 #include <cassert>
 #include <iostream>
 #include <time.h>       // time
@@ -19,19 +23,40 @@
 #include <list>
 #include <iomanip>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <functional>
 
 /**
 * \class BinaryTree
 * \brief A base binary tree class, containing code that is common to all binary trees
 */
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>,
+          typename Allocator = NodePool<T>>
 class BinaryTree {
 
 protected:
     class Iterator; // Forward declaration
 
 public:
+
+    /**
+    * \brief
+    * Default Constructor
+    *
+    */
+    BinaryTree();
+
+    /**
+    * \brief
+    * Comparator Constructor
+    *
+    * \param comp the comparator to order the elements with
+    */
+    explicit BinaryTree(const Compare& comp);
     
     /**
     * \brief 
@@ -44,15 +69,39 @@ public:
     * \brief
     * Copy Constructor
     *
+    * \details Copies the tree node by node, so the copy has exactly the same
+    * shape as the original.
+    *
+    * \note O(n) time
     */
-    BinaryTree<T>(const BinaryTree<T>& orig);
+    BinaryTree<T, Compare, Allocator>(const BinaryTree<T, Compare, Allocator>& orig);
 
     /**
     * \brief
     * Assignment Operator
     *
+    * \details Reuses the nodes the tree already holds before allocating new
+    * ones.
+    */
+    BinaryTree<T, Compare, Allocator>& operator=(const BinaryTree<T, Compare, Allocator>& rhs);
+
+    /**
+    * \brief
+    * Move Constructor
+    *
+    * \details Takes over the nodes of orig, leaving it empty
+    *
+    * \note constant time
+    */
+    BinaryTree<T, Compare, Allocator>(BinaryTree<T, Compare, Allocator>&& orig);
+
+    /**
+    * \brief
+    * Move Assignment Operator
+    *
+    * \note constant time, apart from freeing the tree's old nodes
     */
-    BinaryTree<T>& operator=(const BinaryTree<T>& rhs);
+    BinaryTree<T, Compare, Allocator>& operator=(BinaryTree<T, Compare, Allocator>&& rhs);
 
     /**
     * \brief
@@ -60,14 +109,37 @@ public:
     *
     *
     */
-    void swap(BinaryTree<T>& rhs);
+    void swap(BinaryTree<T, Compare, Allocator>& rhs);
 
+    /**
+    * \brief
+    * Replaces the contents of the tree with the elements in [first, last)
+    *
+    * \details The range must already be sorted; repeated elements are only
+    * stored once. The tree is rebuilt perfectly balanced without any
+    * comparisons or rotations.
+    *
+    * \note runs in O(n) time
+    */
+    template <typename InputIterator>
+    void assignSorted(InputIterator first, InputIterator last);
 
     // Allow users to iterate over the contents of the list. 
     using iterator = Iterator; 
     iterator begin() const; ///< An iterator that refers to the first element
     iterator end() const;   ///< A "past-the-end" iterator
 
+    /**
+    * \brief calls visit(element) for every element, in order
+    *
+    * \details a tight loop, much faster than the iterators over a whole
+    * tree
+    *
+    * \note visit mustn't change the tree
+    */
+    template <typename Function>
+    void forEach(Function&& visit) const;
+
     /**
     * \brief 
     * Size function
@@ -93,6 +165,19 @@ public:
     * \note runs in O(log(n)) time
     */
     virtual bool insert(const T& element) = 0;
+    virtual bool insert(T&& element) = 0;
+
+    /**
+    * \brief
+    * Constructs an element out of args and inserts it into the tree
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \returns true if the element was inserted, false if it was already
+    * present
+    */
+    template <typename... Args>
+    bool emplace(Args&&... args);
 
     /**
     * \brief 
@@ -115,6 +200,67 @@ public:
     */
     virtual bool contains(const T& element) const = 0;
 
+    /**
+    * \brief
+    * Checks if an element equivalent to key is in the tree
+    *
+    * \note only available if Compare defines is_transparent, so keys of
+    * other types can be looked up without converting them to T
+    */
+    template <typename K, typename C = Compare,
+              typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    /**
+    * \brief returns a copy of the comparator that orders the tree
+    */
+    Compare key_comp() const;
+
+    /**
+    * \brief
+    * Finds an element in the tree
+    *
+    * \returns an iterator to the element, end() if it isn't in the tree
+    */
+    iterator find(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that doesn't sort before element
+    *
+    * \returns end() if every element sorts before element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator lower_bound(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that sorts after element
+    *
+    * \returns end() if no element sorts after element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator upper_bound(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements equivalent to element as a pair of iterators, so
+    * the range is empty if element isn't in the tree
+    */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements in [lower, upper), for use in a range-based for
+    * loop
+    *
+    * \note log(n) time to find the ends of the range, then the scan costs
+    * amortized constant time per element
+    */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
+
     /**
     * \brief
     * Binary Tree equality operator
@@ -123,7 +269,7 @@ public:
     * otherwise
     *
     */
-    bool operator==(const BinaryTree<T>& rhs) const;
+    bool operator==(const BinaryTree<T, Compare, Allocator>& rhs) const;
 
     /**
     * \brief
@@ -132,7 +278,7 @@ public:
     * \returns true if the tree rhs is not equal to the current tree, false
     * otherwise
     */
-    bool operator!=(const BinaryTree<T>& rhs) const;
+    bool operator!=(const BinaryTree<T, Compare, Allocator>& rhs) const;
 
     /**
     * \brief
@@ -179,6 +325,7 @@ protected:
         *
         */
         Node(const T& element, Node* left, Node* right, Node* parent);
+        Node(T&& element, Node* left, Node* right, Node* parent);
         /**
         * \brief Node default destructor
         *
@@ -200,6 +347,12 @@ protected:
         Node() = delete; // disable default constructor
         Node& operator=(const Node&) = delete; // disable assignment operator
     };
+
+    using NodeAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator alloc_; ///> where the tree's nodes come from
+    Compare comp_;        ///> orders the elements
     size_t size_;
     mutable Node* root_;
 
@@ -228,7 +381,7 @@ protected:
      * \param top The node to rotate about
      * 
      */
-    void rightRotate(Node* top);
+    void rightRotate(Node* top) const;
 
     /**
      * \brief
@@ -237,7 +390,7 @@ protected:
      * \param top The node to rotate about
      * 
      */
-    void leftRotate(Node* top);
+    void leftRotate(Node* top) const;
 
 
     /**
@@ -248,16 +401,16 @@ protected:
      * \param element The element to insert
      */
     virtual bool insertNode(Node*& here, const T& element) = 0;
+    virtual bool insertNode(Node*& here, T&& element) = 0;
 
     /**
     * \brief
-    * inserts an node into the root of the tree
-    * 
-    * \param here The node to insert at
-    * \param element The element to insert
+    * Restores the tree's balance after an insert or delete below
+    * startingNode
     *
+    * \note does nothing by default, balanced trees override it
     */
-    virtual bool insertNodeAtRoot(Node*& here, const T& element) = 0;
+    virtual void checkBalanced(Node* startingNode, bool afterInsert);
 
     /**
      * \brief
@@ -268,7 +421,8 @@ protected:
      *
      * \returns True if the element is present in the tree, false if otherwise
      */
-    Node* findNode(Node* here, const T& element) const;
+    template <typename K>
+    Node* findNode(Node* here, const K& element) const;
 
     Node* getNextNode(Node* here);
 
@@ -304,6 +458,78 @@ protected:
     */
     bool deleteOneElementTree(const T& element);
 
+    /**
+    * \brief replaces the tree with a perfectly balanced tree holding the
+    * sorted elements
+    *
+    * \param elements sorted elements, repeated elements are removed
+    */
+    void buildFromSorted(std::vector<T>& elements);
+
+    /**
+    * \brief builds a perfectly balanced subtree out of the sorted elements in
+    * [lower, upper)
+    *
+    * \returns the root of the new subtree
+    */
+    Node* buildSubtree(const std::vector<T>& elements, size_t lower,
+                       size_t upper, Node* parent);
+
+    /**
+    * \brief copies the tree rooted at source node by node, keeping its shape
+    * and heights
+    *
+    * \param spares nodes to reuse before allocating new ones, linked through
+    * their right_ pointers
+    *
+    * \returns the root of the copy
+    */
+    Node* cloneTree(const Node* source, Node*& spares);
+
+    /**
+    * \brief makes a childless copy of source below parent, reusing a spare
+    * node if there is one
+    */
+    Node* cloneNode(const Node* source, Node* parent, Node*& spares);
+
+    /**
+    * \brief takes apart the tree rooted at here into a list of nodes linked
+    * through their right_ pointers
+    *
+    * \returns the head of the list
+    */
+    static Node* unlinkNodes(Node* here);
+
+    /**
+    * \brief frees a list of nodes made by unlinkNodes
+    */
+    void deleteSpares(Node* spares);
+
+    /**
+    * \brief allocates a node from the tree's allocator and constructs it
+    * out of args
+    */
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+
+    /**
+    * \brief destroys a single node and gives its memory back, the node's
+    * children are left alone
+    */
+    void destroyNode(Node* node);
+
+    /**
+    * \brief destroys every node in the subtree rooted at here, without
+    * recursing
+    */
+    void destroyTree(Node* here);
+
+    /**
+    * \brief returns an iterator to here, end() if here is nullptr, for
+    * derived trees that find nodes themselves
+    */
+    static iterator iteratorAt(Node* here);
+
     class Iterator
     {
     public:
@@ -330,9 +556,9 @@ protected:
 
 };
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 /// Provide a non-member version of swap to allow standard swap(x,y) usage.
-void swap(BinaryTree<T>& lhs, BinaryTree<T>& rhs);
+void swap(BinaryTree<T, Compare, Allocator>& lhs, BinaryTree<T, Compare, Allocator>& rhs);
 
 #include "binary_tree_private.hpp"
 
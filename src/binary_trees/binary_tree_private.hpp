@@ -6,63 +6,156 @@
  * binary trees
  */
 
-template<typename T>
-BinaryTree<T>::~BinaryTree()
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::BinaryTree()
+            : size_{0}, root_{nullptr}
 {
-    delete root_;
+    // nothing else to do
 }
 
-template<typename T>
-BinaryTree<T>::BinaryTree(const BinaryTree<T>& orig)
-            : size_{0}, root_{nullptr}
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::BinaryTree(const Compare& comp)
+            : comp_{comp}, size_{0}, root_{nullptr}
+{
+    // nothing else to do
+}
+
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::~BinaryTree()
+{
+    destroyTree(root_);
+}
+
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::BinaryTree(const BinaryTree<T, Compare, Allocator>& orig)
+            : alloc_{NodeTraits::select_on_container_copy_construction(
+                  orig.alloc_)}, comp_{orig.comp_}, size_{orig.size_},
+              root_{nullptr}
 {
-    for (iterator i = orig.begin(); i != orig.end(); ++i) {
-        insert(*i);
+    Node* spares = nullptr;
+    root_ = cloneTree(orig.root_, spares);
+}
+
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>& BinaryTree<T, Compare, Allocator>::operator=(const BinaryTree<T, Compare, Allocator>& rhs)
+{
+    if (this != &rhs) {
+        // reuse the nodes we already have and free whatever is left over
+        Node* spares = unlinkNodes(root_);
+        root_ = cloneTree(rhs.root_, spares);
+        deleteSpares(spares);
+        comp_ = rhs.comp_;
+        size_ = rhs.size_;
     }
+    return *this;
 }
 
-template<typename T>
-BinaryTree<T>& BinaryTree<T>::operator=(const BinaryTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::BinaryTree(BinaryTree<T, Compare, Allocator>&& orig)
+            : alloc_{std::move(orig.alloc_)}, comp_{orig.comp_},
+              size_{orig.size_},
+              root_{orig.root_}
 {
-    BinaryTree<T> copy{rhs};
-    swap(copy);
+    orig.size_ = 0;
+    orig.root_ = nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>& BinaryTree<T, Compare, Allocator>::operator=(BinaryTree<T, Compare, Allocator>&& rhs)
+{
+    if (this != &rhs) {
+        destroyTree(root_);
+        // our now empty allocator goes to rhs along with its empty tree
+        using std::swap;
+        swap(alloc_, rhs.alloc_);
+        swap(comp_, rhs.comp_);
+        root_ = rhs.root_;
+        size_ = rhs.size_;
+        rhs.root_ = nullptr;
+        rhs.size_ = 0;
+    }
     return *this;
 }
 
-template<typename T>
-void BinaryTree<T>::swap(BinaryTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::swap(BinaryTree<T, Compare, Allocator>& rhs)
 {
     using std::swap;
     swap(root_, rhs.root_);
     swap(size_, rhs.size_);
+    swap(alloc_, rhs.alloc_);
+    swap(comp_, rhs.comp_);
 }
 
-template<typename T>
-void swap(BinaryTree<T>& lhs, BinaryTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator>
+void swap(BinaryTree<T, Compare, Allocator>& lhs, BinaryTree<T, Compare, Allocator>& rhs)
 {
     lhs.swap(rhs);
 }
 
-template<typename T>
-size_t BinaryTree<T>::size() const
+template<typename T, typename Compare, typename Allocator>
+template<typename InputIterator>
+void BinaryTree<T, Compare, Allocator>::assignSorted(InputIterator first, InputIterator last)
+{
+    std::vector<T> elements(first, last);
+    assert(std::is_sorted(elements.begin(), elements.end(),
+                          [this](const T& a, const T& b) {
+                              return keyLess(comp_, a, b);
+                          }));
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::buildFromSorted(std::vector<T>& elements)
+{
+    // a set only holds each element once
+    elements.erase(std::unique(elements.begin(), elements.end(),
+                               [this](const T& a, const T& b) {
+                                   return keyEquivalent(comp_, a, b);
+                               }),
+                   elements.end());
+    destroyTree(root_);
+    root_ = buildSubtree(elements, 0, elements.size(), nullptr);
+    size_ = elements.size();
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::buildSubtree(
+    const std::vector<T>& elements, size_t lower, size_t upper, Node* parent)
+{
+    if (lower == upper) {
+        return nullptr;
+    }
+    // the middle element becomes the root so both halves differ in size by
+    // at most one
+    size_t middle = lower + (upper - lower) / 2;
+    Node* here = createNode(elements[middle], nullptr, nullptr, parent);
+    here->left_ = buildSubtree(elements, lower, middle, here);
+    here->right_ = buildSubtree(elements, middle + 1, upper, here);
+    here->updateHeight();
+    return here;
+}
+
+template<typename T, typename Compare, typename Allocator>
+size_t BinaryTree<T, Compare, Allocator>::size() const
 {
     return size_;
 }
 
-template<typename T>
-size_t BinaryTree<T>::height() const
+template<typename T, typename Compare, typename Allocator>
+size_t BinaryTree<T, Compare, Allocator>::height() const
 {
     return subtreeHeight(root_);
 }
 
-template<typename T>
-bool BinaryTree<T>::empty() const
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::empty() const
 {
     return (root_ == nullptr);
 }
 
-template<typename T>
-bool BinaryTree<T>::operator==(const BinaryTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::operator==(const BinaryTree<T, Compare, Allocator>& rhs) const
 {
     // if the sizes are different the trees are not equal
     if (size() != rhs.size()) {
@@ -82,29 +175,39 @@ bool BinaryTree<T>::operator==(const BinaryTree<T>& rhs) const
     return true;
 }
 
-template<typename T>
-bool BinaryTree<T>::operator!=(const BinaryTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::operator!=(const BinaryTree<T, Compare, Allocator>& rhs) const
 {
     return !(*this == rhs);
 }
 
-template<typename T>
-size_t BinaryTree<T>::subtreeHeight(Node* here) const
+template<typename T, typename Compare, typename Allocator>
+size_t BinaryTree<T, Compare, Allocator>::subtreeHeight(Node* here) const
 {
-    // recursive base case
-    if (here == nullptr) {
-        return 0;
+    // walk the subtree with an explicit stack of nodes and their depths,
+    // a path-shaped tree is as deep as it is big
+    size_t height = 0;
+    std::stack<std::pair<Node*, size_t>> toVisit;
+    if (here != nullptr) {
+        toVisit.push(std::make_pair(here, 1));
     }
-    // recursively get the left and right subtree heights
-    size_t leftSize = subtreeHeight(here->left_);
-    size_t rightSize = subtreeHeight(here->right_);
-
-    // the taller of the two subtrees is the height of the overall subtree
-    return 1 + std::max(leftSize, rightSize);
+    while (!toVisit.empty()) {
+        Node* node = toVisit.top().first;
+        size_t depth = toVisit.top().second;
+        toVisit.pop();
+        height = std::max(height, depth);
+        if (node->left_ != nullptr) {
+            toVisit.push(std::make_pair(node->left_, depth + 1));
+        }
+        if (node->right_ != nullptr) {
+            toVisit.push(std::make_pair(node->right_, depth + 1));
+        }
+    }
+    return height;
 }
 
-template<typename T>
-bool BinaryTree<T>::contains(const T& element) const
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::contains(const T& element) const
 {
     if (findNode(root_, element) == nullptr) {
         return false;
@@ -113,29 +216,68 @@ bool BinaryTree<T>::contains(const T& element) const
     }
 }
 
-template<typename T>
-typename BinaryTree<T>::Node* BinaryTree<T>::findNode(Node* here, const T& element) const
+template<typename T, typename Compare, typename Allocator>
+template<typename K, typename C, typename>
+bool BinaryTree<T, Compare, Allocator>::contains(const K& key) const
 {
-    if (here == nullptr) {
-        return nullptr;
-    } 
-    // continue searching to the left
-    else if (element < here->element_) {
-        return findNode(here->left_, element);
+    return findNode(root_, key) != nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator>
+Compare BinaryTree<T, Compare, Allocator>::key_comp() const
+{
+    return comp_;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::iterator BinaryTree<T, Compare, Allocator>::find(const T& element) const
+{
+    return Iterator(findNode(root_, element));
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::iterator BinaryTree<T, Compare, Allocator>::lower_bound(const T& element) const
+{
+    return Iterator(lowerBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::iterator BinaryTree<T, Compare, Allocator>::upper_bound(const T& element) const
+{
+    return Iterator(upperBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator>
+std::pair<typename BinaryTree<T, Compare, Allocator>::iterator, typename BinaryTree<T, Compare, Allocator>::iterator>
+BinaryTree<T, Compare, Allocator>::equal_range(const T& element) const
+{
+    iterator first = lower_bound(element);
+    iterator last = first;
+    // the elements are unique, so at most one of them can be equivalent
+    if (last != end() && !keyLess(comp_, element, *last)) {
+        ++last;
     }
-    // continue searching to the right
-    else if (element > here->element_) {
-        return findNode(here->right_, element);
-    } 
-    // element is not less than or greater than here->element_, so it must
-    // be equal to here->element_
-    else {
-        return here;
+    return std::make_pair(first, last);
+}
+
+template<typename T, typename Compare, typename Allocator>
+IteratorRange<typename BinaryTree<T, Compare, Allocator>::iterator> BinaryTree<T, Compare, Allocator>::range(const T& lower, const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return IteratorRange<iterator>(end(), end());
     }
+    return IteratorRange<iterator>(lower_bound(lower), lower_bound(upper));
 }
 
-template<typename T>
-bool BinaryTree<T>::insert(const T& element)
+template<typename T, typename Compare, typename Allocator>
+template<typename K>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::findNode(Node* here, const K& element) const
+{
+    return searchKey(here, element, comp_).match_;
+}
+
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::insert(const T& element)
 {
     if (insertNode(root_, element)) {
         ++size_;
@@ -144,47 +286,53 @@ bool BinaryTree<T>::insert(const T& element)
     return false;
 }
 
-template<typename T>
-bool BinaryTree<T>::insertNode(Node*& here, const T& element)
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::insert(T&& element)
+{
+    if (insertNode(root_, std::move(element))) {
+        ++size_;
+        return true;
+    }
+    return false;
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename... Args>
+bool BinaryTree<T, Compare, Allocator>::emplace(Args&&... args)
+{
+    return insert(T(std::forward<Args>(args)...));
+}
+
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::insertNode(Node*& here, const T& element)
 {
     // if we have an empty tree, make a new node
     if (here == nullptr) {
-        here = new Node(element, nullptr, nullptr, nullptr);
+        here = createNode(element, nullptr, nullptr, nullptr);
         return true;
     }
-    // otherwise go down to the next level in the tree
-    else if (element < here->element_) {
-        if (here->left_ == nullptr) {
-            here->left_ = new Node(element, nullptr, nullptr, here);
-            if (here->right_ == nullptr) {
-                ++here->height_;
-            }
-            checkBalanced(here->parent_, true);
-            return true;
-        } else {
-            return insertNode(here->left_, element);
-        }
-    } else if (element > here->element_) {
-        if (here->right_ == nullptr) {
-            here->right_ = new Node(element, nullptr, nullptr, here);
-            if (here->left_ == nullptr){
-                ++here->height_;
-            }
-            checkBalanced(here->parent_, true);
-            return true;
-        } else {
-            return insertNode(here->right_, element);
-        }
-    } 
-    // if we aren't less than or greater than the element, we must be equal
-    // and thus we can't insert
-    else {
+    KeySearch<Node> spot = searchKey(here, element, comp_);
+    // if the element is already in the tree we can't insert
+    if (spot.match_ != nullptr) {
         return false;
     }
+    Node* parent = spot.parent_;
+    Node* newNode = createNode(element, nullptr, nullptr, parent);
+    if (spot.left_) {
+        parent->left_ = newNode;
+    } else {
+        parent->right_ = newNode;
+    }
+    // a new only child makes its parent one taller
+    if (parent->left_ == nullptr || parent->right_ == nullptr) {
+        ++parent->height_;
+    }
+    checkBalanced(parent->parent_, true);
+    return true;
 }
 
-template<typename T>
-bool BinaryTree<T>::deleteElement(const T& element)
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::deleteElement(const T& element)
 {
     if (empty()) {
         return false;
@@ -192,18 +340,16 @@ bool BinaryTree<T>::deleteElement(const T& element)
     if (size_ == 1) {
         return deleteOneElementTree(element);
     }
-    Node* deletee;    // the node to delete
-    if (root_->element_ == element) {
+    Node* deletee = findNode(root_, element);    // the node to delete
+    // if we couldn't find a node holding the element, we can't delete
+    if (deletee == nullptr) {
+        return false;
+    }
+    if (deletee == root_) {
         deletee = getNextNode(root_);
         // set the root's value to be it's replacement's value, then proceed to
         // delete the old node containing the replacement
         root_->element_ = deletee->element_;
-    } else {
-        deletee = findNode(root_, element);
-        // if we couldn't find a node holding the element, we can't delete
-        if (deletee == nullptr) {
-            return false;
-        }
     }
     // if the element to delete is a leaf, just remove the leaf
     if (deletee->left_ == nullptr && deletee->right_ == nullptr) {
@@ -223,8 +369,8 @@ bool BinaryTree<T>::deleteElement(const T& element)
     }
 }
 
-template<typename T>
-typename BinaryTree<T>::Node* BinaryTree<T>::getNextNode(Node* here)
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::getNextNode(Node* here)
 {
     iterator nextNode = Iterator(here);
     // go one to the right if we can
@@ -233,14 +379,119 @@ typename BinaryTree<T>::Node* BinaryTree<T>::getNextNode(Node* here)
         // go to the right)
         nextNode = --(Iterator(root_));
     }
-    return findNode(root_, *nextNode);
+    return nextNode.current_;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::cloneTree(const Node* source, Node*& spares)
+{
+    if (source == nullptr) {
+        return nullptr;
+    }
+    Node* root = cloneNode(source, nullptr, spares);
+    // walk both trees together using the parent pointers, so deep trees
+    // can't overflow the stack
+    Node* copy = root;
+    while (copy != nullptr) {
+        if (source->left_ != nullptr && copy->left_ == nullptr) {
+            copy->left_ = cloneNode(source->left_, copy, spares);
+            source = source->left_;
+            copy = copy->left_;
+        } else if (source->right_ != nullptr && copy->right_ == nullptr) {
+            copy->right_ = cloneNode(source->right_, copy, spares);
+            source = source->right_;
+            copy = copy->right_;
+        } else {
+            // both subtrees are done, go back up
+            source = source->parent_;
+            copy = copy->parent_;
+        }
+    }
+    return root;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::cloneNode(const Node* source, Node* parent,
+                                                       Node*& spares)
+{
+    Node* copy;
+    if (spares == nullptr) {
+        copy = createNode(source->element_, nullptr, nullptr, parent);
+    } else {
+        copy = spares;
+        spares = spares->right_;
+        copy->element_ = source->element_;
+        copy->left_ = nullptr;
+        copy->right_ = nullptr;
+        copy->parent_ = parent;
+    }
+    copy->height_ = source->height_;
+    return copy;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::unlinkNodes(Node* here)
+{
+    Node* spares = nullptr;
+    while (here != nullptr) {
+        if (here->left_ != nullptr) {
+            // rotate the left child up until there is nothing on the left
+            Node* left = here->left_;
+            here->left_ = left->right_;
+            left->right_ = here;
+            here = left;
+        } else {
+            Node* next = here->right_;
+            here->right_ = spares;
+            spares = here;
+            here = next;
+        }
+    }
+    return spares;
 }
 
-template<typename T>
-bool BinaryTree<T>::deleteOneElementTree(const T& element)
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::deleteSpares(Node* spares)
 {
-    if (root_->element_ == element) {
-        delete root_;
+    while (spares != nullptr) {
+        Node* next = spares->right_;
+        destroyNode(spares);
+        spares = next;
+    }
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename... Args>
+typename BinaryTree<T, Compare, Allocator>::Node* BinaryTree<T, Compare, Allocator>::createNode(Args&&... args)
+{
+    Node* node = NodeTraits::allocate(alloc_, 1);
+    try {
+        NodeTraits::construct(alloc_, node, std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc_, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::destroyNode(Node* node)
+{
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+}
+
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::destroyTree(Node* here)
+{
+    deleteSpares(unlinkNodes(here));
+}
+
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::deleteOneElementTree(const T& element)
+{
+    if (keyEquivalent(comp_, root_->element_, element)) {
+        destroyNode(root_);
         root_ = nullptr;
         --size_;
         return true;
@@ -249,33 +500,23 @@ bool BinaryTree<T>::deleteOneElementTree(const T& element)
     }
 }
 
-template<typename T>
-void BinaryTree<T>::deleteLeaf(Node* deletee)
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::deleteLeaf(Node* deletee)
 {
     Node* parent = deletee->parent_;
-    if (deletee->element_ < parent->element_) {
-        delete parent->left_;
+    if (parent->left_ == deletee) {
+        destroyNode(parent->left_);
         parent->left_ = nullptr;
-    } else if (deletee->element_ > parent->element_) {
-        delete parent->right_;
+    } else {
+        destroyNode(parent->right_);
         parent->right_ = nullptr;
-    } 
-    // if the deletee is equal to its parent (can happen when deleting root)
-    else {
-        if (parent->right_ == nullptr) {
-            delete parent->left_;
-            parent->left_ = nullptr;
-        } else {
-            delete parent->right_;
-            parent->right_ = nullptr;
-        }
     }
     checkBalanced(parent, false);
     --size_;
 }
 
-template<typename T>
-void BinaryTree<T>::deleteStick(Node* deletee, bool deleteLeft)
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::deleteStick(Node* deletee, bool deleteLeft)
 {
     Node* newChild;
     // find the element to delete's child
@@ -297,13 +538,13 @@ void BinaryTree<T>::deleteStick(Node* deletee, bool deleteLeft)
     // when deleting the deletee
     deletee->left_ = nullptr;
     deletee->right_ = nullptr;
-    delete deletee;
+    destroyNode(deletee);
     checkBalanced(newChild->parent_, false);
     --size_;
 }
 
-template<typename T>
-void BinaryTree<T>::deleteTwoChildNode(Node* deletee)
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::deleteTwoChildNode(Node* deletee)
 {
     // replace the node to delete with the next node, then delete that
     // replacement's old node location
@@ -325,8 +566,8 @@ void BinaryTree<T>::deleteTwoChildNode(Node* deletee)
 //    b   E  ->    A   d
 //   / \              / \
 //  A   C            C   E
-template <typename T> 
-void BinaryTree<T>::rightRotate(Node* top)
+template <typename T, typename Compare, typename Allocator> 
+void BinaryTree<T, Compare, Allocator>::rightRotate(Node* top) const
 {
     Node* newRoot = top->left_;          // b is d's left child
     // if C exists, we need to change it's parent to be d
@@ -346,7 +587,7 @@ void BinaryTree<T>::rightRotate(Node* top)
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -360,8 +601,8 @@ void BinaryTree<T>::rightRotate(Node* top)
 //    A   d     ->    b   E
 //       / \         / \
 //      C   E       A   C
-template <typename T> 
-void BinaryTree<T>::leftRotate(Node* top) 
+template <typename T, typename Compare, typename Allocator> 
+void BinaryTree<T, Compare, Allocator>::leftRotate(Node* top) const
 {
     Node* newRoot = top->right_;      // d is b's right child
     // if C exists, we need to change it's parent to be b
@@ -381,7 +622,7 @@ void BinaryTree<T>::leftRotate(Node* top)
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -389,8 +630,14 @@ void BinaryTree<T>::leftRotate(Node* top)
     }
 }
 
-template<typename T>
-int BinaryTree<T>::nodeHeight(Node* here)
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::checkBalanced(Node* /*startingNode*/, bool /*afterInsert*/)
+{
+    // an unbalanced binary tree has nothing to fix
+}
+
+template<typename T, typename Compare, typename Allocator>
+int BinaryTree<T, Compare, Allocator>::nodeHeight(Node* here)
 {
     if (here == nullptr) {
         return -1;
@@ -398,22 +645,26 @@ int BinaryTree<T>::nodeHeight(Node* here)
     return here->height_;
 }
 
-template<typename T>
-std::ostream& BinaryTree<T>::printStatistics(std::ostream& out) const
+template<typename T, typename Compare, typename Allocator>
+std::ostream& BinaryTree<T, Compare, Allocator>::printStatistics(std::ostream& out) const
 {
     out << "height " << height() << std::endl;
+    out << "node memory " << size() * sizeof(Node) << " bytes" << std::endl;
+    out << "allocated memory "
+        << allocatorBytes(alloc_, size() * sizeof(Node)) << " bytes"
+        << std::endl;
     return out;
 }
 
-template <typename T>
-std::ostream& BinaryTree<T>::print(std::ostream& out) const
+template <typename T, typename Compare, typename Allocator>
+std::ostream& BinaryTree<T, Compare, Allocator>::print(std::ostream& out) const
 {
     printPretty(root_, 1, 1, out);
     return out;
 }
 
-template<typename T>
-typename BinaryTree<T>::iterator BinaryTree<T>::begin() const
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::iterator BinaryTree<T, Compare, Allocator>::begin() const
 {
     Node* current = root_;
     // if tree is empty, we don't want to dereference current
@@ -426,21 +677,34 @@ typename BinaryTree<T>::iterator BinaryTree<T>::begin() const
     return Iterator(current);
 }
 
-template<typename T>
-typename BinaryTree<T>::iterator BinaryTree<T>::end() const
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::iterator BinaryTree<T, Compare, Allocator>::end() const
 {
     return Iterator(nullptr);
 }
 
+template<typename T, typename Compare, typename Allocator>
+template <typename Function>
+void BinaryTree<T, Compare, Allocator>::forEach(Function&& visit) const
+{
+    forEachInOrder(root_, visit);
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::iterator BinaryTree<T, Compare, Allocator>::iteratorAt(Node* here)
+{
+    return Iterator(here);
+}
+
 // --------------------------------------
 //
 // Implementation of Pretty Print
 // (taken from http://articles.leetcode.com/2010/09/how-to-pretty-print-binary-tree.html)
 //
 // --------------------------------------
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Print the arm branches (eg, /    \ ) on a line
-void BinaryTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void BinaryTree<T, Compare, Allocator>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel / 2; i++) {  
     out << ((i == 0) ? std::setw(startLen-1) : std::setw(nodeSpaceLen-2)) << "" << ((*iter++) ? "/" : " ");
@@ -449,9 +713,9 @@ void BinaryTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen,
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Print the branches and node (eg, ___10___ )
-void BinaryTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void BinaryTree<T, Compare, Allocator>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(startLen) : std::setw(nodeSpaceLen)) << "" << ((*iter && (*iter)->left_) ? std::setfill('_') : std::setfill(' '));
@@ -471,9 +735,9 @@ void BinaryTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, in
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Print the leaves only (just for the bottom row)
-void BinaryTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void BinaryTree<T, Compare, Allocator>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(indentSpace+2) : std::setw(2*level+2)) << ((*iter) ? std::to_string((*iter)->element_)/* + " " + std::to_string((*iter)->height_) */: "");
@@ -481,12 +745,12 @@ void BinaryTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Pretty formatting of a binary tree to the output stream
 // @ param
 // level  Control how wide you want the tree to sparse (eg, level 1 has the minimum space between nodes, while level 2 has a larger space between nodes)
 // indentSpace  Change this to add some indent space to the left (eg, indentSpace of 0 means the lowest level of the left node will stick to the left margin)
-void BinaryTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
+void BinaryTree<T, Compare, Allocator>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
   int h = subtreeHeight(root_); //maxHeight(root);
   int nodesInThisLevel = 1;
 
@@ -525,22 +789,28 @@ void BinaryTree<T>::printPretty(Node* root, int level, int indentSpace, std::ost
 // Implementation of BinaryTree::Node
 //
 // --------------------------------------
-template<typename T>
-BinaryTree<T>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
     :element_{element}, left_{left}, right_{right}, parent_{parent}, height_{0}
 {
     // nothing else to do
 }
 
-template<typename T>
-BinaryTree<T>::Node::~Node()
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::Node::Node(T&& element, Node* left, Node* right, Node* parent)
+    :element_{std::move(element)}, left_{left}, right_{right}, parent_{parent}, height_{0}
 {
-    delete left_;
-    delete right_;
+    // nothing else to do
 }
 
-template<typename T>
-size_t BinaryTree<T>::Node::size() const
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::Node::~Node()
+{
+    // the tree frees the children itself
+}
+
+template<typename T, typename Compare, typename Allocator>
+size_t BinaryTree<T, Compare, Allocator>::Node::size() const
 {
     size_t size = 1;
 
@@ -553,8 +823,8 @@ size_t BinaryTree<T>::Node::size() const
     return size;
 }
 
-template<typename T>
-int BinaryTree<T>::Node::getBalance()
+template<typename T, typename Compare, typename Allocator>
+int BinaryTree<T, Compare, Allocator>::Node::getBalance()
 {
     /*int leftHeight = 0;
     if (left_ != nullptr) {
@@ -567,15 +837,15 @@ int BinaryTree<T>::Node::getBalance()
     return nodeHeight(right_) - nodeHeight(left_);
 }
 
-template<typename T>
-void BinaryTree<T>::Node::updateHeight()
+template<typename T, typename Compare, typename Allocator>
+void BinaryTree<T, Compare, Allocator>::Node::updateHeight()
 {
     int newHeight = std::max(nodeHeight(left_), nodeHeight(right_)) + 1;
     height_ = newHeight != -1 ? newHeight : 0;
 }
 
 /*template<typename T>
-size_t BinaryTree<T>::Node::subtreeHeight() const
+size_t BinaryTree<T, Compare, Allocator>::Node::subtreeHeight() const
 {
     // recursive base case (at a leaf)
     if (left_ == nullptr && right_ == nullptr) {
@@ -600,26 +870,20 @@ size_t BinaryTree<T>::Node::subtreeHeight() const
 //
 // --------------------------------------
 
-template<typename T>
-BinaryTree<T>::Iterator::Iterator(Node* index)
+template<typename T, typename Compare, typename Allocator>
+BinaryTree<T, Compare, Allocator>::Iterator::Iterator(Node* index)
     : current_{index}
 {
     // Nothing else to do.
 }
 
-template<typename T>
-typename BinaryTree<T>::Iterator& BinaryTree<T>::Iterator::operator++()
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Iterator& BinaryTree<T, Compare, Allocator>::Iterator::operator++()
 {
-    bool lastElement = false;
-    // empty tree
+    // empty tree, or already past the end
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
-    }
     // if there's something to the right, we go there then go as far to the left
     // as we can, for example to get from 10 to 11 in this tree
     //            10
@@ -636,120 +900,67 @@ typename BinaryTree<T>::Iterator& BinaryTree<T>::Iterator::operator++()
         while (current_->left_ != nullptr) {
             current_ = current_->left_;
         }
-    } 
-    // nothing to the right and at the root node, which means we are at the
-    // last element in the tree
-    else if (current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
     }
-    // at this point we must go back up the tree to get to the next largest 
-    // value
-    // if stepping back up to the parent gives us a larger value, then we stop
-    else if (current_->parent_->element_ > current_->element_) {
+    // otherwise we go back up the tree until we step up out of a left
+    // subtree, that parent is the next largest value. If we step off the top
+    // of the tree we were at the largest element, and end up at end()
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    } 
-    // if stepping back up to the parent gives us a smaller value, then we keep
-    // going up until we hit a larger value
-    else if (current_->parent_->element_ < current_->element_) {
-        while (current_->parent_->element_ < current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                lastElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!lastElement) {
+        while (current_ != nullptr && current_->right_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the last element, return the equivalent of the end()
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-typename BinaryTree<T>::Iterator& BinaryTree<T>::Iterator::operator--()
+template<typename T, typename Compare, typename Allocator>
+typename BinaryTree<T, Compare, Allocator>::Iterator& BinaryTree<T, Compare, Allocator>::Iterator::operator--()
 {
     // maybe something to handle -- on end()?
 
-    bool firstElement = false;
     // empty tree
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    else if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
     // if there is something to the left, we go there and then go to the right
     // as far as we can
-    else if (current_->left_ != nullptr) {
+    if (current_->left_ != nullptr) {
         current_ = current_->left_;
         while (current_->right_ != nullptr) {
             current_ = current_->right_;
         }
     }
-    // nothing to the left and at the root node, which means we are at the
-    // first element in the tree
-    else if (current_->left_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // at this point we must go back up the tree to get to the next smallest 
-    // value
-    // if stepping back up to the parent gives us a smaller value, then we stop
-    else if (current_->parent_->element_ < current_->element_) {
+    // otherwise we go back up the tree until we step up out of a right
+    // subtree, that parent is the next smallest value. If we step off the top
+    // of the tree we were at the smallest element, and end up at null
+    // (-- on begin())
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    }
-    // if stepping back up to the parent gives us a larger value, then we keep
-    // going up until we hit a smaller value
-    else if (current_->parent_->element_ > current_->element_) {
-        while (current_->parent_->element_ > current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                firstElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!firstElement) {
+        while (current_ != nullptr && current_->left_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the first element, return null (-- on begin())
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-T& BinaryTree<T>::Iterator::operator*() const
+template<typename T, typename Compare, typename Allocator>
+T& BinaryTree<T, Compare, Allocator>::Iterator::operator*() const
 {
     return current_->element_;
 }
 
-template<typename T>
-bool BinaryTree<T>::Iterator::operator==(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::Iterator::operator==(const Iterator& rhs) const
 {
     return (current_ == rhs.current_);
 }
 
-template<typename T>
-bool BinaryTree<T>::Iterator::operator!=(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool BinaryTree<T, Compare, Allocator>::Iterator::operator!=(const Iterator& rhs) const
 {
     return !(*this == rhs);
 }
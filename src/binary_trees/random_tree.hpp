@@ -9,21 +9,32 @@
 
 #ifndef RANDOM_TREE_INCLUDED
 #define RANDOM_TREE_INCLUDED 1
-#include "binary_tree.hpp"
+#include "abstracttree.hpp"
+#include "node_pool.hpp"
+#include "key_compare.hpp"
+#include "iterator_range.hpp"
+#include "in_order.hpp"
+#include "work_stealing_pool.hpp"
 #include "pcg-cpp-0.98/include/pcg_random.hpp"
 #include <time.h>       // time
 #include <stack>        // std::queue
 #include <iomanip>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <functional>
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>,
+          typename Allocator = NodePool<T>>
 
 /**
 * \class RandomTree
 * \brief A templated random tree
 */
 
-class RandomTree : public BinaryTree<T> {
+class RandomTree : public AbstractTree<T> {
 
 private:
    class Iterator; // Forward declaration
@@ -37,6 +48,40 @@ public:
     */
     RandomTree();
 
+    /**
+    * \brief
+    * Comparator Constructor
+    *
+    * \param comp the comparator to order the elements with
+    */
+    explicit RandomTree(const Compare& comp);
+
+    /**
+    * \brief
+    * Range Constructor
+    *
+    * \details Sorts the elements in [first, last) and builds a perfectly
+    * balanced tree out of them, with the subtree sizes already filled in.
+    *
+    * \note O(n) time after the sort
+    */
+    template <typename InputIterator>
+    RandomTree(InputIterator first, InputIterator last,
+                const Compare& comp = Compare());
+
+    /**
+    * \brief
+    * Replaces the contents of the tree with the elements in [first, last)
+    *
+    * \details The range must already be sorted; repeated elements are only
+    * stored once. The tree is rebuilt perfectly balanced without any
+    * comparisons or rotations.
+    *
+    * \note O(n) time
+    */
+    template <typename InputIterator>
+    void assignSorted(InputIterator first, InputIterator last);
+
     /**
     * \brief 
     * Default Destructor
@@ -44,11 +89,67 @@ public:
     */
     ~RandomTree();
 
+    /**
+    * \brief
+    * Copy Constructor
+    *
+    * \details Copies the tree node by node, so the copy has exactly the same
+    * shape as the original.
+    *
+    * \note O(n) time
+    */
+    RandomTree<T, Compare, Allocator>(const RandomTree<T, Compare, Allocator>& orig);
+
+    /**
+    * \brief
+    * Assignment Operator
+    *
+    * \details Reuses the nodes the tree already holds before allocating new
+    * ones.
+    */
+    RandomTree<T, Compare, Allocator>& operator=(const RandomTree<T, Compare, Allocator>& rhs);
+
+    /**
+    * \brief
+    * Move Constructor
+    *
+    * \details Takes over the nodes of orig, leaving it empty
+    *
+    * \note constant time
+    */
+    RandomTree<T, Compare, Allocator>(RandomTree<T, Compare, Allocator>&& orig);
+
+    /**
+    * \brief
+    * Move Assignment Operator
+    *
+    * \note constant time, apart from freeing the tree's old nodes
+    */
+    RandomTree<T, Compare, Allocator>& operator=(RandomTree<T, Compare, Allocator>&& rhs);
+
+    /**
+    * \brief
+    * Random Tree swap function
+    *
+    */
+    void swap(RandomTree<T, Compare, Allocator>& rhs);
+
     // Allow users to iterate over the contents of the list. 
     using iterator = Iterator; 
     iterator begin() const; ///< An iterator that refers to the first element
     iterator end() const;   ///< A "past-the-end" iterator
 
+    /**
+    * \brief calls visit(element) for every element, in order
+    *
+    * \details a tight loop, much faster than the iterators over a whole
+    * tree
+    *
+    * \note visit mustn't change the tree
+    */
+    template <typename Function>
+    void forEach(Function&& visit) const;
+
     /**
     * \brief 
     * Size function
@@ -68,6 +169,19 @@ public:
     *
     */
     bool insert(const T& element) override;
+    bool insert(T&& element) override;
+
+    /**
+    * \brief
+    * Constructs an element out of args and inserts it into the tree
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \returns true if the element was inserted, false if it was already
+    * present
+    */
+    template <typename... Args>
+    bool emplace(Args&&... args);
 
     /**
     * \brief 
@@ -87,19 +201,166 @@ public:
     */
     bool contains(const T& element) const override;
 
+    /**
+    * \brief
+    * Checks if an element equivalent to key is in the tree
+    *
+    * \note only available if Compare defines is_transparent, so keys of
+    * other types can be looked up without converting them to T
+    */
+    template <typename K, typename C = Compare,
+              typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    /**
+    * \brief returns a copy of the comparator that orders the tree
+    */
+    Compare key_comp() const;
+
+    /**
+    * \brief
+    * Finds an element in the tree
+    *
+    * \returns an iterator to the element, end() if it isn't in the tree
+    */
+    iterator find(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that doesn't sort before element
+    *
+    * \returns end() if every element sorts before element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator lower_bound(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that sorts after element
+    *
+    * \returns end() if no element sorts after element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator upper_bound(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements equivalent to element as a pair of iterators, so
+    * the range is empty if element isn't in the tree
+    */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements in [lower, upper), for use in a range-based for
+    * loop
+    *
+    * \note log(n) time to find the ends of the range, then the scan costs
+    * amortized constant time per element
+    */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
+
+    /**
+    * \brief
+    * Finds the element with exactly k smaller elements in the tree
+    *
+    * \note log(n) time, using the subtree sizes kept at each node
+    */
+    const T& select(size_t k) const;
+
+    /**
+    * \brief
+    * Counts the elements in the tree that sort before element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    size_t rank(const T& element) const;
+
+    /**
+    * \brief
+    * Counts the elements in the tree in the range [lower, upper)
+    *
+    * \note log(n) time
+    */
+    size_t countRange(const T& lower, const T& upper) const;
+
+    /**
+    * \brief
+    * Splits off the elements that don't sort before pivot
+    *
+    * \returns a tree holding every element that doesn't sort before pivot,
+    * while this tree keeps the rest
+    *
+    * \note log(n) expected time, both halves are as random as if their
+    * elements had been inserted into them directly
+    */
+    RandomTree<T, Compare, Allocator> split(const T& pivot);
+
+    /**
+    * \brief
+    * Moves every element of greater onto the end of this tree
+    *
+    * \details every element in greater must sort after every element in
+    * this tree, greater is left empty
+    *
+    * \note log(n) expected time
+    */
+    void join(RandomTree<T, Compare, Allocator>& greater);
+
+    /**
+    * \brief
+    * Adds every element of other to this tree
+    *
+    * \details other is left empty, elements already in this tree are kept
+    * over their equivalents in other. Each root is picked from either tree
+    * with probability proportional to its size, so the result is still a
+    * random tree. Each half of the work is split again and the halves run
+    * on pool's threads.
+    *
+    * \note O(m log(n/m + 1)) expected work and O(log^2 n) expected span,
+    * where m is the size of the smaller tree and n of the larger one
+    */
+    void unionWith(RandomTree<T, Compare, Allocator>& other,
+                   WorkStealingPool& pool = WorkStealingPool::shared());
+
+    /**
+    * \brief
+    * Keeps only the elements that are also in other
+    *
+    * \details other is left empty
+    *
+    * \note the same bounds as unionWith, plus freeing the nodes that are
+    * dropped on the calling thread
+    */
+    void intersect(RandomTree<T, Compare, Allocator>& other,
+                   WorkStealingPool& pool = WorkStealingPool::shared());
+
+    /**
+    * \brief
+    * Removes every element that is also in other
+    *
+    * \details other is left empty
+    *
+    * \note the same bounds as intersect
+    */
+    void difference(RandomTree<T, Compare, Allocator>& other,
+                    WorkStealingPool& pool = WorkStealingPool::shared());
+
     /**
     * \brief
     * Random Tree equality operator
     *
     */
-    bool operator==(const RandomTree<T>& rhs) const;
+    bool operator==(const RandomTree<T, Compare, Allocator>& rhs) const;
 
     /**
     * \brief
     * Random Tree inequality operator
     *
     */
-    bool operator!=(const RandomTree<T>& rhs) const;
+    bool operator!=(const RandomTree<T, Compare, Allocator>& rhs) const;
 
     /**
     * \brief
@@ -141,6 +402,7 @@ private:
         *
         */
         Node(const T& element, Node* left, Node* right, Node* parent);
+        Node(T&& element, Node* left, Node* right, Node* parent);
         
         /**
         * \brief default destructor
@@ -157,6 +419,12 @@ private:
         Node() = delete; // disable default constructor
         Node& operator=(const Node&) = delete; // disable assignment operator
     };
+
+    using NodeAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator alloc_; ///> where the tree's nodes come from
+    Compare comp_;        ///> orders the elements
     //size_t size_;
     Node* root_;
     pcg32_k64 rng;
@@ -208,25 +476,106 @@ private:
 
     size_t nodeSize(Node* here) const;
 
+    /**
+    * \brief recomputes the sizes from here up to the root, after the nodes
+    * on that path have been relinked
+    */
+    void updateSizes(Node* here);
+
+    /**
+    * \brief merges two subtrees where everything in left sorts before
+    * everything in right, as join does
+    *
+    * \returns the root of the merged subtree
+    */
+    Node* joinNodes(Node* left, Node* right);
+
+    enum class SetOperation {
+        UNION,
+        INTERSECTION,
+        DIFFERENCE
+    };
+
+    /**
+    * \brief subtrees taken out by a set operation, to be freed once the
+    * threads are done with them, linked through their roots' parent_
+    * pointers
+    */
+    struct DroppedNodes {
+        Node* first_;
+        Node* last_;
+
+        DroppedNodes();
+
+        /**
+        * \brief adds the subtree rooted at here, if there is one
+        */
+        void add(Node* here);
+
+        /**
+        * \brief moves everything in other onto the end of this list
+        */
+        void append(DroppedNodes& other);
+    };
+
+    /**
+    * \brief subtrees smaller than this on either side are combined on a
+    * single thread, since handing them off would cost more than it saves
+    */
+    static const size_t PARALLEL_SIZE = 1024;
+
+    /**
+    * \brief applies operation to this tree and other, leaving other empty
+    */
+    void combine(RandomTree<T, Compare, Allocator>& other,
+                 SetOperation operation, WorkStealingPool& pool);
+
+    /**
+    * \brief applies operation to the subtrees mine and theirs
+    *
+    * \details rng isn't safe to share, so each thread works through a tree
+    * object of its own
+    *
+    * \returns the root of the combined subtree
+    */
+    Node* combineNodes(Node* mine, Node* theirs, SetOperation operation,
+                       WorkStealingPool& pool, DroppedNodes& dropped);
+
+    /**
+    * \brief splits the subtree rooted at here into the nodes that sort
+    * before pivot and the ones that sort after it
+    *
+    * \returns the node equivalent to pivot, unlinked from both halves, or
+    * nullptr if there isn't one
+    */
+    Node* splitNodes(Node* here, const T& pivot, Node*& less, Node*& greater);
+
+    /**
+    * \brief frees every dropped subtree
+    */
+    void destroyDropped(DroppedNodes& dropped);
+
 
     /**
      * \brief
      * Inserts a node into the tree
      *
      * \param here The node to insert at
-     * \param element The element to insert
+     * \param element The element to insert, forwarded to the new node
      */
-    bool insertNode(Node*& here, const T& element);
+    template <typename U>
+    bool insertNode(Node*& here, U&& element);
 
     /**
     * \brief
     * inserts an node into the root of the tree
     * 
     * \param here The node to insert at
-    * \param element The element to insert
+    * \param element The element to insert, forwarded to the new node
     *
     */
-    bool insertNodeAtRoot(Node*& here, const T& element);
+    template <typename U>
+    bool insertNodeAtRoot(Node*& here, U&& element);
 
     /**
      * \brief
@@ -237,7 +586,8 @@ private:
      *
      * \returns True if the element is present in the tree, false if otherwise
      */
-    Node* findNode(Node* here, const T& element) const;
+    template <typename K>
+    Node* findNode(Node* here, const K& element) const;
 
     Node* getNextNode(Node* here);
 
@@ -271,6 +621,72 @@ private:
     */
     bool deleteOneElementTree(const T& element);
 
+    /**
+    * \brief replaces the tree with a perfectly balanced tree holding the
+    * sorted elements
+    *
+    * \param elements sorted elements, repeated elements are removed
+    */
+    void buildFromSorted(std::vector<T>& elements);
+
+    /**
+    * \brief builds a perfectly balanced subtree out of the sorted elements in
+    * [lower, upper)
+    *
+    * \returns the root of the new subtree
+    */
+    Node* buildSubtree(const std::vector<T>& elements, size_t lower,
+                       size_t upper, Node* parent);
+
+    /**
+    * \brief copies the tree rooted at source node by node, keeping its shape
+    * and subtree sizes
+    *
+    * \param spares nodes to reuse before allocating new ones, linked through
+    * their right_ pointers
+    *
+    * \returns the root of the copy
+    */
+    Node* cloneTree(const Node* source, Node*& spares);
+
+    /**
+    * \brief makes a childless copy of source below parent, reusing a spare
+    * node if there is one
+    */
+    Node* cloneNode(const Node* source, Node* parent, Node*& spares);
+
+    /**
+    * \brief takes apart the tree rooted at here into a list of nodes linked
+    * through their right_ pointers
+    *
+    * \returns the head of the list
+    */
+    static Node* unlinkNodes(Node* here);
+
+    /**
+    * \brief frees a list of nodes made by unlinkNodes
+    */
+    void deleteSpares(Node* spares);
+
+    /**
+    * \brief allocates a node from the tree's allocator and constructs it
+    * out of args
+    */
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+
+    /**
+    * \brief destroys a single node and gives its memory back, the node's
+    * children are left alone
+    */
+    void destroyNode(Node* node);
+
+    /**
+    * \brief destroys every node in the subtree rooted at here, without
+    * recursing
+    */
+    void destroyTree(Node* here);
+
     class Iterator
     {
     public:
@@ -297,10 +713,10 @@ private:
 
 };
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 /// Provide a non-member version of swap to allow standard swap(x,y) usage.
-void swap(RandomTree<T>& lhs, RandomTree<T>& rhs);
+void swap(RandomTree<T, Compare, Allocator>& lhs, RandomTree<T, Compare, Allocator>& rhs);
 
-#include "randomtree-private.hpp"
+#include "random_tree_private.hpp"
 
 #endif // RANDOM_TREE_INCLUDED
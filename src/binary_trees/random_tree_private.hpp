@@ -5,69 +5,126 @@
  * \brief implementation of templated random tree class
  */
 
-template<typename T>
-RandomTree<T>::RandomTree()
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::RandomTree()
             : root_{nullptr}
 {
     //srand (time(NULL));
 }
 
-template<typename T>
-RandomTree<T>::~RandomTree()
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::RandomTree(const Compare& comp)
+            : comp_{comp}, root_{nullptr}
 {
-    delete root_;
+    // nothing else to do
 }
 
-template<typename T>
-RandomTree<T>::RandomTree(const RandomTree<T>& orig)
-            : root_{nullptr}
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::~RandomTree()
+{
+    destroyTree(root_);
+}
+
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::RandomTree(const RandomTree<T, Compare, Allocator>& orig)
+            : alloc_{NodeTraits::select_on_container_copy_construction(
+                  orig.alloc_)}, comp_{orig.comp_}, root_{nullptr}
 {
-    for (iterator i = orig.begin(); i != orig.end(); ++i) {
-        insert(*i);
+    Node* spares = nullptr;
+    root_ = cloneTree(orig.root_, spares);
+}
+
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>& RandomTree<T, Compare, Allocator>::operator=(const RandomTree<T, Compare, Allocator>& rhs)
+{
+    if (this != &rhs) {
+        // reuse the nodes we already have and free whatever is left over
+        Node* spares = unlinkNodes(root_);
+        root_ = cloneTree(rhs.root_, spares);
+        deleteSpares(spares);
+        comp_ = rhs.comp_;
     }
+    return *this;
 }
 
-template<typename T>
-RandomTree<T>& RandomTree<T>::operator=(const RandomTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::RandomTree(RandomTree<T, Compare, Allocator>&& orig)
+            : alloc_{std::move(orig.alloc_)}, comp_{orig.comp_},
+              root_{orig.root_},
+              rng(orig.rng)
 {
-    RandomTree<T> copy{rhs};
-    swap(copy);
+    orig.root_ = nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>& RandomTree<T, Compare, Allocator>::operator=(RandomTree<T, Compare, Allocator>&& rhs)
+{
+    RandomTree<T, Compare, Allocator> moved{std::move(rhs)};
+    swap(moved);
     return *this;
 }
 
-template<typename T>
-void RandomTree<T>::swap(RandomTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::swap(RandomTree<T, Compare, Allocator>& rhs)
 {
     using std::swap;
     swap(root_, rhs.root_);
+    swap(alloc_, rhs.alloc_);
+    swap(comp_, rhs.comp_);
 }
 
-template<typename T>
-void swap(RandomTree<T>& lhs, RandomTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator>
+void swap(RandomTree<T, Compare, Allocator>& lhs, RandomTree<T, Compare, Allocator>& rhs)
 {
     lhs.swap(rhs);
 }
 
-template<typename T>
-size_t RandomTree<T>::size() const
+template<typename T, typename Compare, typename Allocator>
+template<typename InputIterator>
+RandomTree<T, Compare, Allocator>::RandomTree(InputIterator first, InputIterator last,
+                                              const Compare& comp)
+            : comp_{comp}, root_{nullptr}
+{
+    std::vector<T> elements(first, last);
+    std::sort(elements.begin(), elements.end(),
+              [this](const T& a, const T& b) {
+                  return keyLess(comp_, a, b);
+              });
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename InputIterator>
+void RandomTree<T, Compare, Allocator>::assignSorted(InputIterator first, InputIterator last)
+{
+    std::vector<T> elements(first, last);
+    assert(std::is_sorted(elements.begin(), elements.end(),
+                          [this](const T& a, const T& b) {
+                              return keyLess(comp_, a, b);
+                          }));
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator>
+size_t RandomTree<T, Compare, Allocator>::size() const
 {
     return nodeSize(root_);
 }
 
-template<typename T>
-size_t RandomTree<T>::height() const
+template<typename T, typename Compare, typename Allocator>
+size_t RandomTree<T, Compare, Allocator>::height() const
 {
     return subtreeHeight(root_);
 }
 
-template<typename T>
-bool RandomTree<T>::empty()
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::empty()
 {
     return root_ == nullptr;
 }
 
-template<typename T>
-bool RandomTree<T>::operator==(const RandomTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::operator==(const RandomTree<T, Compare, Allocator>& rhs) const
 {
     // if the sizes are different the trees are not equal
     if (size() != rhs.size()) {
@@ -87,29 +144,39 @@ bool RandomTree<T>::operator==(const RandomTree<T>& rhs) const
     return true;
 }
 
-template<typename T>
-bool RandomTree<T>::operator!=(const RandomTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::operator!=(const RandomTree<T, Compare, Allocator>& rhs) const
 {
     return !(*this == rhs);
 }
 
-template<typename T>
-size_t RandomTree<T>::subtreeHeight(Node* here) const
+template<typename T, typename Compare, typename Allocator>
+size_t RandomTree<T, Compare, Allocator>::subtreeHeight(Node* here) const
 {
-    // recursive base case
-    if (here == nullptr) {
-        return 0;
+    // walk the subtree with an explicit stack of nodes and their depths,
+    // a path-shaped tree is as deep as it is big
+    size_t height = 0;
+    std::stack<std::pair<Node*, size_t>> toVisit;
+    if (here != nullptr) {
+        toVisit.push(std::make_pair(here, 1));
     }
-    // recursively get the left and right subtree heights
-    size_t leftSize = subtreeHeight(here->left_);
-    size_t rightSize = subtreeHeight(here->right_);
-
-    // the taller of the two subtrees is the height of the overall subtree
-    return 1 + std::max(leftSize, rightSize);
+    while (!toVisit.empty()) {
+        Node* node = toVisit.top().first;
+        size_t depth = toVisit.top().second;
+        toVisit.pop();
+        height = std::max(height, depth);
+        if (node->left_ != nullptr) {
+            toVisit.push(std::make_pair(node->left_, depth + 1));
+        }
+        if (node->right_ != nullptr) {
+            toVisit.push(std::make_pair(node->right_, depth + 1));
+        }
+    }
+    return height;
 }
 
-template<typename T>
-bool RandomTree<T>::contains(const T& element) const
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::contains(const T& element) const
 {
     if (findNode(root_, element) == nullptr) {
         return false;
@@ -118,29 +185,400 @@ bool RandomTree<T>::contains(const T& element) const
     }
 }
 
-template<typename T>
-typename RandomTree<T>::Node* RandomTree<T>::findNode(Node* here, const T& element) const
+template<typename T, typename Compare, typename Allocator>
+template<typename K, typename C, typename>
+bool RandomTree<T, Compare, Allocator>::contains(const K& key) const
 {
-    if (here == nullptr) {
-        return nullptr;
-    } 
-    // continue searching to the left
-    else if (element < here->element_) {
-        return findNode(here->left_, element);
-    }
-    // continue searching to the right
-    else if (element > here->element_) {
-        return findNode(here->right_, element);
-    } 
-    // element is not less than or greater than here->element_, so it must
-    // be equal to here->element_
-    else {
-        return here;
+    return findNode(root_, key) != nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator>
+Compare RandomTree<T, Compare, Allocator>::key_comp() const
+{
+    return comp_;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::iterator RandomTree<T, Compare, Allocator>::find(const T& element) const
+{
+    return Iterator(findNode(root_, element));
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::iterator RandomTree<T, Compare, Allocator>::lower_bound(const T& element) const
+{
+    return Iterator(lowerBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::iterator RandomTree<T, Compare, Allocator>::upper_bound(const T& element) const
+{
+    return Iterator(upperBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator>
+std::pair<typename RandomTree<T, Compare, Allocator>::iterator, typename RandomTree<T, Compare, Allocator>::iterator>
+RandomTree<T, Compare, Allocator>::equal_range(const T& element) const
+{
+    iterator first = lower_bound(element);
+    iterator last = first;
+    // the elements are unique, so at most one of them can be equivalent
+    if (last != end() && !keyLess(comp_, element, *last)) {
+        ++last;
     }
+    return std::make_pair(first, last);
 }
 
-template<typename T>
-bool RandomTree<T>::insert(const T& element)
+template<typename T, typename Compare, typename Allocator>
+IteratorRange<typename RandomTree<T, Compare, Allocator>::iterator> RandomTree<T, Compare, Allocator>::range(const T& lower, const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return IteratorRange<iterator>(end(), end());
+    }
+    return IteratorRange<iterator>(lower_bound(lower), lower_bound(upper));
+}
+
+template<typename T, typename Compare, typename Allocator>
+const T& RandomTree<T, Compare, Allocator>::select(size_t k) const
+{
+    assert(k < size());
+    Node* here = root_;
+    while (true) {
+        size_t leftSize = nodeSize(here->left_);
+        if (k < leftSize) {
+            here = here->left_;
+        } else if (k == leftSize) {
+            return here->element_;
+        } else {
+            // skip the left subtree and here itself
+            k -= leftSize + 1;
+            here = here->right_;
+        }
+    }
+}
+
+template<typename T, typename Compare, typename Allocator>
+size_t RandomTree<T, Compare, Allocator>::rank(const T& element) const
+{
+    size_t before = 0;
+    Node* here = root_;
+    while (here != nullptr) {
+        if (keyLess(comp_, here->element_, element)) {
+            // here and everything to its left sort before element
+            before += nodeSize(here->left_) + 1;
+            here = here->right_;
+        } else {
+            here = here->left_;
+        }
+    }
+    return before;
+}
+
+template<typename T, typename Compare, typename Allocator>
+size_t RandomTree<T, Compare, Allocator>::countRange(const T& lower,
+                                                     const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return 0;
+    }
+    return rank(upper) - rank(lower);
+}
+
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator> RandomTree<T, Compare, Allocator>::split(const T& pivot)
+{
+    RandomTree<T, Compare, Allocator> greater{comp_};
+    shareAllocator(greater.alloc_, alloc_);
+    // walk down towards pivot, handing each node to one half along with the
+    // subtree on its far side, and hooking the next node of that half where
+    // the walk left it
+    Node* less = nullptr;
+    Node* notLess = nullptr;
+    Node** lessHook = &less;
+    Node** notLessHook = &notLess;
+    Node* lessParent = nullptr;
+    Node* notLessParent = nullptr;
+    Node* here = root_;
+    while (here != nullptr) {
+        if (keyLess(comp_, here->element_, pivot)) {
+            *lessHook = here;
+            here->parent_ = lessParent;
+            lessParent = here;
+            lessHook = &here->right_;
+            here = here->right_;
+        } else {
+            *notLessHook = here;
+            here->parent_ = notLessParent;
+            notLessParent = here;
+            notLessHook = &here->left_;
+            here = here->left_;
+        }
+    }
+    *lessHook = nullptr;
+    *notLessHook = nullptr;
+    // only the nodes on the path lost anything
+    updateSizes(lessParent);
+    updateSizes(notLessParent);
+    root_ = less;
+    greater.root_ = notLess;
+    return greater;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::join(RandomTree<T, Compare, Allocator>& greater)
+{
+    if (greater.root_ == nullptr || this == &greater) {
+        return;
+    }
+    shareAllocator(alloc_, greater.alloc_);
+#ifndef NDEBUG
+    if (root_ != nullptr) {
+        Node* largest = root_;
+        while (largest->right_ != nullptr) {
+            largest = largest->right_;
+        }
+        Node* smallest = greater.root_;
+        while (smallest->left_ != nullptr) {
+            smallest = smallest->left_;
+        }
+        assert(keyLess(comp_, largest->element_, smallest->element_));
+    }
+#endif
+    root_ = joinNodes(root_, greater.root_);
+    greater.root_ = nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::joinNodes(Node* left, Node* right)
+{
+    // merge the right side of left with the left side of right, at each
+    // step picking a root with probability proportional to its size, which
+    // is exactly the chance it would have had of ending up on top
+    Node* joined = nullptr;
+    Node** hook = &joined;
+    Node* parent = nullptr;
+    while (left != nullptr && right != nullptr) {
+        size_t leftSize = nodeSize(left);
+        if (rng(leftSize + nodeSize(right)) < leftSize) {
+            *hook = left;
+            left->parent_ = parent;
+            parent = left;
+            hook = &left->right_;
+            left = left->right_;
+        } else {
+            *hook = right;
+            right->parent_ = parent;
+            parent = right;
+            hook = &right->left_;
+            right = right->left_;
+        }
+    }
+    Node* rest = left != nullptr ? left : right;
+    *hook = rest;
+    if (rest != nullptr) {
+        rest->parent_ = parent;
+    }
+    // only the nodes on the merged path gained anything
+    updateSizes(parent);
+    return joined;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::unionWith(RandomTree<T, Compare, Allocator>& other, WorkStealingPool& pool)
+{
+    combine(other, SetOperation::UNION, pool);
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::intersect(RandomTree<T, Compare, Allocator>& other, WorkStealingPool& pool)
+{
+    combine(other, SetOperation::INTERSECTION, pool);
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::difference(RandomTree<T, Compare, Allocator>& other, WorkStealingPool& pool)
+{
+    combine(other, SetOperation::DIFFERENCE, pool);
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::combine(RandomTree<T, Compare, Allocator>& other, SetOperation operation, WorkStealingPool& pool)
+{
+    if (this == &other) {
+        // a tree combined with itself only changes if it loses everything
+        if (operation == SetOperation::DIFFERENCE) {
+            destroyTree(root_);
+            root_ = nullptr;
+        }
+        return;
+    }
+    shareAllocator(alloc_, other.alloc_);
+    DroppedNodes dropped;
+    root_ = combineNodes(root_, other.root_, operation, pool, dropped);
+    other.root_ = nullptr;
+    // the pool isn't safe to use from several threads, so nothing is freed
+    // until they are all done
+    destroyDropped(dropped);
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::combineNodes(Node* mine, Node* theirs, SetOperation operation, WorkStealingPool& pool, DroppedNodes& dropped)
+{
+    if (mine == nullptr || theirs == nullptr) {
+        // with nothing left to match up, each side is kept or dropped whole
+        Node* kept = nullptr;
+        if (operation == SetOperation::INTERSECTION) {
+            dropped.add(mine);
+        } else {
+            kept = mine;
+        }
+        if (operation == SetOperation::UNION && kept == nullptr) {
+            kept = theirs;
+        } else {
+            dropped.add(theirs);
+        }
+        if (kept != nullptr) {
+            kept->parent_ = nullptr;
+        }
+        return kept;
+    }
+    size_t mineSize = nodeSize(mine);
+    size_t theirsSize = nodeSize(theirs);
+    bool parallel = mineSize >= PARALLEL_SIZE && theirsSize >= PARALLEL_SIZE;
+    // a union takes its root from either side in proportion to their sizes,
+    // the others keep our root or join around it
+    Node* root = mine;
+    if (operation == SetOperation::UNION &&
+        rng(mineSize + theirsSize) >= mineSize) {
+        root = theirs;
+    }
+    // splitting the root's own side just takes the root off
+    const T& pivot = root->element_;
+    Node* mineLess;
+    Node* mineGreater;
+    Node* theirsLess;
+    Node* theirsGreater;
+    Node* middle = splitNodes(mine, pivot, mineLess, mineGreater);
+    Node* match = splitNodes(theirs, pivot, theirsLess, theirsGreater);
+    Node* left = nullptr;
+    Node* right = nullptr;
+    if (parallel) {
+        RandomTree<T, Compare, Allocator> scratch{comp_};
+        scratch.rng.seed(rng());
+        DroppedNodes rightDropped;
+        pool.invoke(
+            [&] {
+                left = combineNodes(mineLess, theirsLess, operation, pool,
+                                    dropped);
+            },
+            [&] {
+                right = scratch.combineNodes(mineGreater, theirsGreater,
+                                             operation, pool, rightDropped);
+            });
+        dropped.append(rightDropped);
+    } else {
+        left = combineNodes(mineLess, theirsLess, operation, pool, dropped);
+        right = combineNodes(mineGreater, theirsGreater, operation, pool,
+                             dropped);
+    }
+    bool keep = operation == SetOperation::INTERSECTION ? match != nullptr :
+                operation == SetOperation::UNION || match == nullptr;
+    if (middle == nullptr) {
+        // only a union's root comes from their side, and then only when we
+        // have nothing equivalent to it
+        std::swap(middle, match);
+    }
+    dropped.add(match);
+    if (!keep) {
+        dropped.add(middle);
+        return joinNodes(left, right);
+    }
+    middle->left_ = left;
+    middle->right_ = right;
+    middle->parent_ = nullptr;
+    if (left != nullptr) {
+        left->parent_ = middle;
+    }
+    if (right != nullptr) {
+        right->parent_ = middle;
+    }
+    middle->size_ = nodeSize(left) + nodeSize(right) + 1;
+    return middle;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::splitNodes(Node* here, const T& pivot, Node*& less, Node*& greater)
+{
+    // walk down towards pivot as split does, stopping if we find it
+    less = nullptr;
+    greater = nullptr;
+    Node** lessHook = &less;
+    Node** greaterHook = &greater;
+    Node* lessParent = nullptr;
+    Node* greaterParent = nullptr;
+    Node* match = nullptr;
+    while (here != nullptr) {
+        if (keyLess(comp_, here->element_, pivot)) {
+            *lessHook = here;
+            here->parent_ = lessParent;
+            lessParent = here;
+            lessHook = &here->right_;
+            here = here->right_;
+        } else if (keyLess(comp_, pivot, here->element_)) {
+            *greaterHook = here;
+            here->parent_ = greaterParent;
+            greaterParent = here;
+            greaterHook = &here->left_;
+            here = here->left_;
+        } else {
+            match = here;
+            break;
+        }
+    }
+    *lessHook = nullptr;
+    *greaterHook = nullptr;
+    if (match != nullptr) {
+        // everything below the match already sorts to one side of it
+        *lessHook = match->left_;
+        if (match->left_ != nullptr) {
+            match->left_->parent_ = lessParent;
+        }
+        *greaterHook = match->right_;
+        if (match->right_ != nullptr) {
+            match->right_->parent_ = greaterParent;
+        }
+        match->left_ = nullptr;
+        match->right_ = nullptr;
+        match->parent_ = nullptr;
+        match->size_ = 1;
+    }
+    updateSizes(lessParent);
+    updateSizes(greaterParent);
+    return match;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::destroyDropped(DroppedNodes& dropped)
+{
+    Node* subtree = dropped.first_;
+    while (subtree != nullptr) {
+        Node* next = subtree->parent_;
+        destroyTree(subtree);
+        subtree = next;
+    }
+    dropped.first_ = nullptr;
+    dropped.last_ = nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename K>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::findNode(Node* here, const K& element) const
+{
+    return searchKey(here, element, comp_).match_;
+}
+
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::insert(const T& element)
 {
     if (insertNode(root_, element)) {
         return true;
@@ -148,100 +586,119 @@ bool RandomTree<T>::insert(const T& element)
     return false;
 }
 
-template<typename T>
-bool RandomTree<T>::insertNode(Node*& here, const T& element)
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::insert(T&& element)
+{
+    if (insertNode(root_, std::move(element))) {
+        return true;
+    }
+    return false;
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename... Args>
+bool RandomTree<T, Compare, Allocator>::emplace(Args&&... args)
+{
+    return insert(T(std::forward<Args>(args)...));
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename U>
+bool RandomTree<T, Compare, Allocator>::insertNode(Node*& here, U&& element)
 {
     // if we have an empty tree, make a new node
     if (here == nullptr) {
-        here = new Node(element, nullptr, nullptr, nullptr);
+        here = createNode(std::forward<U>(element), nullptr, nullptr, nullptr);
         return true;
-    } 
-    // random check to insert at current node
-    //if (rand() % here->size_ == 0) {
-    if (rng(here->size_) == 0) {
-        return insertNodeAtRoot(here, element);
-    } 
-    // otherwise go down to the next level in the tree
-    else if (element < here->element_) {
-        // if nothing to the left, insert there
-        if (here->left_ == nullptr) {
-            ++here->size_;
-            here->left_ = new Node(element, nullptr, nullptr, here);
-            return true;
-        } 
-        // otherwise go down another level in the tree
-        else {
-            if (insertNode(here->left_, element)) {
-                ++here->size_;
+    }
+    // walk down counting the new element into every subtree on the way,
+    // the counts are taken back out if it turns out to be a repeat
+    Node* parent = here;
+    // the last node the element didn't sort before, which is the only one it
+    // can be a repeat of
+    Node* candidate = nullptr;
+    while (true) {
+        // random check to insert at current node
+        if (rng(parent->size_) == 0) {
+            // a repeat of the candidate can't go in anywhere below it
+            if (candidate != nullptr &&
+                !keyLess(comp_, candidate->element_, element)) {
+                break;
+            }
+            Node* subtree = parent;
+            if (insertNodeAtRoot(subtree, std::forward<U>(element))) {
                 return true;
             }
-            return false;
+            break;
+        }
+        ++parent->size_;
+        // otherwise go down to the next level in the tree
+        bool goLeft = keyLess(comp_, element, parent->element_);
+        if (!goLeft) {
+            candidate = parent;
         }
-    } else if (element > here->element_) {
-        // if nothing to the right, insert there
-        if (here->right_ == nullptr) {
-            ++here->size_;
-            here->right_ = new Node(element, nullptr, nullptr, here);
+        Node*& child = goLeft ? parent->left_ : parent->right_;
+        if (child != nullptr) {
+            parent = child;
+        }
+        // at the bottom, insert there unless we are equal to the candidate
+        else if (candidate == nullptr ||
+                 keyLess(comp_, candidate->element_, element)) {
+            child = createNode(std::forward<U>(element), nullptr, nullptr, parent);
             return true;
-        } 
-        // otherwise go down another level in the tree
-        else {
-            if (insertNode(here->right_, element)) {
-                ++here->size_;
-                return true;
-            }
-            return false;
+        } else {
+            // parent was counted too, so its count comes back out as well
+            --parent->size_;
+            break;
         }
-    } 
-    // if we aren't less than or greater than the element, we must be equal
-    // and thus we can't insert
-    else {
-        return false;
     }
+    while (parent != here) {
+        parent = parent->parent_;
+        --parent->size_;
+    }
+    return false;
 }
 
-template<typename T>
-bool RandomTree<T>::insertNodeAtRoot(Node*& here, const T& element)
+template<typename T, typename Compare, typename Allocator>
+template<typename U>
+bool RandomTree<T, Compare, Allocator>::insertNodeAtRoot(Node*& here, U&& element)
 {
     // if we are at a leaf, we are wrong
     if (here == nullptr) {
-        //here = new Node(element, nullptr, nullptr);
+        //here = createNode(element, nullptr, nullptr);
         return false;
-    } else if (element < here->element_) {
-        if (here->left_ == nullptr) {
-            here->left_ = new Node(element, nullptr, nullptr, here);
-            ++here->size_;
-            rightRotate(here);
-            return true;
-        } else if (insertNodeAtRoot(here->left_, element)) {
-            ++here->size_;
-            rightRotate(here);
-            return true;
-        }
+    }
+    // insert the element as a leaf first
+    KeySearch<Node> spot = searchKey(here, element, comp_);
+    // if the element is already in the tree we can't insert
+    if (spot.match_ != nullptr) {
         return false;
-    } else if (element > here->element_) {
-        if (here->right_ == nullptr) {
-            here->right_ = new Node(element, nullptr, nullptr, here);
-            ++here->size_;
-            leftRotate(here);
-            return true;
+    }
+    Node* top = here;
+    Node* parent = spot.parent_;
+    Node* newNode = createNode(std::forward<U>(element), nullptr, nullptr, parent);
+    if (spot.left_) {
+        parent->left_ = newNode;
+    } else {
+        parent->right_ = newNode;
+    }
+    // then rotate it up until it has taken top's place
+    while (true) {
+        parent = newNode->parent_;
+        ++parent->size_;
+        if (parent->left_ == newNode) {
+            rightRotate(parent);
+        } else {
+            leftRotate(parent);
         }
-        if (insertNodeAtRoot(here->right_, element)) {
-            ++here->size_;
-            leftRotate(here); 
+        if (parent == top) {
             return true;
         }
-        return false;
-    } 
-    // if we aren't less than or greater than the element, we must be equal
-    // and thus we can't insert
-    else {
-        return false;
     }
 }
 
-template<typename T>
-bool RandomTree<T>::deleteElement(const T& element)
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::deleteElement(const T& element)
 {
     if (empty()) {
         return false;
@@ -249,18 +706,16 @@ bool RandomTree<T>::deleteElement(const T& element)
     if (nodeSize(root_) == 1) {
         return deleteOneElementTree(element);
     }
-    Node* deletee;    // the node to delete
-    if (root_->element_ == element) {
+    Node* deletee = findNode(root_, element);    // the node to delete
+    // if we couldn't find a node holding the element, we can't delete
+    if (deletee == nullptr) {
+        return false;
+    }
+    if (deletee == root_) {
         deletee = getNextNode(root_);
         // set the root's value to be it's replacement's value, then proceed to
         // delete the old node containing the replacement
         root_->element_ = deletee->element_;
-    } else {
-        deletee = findNode(root_, element);
-        // if we couldn't find a node holding the element, we can't delete
-        if (deletee == nullptr) {
-            return false;
-        }
     }
     // if the element to delete is a leaf, just remove the leaf
     if (deletee->left_ == nullptr && deletee->right_ == nullptr) {
@@ -280,8 +735,8 @@ bool RandomTree<T>::deleteElement(const T& element)
     }
 }
 
-template<typename T>
-typename RandomTree<T>::Node* RandomTree<T>::getNextNode(Node* here)
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::getNextNode(Node* here)
 {
     iterator nextNode = Iterator(here);
     // go one to the right if we can
@@ -290,15 +745,148 @@ typename RandomTree<T>::Node* RandomTree<T>::getNextNode(Node* here)
         // go to the right)
         nextNode = --(Iterator(root_));
     }
-    return findNode(root_, *nextNode);
+    return nextNode.current_;
 }
 
 
-template<typename T>
-bool RandomTree<T>::deleteOneElementTree(const T& element)
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::buildFromSorted(std::vector<T>& elements)
 {
-    if (root_->element_ == element) {
-        delete root_;
+    // a set only holds each element once
+    elements.erase(std::unique(elements.begin(), elements.end(),
+                               [this](const T& a, const T& b) {
+                                   return keyEquivalent(comp_, a, b);
+                               }),
+                   elements.end());
+    destroyTree(root_);
+    root_ = buildSubtree(elements, 0, elements.size(), nullptr);
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::buildSubtree(
+    const std::vector<T>& elements, size_t lower, size_t upper, Node* parent)
+{
+    if (lower == upper) {
+        return nullptr;
+    }
+    size_t middle = lower + (upper - lower) / 2;
+    Node* here = createNode(elements[middle], nullptr, nullptr, parent);
+    here->left_ = buildSubtree(elements, lower, middle, here);
+    here->right_ = buildSubtree(elements, middle + 1, upper, here);
+    here->size_ = upper - lower;
+    return here;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::cloneTree(const Node* source, Node*& spares)
+{
+    if (source == nullptr) {
+        return nullptr;
+    }
+    Node* root = cloneNode(source, nullptr, spares);
+    // walk both trees together using the parent pointers, so deep trees
+    // can't overflow the stack
+    Node* copy = root;
+    while (copy != nullptr) {
+        if (source->left_ != nullptr && copy->left_ == nullptr) {
+            copy->left_ = cloneNode(source->left_, copy, spares);
+            source = source->left_;
+            copy = copy->left_;
+        } else if (source->right_ != nullptr && copy->right_ == nullptr) {
+            copy->right_ = cloneNode(source->right_, copy, spares);
+            source = source->right_;
+            copy = copy->right_;
+        } else {
+            // both subtrees are done, go back up
+            source = source->parent_;
+            copy = copy->parent_;
+        }
+    }
+    return root;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::cloneNode(const Node* source, Node* parent,
+                                                       Node*& spares)
+{
+    Node* copy;
+    if (spares == nullptr) {
+        copy = createNode(source->element_, nullptr, nullptr, parent);
+    } else {
+        copy = spares;
+        spares = spares->right_;
+        copy->element_ = source->element_;
+        copy->left_ = nullptr;
+        copy->right_ = nullptr;
+        copy->parent_ = parent;
+    }
+    copy->size_ = source->size_;
+    return copy;
+}
+
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::unlinkNodes(Node* here)
+{
+    Node* spares = nullptr;
+    while (here != nullptr) {
+        if (here->left_ != nullptr) {
+            // rotate the left child up until there is nothing on the left
+            Node* left = here->left_;
+            here->left_ = left->right_;
+            left->right_ = here;
+            here = left;
+        } else {
+            Node* next = here->right_;
+            here->right_ = spares;
+            spares = here;
+            here = next;
+        }
+    }
+    return spares;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::deleteSpares(Node* spares)
+{
+    while (spares != nullptr) {
+        Node* next = spares->right_;
+        destroyNode(spares);
+        spares = next;
+    }
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename... Args>
+typename RandomTree<T, Compare, Allocator>::Node* RandomTree<T, Compare, Allocator>::createNode(Args&&... args)
+{
+    Node* node = NodeTraits::allocate(alloc_, 1);
+    try {
+        NodeTraits::construct(alloc_, node, std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc_, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::destroyNode(Node* node)
+{
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::destroyTree(Node* here)
+{
+    deleteSpares(unlinkNodes(here));
+}
+
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::deleteOneElementTree(const T& element)
+{
+    if (keyEquivalent(comp_, root_->element_, element)) {
+        destroyNode(root_);
         root_ = nullptr;
         return true;
     } else {
@@ -306,26 +894,16 @@ bool RandomTree<T>::deleteOneElementTree(const T& element)
     }
 }
 
-template<typename T>
-void RandomTree<T>::deleteLeaf(Node* deletee)
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::deleteLeaf(Node* deletee)
 {
     Node* parent = deletee->parent_;
-    if (deletee->element_ < parent->element_) {
-        delete parent->left_;
+    if (parent->left_ == deletee) {
+        destroyNode(parent->left_);
         parent->left_ = nullptr;
-    } else if (deletee->element_ > parent->element_) {
-        delete parent->right_;
+    } else {
+        destroyNode(parent->right_);
         parent->right_ = nullptr;
-    } 
-    // if the deletee is equal to its parent (can happen when deleting root)
-    else {
-        if (parent->right_ == nullptr) {
-            delete parent->left_;
-            parent->left_ = nullptr;
-        } else {
-            delete parent->right_;
-            parent->right_ = nullptr;
-        }
     }
     // adjust size values of all the parents
     while (parent != nullptr) {
@@ -334,8 +912,8 @@ void RandomTree<T>::deleteLeaf(Node* deletee)
     }
 }
 
-template<typename T>
-void RandomTree<T>::deleteStick(Node* deletee, bool deleteLeft)
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::deleteStick(Node* deletee, bool deleteLeft)
 {
     Node* newChild;
 
@@ -360,7 +938,7 @@ void RandomTree<T>::deleteStick(Node* deletee, bool deleteLeft)
     // when deleting the deletee
     deletee->left_ = nullptr;
     deletee->right_ = nullptr;
-    delete deletee;
+    destroyNode(deletee);
     // adjust size values of all the parents
     Node* parent = newChild->parent_;
     while (parent != nullptr) {
@@ -369,8 +947,8 @@ void RandomTree<T>::deleteStick(Node* deletee, bool deleteLeft)
     }
 }
 
-template<typename T>
-void RandomTree<T>::deleteTwoChildNode(Node* deletee)
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::deleteTwoChildNode(Node* deletee)
 {
     // replace the node to delete with the next node, then delete that
     // replacement's old node location
@@ -393,8 +971,8 @@ void RandomTree<T>::deleteTwoChildNode(Node* deletee)
 //    b   E  ->    A   d
 //   / \              / \
 //  A   C            C   E
-template <typename T> 
-void RandomTree<T>::rightRotate(Node* top)
+template <typename T, typename Compare, typename Allocator> 
+void RandomTree<T, Compare, Allocator>::rightRotate(Node* top)
 {
     fixSizeRightRotate(top);
     Node* newRoot = top->left_;          // b is d's left child
@@ -411,7 +989,7 @@ void RandomTree<T>::rightRotate(Node* top)
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -425,8 +1003,8 @@ void RandomTree<T>::rightRotate(Node* top)
 //    A   d     ->    b   E
 //       / \         / \
 //      C   E       A   C
-template <typename T> 
-void RandomTree<T>::leftRotate(Node* top) 
+template <typename T, typename Compare, typename Allocator> 
+void RandomTree<T, Compare, Allocator>::leftRotate(Node* top) 
 {
     fixSizeLeftRotate(top);
     Node* newRoot = top->right_;      // d is b's right child
@@ -443,7 +1021,7 @@ void RandomTree<T>::leftRotate(Node* top)
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -451,46 +1029,59 @@ void RandomTree<T>::leftRotate(Node* top)
     }
 }
 
-template <typename T> 
-void RandomTree<T>::fixSizeRightRotate(Node* here)
+template <typename T, typename Compare, typename Allocator> 
+void RandomTree<T, Compare, Allocator>::fixSizeRightRotate(Node* here)
 {
     size_t hereSize = nodeSize(here);
     here->size_ = nodeSize(here->right_) + nodeSize(here->left_->right_) + 1;
     here->left_->size_ = hereSize;
 }
 
-template <typename T> 
-void RandomTree<T>::fixSizeLeftRotate(Node* here)
+template <typename T, typename Compare, typename Allocator> 
+void RandomTree<T, Compare, Allocator>::fixSizeLeftRotate(Node* here)
 {
     size_t hereSize = nodeSize(here);
     here->size_ = nodeSize(here->left_) + nodeSize(here->right_->left_) + 1;
     here->right_->size_ = hereSize;
 }
 
-template <typename T> 
-size_t RandomTree<T>::nodeSize(Node* here) const
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::updateSizes(Node* here)
+{
+    while (here != nullptr) {
+        here->size_ = nodeSize(here->left_) + nodeSize(here->right_) + 1;
+        here = here->parent_;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator> 
+size_t RandomTree<T, Compare, Allocator>::nodeSize(Node* here) const
 {
     if (!here)
         return 0;
     return here->size_;
 }
 
-template<typename T>
-std::ostream& RandomTree<T>::printStatistics(std::ostream& out) const
+template<typename T, typename Compare, typename Allocator>
+std::ostream& RandomTree<T, Compare, Allocator>::printStatistics(std::ostream& out) const
 {
     out << "height " << height() << std::endl;
+    out << "node memory " << size() * sizeof(Node) << " bytes" << std::endl;
+    out << "allocated memory "
+        << allocatorBytes(alloc_, size() * sizeof(Node)) << " bytes"
+        << std::endl;
     return out;
 }
 
-template <typename T>
-std::ostream& RandomTree<T>::print(std::ostream& out) const
+template <typename T, typename Compare, typename Allocator>
+std::ostream& RandomTree<T, Compare, Allocator>::print(std::ostream& out) const
 {
     printPretty(root_, 1, 1, out);
     return out;
 }
 
-template<typename T>
-typename RandomTree<T>::iterator RandomTree<T>::begin() const
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::iterator RandomTree<T, Compare, Allocator>::begin() const
 {
     Node* current = root_;
     std::stack<Node*> parents;
@@ -505,22 +1096,29 @@ typename RandomTree<T>::iterator RandomTree<T>::begin() const
     return Iterator(current);
 }
 
-template<typename T>
-typename RandomTree<T>::iterator RandomTree<T>::end() const
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::iterator RandomTree<T, Compare, Allocator>::end() const
 {
     std::stack<Node*> parents;
     return Iterator(nullptr);
 }
 
+template<typename T, typename Compare, typename Allocator>
+template <typename Function>
+void RandomTree<T, Compare, Allocator>::forEach(Function&& visit) const
+{
+    forEachInOrder(root_, visit);
+}
+
 // --------------------------------------
 //
 // Implementation of Pretty Print
 // (taken from http://articles.leetcode.com/2010/09/how-to-pretty-print-binary-tree.html)
 //
 // --------------------------------------
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Print the arm branches (eg, /    \ ) on a line
-void RandomTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void RandomTree<T, Compare, Allocator>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel / 2; i++) {  
     out << ((i == 0) ? std::setw(startLen-1) : std::setw(nodeSpaceLen-2)) << "" << ((*iter++) ? "/" : " ");
@@ -529,9 +1127,9 @@ void RandomTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen,
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Print the branches and node (eg, ___10___ )
-void RandomTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void RandomTree<T, Compare, Allocator>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(startLen) : std::setw(nodeSpaceLen)) << "" << ((*iter && (*iter)->left_) ? std::setfill('_') : std::setfill(' '));
@@ -551,9 +1149,9 @@ void RandomTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, in
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Print the leaves only (just for the bottom row)
-void RandomTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void RandomTree<T, Compare, Allocator>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(indentSpace+2) : std::setw(2*level+2)) << ((*iter) ? std::to_string((*iter)->element_) : "");
@@ -561,12 +1159,12 @@ void RandomTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator>
 // Pretty formatting of a binary tree to the output stream
 // @ param
 // level  Control how wide you want the tree to sparse (eg, level 1 has the minimum space between nodes, while level 2 has a larger space between nodes)
 // indentSpace  Change this to add some indent space to the left (eg, indentSpace of 0 means the lowest level of the left node will stick to the left margin)
-void RandomTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
+void RandomTree<T, Compare, Allocator>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
   int h = subtreeHeight(root_); //maxHeight(root);
   int nodesInThisLevel = 1;
 
@@ -605,18 +1203,62 @@ void RandomTree<T>::printPretty(Node* root, int level, int indentSpace, std::ost
 // Implementation of RandomTree::Node
 //
 // --------------------------------------
-template<typename T>
-RandomTree<T>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
     :element_{element}, left_{left}, right_{right}, parent_{parent}, size_{1}
 {
     // nothing else to do
 }
 
-template<typename T>
-RandomTree<T>::Node::~Node()
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::Node::Node(T&& element, Node* left, Node* right, Node* parent)
+    :element_{std::move(element)}, left_{left}, right_{right}, parent_{parent}, size_{1}
+{
+    // nothing else to do
+}
+
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::Node::~Node()
 {
-    delete left_;
-    delete right_;
+    // the tree frees the children itself
+}
+
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::DroppedNodes::DroppedNodes()
+    : first_{nullptr}, last_{nullptr}
+{
+    // nothing else to do
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::DroppedNodes::add(Node* here)
+{
+    if (here == nullptr) {
+        return;
+    }
+    here->parent_ = nullptr;
+    if (last_ == nullptr) {
+        first_ = here;
+    } else {
+        last_->parent_ = here;
+    }
+    last_ = here;
+}
+
+template<typename T, typename Compare, typename Allocator>
+void RandomTree<T, Compare, Allocator>::DroppedNodes::append(DroppedNodes& other)
+{
+    if (other.first_ == nullptr) {
+        return;
+    }
+    if (last_ == nullptr) {
+        first_ = other.first_;
+    } else {
+        last_->parent_ = other.first_;
+    }
+    last_ = other.last_;
+    other.first_ = nullptr;
+    other.last_ = nullptr;
 }
 
 // --------------------------------------
@@ -624,26 +1266,20 @@ RandomTree<T>::Node::~Node()
 // Implementation of RandomTree::Iterator
 //
 // --------------------------------------
-template<typename T>
-RandomTree<T>::Iterator::Iterator(Node* index)
+template<typename T, typename Compare, typename Allocator>
+RandomTree<T, Compare, Allocator>::Iterator::Iterator(Node* index)
     : current_{index}
 {
     // Nothing else to do.
 }
 
-template<typename T>
-typename RandomTree<T>::Iterator& RandomTree<T>::Iterator::operator++()
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Iterator& RandomTree<T, Compare, Allocator>::Iterator::operator++()
 {
-    bool lastElement = false;
-    // empty tree
+    // empty tree, or already past the end
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
-    }
     // if there's something to the right, we go there then go as far to the left
     // as we can, for example to get from 10 to 11 in this tree
     //            10
@@ -660,120 +1296,67 @@ typename RandomTree<T>::Iterator& RandomTree<T>::Iterator::operator++()
         while (current_->left_ != nullptr) {
             current_ = current_->left_;
         }
-    } 
-    // nothing to the right and at the root node, which means we are at the
-    // last element in the tree
-    else if (current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
     }
-    // at this point we must go back up the tree to get to the next largest 
-    // value
-    // if stepping back up to the parent gives us a larger value, then we stop
-    else if (current_->parent_->element_ > current_->element_) {
+    // otherwise we go back up the tree until we step up out of a left
+    // subtree, that parent is the next largest value. If we step off the top
+    // of the tree we were at the largest element, and end up at end()
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    } 
-    // if stepping back up to the parent gives us a smaller value, then we keep
-    // going up until we hit a larger value
-    else if (current_->parent_->element_ < current_->element_) {
-        while (current_->parent_->element_ < current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                lastElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!lastElement) {
+        while (current_ != nullptr && current_->right_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the last element, return the equivalent of the end()
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-typename RandomTree<T>::Iterator& RandomTree<T>::Iterator::operator--()
+template<typename T, typename Compare, typename Allocator>
+typename RandomTree<T, Compare, Allocator>::Iterator& RandomTree<T, Compare, Allocator>::Iterator::operator--()
 {
     // maybe something to handle -- on end()?
 
-    bool firstElement = false;
     // empty tree
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    else if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
     // if there is something to the left, we go there and then go to the right
     // as far as we can
-    else if (current_->left_ != nullptr) {
+    if (current_->left_ != nullptr) {
         current_ = current_->left_;
         while (current_->right_ != nullptr) {
             current_ = current_->right_;
         }
     }
-    // nothing to the left and at the root node, which means we are at the
-    // first element in the tree
-    else if (current_->left_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // at this point we must go back up the tree to get to the next smallest 
-    // value
-    // if stepping back up to the parent gives us a smaller value, then we stop
-    else if (current_->parent_->element_ < current_->element_) {
+    // otherwise we go back up the tree until we step up out of a right
+    // subtree, that parent is the next smallest value. If we step off the top
+    // of the tree we were at the smallest element, and end up at null
+    // (-- on begin())
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    }
-    // if stepping back up to the parent gives us a larger value, then we keep
-    // going up until we hit a smaller value
-    else if (current_->parent_->element_ > current_->element_) {
-        while (current_->parent_->element_ > current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                firstElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!firstElement) {
+        while (current_ != nullptr && current_->left_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the first element, return null (-- on begin())
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-T& RandomTree<T>::Iterator::operator*() const
+template<typename T, typename Compare, typename Allocator>
+T& RandomTree<T, Compare, Allocator>::Iterator::operator*() const
 {
     return current_->element_;
 }
 
-template<typename T>
-bool RandomTree<T>::Iterator::operator==(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::Iterator::operator==(const Iterator& rhs) const
 {
     return (current_ == rhs.current_);
 }
 
-template<typename T>
-bool RandomTree<T>::Iterator::operator!=(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool RandomTree<T, Compare, Allocator>::Iterator::operator!=(const Iterator& rhs) const
 {
     return !(*this == rhs);
 }
@@ -10,6 +10,11 @@
 #ifndef RB_TREE_INCLUDED
 #define RB_TREE_INCLUDED 1
 #include "abstracttree.hpp"
+#include "node_pool.hpp"
+#include "key_compare.hpp"
+#include "iterator_range.hpp"
+#include "in_order.hpp"
+#include "order_statistics.hpp"
 #include <cstddef>
 #include <cassert>
 #include <iostream>
@@ -19,6 +24,11 @@
 #include <list>
 #include <iomanip>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <functional>
 
 
 #define RESET   "\033[0m"
@@ -26,11 +36,16 @@
 #define RED     "\033[31m"      /* Red */
 #define WHITE   "\033[37m"      /* White */
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>,
+          typename Allocator = NodePool<T>,
+          typename Statistics = NoOrderStatistics>
 
 /**
 * \class RBTree
 * \brief A templated random tree
+*
+* \details Statistics is NoOrderStatistics or OrderStatistics, the latter
+* keeps subtree sizes so select, rank and countRange can be used
 */
 
 class RBTree : public AbstractTree<T>{
@@ -47,19 +62,64 @@ public:
     */
     RBTree();
 
+    /**
+    * \brief
+    * Comparator Constructor
+    *
+    * \param comp the comparator to order the elements with
+    */
+    explicit RBTree(const Compare& comp);
+
+    /**
+    * \brief
+    * Range Constructor
+    *
+    * \details Sorts the elements in [first, last) and builds a perfectly
+    * balanced tree out of them.
+    *
+    * \note O(n) time after the sort
+    */
+    template <typename InputIterator>
+    RBTree(InputIterator first, InputIterator last,
+            const Compare& comp = Compare());
+
     /**
     * \brief
     * Copy Constructor
     *
+    * \details Copies the tree node by node, so the copy has exactly the same
+    * shape as the original.
+    *
+    * \note O(n) time
     */
-    RBTree<T>(const RBTree<T>& orig);
+    RBTree<T, Compare, Allocator, Statistics>(const RBTree<T, Compare, Allocator, Statistics>& orig);
 
     /**
     * \brief
     * Assignment Operator
     *
+    * \details Reuses the nodes the tree already holds before allocating new
+    * ones.
     */
-    RBTree<T>& operator=(const RBTree<T>& rhs);
+    RBTree<T, Compare, Allocator, Statistics>& operator=(const RBTree<T, Compare, Allocator, Statistics>& rhs);
+
+    /**
+    * \brief
+    * Move Constructor
+    *
+    * \details Takes over the nodes of orig, leaving it empty
+    *
+    * \note constant time
+    */
+    RBTree<T, Compare, Allocator, Statistics>(RBTree<T, Compare, Allocator, Statistics>&& orig);
+
+    /**
+    * \brief
+    * Move Assignment Operator
+    *
+    * \note constant time, apart from freeing the tree's old nodes
+    */
+    RBTree<T, Compare, Allocator, Statistics>& operator=(RBTree<T, Compare, Allocator, Statistics>&& rhs);
 
     /**
     * \brief
@@ -67,7 +127,20 @@ public:
     *
     *
     */
-    void swap(RBTree<T>& rhs);
+    void swap(RBTree<T, Compare, Allocator, Statistics>& rhs);
+
+    /**
+    * \brief
+    * Replaces the contents of the tree with the elements in [first, last)
+    *
+    * \details The range must already be sorted; repeated elements are only
+    * stored once. The tree is rebuilt perfectly balanced without any
+    * comparisons or rotations.
+    *
+    * \note O(n) time
+    */
+    template <typename InputIterator>
+    void assignSorted(InputIterator first, InputIterator last);
 
     /**
     * \brief 
@@ -81,6 +154,17 @@ public:
     iterator begin() const; ///< An iterator that refers to the first element
     iterator end() const;   ///< A "past-the-end" iterator
 
+    /**
+    * \brief calls visit(element) for every element, in order
+    *
+    * \details a tight loop, much faster than the iterators over a whole
+    * tree
+    *
+    * \note visit mustn't change the tree
+    */
+    template <typename Function>
+    void forEach(Function&& visit) const;
+
     /**
     * \brief 
     * Size function
@@ -100,6 +184,19 @@ public:
     *
     */
     bool insert(const T& element);
+    bool insert(T&& element);
+
+    /**
+    * \brief
+    * Constructs an element out of args and inserts it into the tree
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \returns true if the element was inserted, false if it was already
+    * present
+    */
+    template <typename... Args>
+    bool emplace(Args&&... args);
 
     /**
     * \brief 
@@ -118,19 +215,104 @@ public:
     */
     bool contains(const T& element) const;
 
+    /**
+    * \brief
+    * Checks if an element equivalent to key is in the tree
+    *
+    * \note only available if Compare defines is_transparent, so keys of
+    * other types can be looked up without converting them to T
+    */
+    template <typename K, typename C = Compare,
+              typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    /**
+    * \brief returns a copy of the comparator that orders the tree
+    */
+    Compare key_comp() const;
+
+    /**
+    * \brief
+    * Finds an element in the tree
+    *
+    * \returns an iterator to the element, end() if it isn't in the tree
+    */
+    iterator find(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that doesn't sort before element
+    *
+    * \returns end() if every element sorts before element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator lower_bound(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that sorts after element
+    *
+    * \returns end() if no element sorts after element
+    *
+    * \note log(n) time, one comparison per level
+    */
+    iterator upper_bound(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements equivalent to element as a pair of iterators, so
+    * the range is empty if element isn't in the tree
+    */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements in [lower, upper), for use in a range-based for
+    * loop
+    *
+    * \note log(n) time to find the ends of the range, then the scan costs
+    * amortized constant time per element
+    */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
+
+    /**
+    * \brief
+    * Finds the element with exactly k smaller elements in the tree
+    *
+    * \note only available with the OrderStatistics policy, log(n) time
+    */
+    const T& select(size_t k) const;
+
+    /**
+    * \brief
+    * Counts the elements in the tree that sort before element
+    *
+    * \note only available with the OrderStatistics policy, log(n) time
+    */
+    size_t rank(const T& element) const;
+
+    /**
+    * \brief
+    * Counts the elements in the tree in the range [lower, upper)
+    *
+    * \note only available with the OrderStatistics policy, log(n) time
+    */
+    size_t countRange(const T& lower, const T& upper) const;
+
     /**
     * \brief
     * Random Tree equality operator
     *
     */
-    bool operator==(const RBTree<T>& rhs) const;
+    bool operator==(const RBTree<T, Compare, Allocator, Statistics>& rhs) const;
 
     /**
     * \brief
     * Random Tree inequality operator
     *
     */
-    bool operator!=(const RBTree<T>& rhs) const;
+    bool operator!=(const RBTree<T, Compare, Allocator, Statistics>& rhs) const;
 
     /**
     * \brief
@@ -166,7 +348,7 @@ public:
 
 
 private:
-    struct Node {
+    struct Node : public Statistics::NodeCount {
         T element_;     ///> the element at this node
         Node* left_;    ///> this node's left child
         Node* right_;   ///> this node's right child
@@ -178,6 +360,7 @@ private:
         *
         */
         Node(const T& element, Node* left, Node* right, Node* parent, bool isRed);
+        Node(T&& element, Node* left, Node* right, Node* parent, bool isRed);
         /**
         * \brief default destructor
         *
@@ -207,6 +390,12 @@ private:
         Node() = delete; // disable default constructor
         Node& operator=(const Node&) = delete; // disable assignment operator
     };
+
+    using NodeAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator alloc_; ///> where the tree's nodes come from
+    Compare comp_;        ///> orders the elements
     size_t size_;
     Node* root_;
 
@@ -243,9 +432,10 @@ private:
      * Inserts a node into the tree
      *
      * \param here The node to insert at
-     * \param element The element to insert
+     * \param element The element to insert, forwarded to the new node
      */
-    bool insertNode(Node*& here, const T& element);
+    template <typename U>
+    bool insertNode(Node*& here, U&& element);
 
     /**
     * \brief
@@ -266,7 +456,8 @@ private:
      *
      * \returns True if the element is present in the tree, false if otherwise
      */
-    Node* findNode(Node* here, const T& element) const;
+    template <typename K>
+    Node* findNode(Node* here, const K& element) const;
 
     Node* getNextNode(Node* here);
 
@@ -300,6 +491,77 @@ private:
     */
     bool deleteOneElementTree(const T& element);
 
+    /**
+    * \brief replaces the tree with a perfectly balanced tree holding the
+    * sorted elements
+    *
+    * \param elements sorted elements, repeated elements are removed
+    */
+    void buildFromSorted(std::vector<T>& elements);
+
+    /**
+    * \brief builds a perfectly balanced subtree out of the sorted elements in
+    * [lower, upper)
+    *
+    * \param depth the depth of the subtree's root
+    * \param redDepth the depth of the bottom level, whose nodes are colored
+    * red so every path has the same number of black nodes
+    *
+    * \returns the root of the new subtree
+    */
+    Node* buildSubtree(const std::vector<T>& elements, size_t lower,
+                       size_t upper, Node* parent, size_t depth,
+                       size_t redDepth);
+
+    /**
+    * \brief copies the tree rooted at source node by node, keeping its shape
+    * and colours
+    *
+    * \param spares nodes to reuse before allocating new ones, linked through
+    * their right_ pointers
+    *
+    * \returns the root of the copy
+    */
+    Node* cloneTree(const Node* source, Node*& spares);
+
+    /**
+    * \brief makes a childless copy of source below parent, reusing a spare
+    * node if there is one
+    */
+    Node* cloneNode(const Node* source, Node* parent, Node*& spares);
+
+    /**
+    * \brief takes apart the tree rooted at here into a list of nodes linked
+    * through their right_ pointers
+    *
+    * \returns the head of the list
+    */
+    static Node* unlinkNodes(Node* here);
+
+    /**
+    * \brief frees a list of nodes made by unlinkNodes
+    */
+    void deleteSpares(Node* spares);
+
+    /**
+    * \brief allocates a node from the tree's allocator and constructs it
+    * out of args
+    */
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+
+    /**
+    * \brief destroys a single node and gives its memory back, the node's
+    * children are left alone
+    */
+    void destroyNode(Node* node);
+
+    /**
+    * \brief destroys every node in the subtree rooted at here, without
+    * recursing
+    */
+    void destroyTree(Node* here);
+
     void rebalanceAfterInsert(Node* here);
 
     void rebalanceAfterDelete(Node* here);
@@ -334,10 +596,10 @@ private:
 
 };
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 /// Provide a non-member version of swap to allow standard swap(x,y) usage.
-void swap(RBTree<T>& lhs, RBTree<T>& rhs);
+void swap(RBTree<T, Compare, Allocator, Statistics>& lhs, RBTree<T, Compare, Allocator, Statistics>& rhs);
 
-#include "RBTree-private.hpp"
+#include "red_black_tree_private.hpp"
 
 #endif // RB_TREE_INCLUDED
@@ -5,70 +5,130 @@
  * \brief implementation of templated red black tree class
  */
 
-template<typename T>
-RBTree<T>::RBTree()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::RBTree()
             : size_{0}, root_{nullptr}
 {
     // nothing else to do
 }
 
-template<typename T>
-RBTree<T>::~RBTree()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::RBTree(const Compare& comp)
+            : comp_{comp}, size_{0}, root_{nullptr}
 {
-    delete root_;
+    // nothing else to do
 }
 
-template<typename T>
-RBTree<T>::RBTree(const RBTree<T>& orig)
-            : size_{0}, root_{nullptr}
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::~RBTree()
+{
+    destroyTree(root_);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::RBTree(const RBTree<T, Compare, Allocator, Statistics>& orig)
+            : alloc_{NodeTraits::select_on_container_copy_construction(
+                  orig.alloc_)}, comp_{orig.comp_}, size_{orig.size_},
+              root_{nullptr}
 {
-    for (iterator i = orig.begin(); i != orig.end(); ++i) {
-        insert(*i);
+    Node* spares = nullptr;
+    root_ = cloneTree(orig.root_, spares);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>& RBTree<T, Compare, Allocator, Statistics>::operator=(const RBTree<T, Compare, Allocator, Statistics>& rhs)
+{
+    if (this != &rhs) {
+        // reuse the nodes we already have and free whatever is left over
+        Node* spares = unlinkNodes(root_);
+        root_ = cloneTree(rhs.root_, spares);
+        deleteSpares(spares);
+        comp_ = rhs.comp_;
+        size_ = rhs.size_;
     }
+    return *this;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::RBTree(RBTree<T, Compare, Allocator, Statistics>&& orig)
+            : alloc_{std::move(orig.alloc_)}, comp_{orig.comp_},
+              size_{orig.size_},
+              root_{orig.root_}
+{
+    orig.size_ = 0;
+    orig.root_ = nullptr;
 }
 
-template<typename T>
-RBTree<T>& RBTree<T>::operator=(const RBTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>& RBTree<T, Compare, Allocator, Statistics>::operator=(RBTree<T, Compare, Allocator, Statistics>&& rhs)
 {
-    RBTree<T> copy{rhs};
-    swap(copy);
+    RBTree<T, Compare, Allocator, Statistics> moved{std::move(rhs)};
+    swap(moved);
     return *this;
 }
 
-template<typename T>
-void RBTree<T>::swap(RBTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::swap(RBTree<T, Compare, Allocator, Statistics>& rhs)
 {
     using std::swap;
     swap(root_, rhs.root_);
     swap(size_, rhs.size_);
+    swap(alloc_, rhs.alloc_);
+    swap(comp_, rhs.comp_);
 }
 
-template<typename T>
-void swap(RBTree<T>& lhs, RBTree<T>& rhs)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void swap(RBTree<T, Compare, Allocator, Statistics>& lhs, RBTree<T, Compare, Allocator, Statistics>& rhs)
 {
     lhs.swap(rhs);
 }
 
-template<typename T>
-size_t RBTree<T>::size() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename InputIterator>
+RBTree<T, Compare, Allocator, Statistics>::RBTree(InputIterator first, InputIterator last,
+                                      const Compare& comp)
+            : comp_{comp}, size_{0}, root_{nullptr}
+{
+    std::vector<T> elements(first, last);
+    std::sort(elements.begin(), elements.end(),
+              [this](const T& a, const T& b) {
+                  return keyLess(comp_, a, b);
+              });
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename InputIterator>
+void RBTree<T, Compare, Allocator, Statistics>::assignSorted(InputIterator first, InputIterator last)
+{
+    std::vector<T> elements(first, last);
+    assert(std::is_sorted(elements.begin(), elements.end(),
+                          [this](const T& a, const T& b) {
+                              return keyLess(comp_, a, b);
+                          }));
+    buildFromSorted(elements);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::size() const
 {
     return size_;
 }
 
-template<typename T>
-size_t RBTree<T>::height() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::height() const
 {
     return subtreeHeight(root_);
 }
 
-template<typename T>
-bool RBTree<T>::empty() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::empty() const
 {
     return (size_ == 0);
 }
 
-template<typename T>
-bool RBTree<T>::operator==(const RBTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::operator==(const RBTree<T, Compare, Allocator, Statistics>& rhs) const
 {
     // if the sizes are different the trees are not equal
     if (size() != rhs.size()) {
@@ -88,29 +148,39 @@ bool RBTree<T>::operator==(const RBTree<T>& rhs) const
     return true;
 }
 
-template<typename T>
-bool RBTree<T>::operator!=(const RBTree<T>& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::operator!=(const RBTree<T, Compare, Allocator, Statistics>& rhs) const
 {
     return !(*this == rhs);
 }
 
-template<typename T>
-size_t RBTree<T>::subtreeHeight(Node* here) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::subtreeHeight(Node* here) const
 {
-    // recursive base case
-    if (here == nullptr) {
-        return 0;
+    // walk the subtree with an explicit stack of nodes and their depths,
+    // a path-shaped tree is as deep as it is big
+    size_t height = 0;
+    std::stack<std::pair<Node*, size_t>> toVisit;
+    if (here != nullptr) {
+        toVisit.push(std::make_pair(here, 1));
+    }
+    while (!toVisit.empty()) {
+        Node* node = toVisit.top().first;
+        size_t depth = toVisit.top().second;
+        toVisit.pop();
+        height = std::max(height, depth);
+        if (node->left_ != nullptr) {
+            toVisit.push(std::make_pair(node->left_, depth + 1));
+        }
+        if (node->right_ != nullptr) {
+            toVisit.push(std::make_pair(node->right_, depth + 1));
+        }
     }
-    // recursively get the left and right subtree heights
-    size_t leftSize = subtreeHeight(here->left_);
-    size_t rightSize = subtreeHeight(here->right_);
-
-    // the taller of the two subtrees is the height of the overall subtree
-    return 1 + std::max(leftSize, rightSize);
+    return height;
 }
 
-template<typename T>
-bool RBTree<T>::hasRBProperties() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::hasRBProperties() const
 {
     if (empty()) {
         return true;
@@ -121,8 +191,8 @@ bool RBTree<T>::hasRBProperties() const
     return root_->hasRBProperties();
 }
 
-template<typename T>
-bool RBTree<T>::contains(const T& element) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::contains(const T& element) const
 {
     if (findNode(root_, element) == nullptr) {
         return false;
@@ -131,29 +201,94 @@ bool RBTree<T>::contains(const T& element) const
     }
 }
 
-template<typename T>
-typename RBTree<T>::Node* RBTree<T>::findNode(Node* here, const T& element) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename K, typename C, typename>
+bool RBTree<T, Compare, Allocator, Statistics>::contains(const K& key) const
 {
-    if (here == nullptr) {
-        return nullptr;
-    } 
-    // continue searching to the left
-    else if (element < here->element_) {
-        return findNode(here->left_, element);
-    }
-    // continue searching to the right
-    else if (element > here->element_) {
-        return findNode(here->right_, element);
-    } 
-    // element is not less than or greater than here->element_, so it must
-    // be equal to here->element_
-    else {
-        return here;
+    return findNode(root_, key) != nullptr;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+Compare RBTree<T, Compare, Allocator, Statistics>::key_comp() const
+{
+    return comp_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::iterator RBTree<T, Compare, Allocator, Statistics>::find(const T& element) const
+{
+    return Iterator(findNode(root_, element));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::iterator RBTree<T, Compare, Allocator, Statistics>::lower_bound(const T& element) const
+{
+    return Iterator(lowerBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::iterator RBTree<T, Compare, Allocator, Statistics>::upper_bound(const T& element) const
+{
+    return Iterator(upperBoundNode(root_, element, comp_));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+std::pair<typename RBTree<T, Compare, Allocator, Statistics>::iterator, typename RBTree<T, Compare, Allocator, Statistics>::iterator>
+RBTree<T, Compare, Allocator, Statistics>::equal_range(const T& element) const
+{
+    iterator first = lower_bound(element);
+    iterator last = first;
+    // the elements are unique, so at most one of them can be equivalent
+    if (last != end() && !keyLess(comp_, element, *last)) {
+        ++last;
+    }
+    return std::make_pair(first, last);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+IteratorRange<typename RBTree<T, Compare, Allocator, Statistics>::iterator> RBTree<T, Compare, Allocator, Statistics>::range(const T& lower, const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return IteratorRange<iterator>(end(), end());
+    }
+    return IteratorRange<iterator>(lower_bound(lower), lower_bound(upper));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+const T& RBTree<T, Compare, Allocator, Statistics>::select(size_t k) const
+{
+    static_assert(std::is_same<Statistics, OrderStatistics>::value,
+                  "select needs the OrderStatistics policy");
+    assert(k < size_);
+    return Statistics::select(root_, k)->element_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::rank(const T& element) const
+{
+    static_assert(std::is_same<Statistics, OrderStatistics>::value,
+                  "rank needs the OrderStatistics policy");
+    return Statistics::rank(root_, element, comp_);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::countRange(const T& lower, const T& upper) const
+{
+    if (!keyLess(comp_, lower, upper)) {
+        return 0;
     }
+    return rank(upper) - rank(lower);
 }
 
-template<typename T>
-bool RBTree<T>::insert(const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename K>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::findNode(Node* here, const K& element) const
+{
+    return searchKey(here, element, comp_).match_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::insert(const T& element)
 {
     if (insertNode(root_, element)) {
         ++size_;
@@ -162,63 +297,67 @@ bool RBTree<T>::insert(const T& element)
     return false;
 }
 
-template<typename T>
-bool RBTree<T>::insertNode(Node*& here, const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::insert(T&& element)
+{
+    if (insertNode(root_, std::move(element))) {
+        ++size_;
+        return true;
+    }
+    return false;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename... Args>
+bool RBTree<T, Compare, Allocator, Statistics>::emplace(Args&&... args)
+{
+    return insert(T(std::forward<Args>(args)...));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename U>
+bool RBTree<T, Compare, Allocator, Statistics>::insertNode(Node*& here, U&& element)
 {
     // if we have an empty tree, make a new node
     if (here == nullptr) {
-        here = new Node(element, nullptr, nullptr, nullptr, false);
+        here = createNode(std::forward<U>(element), nullptr, nullptr, nullptr, false);
         return true;
     }
-    // otherwise go down to the next level in the tree
-    else if (element < here->element_) {
-        if (here->left_ == nullptr) {
-            here->left_ = new Node(element, nullptr, nullptr, here, true);
-            rebalanceAfterInsert(here->left_);
-            return true;
-        } else {
-            return insertNode(here->left_, element);
-        }
-    } else if (element > here->element_) {
-        if (here->right_ == nullptr) {
-            here->right_ = new Node(element, nullptr, nullptr, here, true);
-            rebalanceAfterInsert(here->right_);
-            return true;
-        } else {
-            return insertNode(here->right_, element);
-        }
-    } 
-    // if we aren't less than or greater than the element, we must be equal
-    // and thus we can't insert
-    else {
+    KeySearch<Node> spot = searchKey(here, element, comp_);
+    // if the element is already in the tree we can't insert
+    if (spot.match_ != nullptr) {
         return false;
     }
+    Node* parent = spot.parent_;
+    Node* newNode = createNode(std::forward<U>(element), nullptr, nullptr, parent, true);
+    if (spot.left_) {
+        parent->left_ = newNode;
+    } else {
+        parent->right_ = newNode;
+    }
+    Statistics::recountPath(parent);
+    rebalanceAfterInsert(newNode);
+    return true;
 }
 
-template<typename T>
-void RBTree<T>::rebalanceAfterInsert(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::rebalanceAfterInsert(Node* here)
 {
-    //print(std::cout);
-    if (here == nullptr) {
-        return;
-    }
-    // node is root
-    if (here->parent_ == nullptr) {
-        here->isRed_ = false;
-        return;
-    }
-    Node* parent = here->parent_;
-    Node* grandparent = here->parent_->parent_;
-    // if parent is black and we are red, we are done
-    if (here->isRed_ && !parent->isRed_) {
-        if (grandparent == nullptr) {
-            // all done
+    while (here != nullptr) {
+        // node is root
+        if (here->parent_ == nullptr) {
+            here->isRed_ = false;
+            return;
+        }
+        Node* parent = here->parent_;
+        Node* grandparent = here->parent_->parent_;
+        // only a red node below a red parent needs fixing
+        if (!here->isRed_ || !parent->isRed_) {
+            return;
         }
-    }
-    else if (here->isRed_ && parent->isRed_) {
         if (grandparent->isThreeNode()) {
             pushDownBlackness(grandparent);
-            rebalanceAfterInsert(grandparent);
+            here = grandparent;
         } else {
             if (grandparent->hasOneChild()) {
                 if (parent == grandparent->left_) {
@@ -235,13 +374,13 @@ void RBTree<T>::rebalanceAfterInsert(Node* here)
             else if (parent == grandparent->left_) {
                 rightRotate(grandparent);
             }
-            rebalanceAfterInsert(parent);
+            here = parent;
         }
     }
 }
 
-template<typename T>
-void RBTree<T>::pushUp(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::pushUp(Node* here)
 {
     here->isRed_ = true;
     if (here->left_ != nullptr) {
@@ -252,8 +391,8 @@ void RBTree<T>::pushUp(Node* here)
     }
 }
 
-template<typename T>
-void RBTree<T>::pushDownBlackness(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::pushDownBlackness(Node* here)
 {
     here->isRed_ = true;
     if (here->left_ != nullptr) {
@@ -265,8 +404,8 @@ void RBTree<T>::pushDownBlackness(Node* here)
     root_->isRed_ = false;
 }
 
-template<typename T>
-bool RBTree<T>::deleteElement(const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::deleteElement(const T& element)
 {
     if (empty()) {
         return false;
@@ -274,18 +413,16 @@ bool RBTree<T>::deleteElement(const T& element)
     if (size_ == 1) {
         return deleteOneElementTree(element);
     }
-    Node* deletee;    // the node to delete
-    if (root_->element_ == element) {
+    Node* deletee = findNode(root_, element);    // the node to delete
+    // if we couldn't find a node holding the element, we can't delete
+    if (deletee == nullptr) {
+        return false;
+    }
+    if (deletee == root_) {
         deletee = getNextNode(root_);
         // set the root's value to be it's replacement's value, then proceed to
         // delete the old node containing the replacement
         root_->element_ = deletee->element_;
-    } else {
-        deletee = findNode(root_, element);
-        // if we couldn't find a node holding the element, we can't delete
-        if (deletee == nullptr) {
-            return false;
-        }
     }
     // if the element to delete is a leaf, just remove the leaf
     if (deletee->left_ == nullptr && deletee->right_ == nullptr) {
@@ -305,8 +442,8 @@ bool RBTree<T>::deleteElement(const T& element)
     }
 }
 
-template<typename T>
-typename RBTree<T>::Node* RBTree<T>::getNextNode(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::getNextNode(Node* here)
 {
     iterator nextNode = Iterator(here);
     // go one to the right if we can
@@ -315,14 +452,161 @@ typename RBTree<T>::Node* RBTree<T>::getNextNode(Node* here)
         // go to the right)
         nextNode = --(Iterator(root_));
     }
-    return findNode(root_, *nextNode);
+    return nextNode.current_;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::buildFromSorted(std::vector<T>& elements)
+{
+    // a set only holds each element once
+    elements.erase(std::unique(elements.begin(), elements.end(),
+                               [this](const T& a, const T& b) {
+                                   return keyEquivalent(comp_, a, b);
+                               }),
+                   elements.end());
+    destroyTree(root_);
+    // every level above the bottom one is full, so making the bottom level
+    // red and everything else black gives every path the same black height
+    size_t redDepth = 0;
+    for (size_t n = elements.size(); n > 1; n /= 2) {
+        ++redDepth;
+    }
+    root_ = buildSubtree(elements, 0, elements.size(), nullptr, 0, redDepth);
+    size_ = elements.size();
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::buildSubtree(
+    const std::vector<T>& elements, size_t lower, size_t upper, Node* parent,
+    size_t depth, size_t redDepth)
+{
+    if (lower == upper) {
+        return nullptr;
+    }
+    size_t middle = lower + (upper - lower) / 2;
+    // the root is always black
+    bool isRed = depth > 0 && depth == redDepth;
+    Node* here = createNode(elements[middle], nullptr, nullptr, parent, isRed);
+    here->left_ = buildSubtree(elements, lower, middle, here, depth + 1,
+                               redDepth);
+    here->right_ = buildSubtree(elements, middle + 1, upper, here, depth + 1,
+                                redDepth);
+    Statistics::recount(here);
+    return here;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::cloneTree(const Node* source, Node*& spares)
+{
+    if (source == nullptr) {
+        return nullptr;
+    }
+    Node* root = cloneNode(source, nullptr, spares);
+    // walk both trees together using the parent pointers, so deep trees
+    // can't overflow the stack
+    Node* copy = root;
+    while (copy != nullptr) {
+        if (source->left_ != nullptr && copy->left_ == nullptr) {
+            copy->left_ = cloneNode(source->left_, copy, spares);
+            source = source->left_;
+            copy = copy->left_;
+        } else if (source->right_ != nullptr && copy->right_ == nullptr) {
+            copy->right_ = cloneNode(source->right_, copy, spares);
+            source = source->right_;
+            copy = copy->right_;
+        } else {
+            // both subtrees are done, go back up
+            source = source->parent_;
+            copy = copy->parent_;
+        }
+    }
+    return root;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::cloneNode(const Node* source, Node* parent,
+                                               Node*& spares)
+{
+    Node* copy;
+    if (spares == nullptr) {
+        copy = createNode(source->element_, nullptr, nullptr, parent, source->isRed_);
+    } else {
+        copy = spares;
+        spares = spares->right_;
+        copy->element_ = source->element_;
+        copy->left_ = nullptr;
+        copy->right_ = nullptr;
+        copy->parent_ = parent;
+    }
+    copy->isRed_ = source->isRed_;
+    copy->isDoubleBlack_ = source->isDoubleBlack_;
+    Statistics::copyCount(copy, source);
+    return copy;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::unlinkNodes(Node* here)
+{
+    Node* spares = nullptr;
+    while (here != nullptr) {
+        if (here->left_ != nullptr) {
+            // rotate the left child up until there is nothing on the left
+            Node* left = here->left_;
+            here->left_ = left->right_;
+            left->right_ = here;
+            here = left;
+        } else {
+            Node* next = here->right_;
+            here->right_ = spares;
+            spares = here;
+            here = next;
+        }
+    }
+    return spares;
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::deleteSpares(Node* spares)
+{
+    while (spares != nullptr) {
+        Node* next = spares->right_;
+        destroyNode(spares);
+        spares = next;
+    }
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template<typename... Args>
+typename RBTree<T, Compare, Allocator, Statistics>::Node* RBTree<T, Compare, Allocator, Statistics>::createNode(Args&&... args)
+{
+    Node* node = NodeTraits::allocate(alloc_, 1);
+    try {
+        NodeTraits::construct(alloc_, node, std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc_, node, 1);
+        throw;
+    }
+    return node;
 }
 
-template<typename T>
-bool RBTree<T>::deleteOneElementTree(const T& element)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::destroyNode(Node* node)
 {
-    if (root_->element_ == element) {
-        delete root_;
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::destroyTree(Node* here)
+{
+    deleteSpares(unlinkNodes(here));
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::deleteOneElementTree(const T& element)
+{
+    if (keyEquivalent(comp_, root_->element_, element)) {
+        destroyNode(root_);
         root_ = nullptr;
         --size_;
         return true;
@@ -331,8 +615,8 @@ bool RBTree<T>::deleteOneElementTree(const T& element)
     }
 }
 
-template<typename T>
-void RBTree<T>::deleteLeaf(Node* deletee)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::deleteLeaf(Node* deletee)
 {
     Node* parent = deletee->parent_;
     bool simpleRebalance = false;
@@ -340,31 +624,22 @@ void RBTree<T>::deleteLeaf(Node* deletee)
         simpleRebalance = true;
         parent->isRed_ = false;
     }
-    if (deletee->element_ < parent->element_) {
-        delete parent->left_;
+    if (parent->left_ == deletee) {
+        destroyNode(parent->left_);
         parent->left_ = nullptr;
-    } else if (deletee->element_ > parent->element_) {
-        delete parent->right_;
+    } else {
+        destroyNode(parent->right_);
         parent->right_ = nullptr;
-    } 
-    // if the deletee is equal to its parent (can happen when deleting root)
-    else {
-        if (parent->right_ == nullptr) {
-            delete parent->left_;
-            parent->left_ = nullptr;
-        } else {
-            delete parent->right_;
-            parent->right_ = nullptr;
-        }
     }
+    Statistics::recountPath(parent);
     if (!simpleRebalance){
         rebalanceAfterDelete(parent);
     }
     --size_;
 }
 
-template<typename T>
-void RBTree<T>::deleteStick(Node* deletee, bool deleteLeft)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::deleteStick(Node* deletee, bool deleteLeft)
 {
     bool simpleRebalance = false;
     Node* newChild;
@@ -387,13 +662,14 @@ void RBTree<T>::deleteStick(Node* deletee, bool deleteLeft)
     // when deleting the deletee
     deletee->left_ = nullptr;
     deletee->right_ = nullptr;
-    delete deletee;
+    destroyNode(deletee);
+    Statistics::recountPath(newChild->parent_);
     rebalanceAfterDelete(newChild->parent_);
     --size_;
 }
 
-template<typename T>
-void RBTree<T>::deleteTwoChildNode(Node* deletee)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::deleteTwoChildNode(Node* deletee)
 {
     // replace the node to delete with the next node, then delete that
     // replacement's old node location
@@ -409,8 +685,8 @@ void RBTree<T>::deleteTwoChildNode(Node* deletee)
     }
 }
 
-template<typename T>
-void RBTree<T>::rebalanceAfterDelete(Node* here)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::rebalanceAfterDelete(Node* here)
 {
     
 }
@@ -421,8 +697,8 @@ void RBTree<T>::rebalanceAfterDelete(Node* here)
 //    b   E  ->    A   d
 //   / \              / \
 //  A   C            C   E
-template <typename T> 
-void RBTree<T>::rightRotate(Node* top)
+template <typename T, typename Compare, typename Allocator, typename Statistics> 
+void RBTree<T, Compare, Allocator, Statistics>::rightRotate(Node* top)
 {
     Node* newRoot = top->left_;          // b is d's left child
     // if C exists, we need to change it's parent to be d
@@ -434,11 +710,13 @@ void RBTree<T>::rightRotate(Node* top)
     top->parent_ = newRoot;           // b is d's parent
     newRoot->right_= top;             // d becomes right child of b
     newRoot->parent_ = topParent;     // d's old parent is b's parent
+    Statistics::recount(top);
+    Statistics::recount(newRoot);
     // we then need to update the node pointing to our new top
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -457,8 +735,8 @@ void RBTree<T>::rightRotate(Node* top)
 //    A   d     ->    b   E
 //       / \         / \
 //      C   E       A   C
-template <typename T> 
-void RBTree<T>::leftRotate(Node* top) 
+template <typename T, typename Compare, typename Allocator, typename Statistics> 
+void RBTree<T, Compare, Allocator, Statistics>::leftRotate(Node* top) 
 {
     Node* newRoot = top->right_;      // d is b's right child
     // if C exists, we need to change it's parent to be b
@@ -470,11 +748,13 @@ void RBTree<T>::leftRotate(Node* top)
     top->parent_ = newRoot;           // d is b's parent
     newRoot->left_= top;              // b becomes left child of d
     newRoot->parent_ = topParent;     // b's old parent is d's parent
+    Statistics::recount(top);
+    Statistics::recount(newRoot);
     // we then need to update the node pointing to our new top
     if (newRoot->parent_ == nullptr) { 
         root_ = newRoot;
     } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
+        if (topParent->left_ == top) {
             newRoot->parent_->left_ = newRoot;
         } else {
             newRoot->parent_->right_ = newRoot;
@@ -487,23 +767,27 @@ void RBTree<T>::leftRotate(Node* top)
     }
 }
 
-template<typename T>
-std::ostream& RBTree<T>::printStatistics(std::ostream& out) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+std::ostream& RBTree<T, Compare, Allocator, Statistics>::printStatistics(std::ostream& out) const
 {
     out << "height " << height() << std::endl;
+    out << "node memory " << size() * sizeof(Node) << " bytes" << std::endl;
+    out << "allocated memory "
+        << allocatorBytes(alloc_, size() * sizeof(Node)) << " bytes"
+        << std::endl;
     return out;
 }
 
-template <typename T>
-std::ostream& RBTree<T>::print(std::ostream& out) const
+template <typename T, typename Compare, typename Allocator, typename Statistics>
+std::ostream& RBTree<T, Compare, Allocator, Statistics>::print(std::ostream& out) const
 {
     printPretty(root_, 1, 1, out);
     out << WHITE;
     return out;
 }
 
-template<typename T>
-typename RBTree<T>::iterator RBTree<T>::begin() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::iterator RBTree<T, Compare, Allocator, Statistics>::begin() const
 {
     Node* current = root_;
     // if tree is empty, we don't want to dereference current
@@ -516,12 +800,19 @@ typename RBTree<T>::iterator RBTree<T>::begin() const
     return Iterator(current);
 }
 
-template<typename T>
-typename RBTree<T>::iterator RBTree<T>::end() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::iterator RBTree<T, Compare, Allocator, Statistics>::end() const
 {
     return Iterator(nullptr);
 }
 
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+template <typename Function>
+void RBTree<T, Compare, Allocator, Statistics>::forEach(Function&& visit) const
+{
+    forEachInOrder(root_, visit);
+}
+
 // --------------------------------------
 //
 // Implementation of Pretty Print
@@ -529,9 +820,9 @@ typename RBTree<T>::iterator RBTree<T>::end() const
 //
 // --------------------------------------
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Print the arm branches (eg, /    \ ) on a line
-void RBTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void RBTree<T, Compare, Allocator, Statistics>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   out << WHITE;
   for (int i = 0; i < nodesInThisLevel / 2; i++) {  
@@ -541,9 +832,9 @@ void RBTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Print the branches and node (eg, ___10___ )
-void RBTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void RBTree<T, Compare, Allocator, Statistics>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     out << ((i == 0) ? std::setw(startLen) : std::setw(nodeSpaceLen)) << "" << ((*iter && (*iter)->left_) ? std::setfill('_') : std::setfill(' '));
@@ -571,9 +862,9 @@ void RBTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int no
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Print the leaves only (just for the bottom row)
-void RBTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
+void RBTree<T, Compare, Allocator, Statistics>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
   typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
   for (int i = 0; i < nodesInThisLevel; i++, iter++) {
     if (*iter != nullptr) {
@@ -589,12 +880,12 @@ void RBTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, co
   out << std::endl;
 }
 
-template<typename T>
+template<typename T, typename Compare, typename Allocator, typename Statistics>
 // Pretty formatting of a binary tree to the output stream
 // @ param
 // level  Control how wide you want the tree to sparse (eg, level 1 has the minimum space between nodes, while level 2 has a larger space between nodes)
 // indentSpace  Change this to add some indent space to the left (eg, indentSpace of 0 means the lowest level of the left node will stick to the left margin)
-void RBTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
+void RBTree<T, Compare, Allocator, Statistics>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
   int h = subtreeHeight(root_); //maxHeight(root);
   int nodesInThisLevel = 1;
 
@@ -633,22 +924,28 @@ void RBTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostream
 // Implementation of RBTree::Node
 //
 // --------------------------------------
-template<typename T>
-RBTree<T>::Node::Node(const T& element, Node* left, Node* right, Node* parent, bool isRed)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::Node::Node(const T& element, Node* left, Node* right, Node* parent, bool isRed)
     :element_{element}, left_{left}, right_{right}, parent_{parent}, isRed_{isRed}, isDoubleBlack_{false}
 {
     // nothing else to do
 }
 
-template<typename T>
-RBTree<T>::Node::~Node()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::Node::Node(T&& element, Node* left, Node* right, Node* parent, bool isRed)
+    :element_{std::move(element)}, left_{left}, right_{right}, parent_{parent}, isRed_{isRed}, isDoubleBlack_{false}
 {
-    delete left_;
-    delete right_;
+    // nothing else to do
 }
 
-template<typename T>
-size_t RBTree<T>::Node::size() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::Node::~Node()
+{
+    // the tree frees the children itself
+}
+
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::Node::size() const
 {
     size_t size = 1;
 
@@ -661,8 +958,8 @@ size_t RBTree<T>::Node::size() const
     return size;
 }
 
-template<typename T>
-size_t RBTree<T>::Node::subtreeHeight() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::Node::subtreeHeight() const
 {
     // recursive base case (at a leaf)
     if (left_ == nullptr && right_ == nullptr) {
@@ -681,14 +978,14 @@ size_t RBTree<T>::Node::subtreeHeight() const
     return 1 + std::max(leftSize, rightSize);
 }
 
-template<typename T>
-bool RBTree<T>::Node::hasOneChild() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::Node::hasOneChild() const
 {
     return left_ == nullptr ^ right_ == nullptr;
 }
 
-template<typename T>
-bool RBTree<T>::Node::isThreeNode() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::Node::isThreeNode() const
 {
     bool leftRed = false;
     bool rightRed = false;
@@ -701,8 +998,8 @@ bool RBTree<T>::Node::isThreeNode() const
     return !isRed_ && leftRed && rightRed;
 }
 
-template<typename T>
-void RBTree<T>::Node::pushUp()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::Node::pushUp()
 {
     isRed_ = false;
     if (left_ != nullptr) {
@@ -713,8 +1010,8 @@ void RBTree<T>::Node::pushUp()
     }
 }
 
-template<typename T>
-void RBTree<T>::Node::makeThreeNode()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+void RBTree<T, Compare, Allocator, Statistics>::Node::makeThreeNode()
 {
     isRed_ = false;
     if (left_ != nullptr) {
@@ -725,8 +1022,8 @@ void RBTree<T>::Node::makeThreeNode()
     }
 }
 
-template<typename T>
-bool RBTree<T>::Node::hasRBProperties()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::Node::hasRBProperties()
 {
     if (isRed_) {
         if (left_ != nullptr) {
@@ -751,8 +1048,8 @@ bool RBTree<T>::Node::hasRBProperties()
     return leftBlacks == rightBlacks;
 }
 
-template<typename T>
-size_t RBTree<T>::Node::numBlackNodes()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+size_t RBTree<T, Compare, Allocator, Statistics>::Node::numBlackNodes()
 {
     size_t leftNodes = 0;
     size_t rightNodes = 0;
@@ -775,26 +1072,20 @@ size_t RBTree<T>::Node::numBlackNodes()
 //
 // --------------------------------------
 
-template<typename T>
-RBTree<T>::Iterator::Iterator(Node* index)
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+RBTree<T, Compare, Allocator, Statistics>::Iterator::Iterator(Node* index)
     : current_{index}
 {
     // Nothing else to do.
 }
 
-template<typename T>
-typename RBTree<T>::Iterator& RBTree<T>::Iterator::operator++()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Iterator& RBTree<T, Compare, Allocator, Statistics>::Iterator::operator++()
 {
-    bool lastElement = false;
-    // empty tree
+    // empty tree, or already past the end
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
-    }
     // if there's something to the right, we go there then go as far to the left
     // as we can, for example to get from 10 to 11 in this tree
     //            10
@@ -811,120 +1102,67 @@ typename RBTree<T>::Iterator& RBTree<T>::Iterator::operator++()
         while (current_->left_ != nullptr) {
             current_ = current_->left_;
         }
-    } 
-    // nothing to the right and at the root node, which means we are at the
-    // last element in the tree
-    else if (current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
     }
-    // at this point we must go back up the tree to get to the next largest 
-    // value
-    // if stepping back up to the parent gives us a larger value, then we stop
-    else if (current_->parent_->element_ > current_->element_) {
+    // otherwise we go back up the tree until we step up out of a left
+    // subtree, that parent is the next largest value. If we step off the top
+    // of the tree we were at the largest element, and end up at end()
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    } 
-    // if stepping back up to the parent gives us a smaller value, then we keep
-    // going up until we hit a larger value
-    else if (current_->parent_->element_ < current_->element_) {
-        while (current_->parent_->element_ < current_->element_) {
-            // step up to the parent of the current node
+        while (current_ != nullptr && current_->right_ == child) {
+            child = current_;
             current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                lastElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!lastElement) {
-            current_ = current_->parent_;
-        } 
-        // if we were at the last element, return the equivalent of the end()
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-typename RBTree<T>::Iterator& RBTree<T>::Iterator::operator--()
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+typename RBTree<T, Compare, Allocator, Statistics>::Iterator& RBTree<T, Compare, Allocator, Statistics>::Iterator::operator--()
 {
     // maybe something to handle -- on end()?
 
-    bool firstElement = false;
     // empty tree
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    else if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
     // if there is something to the left, we go there and then go to the right
     // as far as we can
-    else if (current_->left_ != nullptr) {
+    if (current_->left_ != nullptr) {
         current_ = current_->left_;
         while (current_->right_ != nullptr) {
             current_ = current_->right_;
         }
     }
-    // nothing to the left and at the root node, which means we are at the
-    // first element in the tree
-    else if (current_->left_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // at this point we must go back up the tree to get to the next smallest 
-    // value
-    // if stepping back up to the parent gives us a smaller value, then we stop
-    else if (current_->parent_->element_ < current_->element_) {
+    // otherwise we go back up the tree until we step up out of a right
+    // subtree, that parent is the next smallest value. If we step off the top
+    // of the tree we were at the smallest element, and end up at null
+    // (-- on begin())
+    else {
+        Node* child = current_;
         current_ = current_->parent_;
-    }
-    // if stepping back up to the parent gives us a larger value, then we keep
-    // going up until we hit a smaller value
-    else if (current_->parent_->element_ > current_->element_) {
-        while (current_->parent_->element_ > current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                firstElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!firstElement) {
+        while (current_ != nullptr && current_->left_ == child) {
+            child = current_;
             current_ = current_->parent_;
-        } 
-        // if we were at the first element, return null (-- on begin())
-        else {
-            current_ = nullptr;
         }
     }
     return *this;
 }
 
-template<typename T>
-T& RBTree<T>::Iterator::operator*() const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+T& RBTree<T, Compare, Allocator, Statistics>::Iterator::operator*() const
 {
     return current_->element_;
 }
 
-template<typename T>
-bool RBTree<T>::Iterator::operator==(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::Iterator::operator==(const Iterator& rhs) const
 {
     return (current_ == rhs.current_);
 }
 
-template<typename T>
-bool RBTree<T>::Iterator::operator!=(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator, typename Statistics>
+bool RBTree<T, Compare, Allocator, Statistics>::Iterator::operator!=(const Iterator& rhs) const
 {
     return !(*this == rhs);
 }
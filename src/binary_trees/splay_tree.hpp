@@ -10,6 +10,7 @@
 #ifndef SPLAY_TREE_INCLUDED
 #define SPLAY_TREE_INCLUDED 1
 #include "binary_tree.hpp"
+#include "key_compare.hpp"
 #include <cstddef>
 #include <cassert>
 #include <iostream>
@@ -19,15 +20,19 @@
 #include <list>
 #include <iomanip>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <utility>
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>,
+          typename Allocator = NodePool<T>>
 
 /**
 * \class SplayTree
 * \brief A templated splay tree
 */
 
-class SplayTree : public BinaryTree<T> {
+class SplayTree : public BinaryTree<T, Compare, Allocator> {
 
 public:
     /**
@@ -37,6 +42,71 @@ public:
      */
     SplayTree();
 
+    /**
+     * \brief
+     * Comparator Constructor
+     *
+     * \param comp the comparator to order the elements with
+     */
+    explicit SplayTree(const Compare& comp);
+
+    /**
+     * \brief
+     * Range Constructor
+     *
+     * \details Sorts the elements in [first, last) and builds a perfectly
+     * balanced tree out of them.
+     *
+     * \note O(n) time after the sort
+     */
+    template <typename InputIterator>
+    SplayTree(InputIterator first, InputIterator last,
+              const Compare& comp = Compare());
+
+    /**
+     * \brief
+     * Copy Constructor
+     *
+     * \details Copies the tree node by node, so the copy has exactly the same
+     * shape as the original.
+     *
+     * \note O(n) time
+     */
+    SplayTree<T, Compare, Allocator>(const SplayTree<T, Compare, Allocator>& orig);
+
+    /**
+     * \brief
+     * Assignment Operator
+     *
+     * \details Reuses the nodes the tree already holds before allocating new
+     * ones.
+     */
+    SplayTree<T, Compare, Allocator>& operator=(const SplayTree<T, Compare, Allocator>& rhs);
+
+    /**
+     * \brief
+     * Move Constructor
+     *
+     * \details Takes over the nodes of orig, leaving it empty
+     *
+     * \note constant time
+     */
+    SplayTree<T, Compare, Allocator>(SplayTree<T, Compare, Allocator>&& orig);
+
+    /**
+     * \brief
+     * Move Assignment Operator
+     *
+     * \note constant time, apart from freeing the tree's old nodes
+     */
+    SplayTree<T, Compare, Allocator>& operator=(SplayTree<T, Compare, Allocator>&& rhs);
+
+    /**
+     * \brief
+     * Splay Tree swap function
+     *
+     */
+    void swap(SplayTree<T, Compare, Allocator>& rhs);
 
     /**
      * \brief 
@@ -50,7 +120,8 @@ public:
      * Inserts an element into the tree
      *
      */
-    bool insert(const T& element);
+    bool insert(const T& element) override;
+    bool insert(T&& element) override;
 
     /**
      * \brief 
@@ -61,16 +132,80 @@ public:
      *
      * \note log(n) time
      */
-    bool deleteElement(const T& element);
+    bool deleteElement(const T& element) override;
 
     /**
      * \brief 
      * Checks if an element is in the tree
      *
      */
-    bool contains(const T& element) const;
+    bool contains(const T& element) const override;
+
+    /**
+     * \brief
+     * Checks if an element equivalent to key is in the tree
+     *
+     * \note only available if Compare defines is_transparent
+     */
+    template <typename K, typename C = Compare,
+              typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    using typename BinaryTree<T, Compare, Allocator>::iterator;
+    using BinaryTree<T, Compare, Allocator>::end;
+
+    /**
+     * \brief
+     * Finds an element in the tree and splays it to the root
+     *
+     * \returns an iterator to the element, end() if it isn't in the tree
+     */
+    iterator find(const T& element) const;
+
+    /**
+     * \brief
+     * Finds the first element that doesn't sort before element and splays
+     * it to the root
+     *
+     * \note amortized log(n) time
+     */
+    iterator lower_bound(const T& element) const;
+
+    /**
+     * \brief
+     * Finds the first element that sorts after element and splays it to the
+     * root
+     *
+     * \note amortized log(n) time
+     */
+    iterator upper_bound(const T& element) const;
+
+    /**
+     * \brief
+     * returns the elements equivalent to element as a pair of iterators
+     */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+     * \brief
+     * returns the elements in [lower, upper), for use in a range-based for
+     * loop
+     *
+     * \note splays both ends of the range, iterating doesn't splay
+     */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
 
 private:
+    using typename BinaryTree<T, Compare, Allocator>::Node;
+    using BinaryTree<T, Compare, Allocator>::size_;
+    using BinaryTree<T, Compare, Allocator>::root_;
+    using BinaryTree<T, Compare, Allocator>::comp_;
+    using BinaryTree<T, Compare, Allocator>::findNode;
+    using BinaryTree<T, Compare, Allocator>::rightRotate;
+    using BinaryTree<T, Compare, Allocator>::leftRotate;
+    using BinaryTree<T, Compare, Allocator>::buildFromSorted;
+    using BinaryTree<T, Compare, Allocator>::createNode;
+    using BinaryTree<T, Compare, Allocator>::iteratorAt;
 
     /**
      * \brief
@@ -79,17 +214,18 @@ private:
      * \param here The node to insert at
      * \param element The element to insert
      */
-    bool insertNode(Node*& here, const T& element);
+    bool insertNode(Node*& here, const T& element) override;
+    bool insertNode(Node*& here, T&& element) override;
 
     /**
-    * \brief
-    * inserts an node into the root of the tree
-    * 
-    * \param here The node to insert at
-    * \param element The element to insert
-    *
-    */
-    bool insertNodeAtRoot(Node*& here, const T& element);
+     * \brief
+     * Inserts an element below here and splays its new node to the root
+     *
+     * \param here The node to insert at
+     * \param element The element to insert, forwarded to the new node
+     */
+    template <typename U>
+    bool insertAndSplay(Node*& here, U&& element);
 
     /**
      * \brief splays the specified element to the root of the tree
@@ -99,6 +235,10 @@ private:
 
 };
 
+template<typename T, typename Compare, typename Allocator>
+/// Provide a non-member version of swap to allow standard swap(x,y) usage.
+void swap(SplayTree<T, Compare, Allocator>& lhs, SplayTree<T, Compare, Allocator>& rhs);
+
 #include "splay_tree_private.hpp"
 
 #endif // SPLAY_TREE_INCLUDED
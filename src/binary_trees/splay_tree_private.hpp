@@ -5,682 +5,255 @@
  * \brief implementation of templated splay tree class
  */
 
-template<typename T>
-SplayTree<T>::SplayTree()
-            : size_{0}, root_{nullptr}
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>::SplayTree()
+            : BinaryTree<T, Compare, Allocator>()
 {
     // nothing else to do
 }
 
-template<typename T>
-SplayTree<T>::~SplayTree()
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>::SplayTree(const Compare& comp)
+            : BinaryTree<T, Compare, Allocator>(comp)
 {
-    delete root_;
+    // nothing else to do
 }
 
-template<typename T>
-size_t SplayTree<T>::size() const
+template<typename T, typename Compare, typename Allocator>
+template<typename InputIterator>
+SplayTree<T, Compare, Allocator>::SplayTree(InputIterator first, InputIterator last,
+                                            const Compare& comp)
+            : BinaryTree<T, Compare, Allocator>(comp)
 {
-    return size_;
+    std::vector<T> elements(first, last);
+    std::sort(elements.begin(), elements.end(),
+              [this](const T& a, const T& b) {
+                  return keyLess(comp_, a, b);
+              });
+    buildFromSorted(elements);
 }
 
-template<typename T>
-size_t SplayTree<T>::height() const
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>::SplayTree(const SplayTree<T, Compare, Allocator>& orig)
+            : BinaryTree<T, Compare, Allocator>(orig)
 {
-    return subtreeHeight(root_);
+    // nothing else to do
 }
 
-template<typename T>
-size_t SplayTree<T>::subtreeHeight(Node* here) const
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>& SplayTree<T, Compare, Allocator>::operator=(const SplayTree<T, Compare, Allocator>& rhs)
 {
-    // recursive base case
-    if (here == nullptr) {
-        return 0;
-    }
-    // recursively get the left and right subtree heights
-    size_t leftSize = subtreeHeight(here->left_);
-    size_t rightSize = subtreeHeight(here->right_);
-
-    // the taller of the two subtrees is the height of the overall subtree
-    return 1 + std::max(leftSize, rightSize);
+    BinaryTree<T, Compare, Allocator>::operator=(rhs);
+    return *this;
 }
 
-template<typename T>
-bool SplayTree<T>::contains(const T& element) const
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>::SplayTree(SplayTree<T, Compare, Allocator>&& orig)
+            : BinaryTree<T, Compare, Allocator>(std::move(orig))
 {
-    Node* elementNode = findNode(root_, element);
-    if (elementNode == nullptr) {
-        return false;
-    } else {
-        splayToRoot(elementNode);
-        return true;
-    }
+    // nothing else to do
 }
 
-template<typename T>
-typename SplayTree<T>::Node* SplayTree<T>::findNode(Node* here, const T& element) const
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>& SplayTree<T, Compare, Allocator>::operator=(SplayTree<T, Compare, Allocator>&& rhs)
 {
-    if (here == nullptr) {
-        return nullptr;
-    } 
-    // continue searching to the left
-    else if (element < here->element_) {
-        return findNode(here->left_, element);
-    }
-    // continue searching to the right
-    else if (element > here->element_) {
-        return findNode(here->right_, element);
-    } 
-    // element is not less than or greater than here->element_, so it must
-    // be equal to here->element_
-    else {
-        //splayToRoot(here);
-        return here;
-    }
+    BinaryTree<T, Compare, Allocator>::operator=(std::move(rhs));
+    return *this;
 }
 
-template<typename T>
-bool SplayTree<T>::insert(const T& element)
+template<typename T, typename Compare, typename Allocator>
+void SplayTree<T, Compare, Allocator>::swap(SplayTree<T, Compare, Allocator>& rhs)
 {
-    if (insertNode(root_, element)) {
-        ++size_;
-        return true;
-    }
-    return false;
+    BinaryTree<T, Compare, Allocator>::swap(rhs);
 }
 
-template<typename T>
-bool SplayTree<T>::insertNode(Node*& here, const T& element)
+template<typename T, typename Compare, typename Allocator>
+void swap(SplayTree<T, Compare, Allocator>& lhs, SplayTree<T, Compare, Allocator>& rhs)
 {
-    // if we have an empty tree, make a new node
-    if (here == nullptr) {
-        here = new Node(element, nullptr, nullptr, nullptr);
-        return true;
-    }
-    // otherwise go down to the next level in the tree
-    else if (element < here->element_) {
-        if (here->left_ == nullptr) {
-            here->left_ = new Node(element, nullptr, nullptr, here);
-            splayToRoot(here->left_);
-            return true;
-        } else {
-            return insertNode(here->left_, element);
-        }
-    } else if (element > here->element_) {
-        if (here->right_ == nullptr) {
-            here->right_ = new Node(element, nullptr, nullptr, here);
-            splayToRoot(here->right_);
-            return true;
-        } else {
-            return insertNode(here->right_, element);
-        }
-    } 
-    // if we aren't less than or greater than the element, we must be equal
-    // and thus we can't insert
-    else {
-        return false;
-    }
+    lhs.swap(rhs);
 }
 
-template<typename T>
-void SplayTree<T>::splayToRoot(Node* newRoot) const
+template<typename T, typename Compare, typename Allocator>
+SplayTree<T, Compare, Allocator>::~SplayTree()
 {
-    // base case (we are at the root)
-    if (newRoot->parent_ == nullptr) {
-        return;
-    }
-    // if we are a child of the root, rotate to become the root
-    else if (newRoot->parent_ == root_) {
-        if (root_->left_ == newRoot) {
-            rightRotate(root_);
-        } else {
-            leftRotate(root_);
-        }
-    }
-    // if we have a zig zag case where we go one direction then the other
-    else if (newRoot->parent_->left_ == newRoot ^ newRoot->parent_->parent_->left_ == newRoot->parent_) {
-        if (newRoot->parent_->left_ == newRoot) {
-            rightRotate(newRoot->parent_);
-            leftRotate(newRoot->parent_);
-        } else {
-            leftRotate(newRoot->parent_);
-            rightRotate(newRoot->parent_);
-        }
-        splayToRoot(newRoot);
-    } 
-    // if we have a zig zag case where we go the same direction twice
-    else {
-        if (newRoot->parent_->parent_->left_ == newRoot->parent_) {
-            rightRotate(newRoot->parent_->parent_);
-            rightRotate(newRoot->parent_);
-        } else {
-            leftRotate(newRoot->parent_->parent_);
-            leftRotate(newRoot->parent_);
-        }
-        splayToRoot(newRoot);
-    }
+    // the BinaryTree destructor frees the nodes
 }
 
-template<typename T>
-bool SplayTree<T>::deleteElement(const T& element)
+template<typename T, typename Compare, typename Allocator>
+bool SplayTree<T, Compare, Allocator>::contains(const T& element) const
 {
-    if (empty()) {
+    Node* elementNode = findNode(root_, element);
+    if (elementNode == nullptr) {
         return false;
-    }
-    if (size_ == 1) {
-        return deleteOneElementTree(element);
-    }
-    Node* deletee;    // the node to delete
-    if (root_->element_ == element) {
-        deletee = getNextNode(root_);
-        // set the root's value to be it's replacement's value, then proceed to
-        // delete the old node containing the replacement
-        root_->element_ = deletee->element_;
     } else {
-        deletee = findNode(root_, element);
-        // if we couldn't find a node holding the element, we can't delete
-        if (deletee == nullptr) {
-            return false;
-        }
-    }
-    // if the element to delete is a leaf, just remove the leaf
-    if (deletee->left_ == nullptr && deletee->right_ == nullptr) {
-        deleteLeaf(deletee);
-        return true;
-    }
-    // if the node to delete has one child, replace the node with its child
-    else if (deletee->left_ == nullptr ^ deletee->right_ == nullptr) {
-        deleteStick(deletee, deletee == deletee->parent_->left_);
-        return true;
-    }
-    // if we get to this point, we know that our node to delete has two
-    // children
-    else {
-        deleteTwoChildNode(deletee);
+        splayToRoot(elementNode);
         return true;
     }
 }
 
-template<typename T>
-typename SplayTree<T>::Node* SplayTree<T>::getNextNode(Node* here)
-{
-    iterator nextNode = Iterator(here);
-    // go one to the right if we can
-    if (++nextNode == end()) {
-        // if we can't we go back one (we were at the last element so we can't
-        // go to the right)
-        nextNode = --(Iterator(root_));
-    }
-    return findNode(root_, *nextNode);
-}
-
-template<typename T>
-bool SplayTree<T>::deleteOneElementTree(const T& element)
+template<typename T, typename Compare, typename Allocator>
+template<typename K, typename C, typename>
+bool SplayTree<T, Compare, Allocator>::contains(const K& key) const
 {
-    if (root_->element_ == element) {
-        delete root_;
-        root_ = nullptr;
-        --size_;
-        return true;
-    } else {
+    Node* elementNode = findNode(root_, key);
+    if (elementNode == nullptr) {
         return false;
+    } else {
+        splayToRoot(elementNode);
+        return true;
     }
 }
 
-template<typename T>
-void SplayTree<T>::deleteLeaf(Node* deletee)
+template<typename T, typename Compare, typename Allocator>
+typename SplayTree<T, Compare, Allocator>::iterator SplayTree<T, Compare, Allocator>::find(const T& element) const
 {
-    Node* parent = deletee->parent_;
-    if (deletee->element_ < parent->element_) {
-        delete parent->left_;
-        parent->left_ = nullptr;
-    } else if (deletee->element_ > parent->element_) {
-        delete parent->right_;
-        parent->right_ = nullptr;
-    } 
-    // if the deletee is equal to its parent (can happen when deleting root)
-    else {
-        if (parent->right_ == nullptr) {
-            delete parent->left_;
-            parent->left_ = nullptr;
-        } else {
-            delete parent->right_;
-            parent->right_ = nullptr;
-        }
+    Node* elementNode = findNode(root_, element);
+    if (elementNode != nullptr) {
+        splayToRoot(elementNode);
     }
-    --size_;
+    return iteratorAt(elementNode);
 }
 
-template<typename T>
-void SplayTree<T>::deleteStick(Node* deletee, bool deleteLeft)
+template<typename T, typename Compare, typename Allocator>
+typename SplayTree<T, Compare, Allocator>::iterator SplayTree<T, Compare, Allocator>::lower_bound(const T& element) const
 {
-    Node* newChild;
-
-    // find the element to delete's child
-    if (deletee->left_ == nullptr) {
-        newChild = deletee->right_;
-    }
-    else {
-        newChild = deletee->left_;
-    }
-    // if the node to delete was the left child of the parent, make the
-    // node's child its parent's left node
-    if (deleteLeft) {
-        deletee->parent_->left_ = newChild;
-    }
-    // otherwise make it its parent's right node
-    else {
-        deletee->parent_->right_ = newChild;
+    Node* bound = lowerBoundNode(root_, element, comp_);
+    if (bound != nullptr) {
+        splayToRoot(bound);
     }
-    newChild->parent_ = deletee->parent_;
-    // set the deletee's children to nullptr so we don't delete any more nodes
-    // when deleting the deletee
-    deletee->left_ = nullptr;
-    deletee->right_ = nullptr;
-    delete deletee;
-    --size_;
+    return iteratorAt(bound);
 }
 
-template<typename T>
-void SplayTree<T>::deleteTwoChildNode(Node* deletee)
+template<typename T, typename Compare, typename Allocator>
+typename SplayTree<T, Compare, Allocator>::iterator SplayTree<T, Compare, Allocator>::upper_bound(const T& element) const
 {
-    // replace the node to delete with the next node, then delete that
-    // replacement's old node location
-    Node* newNode = getNextNode(deletee);
-    deletee->element_ = newNode->element_;
-    // if the old node's location is a leaf, delete it as a leaf
-    if (newNode->left_ == nullptr && newNode->right_ == nullptr){
-        deleteLeaf(newNode);
-    }
-    // otherwise it must be a stick, so delete it as a stick
-    else {
-        deleteStick(newNode, newNode->parent_->left_ == newNode);
+    Node* bound = upperBoundNode(root_, element, comp_);
+    if (bound != nullptr) {
+        splayToRoot(bound);
     }
+    return iteratorAt(bound);
 }
 
-//   right rotation:
-//      d            b
-//     / \          / \
-//    b   E  ->    A   d
-//   / \              / \
-//  A   C            C   E
-template <typename T> 
-void SplayTree<T>::rightRotate(Node* top) const
+template<typename T, typename Compare, typename Allocator>
+std::pair<typename SplayTree<T, Compare, Allocator>::iterator, typename SplayTree<T, Compare, Allocator>::iterator>
+SplayTree<T, Compare, Allocator>::equal_range(const T& element) const
 {
-    Node* newRoot = top->left_;          // b is d's left child
-    // if C exists, we need to change it's parent to be d
-    if (newRoot->right_ != nullptr) {
-        newRoot->right_->parent_ = top;
-    }
-    top->left_= newRoot->right_;      // C becomes left child of d
-    Node* topParent = top->parent_;   // save d's parent value
-    top->parent_ = newRoot;           // b is d's parent
-    newRoot->right_= top;             // d becomes right child of b
-    newRoot->parent_ = topParent;     // d's old parent is b's parent
-    // we then need to update the node pointing to our new top
-    if (newRoot->parent_ == nullptr) { 
-        root_ = newRoot;
-    } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
-            newRoot->parent_->left_ = newRoot;
-        } else {
-            newRoot->parent_->right_ = newRoot;
-        }
+    iterator first = lower_bound(element);
+    iterator last = first;
+    // the elements are unique, so at most one of them can be equivalent
+    if (last != end() && !keyLess(comp_, element, *last)) {
+        ++last;
     }
-    top = newRoot;                    // top is now b
+    return std::make_pair(first, last);
 }
 
-//   left rotation:
-//      b               d
-//     / \             / \
-//    A   d     ->    b   E
-//       / \         / \
-//      C   E       A   C
-template <typename T> 
-void SplayTree<T>::leftRotate(Node* top) const
+template<typename T, typename Compare, typename Allocator>
+IteratorRange<typename SplayTree<T, Compare, Allocator>::iterator> SplayTree<T, Compare, Allocator>::range(const T& lower, const T& upper) const
 {
-    Node* newRoot = top->right_;      // d is b's right child
-    // if C exists, we need to change it's parent to be b
-    if (newRoot->left_ != nullptr) {
-        newRoot->left_->parent_ = top;
+    if (!keyLess(comp_, lower, upper)) {
+        return IteratorRange<iterator>(end(), end());
     }
-    top->right_= newRoot->left_;      // C becomes right child of b
-    Node* topParent = top->parent_;   // save b's parent value
-    top->parent_ = newRoot;           // d is b's parent
-    newRoot->left_= top;              // b becomes left child of d
-    newRoot->parent_ = topParent;     // b's old parent is d's parent
-    // we then need to update the node pointing to our new top
-    if (newRoot->parent_ == nullptr) { 
-        root_ = newRoot;
-    } else {
-        if (newRoot->element_ < newRoot->parent_->element_) {
-            newRoot->parent_->left_ = newRoot;
-        } else {
-            newRoot->parent_->right_ = newRoot;
-        }
-    }
-    top = newRoot;                    // top is now d 
-}
-
-template<typename T>
-std::ostream& SplayTree<T>::printStatistics(std::ostream& out) const
-{
-    out << "height " << height() << std::endl;
-    return out;
-}
-
-template <typename T>
-std::ostream& SplayTree<T>::print(std::ostream& out) const
-{
-    printPretty(root_, 1, 1, out);
-    return out;
+    // splaying only rotates nodes, so the lower end's iterator stays valid
+    // while the upper end is splayed
+    iterator first = lower_bound(lower);
+    return IteratorRange<iterator>(first, lower_bound(upper));
 }
 
-template<typename T>
-typename SplayTree<T>::iterator SplayTree<T>::begin() const
+template<typename T, typename Compare, typename Allocator>
+bool SplayTree<T, Compare, Allocator>::insert(const T& element)
 {
-    Node* current = root_;
-    // if tree is empty, we don't want to dereference current
-    if (current == nullptr) {
-        return Iterator(current);
-    }
-    while (current->left_ != nullptr) {
-        current = current->left_;
+    if (insertNode(root_, element)) {
+        ++size_;
+        return true;
     }
-    return Iterator(current);
+    return false;
 }
 
-template<typename T>
-typename SplayTree<T>::iterator SplayTree<T>::end() const
+template<typename T, typename Compare, typename Allocator>
+bool SplayTree<T, Compare, Allocator>::insert(T&& element)
 {
-    return Iterator(nullptr);
-}
-
-// --------------------------------------
-//
-// Implementation of Pretty Print
-// (taken from http://articles.leetcode.com/2010/09/how-to-pretty-print-binary-tree.html)
-//
-// --------------------------------------
-template<typename T>
-// Print the arm branches (eg, /    \ ) on a line
-void SplayTree<T>::printBranches(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
-  typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
-  for (int i = 0; i < nodesInThisLevel / 2; i++) {  
-    out << ((i == 0) ? std::setw(startLen-1) : std::setw(nodeSpaceLen-2)) << "" << ((*iter++) ? "/" : " ");
-    out << std::setw(2*branchLen+2) << "" << ((*iter++) ? "\\" : " ");
-  }
-  out << std::endl;
-}
-
-template<typename T>
-// Print the branches and node (eg, ___10___ )
-void SplayTree<T>::printNodes(int branchLen, int nodeSpaceLen, int startLen, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
-  typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
-  for (int i = 0; i < nodesInThisLevel; i++, iter++) {
-    out << ((i == 0) ? std::setw(startLen) : std::setw(nodeSpaceLen)) << "" << ((*iter && (*iter)->left_) ? std::setfill('_') : std::setfill(' '));
-    /*std::string parent;
-    if (*iter != nullptr) {
-        if ((*iter)->parent_ != nullptr) {
-            parent = std::to_string((*iter)->parent_->element_);
-        } else {
-            parent = "-";
-        }
-    } else {
-        parent = "-";
-    }*/
-    out << std::setw(branchLen+2) << ((*iter) ? std::to_string((*iter)->element_) : "");
-    out << ((*iter && (*iter)->right_) ? std::setfill('_') : std::setfill(' ')) << std::setw(branchLen) << "" << std::setfill(' ');
-  }
-  out << std::endl;
-}
-
-template<typename T>
-// Print the leaves only (just for the bottom row)
-void SplayTree<T>::printLeaves(int indentSpace, int level, int nodesInThisLevel, const std::deque<Node*>& nodesQueue, std::ostream& out) const{
-  typename std::deque<Node*>::const_iterator iter = nodesQueue.begin();
-  /*std::string parent;
-  if (*iter != nullptr) {
-        if ((*iter)->parent_ != nullptr) {
-            parent = std::to_string((*iter)->parent_->element_);
-        } else {
-            parent = "-";
-        }
-    } else {
-        parent = "-";
-    }*/
-  for (int i = 0; i < nodesInThisLevel; i++, iter++) {
-    out << ((i == 0) ? std::setw(indentSpace+2) : std::setw(2*level+2)) << ((*iter) ? std::to_string((*iter)->element_) : "");
-  }
-  out << std::endl;
-}
-
-template<typename T>
-// Pretty formatting of a binary tree to the output stream
-// @ param
-// level  Control how wide you want the tree to sparse (eg, level 1 has the minimum space between nodes, while level 2 has a larger space between nodes)
-// indentSpace  Change this to add some indent space to the left (eg, indentSpace of 0 means the lowest level of the left node will stick to the left margin)
-void SplayTree<T>::printPretty(Node* root, int level, int indentSpace, std::ostream& out) const {
-  int h = subtreeHeight(root_); //maxHeight(root);
-  int nodesInThisLevel = 1;
-
-  int branchLen = 2*((int)std::pow(2.0,h)-1) - (3-level)*(int)std::pow(2.0,h-1);  // eq of the length of branch for each node of each level
-  int nodeSpaceLen = 2 + (level+1)*(int)std::pow(2.0,h);  // distance between left neighbor node's right arm and right neighbor node's left arm
-  int startLen = branchLen + (3-level) + indentSpace;  // starting space to the first node to print of each level (for the left most node of each level only)
-    
-  std::deque<Node*> nodesQueue;
-  nodesQueue.push_back(root);
-  for (int r = 1; r < h; r++) {
-    printBranches(branchLen, nodeSpaceLen, startLen, nodesInThisLevel, nodesQueue, out);
-    branchLen = branchLen/2 - 1;
-    nodeSpaceLen = nodeSpaceLen/2 + 1;
-    startLen = branchLen + (3-level) + indentSpace;
-    printNodes(branchLen, nodeSpaceLen, startLen, nodesInThisLevel, nodesQueue, out);
-
-    for (int i = 0; i < nodesInThisLevel; i++) {
-      Node *currNode = nodesQueue.front();
-      nodesQueue.pop_front();
-      if (currNode) {
-          nodesQueue.push_back(currNode->left_);
-          nodesQueue.push_back(currNode->right_);
-      } else {
-        nodesQueue.push_back(NULL);
-        nodesQueue.push_back(NULL);
-      }
+    if (insertNode(root_, std::move(element))) {
+        ++size_;
+        return true;
     }
-    nodesInThisLevel *= 2;
-  }
-  printBranches(branchLen, nodeSpaceLen, startLen, nodesInThisLevel, nodesQueue, out);
-  printLeaves(indentSpace, level, nodesInThisLevel, nodesQueue, out);
-}
-
-// --------------------------------------
-//
-// Implementation of SplayTree::Node
-//
-// --------------------------------------
-template<typename T>
-SplayTree<T>::Node::Node(const T& element, Node* left, Node* right, Node* parent)
-    :element_{element}, left_{left}, right_{right}, parent_{parent}
-{
-    // nothing else to do
-}
-
-template<typename T>
-SplayTree<T>::Node::~Node()
-{
-    delete left_;
-    delete right_;
+    return false;
 }
 
-template<typename T>
-size_t SplayTree<T>::Node::size() const
+template<typename T, typename Compare, typename Allocator>
+bool SplayTree<T, Compare, Allocator>::insertNode(Node*& here, const T& element)
 {
-    size_t size = 1;
-
-    if (left_ != nullptr) {
-        size += left_->size();
-    }
-    if (right_ != nullptr) {
-        size += right_->size();
-    }
-    return size;
+    return insertAndSplay(here, element);
 }
 
-// --------------------------------------
-// Implementation of SplayTree::Iterator
-// --------------------------------------
-template<typename T>
-SplayTree<T>::Iterator::Iterator(Node* index)
-    : current_{index}
+template<typename T, typename Compare, typename Allocator>
+bool SplayTree<T, Compare, Allocator>::insertNode(Node*& here, T&& element)
 {
-    // Nothing else to do.
+    return insertAndSplay(here, std::move(element));
 }
 
-template<typename T>
-typename SplayTree<T>::Iterator& SplayTree<T>::Iterator::operator++()
+template<typename T, typename Compare, typename Allocator>
+template<typename U>
+bool SplayTree<T, Compare, Allocator>::insertAndSplay(Node*& here, U&& element)
 {
-    bool lastElement = false;
-    // empty tree
-    if (current_ == nullptr) {
-        return *this;
-    }
-    // tree of size 1
-    if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
+    // if we have an empty tree, make a new node
+    if (here == nullptr) {
+        here = createNode(std::forward<U>(element), nullptr, nullptr, nullptr);
+        return true;
     }
-    // if there's something to the right, we go there then go as far to the left
-    // as we can, for example to get from 10 to 11 in this tree
-    //            10
-    //           /  \
-    //          5    15
-    //              /
-    //             12
-    //            /
-    //           11
-    if (current_->right_ != nullptr) {
-        // one step to the right
-        current_ = current_->right_;
-        // go as far to the left as we can
-        while (current_->left_ != nullptr) {
-            current_ = current_->left_;
-        }
-    } 
-    // nothing to the right and at the root node, which means we are at the
-    // last element in the tree
-    else if (current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        return *this;
+    KeySearch<Node> spot = searchKey(here, element, comp_);
+    // if the element is already in the tree we can't insert
+    if (spot.match_ != nullptr) {
+        return false;
     }
-    // at this point we must go back up the tree to get to the next largest 
-    // value
-    // if stepping back up to the parent gives us a larger value, then we stop
-    else if (current_->parent_->element_ > current_->element_) {
-        current_ = current_->parent_;
-    } 
-    // if stepping back up to the parent gives us a smaller value, then we keep
-    // going up until we hit a larger value
-    else if (current_->parent_->element_ < current_->element_) {
-        while (current_->parent_->element_ < current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                lastElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!lastElement) {
-            current_ = current_->parent_;
-        } 
-        // if we were at the last element, return the equivalent of the end()
-        else {
-            current_ = nullptr;
-        }
+    Node* parent = spot.parent_;
+    Node* newNode = createNode(std::forward<U>(element), nullptr, nullptr, parent);
+    if (spot.left_) {
+        parent->left_ = newNode;
+    } else {
+        parent->right_ = newNode;
     }
-    return *this;
+    splayToRoot(newNode);
+    return true;
 }
 
-template<typename T>
-typename SplayTree<T>::Iterator& SplayTree<T>::Iterator::operator--()
+template<typename T, typename Compare, typename Allocator>
+void SplayTree<T, Compare, Allocator>::splayToRoot(Node* newRoot) const
 {
-    // maybe something to handle -- on end()?
-
-    bool firstElement = false;
-    // empty tree
-    if (current_ == nullptr) {
-        return *this;
-    }
-    // tree of size 1
-    else if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // if there is something to the left, we go there and then go to the right
-    // as far as we can
-    else if (current_->left_ != nullptr) {
-        current_ = current_->left_;
-        while (current_->right_ != nullptr) {
-            current_ = current_->right_;
+    // rotate newRoot up, two levels at a time, until it is the root
+    while (newRoot->parent_ != nullptr) {
+        // if we are a child of the root, rotate to become the root
+        if (newRoot->parent_ == root_) {
+            if (root_->left_ == newRoot) {
+                rightRotate(root_);
+            } else {
+                leftRotate(root_);
+            }
         }
-    }
-    // nothing to the left and at the root node, which means we are at the
-    // first element in the tree
-    else if (current_->left_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // at this point we must go back up the tree to get to the next smallest 
-    // value
-    // if stepping back up to the parent gives us a smaller value, then we stop
-    else if (current_->parent_->element_ < current_->element_) {
-        current_ = current_->parent_;
-    }
-    // if stepping back up to the parent gives us a larger value, then we keep
-    // going up until we hit a smaller value
-    else if (current_->parent_->element_ > current_->element_) {
-        while (current_->parent_->element_ > current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                firstElement = true;
-                break;
+        // if we have a zig zag case where we go one direction then the other
+        else if (newRoot->parent_->left_ == newRoot ^ newRoot->parent_->parent_->left_ == newRoot->parent_) {
+            if (newRoot->parent_->left_ == newRoot) {
+                rightRotate(newRoot->parent_);
+                leftRotate(newRoot->parent_);
+            } else {
+                leftRotate(newRoot->parent_);
+                rightRotate(newRoot->parent_);
             }
         }
-        // one more pop to get to the element that is greater than the current one
-        if (!firstElement) {
-            current_ = current_->parent_;
-        } 
-        // if we were at the first element, return null (-- on begin())
+        // if we have a zig zag case where we go the same direction twice
         else {
-            current_ = nullptr;
+            if (newRoot->parent_->parent_->left_ == newRoot->parent_) {
+                rightRotate(newRoot->parent_->parent_);
+                rightRotate(newRoot->parent_);
+            } else {
+                leftRotate(newRoot->parent_->parent_);
+                leftRotate(newRoot->parent_);
+            }
         }
     }
-    return *this;
-}
-
-template<typename T>
-T& SplayTree<T>::Iterator::operator*() const
-{
-    return current_->element_;
 }
 
-template<typename T>
-bool SplayTree<T>::Iterator::operator==(const Iterator& rhs) const
+template<typename T, typename Compare, typename Allocator>
+bool SplayTree<T, Compare, Allocator>::deleteElement(const T& element)
 {
-    return (current_ == rhs.current_);
+    return BinaryTree<T, Compare, Allocator>::deleteElement(element);
 }
-
-template<typename T>
-bool SplayTree<T>::Iterator::operator!=(const Iterator& rhs) const
-{
-    return !(*this == rhs);
-}
-
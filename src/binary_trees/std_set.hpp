@@ -12,9 +12,13 @@
 #include <climits>
 #include <cassert>
 #include <set>
+#include <utility>
+#include <functional>
 #include "abstracttree.hpp" 
+#include "key_compare.hpp"
+#include "iterator_range.hpp"
 
-template <typename T>
+template <typename T, typename Compare = std::less<T>>
 
 /**
 * \class StdSet
@@ -30,14 +34,67 @@ public:
      *
      * \note constant time
      */
-    StdSet<T>();
+    StdSet<T, Compare>();
+
+    /**
+     * \brief
+     * Comparator Constructor
+     *
+     * \param comp the comparator to order the elements with
+     */
+    explicit StdSet<T, Compare>(const Compare& comp);
+
+    /**
+     * \brief
+     * Copy Constructor
+     *
+     */
+    StdSet<T, Compare>(const StdSet<T, Compare>& orig) = default;
+
+    /**
+     * \brief
+     * Move Constructor
+     *
+     * \note constant time
+     */
+    StdSet<T, Compare>(StdSet<T, Compare>&& orig) = default;
+
+    /**
+     * \brief
+     * Assignment Operator
+     *
+     */
+    StdSet<T, Compare>& operator=(const StdSet<T, Compare>& rhs) = default;
+
+    /**
+     * \brief
+     * Move Assignment Operator
+     *
+     */
+    StdSet<T, Compare>& operator=(StdSet<T, Compare>&& rhs) = default;
 
     /**
      * \brief
      * Default Destructor
      *
      */
-    ~StdSet<T>();
+    ~StdSet<T, Compare>();
+
+    // Allow users to iterate over the contents of the set.
+    using iterator = typename std::set<T, KeyLess<Compare>>::const_iterator;
+    iterator begin() const; ///< An iterator that refers to the first element
+    iterator end() const;   ///< A "past-the-end" iterator
+
+    /**
+    * \brief calls visit(element) for every element, in order
+    *
+    * \details a tight loop, much faster than the iterators over a whole
+    * tree
+    *
+    * \note visit mustn't change the tree
+    */
+    template <typename Function>
+    void forEach(Function&& visit) const;
 
     /**
      * \brief
@@ -56,6 +113,16 @@ public:
      * \param element The element to be inserted
      */
     bool insert(const T& element) override;
+    bool insert(T&& element) override;
+
+    /**
+     * \brief
+     * Constructs an element in place and inserts it into the set
+     *
+     * \param args the arguments to pass to the element's constructor
+     */
+    template <typename... Args>
+    bool emplace(Args&&... args);
 
     /**
      * \brief
@@ -69,6 +136,44 @@ public:
 
     bool deleteElement(const T& element);
 
+    /**
+     * \brief returns a copy of the comparator that orders the set
+     */
+    Compare key_comp() const;
+
+    /**
+     * \brief
+     * Finds an element in the set
+     *
+     * \returns an iterator to the element, end() if it isn't in the set
+     */
+    iterator find(const T& element) const;
+
+    /**
+     * \brief
+     * Finds the first element in the set that doesn't sort before element
+     */
+    iterator lower_bound(const T& element) const;
+
+    /**
+     * \brief
+     * Finds the first element in the set that sorts after element
+     */
+    iterator upper_bound(const T& element) const;
+
+    /**
+     * \brief
+     * returns the elements equivalent to element as a pair of iterators
+     */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+     * \brief
+     * returns the elements in [lower, upper), for use in a range-based for
+     * loop
+     */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
+
     /**
     * \brief
     * Print the statistics for the set
@@ -82,10 +187,10 @@ public:
 
 private:
 
-    std::set<T> data_; ///< the set to store data
+    std::set<T, KeyLess<Compare>> data_; ///< the set to store data
 
 };
 
-#include "stdset-private.hpp"
+#include "std_set_private.hpp"
 
 #endif // STDET_HPP_INCLUDED
@@ -6,44 +6,127 @@
  */
 
 
-template <typename T>
-StdSet<T>::StdSet()
+template <typename T, typename Compare>
+StdSet<T, Compare>::StdSet()
 {
     // default constructor for std::set is ok
 }
 
-template <typename T>
-StdSet<T>::~StdSet()
+template <typename T, typename Compare>
+StdSet<T, Compare>::StdSet(const Compare& comp)
+    : data_{KeyLess<Compare>{comp}}
+{
+    // nothing else to do
+}
+
+template <typename T, typename Compare>
+StdSet<T, Compare>::~StdSet()
 {
     // default destructor for std::set is ok
 }
 
-template <typename T>
-size_t StdSet<T>::size() const
+template <typename T, typename Compare>
+typename StdSet<T, Compare>::iterator StdSet<T, Compare>::begin() const
+{
+    return data_.begin();
+}
+
+template <typename T, typename Compare>
+typename StdSet<T, Compare>::iterator StdSet<T, Compare>::end() const
+{
+    return data_.end();
+}
+
+template <typename T, typename Compare>
+template <typename Function>
+void StdSet<T, Compare>::forEach(Function&& visit) const
+{
+    for (const T& element : data_) {
+        visit(element);
+    }
+}
+
+template <typename T, typename Compare>
+size_t StdSet<T, Compare>::size() const
 {
     return data_.size();
 }
 
-template <typename T>
-bool StdSet<T>::insert(const T& element)
+template <typename T, typename Compare>
+bool StdSet<T, Compare>::insert(const T& element)
+{
+    return data_.insert(element).second;
+}
+
+template <typename T, typename Compare>
+bool StdSet<T, Compare>::insert(T&& element)
+{
+    return data_.insert(std::move(element)).second;
+}
+
+template <typename T, typename Compare>
+template <typename... Args>
+bool StdSet<T, Compare>::emplace(Args&&... args)
 {
-    data_.insert(element);
+    return data_.emplace(std::forward<Args>(args)...).second;
 }
 
-template <typename T>
-bool StdSet<T>::contains(const T& element) const
+template <typename T, typename Compare>
+bool StdSet<T, Compare>::contains(const T& element) const
 {
     return (data_.find(element) != data_.end());
 }
 
-template <typename T>
-bool StdSet<T>::deleteElement(const T& element)
+template <typename T, typename Compare>
+bool StdSet<T, Compare>::deleteElement(const T& element)
 {
     return (data_.erase(element) == 1);
 }
 
-template <typename T>
-std::ostream& StdSet<T>::printStatistics(std::ostream& out) const
+template <typename T, typename Compare>
+Compare StdSet<T, Compare>::key_comp() const
+{
+    return data_.key_comp().comp_;
+}
+
+template <typename T, typename Compare>
+typename StdSet<T, Compare>::iterator StdSet<T, Compare>::find(const T& element) const
+{
+    return data_.find(element);
+}
+
+template <typename T, typename Compare>
+typename StdSet<T, Compare>::iterator StdSet<T, Compare>::lower_bound(const T& element) const
+{
+    return data_.lower_bound(element);
+}
+
+template <typename T, typename Compare>
+typename StdSet<T, Compare>::iterator StdSet<T, Compare>::upper_bound(const T& element) const
+{
+    return data_.upper_bound(element);
+}
+
+template <typename T, typename Compare>
+std::pair<typename StdSet<T, Compare>::iterator, typename StdSet<T, Compare>::iterator>
+StdSet<T, Compare>::equal_range(const T& element) const
+{
+    return data_.equal_range(element);
+}
+
+template <typename T, typename Compare>
+IteratorRange<typename StdSet<T, Compare>::iterator> StdSet<T, Compare>::range(const T& lower, const T& upper) const
+{
+    // a backwards range would never reach its end
+    if (!data_.key_comp()(lower, upper)) {
+        return IteratorRange<iterator>(data_.end(), data_.end());
+    }
+    return IteratorRange<iterator>(data_.lower_bound(lower),
+                                   data_.lower_bound(upper));
+}
+
+template <typename T, typename Compare>
+std::ostream& StdSet<T, Compare>::printStatistics(std::ostream& out) const
 {
     out << "No statistics available" << std::endl;
     return out;
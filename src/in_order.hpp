@@ -0,0 +1,37 @@
+/**
+ * \file in_order.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief visiting every element of a binary tree in order, as a tight loop
+ *
+ * \details Stepping an iterator from one element to the next climbs parent
+ * pointers whenever it leaves a right subtree, reading nodes it already
+ * passed again, and a tree larger than the cache misses on every one of
+ * them. Walking the tree with a stack of the nodes still to come reads
+ * each node once, so a full walk is several times faster. The trees use it
+ * for forEach.
+ */
+
+#ifndef IN_ORDER_HPP_INCLUDED
+#define IN_ORDER_HPP_INCLUDED 1
+#include <algorithm>
+#include <cstddef>
+
+/**
+* \brief calls visit(node->element_) for every node of the tree whose root
+* is root, in order
+*
+* \details Works on any node with element_, left_, right_ and parent_
+* members. The stack only holds the nearest ancestors still to come, so a
+* very deep tree doesn't need any memory of its own, and the parent
+* pointers find the ones it forgot.
+*
+* \note visit mustn't change the tree
+*/
+template <typename Node, typename Function>
+void forEachInOrder(Node* root, Function&& visit);
+
+#include "in_order_private.hpp"
+
+#endif // IN_ORDER_HPP_INCLUDED
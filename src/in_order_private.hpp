@@ -0,0 +1,52 @@
+/**
+ * \file in_order_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the in-order walk shared by the trees
+ */
+
+template <typename Node, typename Function>
+void forEachInOrder(Node* root, Function&& visit)
+{
+    // deep enough for any balanced tree that fits in memory
+    const size_t DEPTH = 64;
+    // nodes reached by going left, so their element and right subtree are
+    // still to come, the nearest last
+    Node* pending[DEPTH];
+    size_t count = 0;
+    Node* last = nullptr;     ///> the node visited last
+    Node* next = root;        ///> a subtree not started yet
+    while (true) {
+        for (; next != nullptr; next = next->left_) {
+            if (count == DEPTH) {
+                // forget the furthest half, the parent pointers lead back
+                std::copy(pending + DEPTH / 2, pending + DEPTH, pending);
+                count = DEPTH / 2;
+            }
+            pending[count++] = next;
+        }
+        Node* node;
+        if (count != 0) {
+            node = pending[--count];
+        } else {
+            // either everything has been visited, or the next node was
+            // forgotten. It's the first ancestor of the last node whose
+            // left subtree the last node is in.
+            if (last == nullptr) {
+                return;
+            }
+            Node* child = last;
+            node = last->parent_;
+            while (node != nullptr && node->right_ == child) {
+                child = node;
+                node = node->parent_;
+            }
+            if (node == nullptr) {
+                return;
+            }
+        }
+        visit(static_cast<const Node*>(node)->element_);
+        last = node;
+        next = node->right_;
+    }
+}
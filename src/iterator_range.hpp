@@ -0,0 +1,52 @@
+/**
+ * \file iterator_range.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief a pair of iterators that can be used in a range-based for loop
+ *
+ * \details The trees hand these out from range(lower, upper) so a scan over
+ * part of a tree reads like a scan over all of it.
+ */
+
+#ifndef ITERATOR_RANGE_HPP_INCLUDED
+#define ITERATOR_RANGE_HPP_INCLUDED 1
+
+template <typename Iterator>
+
+/**
+* \class IteratorRange
+* \brief The elements from first up to, but not including, last
+*/
+
+class IteratorRange {
+
+public:
+    using iterator = Iterator;
+
+    /**
+    * \brief
+    * Constructor
+    *
+    * \param first the first element in the range
+    * \param last the element just past the end of the range
+    */
+    IteratorRange(Iterator first, Iterator last);
+
+    iterator begin() const; ///< An iterator that refers to the first element
+    iterator end() const;   ///< A "past-the-end" iterator
+
+    /**
+    * \brief
+    * returns true if the range holds no elements
+    */
+    bool empty() const;
+
+private:
+    Iterator first_; ///< the first element in the range
+    Iterator last_;  ///< one past the last element in the range
+};
+
+#include "iterator_range_private.hpp"
+
+#endif // ITERATOR_RANGE_HPP_INCLUDED
@@ -0,0 +1,31 @@
+/**
+ * \file iterator_range_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the iterator range
+ */
+
+template <typename Iterator>
+IteratorRange<Iterator>::IteratorRange(Iterator first, Iterator last)
+    : first_{first}, last_{last}
+{
+    // nothing else to do
+}
+
+template <typename Iterator>
+Iterator IteratorRange<Iterator>::begin() const
+{
+    return first_;
+}
+
+template <typename Iterator>
+Iterator IteratorRange<Iterator>::end() const
+{
+    return last_;
+}
+
+template <typename Iterator>
+bool IteratorRange<Iterator>::empty() const
+{
+    return first_ == last_;
+}
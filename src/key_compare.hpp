@@ -0,0 +1,103 @@
+/**
+ * \file key_compare.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief comparator helpers shared by the binary trees
+ *
+ * \details The trees order their elements with a Compare object. By default
+ * it is a strict weak ordering like std::less, and a search makes a single
+ * comparison per level, only checking for a match once it reaches the bottom
+ * of the tree. A comparator that derives from ThreeWayCompare instead returns
+ * a negative, zero or positive int, so the search can stop as soon as it
+ * meets the element it is looking for.
+ */
+
+#ifndef KEY_COMPARE_HPP_INCLUDED
+#define KEY_COMPARE_HPP_INCLUDED 1
+#include <type_traits>
+
+/**
+* \brief Base class marking a comparator as three-way
+*
+* \details comp(a, b) must return a value less than, equal to or greater than
+* zero when a sorts before, alongside or after b
+*/
+struct ThreeWayCompare {};
+
+/**
+* \brief true_type if Compare is a three-way comparator
+*/
+template <typename Compare>
+struct isThreeWayCompare : std::is_base_of<ThreeWayCompare, Compare> {};
+
+/**
+* \brief returns true if a sorts before b
+*/
+template <typename Compare, typename A, typename B>
+bool keyLess(const Compare& comp, const A& a, const B& b);
+
+/**
+* \brief returns true if neither a nor b sorts before the other
+*/
+template <typename Compare, typename A, typename B>
+bool keyEquivalent(const Compare& comp, const A& a, const B& b);
+
+/**
+* \struct KeyLess
+* \brief Turns any comparator the trees accept into a strict weak ordering,
+* for handing to the standard library
+*/
+template <typename Compare>
+struct KeyLess {
+    Compare comp_; ///> the comparator being wrapped
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const;
+};
+
+/**
+* \struct KeySearch
+* \brief Where a search for a key ended up
+*/
+template <typename Node>
+struct KeySearch {
+    Node* match_;  ///> the node holding the key, nullptr if there isn't one
+    Node* parent_; ///> without a match, the node the key would hang off
+    bool left_;    ///> without a match, true if the key belongs on the left
+};
+
+/**
+* \brief searches the subtree rooted at here for key
+*
+* \details Works on any node with element_, left_ and right_ members. A
+* missing key's parent_ is the last node looked at, so the caller can attach
+* a new node there without searching a second time.
+*
+* \note one comparison per level, plus one at the bottom for strict weak
+* orderings
+*/
+template <typename Node, typename Key, typename Compare>
+KeySearch<Node> searchKey(Node* here, const Key& key, const Compare& comp);
+
+/**
+* \brief returns the first node in the subtree rooted at here that doesn't
+* sort before key, nullptr if there isn't one
+*
+* \note one comparison per level
+*/
+template <typename Node, typename Key, typename Compare>
+Node* lowerBoundNode(Node* here, const Key& key, const Compare& comp);
+
+/**
+* \brief returns the first node in the subtree rooted at here that sorts
+* after key, nullptr if there isn't one
+*
+* \note one comparison per level
+*/
+template <typename Node, typename Key, typename Compare>
+Node* upperBoundNode(Node* here, const Key& key, const Compare& comp);
+
+#include "key_compare_private.hpp"
+
+#endif // KEY_COMPARE_HPP_INCLUDED
@@ -0,0 +1,133 @@
+/**
+ * \file key_compare_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the comparator helpers shared by the trees
+ */
+
+template <typename Compare, typename A, typename B>
+bool keyLess(const Compare& comp, const A& a, const B& b, std::true_type)
+{
+    return comp(a, b) < 0;
+}
+
+template <typename Compare, typename A, typename B>
+bool keyLess(const Compare& comp, const A& a, const B& b, std::false_type)
+{
+    return comp(a, b);
+}
+
+template <typename Compare, typename A, typename B>
+bool keyLess(const Compare& comp, const A& a, const B& b)
+{
+    return keyLess(comp, a, b, typename isThreeWayCompare<Compare>::type());
+}
+
+template <typename Compare, typename A, typename B>
+bool keyEquivalent(const Compare& comp, const A& a, const B& b,
+                   std::true_type)
+{
+    return comp(a, b) == 0;
+}
+
+template <typename Compare, typename A, typename B>
+bool keyEquivalent(const Compare& comp, const A& a, const B& b,
+                   std::false_type)
+{
+    return !comp(a, b) && !comp(b, a);
+}
+
+template <typename Compare, typename A, typename B>
+bool keyEquivalent(const Compare& comp, const A& a, const B& b)
+{
+    return keyEquivalent(comp, a, b,
+                         typename isThreeWayCompare<Compare>::type());
+}
+
+template <typename Compare>
+template <typename A, typename B>
+bool KeyLess<Compare>::operator()(const A& a, const B& b) const
+{
+    return keyLess(comp_, a, b);
+}
+
+template <typename Node, typename Key, typename Compare>
+KeySearch<Node> searchKey(Node* here, const Key& key, const Compare& comp,
+                          std::true_type)
+{
+    KeySearch<Node> result{nullptr, nullptr, false};
+    while (here != nullptr) {
+        int order = comp(key, here->element_);
+        if (order == 0) {
+            result.match_ = here;
+            return result;
+        }
+        result.parent_ = here;
+        result.left_ = order < 0;
+        here = result.left_ ? here->left_ : here->right_;
+    }
+    return result;
+}
+
+template <typename Node, typename Key, typename Compare>
+KeySearch<Node> searchKey(Node* here, const Key& key, const Compare& comp,
+                          std::false_type)
+{
+    KeySearch<Node> result{nullptr, nullptr, false};
+    // the last node the key didn't sort before, if the key is in the tree it
+    // is the largest such node
+    Node* candidate = nullptr;
+    while (here != nullptr) {
+        result.parent_ = here;
+        result.left_ = comp(key, here->element_);
+        if (result.left_) {
+            here = here->left_;
+        } else {
+            candidate = here;
+            here = here->right_;
+        }
+    }
+    if (candidate != nullptr && !comp(candidate->element_, key)) {
+        result.match_ = candidate;
+    }
+    return result;
+}
+
+template <typename Node, typename Key, typename Compare>
+KeySearch<Node> searchKey(Node* here, const Key& key, const Compare& comp)
+{
+    return searchKey(here, key, comp,
+                     typename isThreeWayCompare<Compare>::type());
+}
+
+template <typename Node, typename Key, typename Compare>
+Node* lowerBoundNode(Node* here, const Key& key, const Compare& comp)
+{
+    Node* bound = nullptr;
+    while (here != nullptr) {
+        if (keyLess(comp, here->element_, key)) {
+            here = here->right_;
+        } else {
+            // here is a candidate, but there may be a closer one on the left
+            bound = here;
+            here = here->left_;
+        }
+    }
+    return bound;
+}
+
+template <typename Node, typename Key, typename Compare>
+Node* upperBoundNode(Node* here, const Key& key, const Compare& comp)
+{
+    Node* bound = nullptr;
+    while (here != nullptr) {
+        if (keyLess(comp, key, here->element_)) {
+            // here is a candidate, but there may be a closer one on the left
+            bound = here;
+            here = here->left_;
+        } else {
+            here = here->right_;
+        }
+    }
+    return bound;
+}
@@ -0,0 +1,227 @@
+/**
+ * \file node_pool.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief templated slab allocator for tree and list nodes
+ *
+ * \details The containers allocate their nodes one at a time. A NodePool
+ * hands them out of large slabs and keeps the nodes that are freed on a
+ * free list, so churn does not go back to the heap and nodes stay close
+ * together in memory. All slabs are released at once when the pool is
+ * destroyed.
+ */
+
+#ifndef NODE_POOL_HPP_INCLUDED
+#define NODE_POOL_HPP_INCLUDED 1
+#include <algorithm>
+#include <cstddef>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+
+/**
+* \class NodePool
+* \brief A per-container pool of T sized slots, usable as a std allocator
+*
+* \note Copies of a pool start out empty; only moving a pool hands over its
+* slabs, so each container owns exactly one pool. A container that takes
+* over nodes from another one shares that pool's slabs, which are freed once
+* neither pool needs them.
+*/
+
+class NodePool {
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /**
+    * \brief
+    * Default Constructor
+    *
+    * \note no memory is reserved until the first allocation
+    */
+    NodePool();
+
+    /**
+    * \brief
+    * Copy Constructor, makes a new empty pool
+    *
+    */
+    NodePool(const NodePool<T>& orig);
+
+    /**
+    * \brief
+    * Rebinding Constructor, makes a new empty pool for a different type
+    *
+    */
+    template <typename U>
+    NodePool(const NodePool<U>& orig);
+
+    /**
+    * \brief
+    * Move Constructor, takes over the slabs of orig
+    *
+    */
+    NodePool(NodePool<T>&& orig);
+
+    /**
+    * \brief
+    * Move Assignment Operator
+    *
+    * \warning the slabs the pool held before are freed, so nothing may still
+    * live in them
+    */
+    NodePool<T>& operator=(NodePool<T>&& rhs);
+
+    NodePool<T>& operator=(const NodePool<T>& rhs) = delete;
+
+    /**
+    * \brief
+    * Default Destructor, releases every slab at once
+    *
+    */
+    ~NodePool();
+
+    /**
+    * \brief
+    * Node Pool swap function
+    *
+    */
+    void swap(NodePool<T>& rhs);
+
+    /**
+    * \brief
+    * Hands out space for n objects
+    *
+    * \note single objects come out of the free list or the current slab,
+    * anything bigger goes straight to the heap
+    */
+    T* allocate(size_t n);
+
+    /**
+    * \brief
+    * Gives back space from allocate, single objects go on the free list
+    *
+    */
+    void deallocate(T* p, size_t n);
+
+    /**
+    * \brief
+    * Lets this pool free and reuse slots handed out by other
+    *
+    * \details Keeps other's slabs, including the ones it allocates later,
+    * alive for as long as this pool is. Used when a container takes nodes
+    * over from another container.
+    */
+    void share(const NodePool<T>& other);
+
+    /**
+    * \brief returns the number of bytes held in slabs
+    */
+    size_t bytesReserved() const;
+
+    /**
+    * \brief returns the number of slots currently handed out
+    *
+    * \note once pools share slabs a slot can be given back through a
+    * different pool than the one that handed it out, and only the total over
+    * all of those pools stays meaningful
+    */
+    size_t slotsInUse() const;
+
+    /**
+    * \brief
+    * Pools only compare equal to themselves, since memory from one pool can't
+    * be given back to another
+    */
+    bool operator==(const NodePool<T>& rhs) const;
+    bool operator!=(const NodePool<T>& rhs) const;
+
+private:
+    union Slot {
+        Slot* next_;   ///> the next free slot while this one is free
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+    };
+
+    struct Slab {
+        Slab* next_;   ///> the slab allocated before this one
+        Slot* slots_;  ///> the slots in this slab
+    };
+
+    /**
+    * \brief the slabs one pool has allocated, freed when the last pool
+    * holding them goes away
+    */
+    struct SlabList {
+        Slab* head_;   ///> the newest slab
+
+        SlabList();
+        ~SlabList();
+        SlabList(const SlabList&) = delete;
+        SlabList& operator=(const SlabList&) = delete;
+    };
+
+    static const size_t FIRST_SLAB_SLOTS = 64;
+    static const size_t MAX_SLAB_SLOTS = 16384;
+
+    std::shared_ptr<SlabList> slabs_; ///> every slab allocated so far
+    std::vector<std::shared_ptr<SlabList>> shared_; ///> other pools' slabs
+    Slot* freeList_;       ///> slots that have been given back
+    Slot* nextUnused_;     ///> next never used slot in the newest slab
+    Slot* slabEnd_;        ///> one past the last slot in the newest slab
+    size_t nextSlabSlots_; ///> the number of slots in the next slab
+    size_t slotsReserved_;
+    size_t slotsInUse_;
+
+    /**
+    * \brief allocates a new slab, each twice as big as the last up to
+    * MAX_SLAB_SLOTS
+    */
+    void addSlab();
+
+    /**
+    * \brief lets go of every slab, freeing those no other pool shares
+    */
+    void releaseSlabs();
+};
+
+template<typename T>
+/// Provide a non-member version of swap to allow standard swap(x,y) usage.
+void swap(NodePool<T>& lhs, NodePool<T>& rhs);
+
+/**
+* \brief returns the number of bytes an allocator holds for its nodes
+*
+* \param inUse the bytes taken up by live nodes, which is all an arbitrary
+* allocator can be assumed to hold
+*/
+template <typename Allocator>
+size_t allocatorBytes(const Allocator& allocator, size_t inUse);
+
+template <typename T>
+size_t allocatorBytes(const NodePool<T>& pool, size_t inUse);
+
+/**
+* \brief lets memory allocated by from be given back through to, for
+* containers that hand their nodes over to each other
+*
+* \note only pools need to do anything, other allocators have to compare
+* equal already
+*/
+template <typename Allocator>
+void shareAllocator(Allocator& to, const Allocator& from);
+
+template <typename T>
+void shareAllocator(NodePool<T>& to, const NodePool<T>& from);
+
+#include "node_pool_private.hpp"
+
+#endif // NODE_POOL_HPP_INCLUDED
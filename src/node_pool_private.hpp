@@ -0,0 +1,217 @@
+/**
+ * \file node_pool_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of templated node pool class
+ */
+
+template<typename T>
+NodePool<T>::NodePool()
+            : slabs_{}, shared_{}, freeList_{nullptr}, nextUnused_{nullptr},
+              slabEnd_{nullptr}, nextSlabSlots_{FIRST_SLAB_SLOTS},
+              slotsReserved_{0}, slotsInUse_{0}
+{
+    // nothing else to do
+}
+
+template<typename T>
+NodePool<T>::NodePool(const NodePool<T>& /*orig*/)
+            : NodePool()
+{
+    // the copy gets a pool of its own
+}
+
+template<typename T>
+template<typename U>
+NodePool<T>::NodePool(const NodePool<U>& /*orig*/)
+            : NodePool()
+{
+    // the copy gets a pool of its own
+}
+
+template<typename T>
+NodePool<T>::NodePool(NodePool<T>&& orig)
+            : NodePool()
+{
+    swap(orig);
+}
+
+template<typename T>
+NodePool<T>& NodePool<T>::operator=(NodePool<T>&& rhs)
+{
+    NodePool<T> moved{std::move(rhs)};
+    swap(moved);
+    return *this;
+}
+
+template<typename T>
+NodePool<T>::~NodePool()
+{
+    releaseSlabs();
+}
+
+template<typename T>
+void NodePool<T>::swap(NodePool<T>& rhs)
+{
+    using std::swap;
+    swap(slabs_, rhs.slabs_);
+    swap(shared_, rhs.shared_);
+    swap(freeList_, rhs.freeList_);
+    swap(nextUnused_, rhs.nextUnused_);
+    swap(slabEnd_, rhs.slabEnd_);
+    swap(nextSlabSlots_, rhs.nextSlabSlots_);
+    swap(slotsReserved_, rhs.slotsReserved_);
+    swap(slotsInUse_, rhs.slotsInUse_);
+}
+
+template<typename T>
+void swap(NodePool<T>& lhs, NodePool<T>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+template<typename T>
+T* NodePool<T>::allocate(size_t n)
+{
+    if (n != 1) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    Slot* slot;
+    if (freeList_ != nullptr) {
+        slot = freeList_;
+        freeList_ = freeList_->next_;
+    } else {
+        if (nextUnused_ == slabEnd_) {
+            addSlab();
+        }
+        slot = nextUnused_;
+        ++nextUnused_;
+    }
+    ++slotsInUse_;
+    return reinterpret_cast<T*>(slot);
+}
+
+template<typename T>
+void NodePool<T>::deallocate(T* p, size_t n)
+{
+    if (n != 1) {
+        ::operator delete(p);
+        return;
+    }
+    Slot* slot = reinterpret_cast<Slot*>(p);
+    slot->next_ = freeList_;
+    freeList_ = slot;
+    --slotsInUse_;
+}
+
+template<typename T>
+void NodePool<T>::share(const NodePool<T>& other)
+{
+    std::vector<std::shared_ptr<SlabList>> lists = other.shared_;
+    lists.push_back(other.slabs_);
+    for (const std::shared_ptr<SlabList>& list : lists) {
+        // skip other's slabs until it has some, and anything we already hold
+        if (list == nullptr || list == slabs_ ||
+            std::find(shared_.begin(), shared_.end(), list) != shared_.end()) {
+            continue;
+        }
+        shared_.push_back(list);
+    }
+}
+
+template<typename T>
+size_t NodePool<T>::bytesReserved() const
+{
+    return slotsReserved_ * sizeof(Slot);
+}
+
+template<typename T>
+size_t NodePool<T>::slotsInUse() const
+{
+    return slotsInUse_;
+}
+
+template<typename T>
+bool NodePool<T>::operator==(const NodePool<T>& rhs) const
+{
+    return this == &rhs;
+}
+
+template<typename T>
+bool NodePool<T>::operator!=(const NodePool<T>& rhs) const
+{
+    return !(*this == rhs);
+}
+
+template<typename T>
+void NodePool<T>::addSlab()
+{
+    if (slabs_ == nullptr) {
+        slabs_ = std::make_shared<SlabList>();
+    }
+    Slab* slab = new Slab;
+    slab->slots_ = new Slot[nextSlabSlots_];
+    slab->next_ = slabs_->head_;
+    slabs_->head_ = slab;
+    nextUnused_ = slab->slots_;
+    slabEnd_ = slab->slots_ + nextSlabSlots_;
+    slotsReserved_ += nextSlabSlots_;
+    if (nextSlabSlots_ < MAX_SLAB_SLOTS) {
+        nextSlabSlots_ *= 2;
+    }
+}
+
+template<typename T>
+void NodePool<T>::releaseSlabs()
+{
+    // the slabs themselves go once no other pool shares them
+    slabs_.reset();
+    shared_.clear();
+    freeList_ = nextUnused_ = slabEnd_ = nullptr;
+    nextSlabSlots_ = FIRST_SLAB_SLOTS;
+    slotsReserved_ = 0;
+}
+
+template<typename T>
+NodePool<T>::SlabList::SlabList()
+    : head_{nullptr}
+{
+    // nothing else to do
+}
+
+template<typename T>
+NodePool<T>::SlabList::~SlabList()
+{
+    while (head_ != nullptr) {
+        Slab* next = head_->next_;
+        delete[] head_->slots_;
+        delete head_;
+        head_ = next;
+    }
+}
+
+template <typename Allocator>
+size_t allocatorBytes(const Allocator& /*allocator*/, size_t inUse)
+{
+    return inUse;
+}
+
+template <typename T>
+size_t allocatorBytes(const NodePool<T>& pool, size_t /*inUse*/)
+{
+    return pool.bytesReserved();
+}
+
+template <typename Allocator>
+void shareAllocator(Allocator& to, const Allocator& from)
+{
+    // nodes can only move between containers whose allocators can free
+    // each other's memory
+    assert(to == from);
+}
+
+template <typename T>
+void shareAllocator(NodePool<T>& to, const NodePool<T>& from)
+{
+    to.share(from);
+}
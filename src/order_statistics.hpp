@@ -0,0 +1,100 @@
+/**
+ * \file order_statistics.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief policies deciding whether a balanced tree keeps subtree sizes
+ *
+ * \details AvlTree and RBTree take one of these as their Statistics
+ * parameter. NoOrderStatistics, the default, adds nothing to the nodes and
+ * all of its hooks compile away. OrderStatistics keeps the number of nodes
+ * in every subtree, so the tree can find the k-th element or the rank of an
+ * element in O(log n) time. It costs a size_t per node and a walk back to
+ * the root after every insert and delete.
+ */
+
+#ifndef ORDER_STATISTICS_HPP_INCLUDED
+#define ORDER_STATISTICS_HPP_INCLUDED 1
+#include <cstddef>
+#include "key_compare.hpp"
+
+/**
+* \struct NoOrderStatistics
+* \brief Policy for trees that don't keep subtree sizes
+*/
+struct NoOrderStatistics {
+    /**
+    * \brief what the policy adds to every node, nothing here
+    */
+    struct NodeCount {};
+
+    template <typename Node>
+    static void recount(Node* /*here*/) {}
+
+    template <typename Node>
+    static void recountPath(Node* /*here*/) {}
+
+    template <typename Node>
+    static void copyCount(Node* /*copy*/, const Node* /*source*/) {}
+};
+
+/**
+* \struct OrderStatistics
+* \brief Policy for trees that keep the size of every subtree
+*
+* \note the nodes it works on need left_, right_, parent_ and element_
+* members as well as the NodeCount base
+*/
+struct OrderStatistics {
+    /**
+    * \brief what the policy adds to every node
+    */
+    struct NodeCount {
+        size_t count_; ///> the number of nodes in this node's subtree
+
+        NodeCount() : count_{1} {}
+    };
+
+    /**
+    * \brief returns the number of nodes in the subtree rooted at here
+    */
+    template <typename Node>
+    static size_t count(const Node* here);
+
+    /**
+    * \brief recomputes here's count from its children's counts
+    */
+    template <typename Node>
+    static void recount(Node* here);
+
+    /**
+    * \brief recomputes the counts from here all the way up to the root,
+    * after a node has been added or removed below here
+    */
+    template <typename Node>
+    static void recountPath(Node* here);
+
+    /**
+    * \brief gives copy the same count as source
+    */
+    template <typename Node>
+    static void copyCount(Node* copy, const Node* source);
+
+    /**
+    * \brief returns the node with k nodes before it in the subtree rooted at
+    * here, nullptr if the subtree is too small
+    */
+    template <typename Node>
+    static Node* select(Node* here, size_t k);
+
+    /**
+    * \brief returns the number of nodes in the subtree rooted at here whose
+    * elements sort before key
+    */
+    template <typename Node, typename Key, typename Compare>
+    static size_t rank(const Node* here, const Key& key, const Compare& comp);
+};
+
+#include "order_statistics_private.hpp"
+
+#endif // ORDER_STATISTICS_HPP_INCLUDED
@@ -0,0 +1,71 @@
+/**
+ * \file order_statistics_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the order statistic policy
+ */
+
+template <typename Node>
+size_t OrderStatistics::count(const Node* here)
+{
+    if (here == nullptr) {
+        return 0;
+    }
+    return here->count_;
+}
+
+template <typename Node>
+void OrderStatistics::recount(Node* here)
+{
+    here->count_ = 1 + count(here->left_) + count(here->right_);
+}
+
+template <typename Node>
+void OrderStatistics::recountPath(Node* here)
+{
+    while (here != nullptr) {
+        recount(here);
+        here = here->parent_;
+    }
+}
+
+template <typename Node>
+void OrderStatistics::copyCount(Node* copy, const Node* source)
+{
+    copy->count_ = source->count_;
+}
+
+template <typename Node>
+Node* OrderStatistics::select(Node* here, size_t k)
+{
+    while (here != nullptr) {
+        size_t leftCount = count(here->left_);
+        if (k < leftCount) {
+            here = here->left_;
+        } else if (k == leftCount) {
+            return here;
+        } else {
+            // skip the left subtree and here itself
+            k -= leftCount + 1;
+            here = here->right_;
+        }
+    }
+    return nullptr;
+}
+
+template <typename Node, typename Key, typename Compare>
+size_t OrderStatistics::rank(const Node* here, const Key& key,
+                             const Compare& comp)
+{
+    size_t before = 0;
+    while (here != nullptr) {
+        if (keyLess(comp, here->element_, key)) {
+            // here and everything to its left sort before key
+            before += count(here->left_) + 1;
+            here = here->right_;
+        } else {
+            here = here->left_;
+        }
+    }
+    return before;
+}
@@ -12,8 +12,11 @@
 #include <cstddef>
 #include <cassert>
 #include <iostream>
+#include <utility>
+#include <memory>
+#include "node_pool.hpp"
 
-template <typename T>
+template <typename T, typename Allocator = NodePool<T>>
 
 /**
 * \class LinkedList
@@ -39,14 +42,32 @@ public:
     * Copy Constructor
     *
     */
-    LinkedList<T>(const LinkedList<T>& orig);
+    LinkedList<T, Allocator>(const LinkedList<T, Allocator>& orig);
 
     /**
     * \brief
     * Assignment Operator
     *
     */
-    LinkedList<T>& operator=(const LinkedList<T>& rhs);
+    LinkedList<T, Allocator>& operator=(const LinkedList<T, Allocator>& rhs);
+
+    /**
+    * \brief
+    * Move Constructor
+    *
+    * \details Takes over the nodes of orig, leaving it empty
+    *
+    * \note constant time
+    */
+    LinkedList<T, Allocator>(LinkedList<T, Allocator>&& orig);
+
+    /**
+    * \brief
+    * Move Assignment Operator
+    *
+    * \note constant time, apart from freeing the list's old nodes
+    */
+    LinkedList<T, Allocator>& operator=(LinkedList<T, Allocator>&& rhs);
 
     /**
     * \brief
@@ -54,7 +75,7 @@ public:
     *
     *
     */
-    void swap(LinkedList<T>& rhs);
+    void swap(LinkedList<T, Allocator>& rhs);
 
     /**
     * \brief 
@@ -83,6 +104,18 @@ public:
     * \note constant time
     */
     void insertFront(const T& element);
+    void insertFront(T&& element);
+
+    /**
+    * \brief
+    * Constructs an element in place at the front of the list
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \note constant time
+    */
+    template <typename... Args>
+    void emplaceFront(Args&&... args);
 
     /**
     * \brief 
@@ -91,6 +124,18 @@ public:
     * \note constant time
     */
     void insertBack(const T& element);
+    void insertBack(T&& element);
+
+    /**
+    * \brief
+    * Constructs an element in place at the back of the list
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \note constant time
+    */
+    template <typename... Args>
+    void emplaceBack(Args&&... args);
 
     /**
     * \brief 
@@ -101,6 +146,20 @@ public:
     * \details The iterator cannot be end()
     */
     void insertAfter(iterator where, const T& element);
+    void insertAfter(iterator where, T&& element);
+
+    /**
+    * \brief
+    * Constructs an element in place after the specified iterator
+    *
+    * \param args the arguments to pass to the element's constructor
+    *
+    * \note constant time
+    *
+    * \details The iterator cannot be end()
+    */
+    template <typename... Args>
+    void emplaceAfter(iterator where, Args&&... args);
 
     /**
     * \brief 
@@ -142,14 +201,14 @@ public:
     * Linked List equality operator
     *
     */
-    bool operator==(const LinkedList<T>& rhs) const;
+    bool operator==(const LinkedList<T, Allocator>& rhs) const;
 
     /**
     * \brief
     * Linked List inequality operator
     *
     */
-    bool operator!=(const LinkedList<T>& rhs) const;
+    bool operator!=(const LinkedList<T, Allocator>& rhs) const;
 
     /**
     * \brief
@@ -157,19 +216,50 @@ public:
     */
     bool empty();
 
+    /**
+     * \brief
+     * Prints how much memory the list's nodes take up
+     *
+     * \param out the output stream to print to
+     *
+     * \returns the output stream after printing
+     */
+    std::ostream& printStatistics(std::ostream& out) const;
+
 private:
     struct Node {
         T element_;
         Node* next_;
-        Node(const T& element, Node* next);
+        /**
+        * \brief Node constructor, builds the element in place out of args
+        */
+        template <typename... Args>
+        Node(Node* next, Args&&... args);
 
         Node() = delete;
         Node& operator=(const Node&) = delete;
     };
+
+    using NodeAllocator =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator alloc_; ///> where the list's nodes come from
     size_t size_;
     Node* head_;
     Node* tail_;
 
+    /**
+    * \brief allocates a node from the list's allocator and constructs it
+    * out of args
+    */
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+
+    /**
+    * \brief destroys a single node and gives its memory back
+    */
+    void destroyNode(Node* node);
+
     class Iterator
     {
     public:
@@ -194,10 +284,10 @@ private:
     };
 };
 
-template<typename T>
+template<typename T, typename Allocator>
 /// Provide a non-member version of swap to allow standard swap(x,y) usage.
-void swap(LinkedList<T>& lhs, LinkedList<T>& rhs);
+void swap(LinkedList<T, Allocator>& lhs, LinkedList<T, Allocator>& rhs);
 
-#include "linkedlist-private.hpp"
+#include "linked_list_private.hpp"
 
 #endif // LINKEDLIST_HPP_INCLUDED
@@ -5,103 +5,163 @@
  * \brief implementation of templated linked list class
  */
 
-template<typename T>
-LinkedList<T>::LinkedList()
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>::LinkedList()
             : size_{0}, head_{nullptr}, tail_{nullptr}
 {
     // nothing to do
 }
 
-template<typename T>
-LinkedList<T>::~LinkedList()
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>::~LinkedList()
 {
     while (!empty()) {
         deleteFront();
     }
 }
 
-template<typename T>
-LinkedList<T>::LinkedList(const LinkedList<T>& orig)
-            : size_{0}, head_{nullptr}, tail_{nullptr}
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>::LinkedList(const LinkedList<T, Allocator>& orig)
+            : alloc_{NodeTraits::select_on_container_copy_construction(
+                  orig.alloc_)},
+              size_{0}, head_{nullptr}, tail_{nullptr}
 {
     for (iterator i = orig.begin(); i != orig.end(); ++i) {
         insertBack(*i);
     }
 }
 
-template<typename T>
-LinkedList<T>& LinkedList<T>::operator=(const LinkedList<T>& rhs)
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>& LinkedList<T, Allocator>::operator=(const LinkedList<T, Allocator>& rhs)
 {
-    LinkedList<T> copy{rhs};
+    LinkedList<T, Allocator> copy{rhs};
     swap(copy);
     return *this;
 }
 
-template<typename T>
-void LinkedList<T>::swap(LinkedList<T>& rhs)
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>::LinkedList(LinkedList<T, Allocator>&& orig)
+            : alloc_{std::move(orig.alloc_)}, size_{orig.size_},
+              head_{orig.head_}, tail_{orig.tail_}
+{
+    orig.size_ = 0;
+    orig.head_ = nullptr;
+    orig.tail_ = nullptr;
+}
+
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>& LinkedList<T, Allocator>::operator=(LinkedList<T, Allocator>&& rhs)
+{
+    LinkedList<T, Allocator> moved{std::move(rhs)};
+    swap(moved);
+    return *this;
+}
+
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::swap(LinkedList<T, Allocator>& rhs)
 {
     using std::swap;
     swap(head_, rhs.head_);
     swap(tail_, rhs.tail_);
     swap(size_, rhs.size_);
+    swap(alloc_, rhs.alloc_);
 }
 
-template<typename T>
-void swap(LinkedList<T>& lhs, LinkedList<T>& rhs)
+template<typename T, typename Allocator>
+void swap(LinkedList<T, Allocator>& lhs, LinkedList<T, Allocator>& rhs)
 {
     lhs.swap(rhs);
 }
 
-template<typename T>
-size_t LinkedList<T>::size() const
+template<typename T, typename Allocator>
+size_t LinkedList<T, Allocator>::size() const
 {
     return size_;
 }
 
-template<typename T>
-void LinkedList<T>::insertFront(const T& element)
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::insertFront(const T& element)
+{
+    emplaceFront(element);
+}
+
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::insertFront(T&& element)
+{
+    emplaceFront(std::move(element));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void LinkedList<T, Allocator>::emplaceFront(Args&&... args)
 {
-    head_ = new Node(element, head_);
+    head_ = createNode(head_, std::forward<Args>(args)...);
     if (size_ == 0) {
         tail_ = head_;
     }
     ++size_;
 }
 
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::insertBack(const T& element)
+{
+    emplaceBack(element);
+}
 
-template<typename T>
-void LinkedList<T>::insertBack(const T& element)
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::insertBack(T&& element)
+{
+    emplaceBack(std::move(element));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void LinkedList<T, Allocator>::emplaceBack(Args&&... args)
 {
     if (size_ == 0) {
-        insertFront(element);
+        emplaceFront(std::forward<Args>(args)...);
     } else {
-        Node* newBack = new Node(element, nullptr);
+        Node* newBack = createNode(nullptr, std::forward<Args>(args)...);
         tail_->next_ = newBack;
         tail_ = newBack;
         ++size_;
     }
 }
 
-template<typename T>
-void LinkedList<T>::insertAfter(iterator where, const T& element)
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::insertAfter(iterator where, const T& element)
+{
+    emplaceAfter(where, element);
+}
+
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::insertAfter(iterator where, T&& element)
+{
+    emplaceAfter(where, std::move(element));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void LinkedList<T, Allocator>::emplaceAfter(iterator where, Args&&... args)
 {
     Node* currentNode = where.current_;
     if (currentNode == tail_) {
-        insertBack(element);
+        emplaceBack(std::forward<Args>(args)...);
     } else {
-        currentNode->next_ = new Node(element, currentNode->next_);
+        currentNode->next_ = createNode(currentNode->next_,
+                                        std::forward<Args>(args)...);
         ++size_;
     }
 }
 
-template<typename T>
-T LinkedList<T>::deleteFront()
+template<typename T, typename Allocator>
+T LinkedList<T, Allocator>::deleteFront()
 {
     assert(!empty());
 
-    T oldFrontVal = head_->element_;
+    T oldFrontVal = std::move(head_->element_);
     Node* newFront = head_->next_;
-    delete head_;
+    destroyNode(head_);
     head_ = newFront;
     --size_;
 
@@ -112,8 +172,8 @@ T LinkedList<T>::deleteFront()
 
 }
 
-template<typename T>
-T LinkedList<T>::deleteBack()
+template<typename T, typename Allocator>
+T LinkedList<T, Allocator>::deleteBack()
 {
     assert(!empty());
     if (size_ == 1) {
@@ -127,15 +187,15 @@ T LinkedList<T>::deleteBack()
         }
 
         tail_ = currentNode;
-        T oldBackVal = oldBack->element_;
-        delete oldBack;
+        T oldBackVal = std::move(oldBack->element_);
+        destroyNode(oldBack);
         --size_;
         return oldBackVal;
     }
 }
 
-template<typename T>
-bool LinkedList<T>::deleteElement(const T& element)
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::deleteElement(const T& element)
 {
     if (size_ == 0) {
         return false;
@@ -150,7 +210,7 @@ bool LinkedList<T>::deleteElement(const T& element)
         if (currentNode->next_->element_ == element) {
             Node* nodeToDelete = currentNode->next_;
             currentNode->next_ = currentNode->next_->next_;
-            delete nodeToDelete;
+            destroyNode(nodeToDelete);
             --size_;
             if (currentNode->next_ == nullptr) {
                 tail_ = currentNode;
@@ -162,8 +222,8 @@ bool LinkedList<T>::deleteElement(const T& element)
     return false;
 }
 
-template<typename T>
-bool LinkedList<T>::contains(const T& element)
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::contains(const T& element)
 {
     if (size_ == 0) {
         return false;
@@ -179,14 +239,46 @@ bool LinkedList<T>::contains(const T& element)
     return false;
 }
 
-template<typename T>
-bool LinkedList<T>::empty()
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::empty()
 {
     return (size_ == 0);
 }
 
-template<typename T>
-bool LinkedList<T>::operator==(const LinkedList<T>& rhs) const
+template<typename T, typename Allocator>
+std::ostream& LinkedList<T, Allocator>::printStatistics(std::ostream& out) const
+{
+    out << "node memory " << size_ * sizeof(Node) << " bytes" << std::endl;
+    out << "allocated memory "
+        << allocatorBytes(alloc_, size_ * sizeof(Node)) << " bytes"
+        << std::endl;
+    return out;
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+typename LinkedList<T, Allocator>::Node*
+LinkedList<T, Allocator>::createNode(Args&&... args)
+{
+    Node* node = NodeTraits::allocate(alloc_, 1);
+    try {
+        NodeTraits::construct(alloc_, node, std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc_, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template<typename T, typename Allocator>
+void LinkedList<T, Allocator>::destroyNode(Node* node)
+{
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+}
+
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::operator==(const LinkedList<T, Allocator>& rhs) const
 {
     if (size() != rhs.size()) {
         return false;
@@ -206,21 +298,21 @@ bool LinkedList<T>::operator==(const LinkedList<T>& rhs) const
 }
 
 
-template<typename T>
-bool LinkedList<T>::operator!=(const LinkedList<T>& rhs) const
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::operator!=(const LinkedList<T, Allocator>& rhs) const
 {
     return !(*this == rhs);
 }
 
 
-template<typename T>
-typename LinkedList<T>::iterator LinkedList<T>::begin() const
+template<typename T, typename Allocator>
+typename LinkedList<T, Allocator>::iterator LinkedList<T, Allocator>::begin() const
 {
     return Iterator(head_);
 }
 
-template<typename T>
-typename LinkedList<T>::iterator LinkedList<T>::end() const
+template<typename T, typename Allocator>
+typename LinkedList<T, Allocator>::iterator LinkedList<T, Allocator>::end() const
 {
     return Iterator(nullptr);
 }
@@ -228,9 +320,10 @@ typename LinkedList<T>::iterator LinkedList<T>::end() const
 // --------------------------------------
 // Implementation of LinkedList::Node
 // --------------------------------------
-template<typename T>
-LinkedList<T>::Node::Node(const T& element, Node* next)
-    :element_{element}, next_{next}
+template<typename T, typename Allocator>
+template<typename... Args>
+LinkedList<T, Allocator>::Node::Node(Node* next, Args&&... args)
+    :element_(std::forward<Args>(args)...), next_{next}
 {
     // nothing else to do
 }
@@ -239,34 +332,34 @@ LinkedList<T>::Node::Node(const T& element, Node* next)
 // --------------------------------------
 // Implementation of LinkedList::Iterator
 // --------------------------------------
-template<typename T>
-LinkedList<T>::Iterator::Iterator(Node* index)
+template<typename T, typename Allocator>
+LinkedList<T, Allocator>::Iterator::Iterator(Node* index)
     : current_{index}
 {
     // Nothing else to do.
 }
 
-template<typename T>
-typename LinkedList<T>::Iterator& LinkedList<T>::Iterator::operator++()
+template<typename T, typename Allocator>
+typename LinkedList<T, Allocator>::Iterator& LinkedList<T, Allocator>::Iterator::operator++()
 {
     current_ = current_->next_;
     return *this;
 }
 
-template<typename T>
-T& LinkedList<T>::Iterator::operator*() const
+template<typename T, typename Allocator>
+T& LinkedList<T, Allocator>::Iterator::operator*() const
 {
     return current_->element_;
 }
 
-template<typename T>
-bool LinkedList<T>::Iterator::operator==(const Iterator& rhs) const
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::Iterator::operator==(const Iterator& rhs) const
 {
     return (current_ == rhs.current_);
 }
 
-template<typename T>
-bool LinkedList<T>::Iterator::operator!=(const Iterator& rhs) const
+template<typename T, typename Allocator>
+bool LinkedList<T, Allocator>::Iterator::operator!=(const Iterator& rhs) const
 {
     return !(*this == rhs);
 }
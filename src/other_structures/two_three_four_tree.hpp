@@ -10,6 +10,7 @@
 #ifndef TWOTHREEFOUR_TREE_INCLUDED
 #define TWOTHREEFOUR_TREE_INCLUDED 1
 #include "abstracttree.hpp"
+#include "iterator_range.hpp"
 //#include <cstddef>
 #include <cassert>
 //#include <iostream>
@@ -18,6 +19,7 @@
 //#include <list>
 #include <iomanip>
 #include <cmath>
+#include <utility>
 
 template <typename T>
 
@@ -51,6 +53,16 @@ public:
     */
     twothreefourTree<T>& operator=(const twothreefourTree<T>& rhs);
 
+    /**
+    * Move Constructor, leaves orig empty
+    */
+    twothreefourTree<T>(twothreefourTree<T>&& orig);
+
+    /**
+    * Move Assignment Operator
+    */
+    twothreefourTree<T>& operator=(twothreefourTree<T>&& rhs);
+
     /**
     * 2-3-4 Tree swap function
     */
@@ -84,6 +96,14 @@ public:
     * Inserts an element into the tree
     */
     bool insert(const T& element) override;
+    bool insert(T&& element) override;
+
+    /**
+    * \brief
+    * Constructs an element out of args and inserts it into the tree
+    */
+    template <typename... Args>
+    bool emplace(Args&&... args);
 
     /**
     * \brief 
@@ -99,6 +119,43 @@ public:
     */
     bool contains(const T& element) const override;
 
+    /**
+    * \brief
+    * Finds an element in the tree
+    *
+    * \returns an iterator to the element, end() if it isn't in the tree
+    */
+    iterator find(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that isn't less than element
+    *
+    * \returns end() if every element is less than element
+    */
+    iterator lower_bound(const T& element) const;
+
+    /**
+    * \brief
+    * Finds the first element in the tree that is greater than element
+    *
+    * \returns end() if no element is greater than element
+    */
+    iterator upper_bound(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements equal to element as a pair of iterators
+    */
+    std::pair<iterator, iterator> equal_range(const T& element) const;
+
+    /**
+    * \brief
+    * returns the elements in [lower, upper), for use in a range-based for
+    * loop
+    */
+    IteratorRange<iterator> range(const T& lower, const T& upper) const;
+
     /**
     * 2-3-4 Tree equality operator
     */
@@ -147,7 +204,6 @@ private:
         Node* third_;        ///< this node's third child
         Node* fourth_;       ///< this node's fourth child
         Node* parent_;       ///< this node's parent
-        size_t size_;        ///< this node's size
         size_t nodeType_;        ///< this node's type
 
         /**
@@ -164,7 +220,7 @@ private:
         Node& operator=(const Node&) = delete; // disable assignment operator
     };
 
-    //size_t size_;
+    size_t size_;        ///< the number of elements in the tree
     Node* root_;
 
     /**
@@ -187,36 +243,6 @@ private:
 
     bool isLeaf(Node*& here) const; ///< Checks if here is a leaf
 
-    /**
-     * \brief Checks if here is the first child of its parent
-     *
-     * \note Also checks if here is a valid node
-     */
-    bool isFirstChild(Node*& here) const;
-
-    /**
-     * \brief Checks if here is the second child of its parent
-     *
-     * \note Also checks if here is a valid node
-     */
-    bool isSecondChild(Node*& here) const;
-
-    /**
-     * \brief Checks if here is the third child of its parent
-     *
-     * \note Also checks if here is a valid node
-     *       and if here's parent is a 3- or a 4- node (i.e. legal to have a third child)
-     */
-    bool isThirdChild(Node*& here) const;
-
-    /**
-     * \brief Checks if here is the fourth child of its parent
-     *
-     * \note Also checks if here is a valid node
-     *       and if here's parent is a 4-node (i.e. legal to have a fourth child)
-     */
-    bool isFourthChild(Node*& here) const;
-
     /**
      * \brief Compares element to a 2-node's elements
      *
@@ -241,38 +267,40 @@ private:
     /**
      * \brief Compares the element to here's elements
      *
-     * \returns The index to which the element belongs in the node (starting from 1)
+     * \returns The index of the first of here's elements that isn't less
+     *          than element (starting from 0), which is also the index of
+     *          the child element belongs under
      *
      * \note e.g. here's elements = [3, 5, 7]
-     *       belongs(here, 3) = 1
-     *       beongs(here, 5) = 2
-     *       belongs(here, 7) = 3
-     *       belongs(here, 9) = 4
-     *       belongs(2) = 1
-     *       belongs(4) = 2
-     *       belongs(6) = 3
-     *       belongs(8) = 4
-     */
-    size_t belongs(Node*& here, const T& element) const;
-
-    /*
-     * Splits a 4-node into two 2-nodes and pushes the middle key up to its parent
+     *       belongs(here, 3) = 0
+     *       belongs(here, 5) = 1
+     *       belongs(here, 7) = 2
+     *       belongs(here, 9) = 3
+     *       belongs(here, 2) = 0
+     *       belongs(here, 4) = 1
+     *       belongs(here, 6) = 2
+     *       belongs(here, 8) = 3
      */
-    void split4node(Node*& here);
+    size_t belongs(Node* here, const T& element) const;
 
     /**
-     * Returns the size of the node's subtree
+     * \brief Splits a 4-node into two 2-nodes and pushes the middle key up
+     * to its parent, which mustn't be a 4-node
+     *
+     * \returns the node the middle key went to, a new root if here was the
+     *          root
      */
-    size_t nodeSize(Node* here) const;
+    Node* split4node(Node* here);
 
     /**
      * \brief
      * Inserts a node into the tree
      *
      * \param here The node to insert at
-     * \param element The element to insert
+     * \param element The element to insert, forwarded into the tree
      */
-    bool insertNode(Node*& here, const T& element);
+    template <typename U>
+    bool insertNode(Node*& here, U&& element);
 
     /**
      * \brief
@@ -295,6 +323,21 @@ private:
     */
     size_t subtreeHeight(Node* here) const;
 
+    /**
+     * \brief returns here's element at index, counting from 0
+     */
+    static T& elementAt(Node* here, size_t index);
+
+    /**
+     * \brief returns here's child at index, counting from 0
+     */
+    static Node*& childAt(Node* here, size_t index);
+
+    /**
+     * \brief returns which of its parent's children here is, counting from 0
+     */
+    static size_t childIndex(Node* here);
+
     class Iterator
     {
     public:
@@ -315,8 +358,9 @@ private:
 
     private:
         friend class twothreefourTree;
-        Iterator(Node* index);
-        Node* current_;
+        Iterator(Node* here, size_t index);
+        Node* current_;  ///< the node holding the element, nullptr at the end
+        size_t index_;   ///< which of current_'s elements we are at
     };
 
 };
@@ -325,6 +369,6 @@ template<typename T>
 /// Provide a non-member version of swap to allow standard swap(x,y) usage.
 void swap(twothreefourTree<T>& lhs, twothreefourTree<T>& rhs);
 
-#include "twothreefourtree-private.hpp"
+#include "two_three_four_tree_private.hpp"
 
 #endif // TWOTHREEFOUR_TREE_INCLUDED
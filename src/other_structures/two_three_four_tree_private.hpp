@@ -7,7 +7,7 @@
 
 template<typename T>
 twothreefourTree<T>::twothreefourTree()
-            : root_{nullptr}
+            : size_{0}, root_{nullptr}
 {
     //srand (time(NULL));
 }
@@ -20,7 +20,7 @@ twothreefourTree<T>::~twothreefourTree()
 
 template<typename T>
 twothreefourTree<T>::twothreefourTree(const twothreefourTree<T>& orig)
-            : root_{nullptr}
+            : size_{0}, root_{nullptr}
 {
     for (iterator i = orig.begin(); i != orig.end(); ++i) {
         insert(*i);
@@ -35,10 +35,27 @@ twothreefourTree<T>& twothreefourTree<T>::operator=(const twothreefourTree<T>& r
     return *this;
 }
 
+template<typename T>
+twothreefourTree<T>::twothreefourTree(twothreefourTree<T>&& orig)
+            : size_{orig.size_}, root_{orig.root_}
+{
+    orig.size_ = 0;
+    orig.root_ = nullptr;
+}
+
+template<typename T>
+twothreefourTree<T>& twothreefourTree<T>::operator=(twothreefourTree<T>&& rhs)
+{
+    twothreefourTree<T> moved{std::move(rhs)};
+    swap(moved);
+    return *this;
+}
+
 template<typename T>
 void twothreefourTree<T>::swap(twothreefourTree<T>& rhs)
 {
     using std::swap;
+    swap(size_, rhs.size_);
     swap(root_, rhs.root_);
 }
 
@@ -51,7 +68,7 @@ void swap(twothreefourTree<T>& lhs, twothreefourTree<T>& rhs)
 template<typename T>
 size_t twothreefourTree<T>::size() const
 {
-    return nodeSize(root_);
+    return size_;
 }
 
 template<typename T>
@@ -113,288 +130,141 @@ size_t twothreefourTree<T>::subtreeHeight(Node* here) const
 template<typename T>
 bool twothreefourTree<T>::contains(const T& element) const
 {
-    std::cout << "checking" << std::endl;
-    
-    if (findNode(root_, element) == nullptr) {
-        std::cout << "hi" << std::endl;
-        return false;
-    } else {
-        std::cout << "bye" << std::endl;
-        return true;
-    }
+    return findNode(root_, element) != nullptr;
 }
 
 template<typename T>
 typename twothreefourTree<T>::Node* twothreefourTree<T>::findNode(Node* here, const T& element) const
 {
-    std::cout << "findNode called" << std::endl;
-    size_t index = belongs(here, element);
-    std::cout << "successfully called belongs" << std::endl;
-    
-    if (index == 0) {
-        std::cout << "seg fault here 1" << std::endl;
-        return nullptr;
-    }
-    
-    else if (index == 1 && here->firstElement_ == element) {
-        std::cout << "seg fault here 2" << std::endl;
-        return here;
-    }
-    else if (index == 1) {
-        std::cout << "seg fault here 3" << std::endl;
-        return findNode(here->first_, element);
-    }
-    
-    else if (index == 2 && here->secondElement_ == element) {
-        std::cout << "seg fault here 4" << std::endl;
-        return here;
-    }
-    else if (index == 2) {
-        std::cout << "seg fault here 5" << std::endl;
-        return findNode(here->second_, element);
-    }
-
-    else if (index == 3 && here->thirdElement_ == element) {
-        std::cout << "seg fault here 6" << std::endl;
-        return here;
-    }
-    else if (index == 3) {
-        std::cout << "seg fault here 7" << std::endl;
-        return findNode(here->third_, element);
-    }
-
-    else if (index == 4) {
-        std::cout << "seg fault here 8" << std::endl;
-        return findNode(here->fourth_, element);
+    while (here != nullptr) {
+        size_t index = belongs(here, element);
+        if (index < here->nodeType_ - 1 && !(element < elementAt(here, index))) {
+            return here;
+        }
+        here = childAt(here, index);
     }
+    return nullptr;
+}
 
-    else { // index = 0
-        std::cout << "seg fault here 9" << std::endl;
-        return nullptr;
+template<typename T>
+size_t twothreefourTree<T>::belongs(Node* here, const T& element) const
+{
+    size_t index = 0;
+    while (index < here->nodeType_ - 1 && elementAt(here, index) < element) {
+        ++index;
     }
+    return index;
 }
 
 template<typename T>
-size_t twothreefourTree<T>::belongs(Node*& here, const T& element) const
+bool twothreefourTree<T>::insert(const T& element)
 {
-    if (here == nullptr)
-        return 0;
+    return (insertNode(root_, element));
+}
 
-    std::cout << "belongs called" << std::endl;
-    // Checking the element's 2-node index
-    if (is2node(here)) {
-        std::cout << "case: is2node" << std::endl; 
-        if (element <= here->firstElement_) 
-            return 1;
-        else
-            return 2;
-    }
-    // Checking the element's 3-node index
-    else if (is3node(here)) {
-        std::cout << "case: is3node" << std::endl; 
-        if (element <= here->firstElement_) 
-            return 1;
-        else if (here->secondElement_ < element) // order matters
-            return 3;
-        else // first < elemenet <= second
-            return 2;
-    }
-    // Checking the element's 4-node index
-    else if (is4node(here)) {
-        std::cout << "case: is4node" << std::endl; 
-        if (element <= here->firstElement_) 
-            return 1;
-        else if (here->thirdElement_ < element)
-            return 4;
-        else if (here->secondElement_ < element)
-            return 3;
-        else // first < element <= second
-            return 2;
-    }
-    // if here isn't a valid node (including nullptr)
-    return 0;
+template<typename T>
+bool twothreefourTree<T>::insert(T&& element)
+{
+    return (insertNode(root_, std::move(element)));
 }
 
 template<typename T>
-bool twothreefourTree<T>::insert(const T& element)
+template<typename... Args>
+bool twothreefourTree<T>::emplace(Args&&... args)
 {
-    return (insertNode(root_, element));
+    return insert(T(std::forward<Args>(args)...));
 }
 
 template<typename T>
-bool twothreefourTree<T>::insertNode(Node*& here, const T& element)
+template<typename U>
+bool twothreefourTree<T>::insertNode(Node*& here, U&& element)
 {
     // if the tree is empty, make a new node
-    if (!here) {
-        root_ = new Node(element, nullptr, nullptr, nullptr, 2);
+    if (here == nullptr) {
+        here = new Node(std::forward<U>(element), nullptr, nullptr, nullptr, 2);
+        ++size_;
         return true;
     }
 
-    // split 4-nodes on the way down
-    if (is4node(here))
-        split4node(here);
-
-    size_t index = belongs(here, element);
+    Node* current = here;
+    while (true) {
+        size_t index = belongs(current, element);
+        if (index < current->nodeType_ - 1 && !(element < elementAt(current, index))) {
+            return false; // the element already exists
+        }
 
-    // if we reach a leaf, insert at the leaf
-    if (isLeaf(here)) {
-        if (index == 1 && here->firstElement_ != element) {
-            here->thirdElement_ = here->secondElement_;
-            here->secondElement_ = here->firstElement_;
-            here->firstElement_ = element;
-            ++here->nodeType_;
-            return true;
+        // split 4-nodes on the way down, so that there is always room in the
+        // parent for the middle key
+        if (is4node(current)) {
+            current = split4node(current);
+            index = belongs(current, element);
         }
-        else if (index == 2 && here->secondElement_ != element) {
-            here->thirdElement_ = here->secondElement_;
-            here->secondElement_ = element;
-            ++here->nodeType_;
+
+        // if we reach a leaf, insert at the leaf
+        if (isLeaf(current)) {
+            for (size_t i = current->nodeType_ - 1; i > index; --i) {
+                elementAt(current, i) = std::move(elementAt(current, i - 1));
+            }
+            elementAt(current, index) = std::forward<U>(element);
+            ++current->nodeType_;
+            ++size_;
             return true;
         }
-        else { // either index equals 3 (something went wrong with the top-down algorithm!)
-               // or the element already exists
-            return false;
-        }
-    }
 
-    // if we're not at the leaf, go down to the appropriate subtree
-    else if (index == 1) {
-        return insertNode(here->first_, element);
-    }
-    else if (index == 2) {
-        return insertNode(here->second_, element);
-    }
-    else if (index == 3) {
-        return insertNode(here->third_, element);
-    }
-    else {
-        return false;
+        // if we're not at the leaf, go down to the appropriate subtree
+        current = childAt(current, index);
     }
 }
 
 template<typename T>
 bool twothreefourTree<T>::isLeaf(Node*& here) const
 {
-    if (here->first_ == nullptr)
-        return false;
-    if (here->second_ == nullptr)
-        return false;
-    if (here->third_ == nullptr)
-        return false;
-    if (here->fourth_ == nullptr)
-        return false;
-    return true;
+    // nodes are filled from their first child on, so a leaf has none
+    return here->first_ == nullptr;
 }
 
 template<typename T>
-void twothreefourTree<T>::split4node(Node*& here)
+typename twothreefourTree<T>::Node* twothreefourTree<T>::split4node(Node* here)
 {
-    //assert(is4node(here));    
-    
-    T midKey = here->secondElement_;
-    Node*& parent = here->parent_;
-
-    // split into two 2-nodes
-    Node* leftChild = new Node(here->firstElement_, here->first_, here->second_, parent, 2);
-    Node* rightChild = new Node(here->thirdElement_, here->third_, here->fourth_, parent, 2);
+    assert(is4node(here));
+    Node* parent = here->parent_;
 
-    // if the root of the tree is a 4-node
-    if (!parent) {
-        root_ = new Node(midKey, leftChild, rightChild, nullptr, 2);
-        ++here->size_; // growing up!
+    // here keeps the first key and its two children, a new 2-node takes the
+    // last key and the other two
+    Node* right = new Node(std::move(here->thirdElement_), here->third_, here->fourth_, parent, 2);
+    if (right->first_ != nullptr) {
+        right->first_->parent_ = right;
+        right->second_->parent_ = right;
     }
+    here->third_ = nullptr;
+    here->fourth_ = nullptr;
+    here->nodeType_ = 2;
 
-    else if (isFirstChild(here)) {
-        // fix the parent's pointers
-        parent->first_ = leftChild;
-        parent->second_ = rightChild;
-
-        // fix the parent's elements
-        parent->thirdElement_ = parent->secondElement_;
-        parent->secondElement_ = parent->firstElement_;
-        parent->firstElement_ = midKey;
-
-        ++parent->nodeType_;
-    }
-
-    else if (isSecondChild(here)) {
-        // fix the parent's pointers
-        parent->second_ = leftChild;
-        parent->third_ = rightChild;
-
-        // fix the parent's elements
-        parent->thirdElement_ = parent->secondElement_;
-        parent->secondElement_ = midKey;
-
-        ++parent->nodeType_;
+    // if the root of the tree is a 4-node, the tree grows up
+    if (parent == nullptr) {
+        root_ = new Node(std::move(here->secondElement_), here, right, nullptr, 2);
+        here->parent_ = root_;
+        right->parent_ = root_;
+        return root_;
     }
 
-    else if (isThirdChild(here)) {
-        // fix the parent's pointers
-        parent->third_ = leftChild;
-        parent->fourth_ = rightChild;
-
-        // fix the parent's elements
-        parent->thirdElement_ = midKey;
-
-        ++parent->nodeType_;
+    // otherwise make room in the parent for the middle key, just after here
+    size_t index = childIndex(here);
+    for (size_t i = parent->nodeType_ - 1; i > index; --i) {
+        elementAt(parent, i) = std::move(elementAt(parent, i - 1));
+        childAt(parent, i + 1) = childAt(parent, i);
     }
-
-    // note: here can't be the fourth child, since that means the parent was a 4-node
-}
-
-template<typename T>
-bool twothreefourTree<T>::isFirstChild(Node*& here) const
-{
-
-    if (!here)
-        return false;
-    
-    return (here->firstElement_ < here->parent_->firstElement_);
-}
-
-template<typename T>
-bool twothreefourTree<T>::isSecondChild(Node*& here) const
-{
-
-    if (!here)
-        return false;
-    
-    return (here->parent_->firstElement_ < here->firstElement_ &&
-        here->firstElement_ < here->parent_->secondElement_);
-}
-
-template<typename T>
-bool twothreefourTree<T>::isThirdChild(Node*& here) const
-{
-
-    if (!here || (!is3node(here->parent_) && !is4node(here->parent_)))
-        return false;
-    
-    return (here->parent_->secondElement_ < here->firstElement_ &&
-        here->firstElement_ < here->parent_->thirdElement_);
-}
-
-template<typename T>
-bool twothreefourTree<T>::isFourthChild(Node*& here) const
-{
-
-    if (!here || !is4node(here->parent_))
-        return false;
-    
-    return (here->parent_->thirdElement_ < here->firstElement_);
+    elementAt(parent, index) = std::move(here->secondElement_);
+    childAt(parent, index + 1) = right;
+    ++parent->nodeType_;
+    return parent;
 }
 
 template<typename T>
 bool twothreefourTree<T>::is2node(Node*& here) const
 {
-    std::cout << "is2node called" << std::endl; 
-    if (here->nodeType_ == 2) {
-        std::cout << "returning true for is2node" << std::endl; 
+    if (here->nodeType_ == 2)
         return true;
-    }
-
-    std::cout << "returning false for is2node" << std::endl; 
     return false;
 }
 
@@ -427,14 +297,6 @@ typename twothreefourTree<T>::Node* twothreefourTree<T>::getNextNode(Node* here)
     return findNode(root_, *nextNode);
 }*/
 
-template <typename T> 
-size_t twothreefourTree<T>::nodeSize(Node* here) const
-{
-    if (!here)
-        return 0;
-    return here->size_;
-}
-
 template <typename T>
 bool twothreefourTree<T>::deleteElement(const T& element)
 {
@@ -459,23 +321,125 @@ template<typename T>
 typename twothreefourTree<T>::iterator twothreefourTree<T>::begin() const
 {
     Node* current = root_;
-    std::stack<Node*> parents;
     // if tree is empty, we don't want to dereference current
     if (current == nullptr) {
-        return Iterator(current);
+        return end();
     }
-    while (current->left_ != nullptr) {
-        parents.push(current);
-        current = current->left_;
+    while (current->first_ != nullptr) {
+        current = current->first_;
     }
-    return Iterator(current);
+    return Iterator(current, 0);
 }
 
 template<typename T>
 typename twothreefourTree<T>::iterator twothreefourTree<T>::end() const
 {
-    std::stack<Node*> parents;
-    return Iterator(nullptr);
+    return Iterator(nullptr, 0);
+}
+
+template<typename T>
+typename twothreefourTree<T>::iterator twothreefourTree<T>::find(const T& element) const
+{
+    iterator bound = lower_bound(element);
+    if (bound != end() && !(element < *bound)) {
+        return bound;
+    }
+    return end();
+}
+
+template<typename T>
+typename twothreefourTree<T>::iterator twothreefourTree<T>::lower_bound(const T& element) const
+{
+    iterator bound = end();
+    Node* here = root_;
+    while (here != nullptr) {
+        // find the first of here's elements that isn't less than element,
+        // the child just before it holds everything between the two
+        size_t index = 0;
+        while (index < here->nodeType_ - 1 && elementAt(here, index) < element) {
+            ++index;
+        }
+        if (index < here->nodeType_ - 1) {
+            bound = Iterator(here, index);
+        }
+        here = childAt(here, index);
+    }
+    return bound;
+}
+
+template<typename T>
+typename twothreefourTree<T>::iterator twothreefourTree<T>::upper_bound(const T& element) const
+{
+    iterator bound = end();
+    Node* here = root_;
+    while (here != nullptr) {
+        // find the first of here's elements that is greater than element
+        size_t index = 0;
+        while (index < here->nodeType_ - 1 && !(element < elementAt(here, index))) {
+            ++index;
+        }
+        if (index < here->nodeType_ - 1) {
+            bound = Iterator(here, index);
+        }
+        here = childAt(here, index);
+    }
+    return bound;
+}
+
+template<typename T>
+std::pair<typename twothreefourTree<T>::iterator, typename twothreefourTree<T>::iterator>
+twothreefourTree<T>::equal_range(const T& element) const
+{
+    iterator first = lower_bound(element);
+    iterator last = first;
+    // the elements are unique, so at most one of them can be equal
+    if (last != end() && !(element < *last)) {
+        ++last;
+    }
+    return std::make_pair(first, last);
+}
+
+template<typename T>
+IteratorRange<typename twothreefourTree<T>::iterator> twothreefourTree<T>::range(const T& lower, const T& upper) const
+{
+    if (!(lower < upper)) {
+        return IteratorRange<iterator>(end(), end());
+    }
+    return IteratorRange<iterator>(lower_bound(lower), lower_bound(upper));
+}
+
+template<typename T>
+T& twothreefourTree<T>::elementAt(Node* here, size_t index)
+{
+    if (index == 0) {
+        return here->firstElement_;
+    } else if (index == 1) {
+        return here->secondElement_;
+    }
+    return here->thirdElement_;
+}
+
+template<typename T>
+typename twothreefourTree<T>::Node*& twothreefourTree<T>::childAt(Node* here, size_t index)
+{
+    if (index == 0) {
+        return here->first_;
+    } else if (index == 1) {
+        return here->second_;
+    } else if (index == 2) {
+        return here->third_;
+    }
+    return here->fourth_;
+}
+
+template<typename T>
+size_t twothreefourTree<T>::childIndex(Node* here)
+{
+    size_t index = 0;
+    while (childAt(here->parent_, index) != here) {
+        ++index;
+    }
+    return index;
 }
 
 // --------------------------------------
@@ -573,7 +537,9 @@ void twothreefourTree<T>::printPretty(Node* root, int level, int indentSpace, st
 // --------------------------------------
 template<typename T>
 twothreefourTree<T>::Node::Node(const T& firstElement, Node* first, Node* second, Node* parent, size_t nodeType)
-                : firstElement_{firstElement}, first_{first}, second_{second}, size_{1}, parent_{parent}, nodeType_{nodeType}
+                : firstElement_{firstElement}, first_{first}, second_{second},
+                  third_{nullptr}, fourth_{nullptr}, parent_{parent},
+                  nodeType_{nodeType}
 {
     // nothing else to do
 }
@@ -593,8 +559,8 @@ twothreefourTree<T>::Node::~Node()
 //
 // --------------------------------------
 template<typename T>
-twothreefourTree<T>::Iterator::Iterator(Node* index)
-    : current_{index}
+twothreefourTree<T>::Iterator::Iterator(Node* here, size_t index)
+    : current_{here}, index_{index}
 {
     // Nothing else to do.
 }
@@ -602,142 +568,92 @@ twothreefourTree<T>::Iterator::Iterator(Node* index)
 template<typename T>
 typename twothreefourTree<T>::Iterator& twothreefourTree<T>::Iterator::operator++()
 {
-    bool lastElement = false;
-    // empty tree
+    // incrementing end() leaves it at the end
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
+    // if there's a subtree just after this element, its leftmost element is
+    // next
+    Node* child = childAt(current_, index_ + 1);
+    if (child != nullptr) {
+        while (child->first_ != nullptr) {
+            child = child->first_;
+        }
+        current_ = child;
+        index_ = 0;
         return *this;
     }
-    // if there's something to the right, we go there then go as far to the left
-    // as we can, for example to get from 10 to 11 in this tree
-    //            10
-    //           /  \
-    //          5    15
-    //              /
-    //             12
-    //            /
-    //           11
-    if (current_->right_ != nullptr) {
-        // one step to the right
-        current_ = current_->right_;
-        // go as far to the left as we can
-        while (current_->left_ != nullptr) {
-            current_ = current_->left_;
-        }
-    } 
-    // nothing to the right and at the root node, which means we are at the
-    // last element in the tree
-    else if (current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
+    // otherwise the next element is the next one in this node, if there is one
+    if (index_ + 1 < current_->nodeType_ - 1) {
+        ++index_;
         return *this;
     }
-    // at this point we must go back up the tree to get to the next largest 
-    // value
-    // if stepping back up to the parent gives us a larger value, then we stop
-    else if (current_->parent_->element_ > current_->element_) {
+    // otherwise we go up until we come from a child that has an element after
+    // it in its parent
+    while (current_->parent_ != nullptr) {
+        size_t index = childIndex(current_);
         current_ = current_->parent_;
-    } 
-    // if stepping back up to the parent gives us a smaller value, then we keep
-    // going up until we hit a larger value
-    else if (current_->parent_->element_ < current_->element_) {
-        while (current_->parent_->element_ < current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                lastElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!lastElement) {
-            current_ = current_->parent_;
-        } 
-        // if we were at the last element, return the equivalent of the end()
-        else {
-            current_ = nullptr;
+        if (index < current_->nodeType_ - 1) {
+            index_ = index;
+            return *this;
         }
     }
+    // we were at the last element, so we are now at the end
+    current_ = nullptr;
+    index_ = 0;
     return *this;
 }
 
 template<typename T>
 typename twothreefourTree<T>::Iterator& twothreefourTree<T>::Iterator::operator--()
 {
-    // maybe something to handle -- on end()?
-
-    bool firstElement = false;
-    // empty tree
+    // decrementing end() leaves it at the end
     if (current_ == nullptr) {
         return *this;
     }
-    // tree of size 1
-    else if (current_->left_ == nullptr && current_->right_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
-    }
-    // if there is something to the left, we go there and then go to the right
-    // as far as we can
-    else if (current_->left_ != nullptr) {
-        current_ = current_->left_;
-        while (current_->right_ != nullptr) {
-            current_ = current_->right_;
+    // if there's a subtree just before this element, its rightmost element is
+    // the previous one
+    Node* child = childAt(current_, index_);
+    if (child != nullptr) {
+        while (childAt(child, child->nodeType_ - 1) != nullptr) {
+            child = childAt(child, child->nodeType_ - 1);
         }
+        current_ = child;
+        index_ = child->nodeType_ - 2;
+        return *this;
     }
-    // nothing to the left and at the root node, which means we are at the
-    // first element in the tree
-    else if (current_->left_ == nullptr && current_->parent_ == nullptr) {
-        current_ = nullptr;
-        //return *this;
+    // otherwise the previous element is the previous one in this node, if
+    // there is one
+    if (index_ > 0) {
+        --index_;
+        return *this;
     }
-    // at this point we must go back up the tree to get to the next smallest 
-    // value
-    // if stepping back up to the parent gives us a smaller value, then we stop
-    else if (current_->parent_->element_ < current_->element_) {
+    // otherwise we go up until we come from a child that has an element
+    // before it in its parent
+    while (current_->parent_ != nullptr) {
+        size_t index = childIndex(current_);
         current_ = current_->parent_;
-    }
-    // if stepping back up to the parent gives us a larger value, then we keep
-    // going up until we hit a smaller value
-    else if (current_->parent_->element_ > current_->element_) {
-        while (current_->parent_->element_ > current_->element_) {
-            // step up to the parent of the current node
-            current_ = current_->parent_;
-            // if we have stepped all the way up to the root node and it is
-            // less than the current node, we must have been coming from the
-            // largest element, and thus we are at the end
-            if (current_->parent_ == nullptr) {
-                firstElement = true;
-                break;
-            }
-        }
-        // one more pop to get to the element that is greater than the current one
-        if (!firstElement) {
-            current_ = current_->parent_;
-        } 
-        // if we were at the first element, return null (-- on begin())
-        else {
-            current_ = nullptr;
+        if (index > 0) {
+            index_ = index - 1;
+            return *this;
         }
     }
+    // we were at the first element (-- on begin())
+    current_ = nullptr;
+    index_ = 0;
     return *this;
 }
 
 template<typename T>
 T& twothreefourTree<T>::Iterator::operator*() const
 {
-    return current_->element_;
+    return elementAt(current_, index_);
 }
 
 template<typename T>
 bool twothreefourTree<T>::Iterator::operator==(const Iterator& rhs) const
 {
-    return (current_ == rhs.current_);
+    return current_ == rhs.current_ && index_ == rhs.index_;
 }
 
 template<typename T>
@@ -745,4 +661,3 @@ bool twothreefourTree<T>::Iterator::operator!=(const Iterator& rhs) const
 {
     return !(*this == rhs);
 }
-
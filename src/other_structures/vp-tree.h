@@ -5,155 +5,435 @@
 #include <algorithm>
 #include <vector>
 #include <stdio.h>
-#include <queue>
 #include <limits>
+#include <stdint.h>
 
-template<typename T, double (*distance)( const T&, const T& )>
+// the number of bits set in x
+inline unsigned popcount64( uint64_t x )
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll( x );
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return unsigned((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// A metric is a functor with a Distance type and a const operator() giving
+// the distance between two items, which has to be a metric for the pruning
+// to be right. Distance can be any arithmetic type, integers are cheapest.
+
+// Hamming distance between 64 bit hashes
+struct Hamming64
+{
+    typedef unsigned Distance;
+
+    unsigned operator()( uint64_t a, uint64_t b ) const {
+        return popcount64( a ^ b );
+    }
+};
+
+struct Hash128
+{
+    uint64_t high;
+    uint64_t low;
+};
+
+// Hamming distance between 128 bit hashes
+struct Hamming128
+{
+    typedef unsigned Distance;
+
+    unsigned operator()( const Hash128& a, const Hash128& b ) const {
+        return popcount64( a.high ^ b.high ) + popcount64( a.low ^ b.low );
+    }
+};
+
+template<typename T, typename Metric>
 class VpTree
 {
 public:
-    VpTree() : _root(0) {}
+    typedef typename Metric::Distance Distance;
 
-    ~VpTree() {
-        delete _root;
-    }
+    // Subtrees of at most leafSize items are kept as buckets, which a
+    // search scores one after another instead of pruning item by item.
+    explicit VpTree( int leafSize = 16, const Metric& metric = Metric() ) :
+        _root(NONE),
+        _leafSize(leafSize < 1 ? 1 :
+                  leafSize > MAX_LEAF_SIZE ? MAX_LEAF_SIZE : leafSize),
+        _metric(metric) {}
 
     void create( const std::vector<T>& items ) {
-        delete _root;
-        _items = items;
+        // one allocation for the whole tree, which the vector frees at once
+        _nodes.clear();
+        _nodes.reserve( items.size() );
+        for ( size_t i = 0; i < items.size(); ++i ) {
+            _nodes.push_back( Node( items[i] ) );
+        }
         _root = buildFromPoints(0, items.size());
     }
 
     void search( const T& target, int k, std::vector<T>* results,
-                 std::vector<double>* distances) const
+                 std::vector<Distance>* distances) const
     {
-        std::priority_queue<HeapItem> heap;
-
-        double _tau = std::numeric_limits<double>::max();
-        search( _root, target, k, heap, _tau );
+        Query query;
+        size_t count = k < 0 ? 0 : std::min( size_t(k), _nodes.size() );
+        std::vector<const T*> found( count );
+        distances->resize( count );
+        count = search( target, count, query, found.data(),
+                        distances->data() );
+
+        results->clear();
+        for ( size_t i = 0; i < count; ++i ) {
+            results->push_back( *found[i] );
+        }
+        distances->resize( count );
+    }
 
-        results->clear(); distances->clear();
+    // Scratch space for searches, see below.
+    class Query;
 
-        while( !heap.empty() ) {
-            results->push_back( _items[heap.top().index] );
-            distances->push_back( heap.top().dist );
-            heap.pop();
+    // Finds the k nearest items to target, nearest first, writing where
+    // they are to results and how far they are to distances, which both
+    // need room for k. Returns how many there were. The items stay where
+    // they are until the next create. Once query has served a search for
+    // as many items, no search with it allocates.
+    size_t search( const T& target, size_t k, Query& query,
+                   const T** results, Distance* distances ) const
+    {
+        // asking for more than there are is asking for all of them
+        k = std::min( k, _nodes.size() );
+        if ( k == 0 ) {
+            return 0;
+        }
+        size_t count;
+        if ( k <= SMALL_K ) {
+            SmallHeap heap( k );
+            search( target, heap, query._stack );
+            count = heap.size;
+            for ( size_t i = 0; i < count; ++i ) {
+                results[i] = &_nodes[heap.items[i].index].item;
+                distances[i] = heap.items[i].dist;
+            }
+        } else {
+            LargeHeap heap( k, query._heap );
+            search( target, heap, query._stack );
+            std::sort_heap( query._heap.begin(), query._heap.end() );
+            count = query._heap.size();
+            for ( size_t i = 0; i < count; ++i ) {
+                results[i] = &_nodes[query._heap[i].index].item;
+                distances[i] = query._heap[i].dist;
+            }
         }
+        return count;
+    }
 
-        std::reverse( results->begin(), results->end() );
-        std::reverse( distances->begin(), distances->end() );
+    // Finds the items at most r from target, in no particular order, keeping
+    // the first limit found. Returns false if there were more than limit.
+    bool searchRadius( const T& target, Distance r, std::vector<T>* results,
+                       std::vector<Distance>* distances,
+                       size_t limit = std::numeric_limits<size_t>::max() ) const
+    {
+        results->clear(); distances->clear();
+        return forEachInRadius( target, r, Collector( results, distances ),
+                                limit );
     }
 
-private:
-    std::vector<T> _items;
+    // Calls visit( item, distance ) for each item at most r from target as
+    // it is found, which needs nothing stored, up to limit of them. Returns
+    // false if there were more than limit.
+    template<typename Visitor>
+    bool forEachInRadius( const T& target, Distance r, Visitor visit,
+                          size_t limit = std::numeric_limits<size_t>::max() ) const
+    {
+        size_t found = 0;
+        return searchRadius( _root, target, r, visit, limit, found );
+    }
 
+private:
+    static const int32_t NONE = -1;
+    static const int32_t BUCKET = -2;
+    static const int MAX_LEAF_SIZE = 64;
+    static const size_t SMALL_K = 16;
+    static const int MAX_DEPTH = 48;
+
+    // Nodes live in one array in the order they were built, children being
+    // indices into it. The vantage item is kept in its node, next to the
+    // threshold, so a visit reads one place. A node's subtree is the run of
+    // nodes starting at it, its left child is the next node if it has one.
+    // A bucket is a node whose left is BUCKET and whose right is the end of
+    // its run, the items in the run having no order.
     struct Node
     {
-        int index;
-        double threshold;
-        Node* left;
-        Node* right;
+        T item;
+        Distance threshold;
+        int32_t left;
+        int32_t right;
 
-        Node() :
-            index(0), threshold(0.), left(0), right(0) {}
+        explicit Node( const T& item ) :
+            item(item), threshold(0), left(NONE), right(NONE) {}
+    };
 
-        ~Node() {
-            delete left;
-            delete right;
-        }
-    }* _root;
+    std::vector<Node> _nodes;
+    int32_t _root;
+    int _leafSize;
+    Metric _metric;
 
     struct HeapItem {
-        HeapItem( int index, double dist) :
+        HeapItem() : index(0), dist(0) {}
+        HeapItem( int index, Distance dist) :
             index(index), dist(dist) {}
         int index;
-        double dist;
+        Distance dist;
         bool operator<( const HeapItem& o ) const {
             return dist < o.dist;
         }
     };
 
+    // The nearest items so far for up to SMALL_K of them, kept sorted in
+    // place, which beats a heap at these sizes and needs no allocation.
+    struct SmallHeap
+    {
+        HeapItem items[SMALL_K];
+        size_t size;
+        size_t k;
+        Distance tau;   // the distance to beat
+
+        explicit SmallHeap( size_t k ) :
+            size(0), k(k), tau(std::numeric_limits<Distance>::max()) {}
+
+        // returns the distance to beat afterwards
+        Distance push( int index, Distance dist ) {
+            size_t i = size < k ? size++ : k - 1;
+            for ( ; i > 0 && dist < items[i - 1].dist; --i ) {
+                items[i] = items[i - 1];
+            }
+            items[i] = HeapItem( index, dist );
+            if ( size == k ) tau = items[k - 1].dist;
+            return tau;
+        }
+    };
+
+    // The nearest k items so far, a max heap in storage kept by a Query.
+    struct LargeHeap
+    {
+        std::vector<HeapItem>& items;
+        size_t k;
+        Distance tau;   // the distance to beat
+
+        LargeHeap( size_t k, std::vector<HeapItem>& items ) :
+            items(items), k(k), tau(std::numeric_limits<Distance>::max()) {
+            items.clear();
+            items.reserve( k );
+        }
+
+        // returns the distance to beat afterwards
+        Distance push( int index, Distance dist ) {
+            if ( items.size() == k ) {
+                std::pop_heap( items.begin(), items.end() );
+                items.pop_back();
+            }
+            items.push_back( HeapItem( index, dist ) );
+            std::push_heap( items.begin(), items.end() );
+            if ( items.size() == k ) tau = items.front().dist;
+            return tau;
+        }
+    };
+
+    // A subtree still to search, if the ball around the target still
+    // reaches gap past its parent's threshold.
+    struct Frame
+    {
+        Frame() : index(NONE), gap(0) {}
+        Frame( int32_t index, Distance gap ) : index(index), gap(gap) {}
+        int32_t index;
+        Distance gap;
+    };
+
+    struct Collector
+    {
+        std::vector<T>* results;
+        std::vector<Distance>* distances;
+        Collector( std::vector<T>* results, std::vector<Distance>* distances ) :
+            results(results), distances(distances) {}
+        void operator()( const T& item, Distance dist ) {
+            results->push_back( item );
+            distances->push_back( dist );
+        }
+    };
+
     struct DistanceComparator
     {
+        const Metric& distance;
         const T& item;
-        DistanceComparator( const T& item ) : item(item) {}
-        bool operator()(const T& a, const T& b) {
-            return distance( item, a ) < distance( item, b );
+        DistanceComparator( const Metric& distance, const T& item ) :
+            distance(distance), item(item) {}
+        bool operator()(const Node& a, const Node& b) {
+            return distance( item, a.item ) < distance( item, b.item );
         }
     };
 
-    Node* buildFromPoints( int lower, int upper )
+    int32_t buildFromPoints( int lower, int upper )
     {
         if ( upper == lower ) {
-            return NULL;
+            return NONE;
         }
 
-        Node* node = new Node();
-        node->index = lower;
-
-        if ( upper - lower > 1 ) {
+        Node& node = _nodes[lower];
 
+        if ( upper - lower <= _leafSize ) {
+            node.left = BUCKET;
+            node.right = upper;
+        } else {
             // choose an arbitrary point and move it to the start
             int i = (int)((double)rand() / RAND_MAX * (upper - lower - 1) ) + lower;
-            std::swap( _items[lower], _items[i] );
+            std::swap( _nodes[lower], _nodes[i] );
 
             int median = ( upper + lower ) / 2;
 
             // partitian around the median distance
             std::nth_element(
-                        _items.begin() + lower + 1,
-                        _items.begin() + median,
-                        _items.begin() + upper,
-                        DistanceComparator( _items[lower] ));
+                        _nodes.begin() + lower + 1,
+                        _nodes.begin() + median,
+                        _nodes.begin() + upper,
+                        DistanceComparator( _metric, node.item ));
 
             // what was the median?
-            node->threshold = distance( _items[lower], _items[median] );
+            node.threshold = _metric( node.item, _nodes[median].item );
 
-            node->index = lower;
-            node->left = buildFromPoints( lower + 1, median );
-            node->right = buildFromPoints( median, upper );
+            node.left = buildFromPoints( lower + 1, median );
+            node.right = buildFromPoints( median, upper );
         }
 
-        return node;
+        return lower;
     }
 
-    void search( Node* node, const T& target, size_t k,
-                 std::priority_queue<HeapItem>& heap, double &_tau ) const
+    template<typename Heap>
+    void search( const T& target, Heap& heap, Frame* stack ) const
     {
-        if ( node == NULL ) return;
+        Distance tau = heap.tau;
+        size_t top = 0;
+        int32_t index = _root;
+        for (;;) {
+            // Go down the near side, leaving the far side on the stack
+            // until the near side has shrunk the ball. Inside the threshold
+            // the left side is near, outside it the right side is. The far
+            // side is searched if the ball of radius tau reaches across the
+            // threshold, written so that unsigned distances can't wrap and
+            // a tau of max can't overflow.
+            while ( index != NONE ) {
+                const Node* node = &_nodes[index];
+                if ( node->left == BUCKET ) {
+                    tau = searchBucket( index, node->right, target, heap );
+                    break;
+                }
+
+                Distance dist = _metric( node->item, target );
+                if ( dist < tau ) {
+                    tau = heap.push( index, dist );
+                }
+
+                int32_t far;
+                Distance gap;
+                if ( dist < node->threshold ) {
+                    far = node->right;
+                    gap = node->threshold - dist;
+                    index = node->left;
+                } else {
+                    far = node->left;
+                    gap = dist - node->threshold;
+                    index = node->right;
+                }
+                if ( far != NONE && gap <= tau ) {
+                    stack[top++] = Frame( far, gap );
+                }
+            }
 
-        double dist = distance( _items[node->index], target );
-        //printf("dist=%g tau=%gn", dist, _tau );
+            // the ball may have shrunk since a frame was pushed
+            do {
+                if ( top == 0 ) {
+                    return;
+                }
+                --top;
+            } while ( stack[top].gap > tau );
+            index = stack[top].index;
+        }
+    }
 
-        if ( dist < _tau ) {
-            if ( heap.size() == k ) heap.pop();
-            heap.push( HeapItem(node->index, dist) );
-            if ( heap.size() == k ) _tau = heap.top().dist;
+    template<typename Visitor>
+    bool searchRadius( int32_t index, const T& target, Distance r,
+                       Visitor& visit, size_t limit, size_t& found ) const
+    {
+        if ( index == NONE ) return true;
+
+        const Node* node = &_nodes[index];
+        if ( node->left == BUCKET ) {
+            for ( int32_t i = index; i < node->right; ++i ) {
+                Distance dist = _metric( _nodes[i].item, target );
+                if ( dist <= r ) {
+                    if ( found == limit ) return false;
+                    visit( _nodes[i].item, dist );
+                    ++found;
+                }
+            }
+            return true;
         }
 
-        if ( node->left == NULL && node->right == NULL ) {
-            return;
+        Distance dist = _metric( node->item, target );
+        if ( dist <= r ) {
+            if ( found == limit ) return false;
+            visit( node->item, dist );
+            ++found;
         }
 
+        // the same pruning as search, with the radius r standing in for tau
         if ( dist < node->threshold ) {
-            if ( dist - _tau <= node->threshold ) {
-                search( node->left, target, k, heap, _tau );
-            }
-
-            if ( dist + _tau >= node->threshold ) {
-                search( node->right, target, k, heap, _tau );
-            }
+            return searchRadius( node->left, target, r, visit, limit, found ) &&
+                   ( node->threshold - dist > r ||
+                     searchRadius( node->right, target, r, visit, limit,
+                                   found ) );
+        }
+        return searchRadius( node->right, target, r, visit, limit, found ) &&
+               ( dist - node->threshold > r ||
+                 searchRadius( node->left, target, r, visit, limit, found ) );
+    }
 
-        } else {
-            if ( dist + _tau >= node->threshold ) {
-                search( node->right, target, k, heap, _tau );
-            }
+    // returns the distance to beat afterwards
+    template<typename Heap>
+    Distance searchBucket( int32_t first, int32_t last, const T& target,
+                           Heap& heap ) const
+    {
+        // score the whole bucket before touching the heap, so the first
+        // loop is nothing but distances
+        Distance dists[MAX_LEAF_SIZE];
+        const Node* nodes = &_nodes[first];
+        int count = last - first;
+        for ( int i = 0; i < count; ++i ) {
+            dists[i] = _metric( nodes[i].item, target );
+        }
 
-            if ( dist - _tau <= node->threshold ) {
-                search( node->left, target, k, heap, _tau );
+        Distance tau = heap.tau;
+        for ( int i = 0; i < count; ++i ) {
+            if ( dists[i] < tau ) {
+                tau = heap.push( first + i, dists[i] );
             }
         }
+        return tau;
     }
+
+public:
+    class Query
+    {
+    private:
+        friend class VpTree;
+
+        std::vector<HeapItem> _heap;
+        // A search keeps at most one frame per level, and halving 2^31
+        // items down to one takes 31 levels.
+        Frame _stack[MAX_DEPTH];
+    };
 };
 
 #endif // VPTREE_H
\ No newline at end of file
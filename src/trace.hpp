@@ -0,0 +1,204 @@
+/**
+ * \file trace.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief recording the operations done on a tree and reading them back
+ *
+ * \details A trace file is a 32 byte header followed by its records, each
+ * an operation and an int32_t key, in one of two encodings:
+ *
+ *  - RAW stores every record as a TraceRecord, 8 bytes in the byte order
+ *    of the machine that wrote it, so a mapped trace can be used in place.
+ *  - DELTA stores every record as one unsigned LEB128 varint holding the
+ *    zigzagged difference from the previous key shifted left by two, with
+ *    the operation in the low two bits. Keys that are close together take a
+ *    byte or two.
+ *
+ * The record count in the header is 64 bits, so a trace can hold as many
+ * records as the file system allows.
+ */
+
+#ifndef TRACE_HPP_INCLUDED
+#define TRACE_HPP_INCLUDED 1
+#include "abstracttree.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class TraceOperation : uint32_t {
+    READ,
+    INSERT,
+    DELETE,
+    SCAN     ///> visits the keys from key onwards, how many isn't recorded
+};
+
+enum class TraceEncoding : uint32_t {
+    RAW,
+    DELTA
+};
+
+/**
+ * \brief one operation on one key
+ */
+struct TraceRecord {
+    TraceOperation operation_;
+    int32_t key_;
+};
+
+/**
+* \class TraceWriter
+* \brief Appends records to a new trace file
+*
+* \note not thread safe, a writer shared between threads needs a lock
+*/
+class TraceWriter {
+public:
+    /**
+    * \brief
+    * Constructor, creates or truncates the file at path
+    *
+    * \note check good() to see whether the file could be opened
+    */
+    TraceWriter(const std::string& path, TraceEncoding encoding);
+
+    /**
+    * \brief
+    * Destructor, finishes the file if close() wasn't called
+    */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    void append(TraceOperation operation, int32_t key);
+
+    /**
+    * \brief writes the record count into the header and closes the file
+    *
+    * \returns true if everything was written
+    */
+    bool close();
+
+    /**
+    * \brief returns false if the file couldn't be opened or written
+    */
+    bool good() const;
+
+    uint64_t records() const;
+
+private:
+    FILE* file_;
+    TraceEncoding encoding_;
+    uint64_t records_;
+    int32_t previous_;     ///> the last key, for DELTA
+    bool failed_;
+};
+
+/**
+* \class TraceReader
+* \brief Maps a trace file into memory and hands out its records in order
+*/
+class TraceReader {
+public:
+    /**
+    * \brief
+    * Constructor, maps the file at path
+    *
+    * \note check good() to see whether it was a trace that could be mapped
+    */
+    explicit TraceReader(const std::string& path);
+
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    /**
+    * \brief returns false if the file couldn't be mapped, isn't a trace or
+    * is cut short
+    */
+    bool good() const;
+
+    TraceEncoding encoding() const;
+
+    uint64_t records() const;
+
+    /**
+    * \brief
+    * Hands out up to count of the records after the last ones handed out
+    *
+    * \details RAW records point straight into the mapping, DELTA records
+    * are decoded into a buffer that the next call reuses
+    *
+    * \returns the number of records at records, 0 once there are no more
+    */
+    size_t next(const TraceRecord*& records, size_t count);
+
+    /**
+    * \brief starts handing out records from the first one again
+    */
+    void rewind();
+
+private:
+    void* mapping_;
+    size_t length_;
+    TraceEncoding encoding_;
+    uint64_t records_;
+    uint64_t handedOut_;
+    const unsigned char* position_;   ///> the next byte to decode
+    int32_t previous_;                ///> the last key decoded, for DELTA
+    std::vector<TraceRecord> decoded_;
+    bool good_;
+};
+
+/**
+* \class TracingTree
+* \brief Passes every call on to another tree, recording it in a trace first
+*
+* \details reads, inserts and deletes are recorded whatever their outcome,
+* so replaying the trace repeats exactly the calls that were made
+*/
+template <typename T>
+class TracingTree : public AbstractTree<T> {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= sizeof(int32_t),
+                  "traces hold 32 bit keys");
+
+public:
+    /**
+    * \brief
+    * Constructor, tree and writer have to outlive the TracingTree
+    */
+    TracingTree(AbstractTree<T>& tree, TraceWriter& writer);
+
+    size_t size() const override;
+
+    bool insert(const T& element) override;
+
+    bool insert(T&& element) override;
+
+    bool contains(const T& element) const override;
+
+    bool deleteElement(const T& element) override;
+
+    std::ostream& printStatistics(std::ostream& out) const override;
+
+private:
+    AbstractTree<T>& tree_;
+    TraceWriter& writer_;
+};
+
+#include "trace_private.hpp"
+
+#endif // TRACE_HPP_INCLUDED
@@ -0,0 +1,261 @@
+/**
+ * \file trace_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the trace writer, reader and tracing tree
+ */
+
+/**
+ * \brief what every trace file starts with
+ */
+struct TraceHeader {
+    char magic_[8];
+    uint32_t version_;
+    TraceEncoding encoding_;
+    uint64_t records_;
+    uint64_t reserved_;
+};
+
+static_assert(sizeof(TraceRecord) == 8, "RAW records are mapped in place");
+static_assert(sizeof(TraceHeader) == 32, "the header has a fixed size");
+
+static const char TRACE_MAGIC[8] = {'B', 'S', 'T', 'T', 'R', 'A', 'C', 'E'};
+static const uint32_t TRACE_VERSION = 1;
+
+// ----- TraceWriter -----
+
+inline TraceWriter::TraceWriter(const std::string& path,
+                                TraceEncoding encoding)
+    : file_{fopen(path.c_str(), "wb")}, encoding_{encoding}, records_{0},
+      previous_{0}, failed_{false}
+{
+    // the count is filled in by close
+    TraceHeader header;
+    memcpy(header.magic_, TRACE_MAGIC, sizeof(header.magic_));
+    header.version_ = TRACE_VERSION;
+    header.encoding_ = encoding;
+    header.records_ = 0;
+    header.reserved_ = 0;
+    failed_ = file_ == nullptr ||
+              fwrite(&header, sizeof(header), 1, file_) != 1;
+}
+
+inline TraceWriter::~TraceWriter()
+{
+    close();
+}
+
+inline void TraceWriter::append(TraceOperation operation, int32_t key)
+{
+    if (file_ == nullptr) {
+        return;
+    }
+    if (encoding_ == TraceEncoding::RAW) {
+        TraceRecord record{operation, key};
+        failed_ |= fwrite(&record, sizeof(record), 1, file_) != 1;
+    } else {
+        int64_t delta = int64_t(key) - previous_;
+        uint64_t zigzag = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+        uint64_t value = (zigzag << 2) | uint64_t(operation);
+        unsigned char bytes[10];
+        size_t length = 0;
+        do {
+            unsigned char byte = value & 0x7f;
+            value >>= 7;
+            bytes[length++] = value != 0 ? byte | 0x80 : byte;
+        } while (value != 0);
+        failed_ |= fwrite(bytes, 1, length, file_) != length;
+        previous_ = key;
+    }
+    ++records_;
+}
+
+inline bool TraceWriter::close()
+{
+    if (file_ == nullptr) {
+        return !failed_;
+    }
+    size_t offset = offsetof(TraceHeader, records_);
+    failed_ |= fseek(file_, long(offset), SEEK_SET) != 0 ||
+               fwrite(&records_, sizeof(records_), 1, file_) != 1;
+    failed_ |= fclose(file_) != 0;
+    file_ = nullptr;
+    return !failed_;
+}
+
+inline bool TraceWriter::good() const
+{
+    return !failed_;
+}
+
+inline uint64_t TraceWriter::records() const
+{
+    return records_;
+}
+
+// ----- TraceReader -----
+
+inline TraceReader::TraceReader(const std::string& path)
+    : mapping_{MAP_FAILED}, length_{0}, encoding_{TraceEncoding::RAW},
+      records_{0}, handedOut_{0}, position_{nullptr}, previous_{0},
+      decoded_{}, good_{false}
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file == -1) {
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 &&
+        size_t(status.st_size) >= sizeof(TraceHeader)) {
+        length_ = size_t(status.st_size);
+        mapping_ = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // the mapping stays valid without the file
+    ::close(file);
+    if (mapping_ == MAP_FAILED) {
+        return;
+    }
+    madvise(mapping_, length_, MADV_SEQUENTIAL);
+    TraceHeader header;
+    memcpy(&header, mapping_, sizeof(header));
+    if (memcmp(header.magic_, TRACE_MAGIC, sizeof(header.magic_)) != 0 ||
+        header.version_ != TRACE_VERSION ||
+        (header.encoding_ != TraceEncoding::RAW &&
+         header.encoding_ != TraceEncoding::DELTA)) {
+        return;
+    }
+    encoding_ = header.encoding_;
+    records_ = header.records_;
+    size_t body = length_ - sizeof(TraceHeader);
+    if (encoding_ == TraceEncoding::RAW) {
+        good_ = records_ <= body / sizeof(TraceRecord);
+    } else {
+        // every record takes at least a byte
+        good_ = records_ <= body;
+    }
+    rewind();
+}
+
+inline TraceReader::~TraceReader()
+{
+    if (mapping_ != MAP_FAILED) {
+        munmap(mapping_, length_);
+    }
+}
+
+inline bool TraceReader::good() const
+{
+    return good_;
+}
+
+inline TraceEncoding TraceReader::encoding() const
+{
+    return encoding_;
+}
+
+inline uint64_t TraceReader::records() const
+{
+    return records_;
+}
+
+inline size_t TraceReader::next(const TraceRecord*& records, size_t count)
+{
+    if (!good_) {
+        return 0;
+    }
+    if (uint64_t(count) > records_ - handedOut_) {
+        count = size_t(records_ - handedOut_);
+    }
+    if (encoding_ == TraceEncoding::RAW) {
+        records = reinterpret_cast<const TraceRecord*>(position_);
+        position_ += count * sizeof(TraceRecord);
+        handedOut_ += count;
+        return count;
+    }
+    const unsigned char* end =
+        static_cast<const unsigned char*>(mapping_) + length_;
+    decoded_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t value = 0;
+        unsigned shift = 0;
+        unsigned char byte;
+        do {
+            if (position_ == end || shift > 63) {
+                // cut short or garbled, stop here for good
+                good_ = false;
+                decoded_.resize(i);
+                handedOut_ += i;
+                records = decoded_.data();
+                return i;
+            }
+            byte = *position_++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        uint64_t zigzag = value >> 2;
+        int64_t delta = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+        previous_ = int32_t(previous_ + delta);
+        decoded_[i] = TraceRecord{TraceOperation(value & 3), previous_};
+    }
+    handedOut_ += count;
+    records = decoded_.data();
+    return count;
+}
+
+inline void TraceReader::rewind()
+{
+    position_ = static_cast<const unsigned char*>(mapping_) +
+                sizeof(TraceHeader);
+    handedOut_ = 0;
+    previous_ = 0;
+}
+
+// ----- TracingTree -----
+
+template <typename T>
+TracingTree<T>::TracingTree(AbstractTree<T>& tree, TraceWriter& writer)
+    : tree_(tree), writer_(writer)
+{
+    // nothing else to do
+}
+
+template <typename T>
+size_t TracingTree<T>::size() const
+{
+    return tree_.size();
+}
+
+template <typename T>
+bool TracingTree<T>::insert(const T& element)
+{
+    writer_.append(TraceOperation::INSERT, int32_t(element));
+    return tree_.insert(element);
+}
+
+template <typename T>
+bool TracingTree<T>::insert(T&& element)
+{
+    writer_.append(TraceOperation::INSERT, int32_t(element));
+    return tree_.insert(std::move(element));
+}
+
+template <typename T>
+bool TracingTree<T>::contains(const T& element) const
+{
+    writer_.append(TraceOperation::READ, int32_t(element));
+    return tree_.contains(element);
+}
+
+template <typename T>
+bool TracingTree<T>::deleteElement(const T& element)
+{
+    writer_.append(TraceOperation::DELETE, int32_t(element));
+    return tree_.deleteElement(element);
+}
+
+template <typename T>
+std::ostream& TracingTree<T>::printStatistics(std::ostream& out) const
+{
+    out << "traced " << writer_.records() << " operations" << std::endl;
+    return tree_.printStatistics(out);
+}
@@ -0,0 +1,172 @@
+/**
+ * \file work_stealing_pool.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief a small fork-join thread pool for the trees' bulk operations
+ *
+ * \details invoke(left, right) may hand right to another thread while the
+ * caller runs left. Every thread keeps its own deque of handed off work,
+ * running the newest item itself and letting idle threads steal the oldest,
+ * which for divide and conquer is the biggest piece left. A thread that has
+ * to wait for work someone stole from it runs other work in the meantime,
+ * so nesting invoke never leaves a thread blocked.
+ */
+
+#ifndef WORK_STEALING_POOL_HPP_INCLUDED
+#define WORK_STEALING_POOL_HPP_INCLUDED 1
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+* \class WorkStealingPool
+* \brief A fixed set of threads that run the halves of fork-join work
+*
+* \note a pool of n threads starts n - 1 of its own, the thread calling
+* invoke is the last one. With a single thread invoke just runs both halves
+* in order.
+*/
+
+class WorkStealingPool {
+
+public:
+    /**
+    * \brief
+    * Constructor
+    *
+    * \param threads the number of threads working on each invoke, counting
+    * the caller's
+    */
+    explicit WorkStealingPool(size_t threads = defaultThreads());
+
+    /**
+    * \brief
+    * Destructor, waits for the pool's threads to finish
+    *
+    * \warning no invoke may still be running
+    */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+    * \brief returns the number of threads working on each invoke
+    */
+    size_t threads() const;
+
+    /**
+    * \brief
+    * Runs left and right, possibly at the same time, and returns once both
+    * are done
+    *
+    * \details if either throws, the exception is passed on once both are
+    * done
+    */
+    template <typename Left, typename Right>
+    void invoke(Left&& left, Right&& right);
+
+    /**
+    * \brief returns a pool with one thread per core, started the first time
+    * it is used
+    */
+    static WorkStealingPool& shared();
+
+    /**
+    * \brief returns the number of cores, or 1 if that isn't known
+    */
+    static size_t defaultThreads();
+
+private:
+    /**
+    * \brief work handed off by invoke, which owns it and waits for it
+    */
+    struct Task {
+        std::function<void()> work_;
+        std::atomic<bool> done_;       ///> set once work_ has returned
+        std::exception_ptr error_;     ///> whatever work_ threw
+
+        template <typename Work>
+        explicit Task(Work&& work);
+    };
+
+    /**
+    * \brief one thread's deque, its owner works at the back and thieves
+    * take from the front
+    */
+    struct Worker {
+        std::mutex lock_;
+        std::deque<Task*> tasks_;
+    };
+
+    /**
+    * \brief which pool and deque the running thread belongs to
+    */
+    struct Identity {
+        const WorkStealingPool* pool_;
+        size_t worker_;
+    };
+
+    // deque 0 is shared by every thread outside the pool
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_;   ///> tasks sitting in any deque
+    std::atomic<bool> stopping_;
+    std::mutex sleepLock_;
+    std::condition_variable wakeUp_;
+
+    /**
+    * \brief returns the running thread's deque
+    */
+    size_t currentWorker() const;
+
+    static Identity& identity();
+
+    /**
+    * \brief puts task on the back of a deque and wakes a sleeping thread
+    */
+    void push(size_t worker, Task* task);
+
+    /**
+    * \brief takes task back out of a deque, unless it was already stolen
+    *
+    * \returns true if the task was still there
+    */
+    bool reclaim(size_t worker, Task* task);
+
+    /**
+    * \brief finds something to run, the newest task in worker's own deque or
+    * else the oldest one in any other deque
+    *
+    * \returns nullptr if every deque is empty
+    */
+    Task* take(size_t worker);
+
+    /**
+    * \brief runs a task, catching whatever it throws
+    */
+    static void run(Task* task);
+
+    /**
+    * \brief runs tasks until task is done
+    */
+    void helpUntilDone(size_t worker, Task* task);
+
+    /**
+    * \brief what each of the pool's threads does until the pool goes away
+    */
+    void workerLoop(size_t worker);
+};
+
+#include "work_stealing_pool_private.hpp"
+
+#endif // WORK_STEALING_POOL_HPP_INCLUDED
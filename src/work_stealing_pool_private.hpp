@@ -0,0 +1,198 @@
+/**
+ * \file work_stealing_pool_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the work stealing pool
+ */
+
+inline WorkStealingPool::WorkStealingPool(size_t threads)
+            : workers_{}, threads_{}, queued_{0}, stopping_{false}
+{
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(new Worker);
+    }
+    // the caller of invoke is the last thread
+    for (size_t i = 1; i < threads; ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+inline WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> guard{sleepLock_};
+        stopping_ = true;
+    }
+    wakeUp_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+inline size_t WorkStealingPool::threads() const
+{
+    return workers_.size();
+}
+
+template <typename Left, typename Right>
+void WorkStealingPool::invoke(Left&& left, Right&& right)
+{
+    if (workers_.size() == 1) {
+        left();
+        right();
+        return;
+    }
+    size_t self = currentWorker();
+    Task task{std::forward<Right>(right)};
+    push(self, &task);
+    std::exception_ptr leftError;
+    try {
+        left();
+    } catch (...) {
+        leftError = std::current_exception();
+    }
+    // the task lives on this stack, so it has to be finished before we leave
+    if (reclaim(self, &task)) {
+        run(&task);
+    } else {
+        helpUntilDone(self, &task);
+    }
+    if (leftError != nullptr) {
+        std::rethrow_exception(leftError);
+    }
+    if (task.error_ != nullptr) {
+        std::rethrow_exception(task.error_);
+    }
+}
+
+inline WorkStealingPool& WorkStealingPool::shared()
+{
+    static WorkStealingPool pool;
+    return pool;
+}
+
+inline size_t WorkStealingPool::defaultThreads()
+{
+    size_t cores = std::thread::hardware_concurrency();
+    return cores != 0 ? cores : 1;
+}
+
+template <typename Work>
+WorkStealingPool::Task::Task(Work&& work)
+    : work_{std::forward<Work>(work)}, done_{false}, error_{}
+{
+    // nothing else to do
+}
+
+inline size_t WorkStealingPool::currentWorker() const
+{
+    const Identity& self = identity();
+    return self.pool_ == this ? self.worker_ : 0;
+}
+
+inline WorkStealingPool::Identity& WorkStealingPool::identity()
+{
+    static thread_local Identity self{nullptr, 0};
+    return self;
+}
+
+inline void WorkStealingPool::push(size_t worker, Task* task)
+{
+    {
+        std::lock_guard<std::mutex> guard{workers_[worker]->lock_};
+        // counted first, so nobody can take it and count it out before
+        // it was counted in
+        ++queued_;
+        workers_[worker]->tasks_.push_back(task);
+    }
+    // taking the lock keeps the wake up from slipping in between a sleeping
+    // thread checking queued_ and starting to wait
+    {
+        std::lock_guard<std::mutex> guard{sleepLock_};
+    }
+    wakeUp_.notify_one();
+}
+
+inline bool WorkStealingPool::reclaim(size_t worker, Task* task)
+{
+    std::lock_guard<std::mutex> guard{workers_[worker]->lock_};
+    std::deque<Task*>& tasks = workers_[worker]->tasks_;
+    // outside threads share a deque, so task isn't always at the back
+    for (auto i = tasks.rbegin(); i != tasks.rend(); ++i) {
+        if (*i == task) {
+            tasks.erase(std::next(i).base());
+            --queued_;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline WorkStealingPool::Task* WorkStealingPool::take(size_t worker)
+{
+    if (queued_ == 0) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        size_t victim = (worker + i) % workers_.size();
+        std::lock_guard<std::mutex> guard{workers_[victim]->lock_};
+        std::deque<Task*>& tasks = workers_[victim]->tasks_;
+        if (tasks.empty()) {
+            continue;
+        }
+        Task* task;
+        if (victim == worker) {
+            task = tasks.back();
+            tasks.pop_back();
+        } else {
+            task = tasks.front();
+            tasks.pop_front();
+        }
+        --queued_;
+        return task;
+    }
+    return nullptr;
+}
+
+inline void WorkStealingPool::run(Task* task)
+{
+    try {
+        task->work_();
+    } catch (...) {
+        task->error_ = std::current_exception();
+    }
+    // the owner may free the task as soon as it sees this
+    task->done_.store(true, std::memory_order_release);
+}
+
+inline void WorkStealingPool::helpUntilDone(size_t worker, Task* task)
+{
+    while (!task->done_.load(std::memory_order_acquire)) {
+        Task* other = take(worker);
+        if (other != nullptr) {
+            run(other);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void WorkStealingPool::workerLoop(size_t worker)
+{
+    identity() = Identity{this, worker};
+    while (true) {
+        Task* task = take(worker);
+        if (task != nullptr) {
+            run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{sleepLock_};
+        wakeUp_.wait(lock, [this] { return stopping_ || queued_ != 0; });
+        if (stopping_) {
+            return;
+        }
+    }
+}
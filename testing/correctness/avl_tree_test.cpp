@@ -10,13 +10,55 @@
  *
  */
 
-#include "avltree.hpp"
+#include "avl_tree.hpp"
 #include <iostream>
 #include <stdlib.h>      // rand(), srand()
 #include <time.h>       // time
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <functional>
+#include <iterator>
 #include <gtest/gtest.h>
 #include "otter.hpp"
 
+/// counts every comparison, to check what a search costs
+struct CountingLess {
+    static size_t calls_;
+    bool operator()(int lhs, int rhs) const
+    {
+        ++calls_;
+        return lhs < rhs;
+    }
+};
+size_t CountingLess::calls_ = 0;
+
+/// orders strings with a single three-way compare
+struct StringThreeWay : ThreeWayCompare {
+    int operator()(const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs.compare(rhs);
+    }
+};
+
+/// orders strings by length, and can look them up by a length directly
+struct LengthLess {
+    using is_transparent = void;
+    bool operator()(const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs.size() < rhs.size();
+    }
+    bool operator()(const std::string& lhs, size_t rhs) const
+    {
+        return lhs.size() < rhs;
+    }
+    bool operator()(size_t lhs, const std::string& rhs) const
+    {
+        return lhs < rhs.size();
+    }
+};
+
 TEST(avlTreeIntTest, insertTests)
 {
     AvlTree<int> intTree;
@@ -150,6 +192,28 @@ TEST(avlTreeIntTest, iteratorTests)
     }
 }
 
+TEST(avlTreeIntTest, forEachTests)
+{
+    AvlTree<int> intTree;
+    std::vector<int> visited;
+    intTree.forEach([&](const int& element) { visited.push_back(element); });
+    ASSERT_TRUE(visited.empty());
+    std::vector<int> elements;
+    for (int i = 0; i < 1000; ++i) {
+        elements.push_back(i * 3);
+    }
+    std::mt19937 generator{7};
+    std::shuffle(elements.begin(), elements.end(), generator);
+    for (int element : elements) {
+        intTree.insert(element);
+    }
+    intTree.forEach([&](const int& element) { visited.push_back(element); });
+    // the same elements, in the same order, as the iterators
+    ASSERT_EQ(visited.size(), intTree.size());
+    ASSERT_TRUE(std::equal(visited.begin(), visited.end(), intTree.begin()));
+    ASSERT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+}
+
 TEST(avlTreeIntTest, deleteElementTests) {
     AvlTree<int> intTree;
     intTree.insert(5);
@@ -190,6 +254,498 @@ TEST(avlTreeIntTest, deleteElementTests) {
     }
 }
 
+TEST(avlTreeIntTest, sortedConstructorTests)
+{
+    std::vector<int> sorted;
+    for (int i = 0; i < 1000; ++i) {
+        sorted.push_back(i);
+    }
+    AvlTree<int> intTree{sorted.begin(), sorted.end()};
+    ASSERT_EQ(intTree.size(), 1000);
+    // a perfectly balanced tree with 1000 elements has 10 levels
+    ASSERT_EQ(intTree.height(), 10);
+    EXPECT_TRUE(intTree.isBalanced());
+    int num = 0;
+    for (AvlTree<int>::iterator i = intTree.begin(); i != intTree.end(); ++i) {
+        ASSERT_EQ(num, *i);
+        ++num;
+    }
+    // the tree should keep working as usual after being built
+    for (int i = 1000; i < 1100; ++i) {
+        EXPECT_TRUE(intTree.insert(i));
+        EXPECT_TRUE(intTree.isBalanced());
+    }
+    for (int i = 0; i < 500; ++i) {
+        EXPECT_TRUE(intTree.deleteElement(i));
+        EXPECT_FALSE(intTree.contains(i));
+        EXPECT_TRUE(intTree.isBalanced());
+    }
+    ASSERT_EQ(intTree.size(), 600);
+
+    // unsorted input with repeated elements gets sorted first
+    std::vector<int> unsorted;
+    for (int i = 0; i < 500; ++i) {
+        unsorted.push_back(rand() % 100);
+    }
+    AvlTree<int> intTree2{unsorted.begin(), unsorted.end()};
+    std::sort(unsorted.begin(), unsorted.end());
+    unsorted.erase(std::unique(unsorted.begin(), unsorted.end()),
+                   unsorted.end());
+    ASSERT_EQ(intTree2.size(), unsorted.size());
+    for (size_t i = 0; i < unsorted.size(); ++i) {
+        EXPECT_TRUE(intTree2.contains(unsorted[i]));
+    }
+
+    // assignSorted replaces whatever was in the tree before
+    intTree2.assignSorted(sorted.begin(), sorted.begin() + 7);
+    ASSERT_EQ(intTree2.size(), 7);
+    ASSERT_EQ(intTree2.height(), 3);
+    EXPECT_TRUE(intTree2.isBalanced());
+    EXPECT_FALSE(intTree2.contains(50));
+    intTree2.assignSorted(sorted.end(), sorted.end());
+    EXPECT_TRUE(intTree2.size() == 0);
+}
+
+TEST(avlTreeIntTest, copyShapeTests)
+{
+    AvlTree<int> intTree;
+    for (int i = 0; i < 1000; ++i) {
+        intTree.insert(rand() % 5000);
+    }
+    // copies keep the shape of the original rather than rebuilding it
+    AvlTree<int> intTree2{intTree};
+    ASSERT_EQ(intTree, intTree2);
+    ASSERT_EQ(intTree.size(), intTree2.size());
+    ASSERT_EQ(intTree.height(), intTree2.height());
+    EXPECT_TRUE(intTree2.isBalanced());
+
+    // assigning over a bigger tree reuses its nodes and frees the rest
+    AvlTree<int> intTree3;
+    for (int i = 0; i < 3000; ++i) {
+        intTree3.insert(i);
+    }
+    intTree3 = intTree;
+    ASSERT_EQ(intTree, intTree3);
+    ASSERT_EQ(intTree.height(), intTree3.height());
+
+    // assigning over a smaller tree allocates what is missing
+    AvlTree<int> intTree4;
+    intTree4.insert(-1);
+    intTree4 = intTree;
+    ASSERT_EQ(intTree, intTree4);
+    ASSERT_EQ(intTree.size(), intTree4.size());
+
+    // self assignment leaves the tree alone
+    intTree4 = intTree4;
+    ASSERT_EQ(intTree, intTree4);
+
+    // the copies are independent of the original
+    for (int i = 0; i < 5000; i += 2) {
+        intTree2.deleteElement(i);
+    }
+    ASSERT_EQ(intTree, intTree3);
+    ASSERT_NE(intTree, intTree2);
+
+    AvlTree<int> empty;
+    intTree4 = empty;
+    EXPECT_TRUE(intTree4.size() == 0);
+    EXPECT_FALSE(intTree4.contains(intTree.size()));
+}
+
+TEST(avlTreeIntTest, moveTests)
+{
+    AvlTree<int> intTree;
+    for (int i = 0; i < 100; ++i) {
+        intTree.insert(i);
+    }
+    AvlTree<int> copy{intTree};
+    // moving takes the nodes and leaves the original empty
+    AvlTree<int> intTree2{std::move(intTree)};
+    ASSERT_EQ(intTree2, copy);
+    EXPECT_TRUE(intTree.size() == 0);
+    AvlTree<int> intTree3;
+    intTree3.insert(5000);
+    intTree3 = std::move(intTree2);
+    ASSERT_EQ(intTree3, copy);
+    EXPECT_FALSE(intTree3.contains(5000));
+    // a moved from tree can still be used
+    EXPECT_TRUE(intTree.insert(3));
+    EXPECT_TRUE(intTree.contains(3));
+
+    int value = 7000;
+    EXPECT_TRUE(intTree3.insert(std::move(value)));
+    EXPECT_TRUE(intTree3.emplace(7001));
+    EXPECT_FALSE(intTree3.emplace(7001));
+    EXPECT_TRUE(intTree3.contains(7000));
+    EXPECT_TRUE(intTree3.contains(7001));
+    ASSERT_EQ(intTree3.size(), 102);
+
+    AvlTree<std::string> stringTree;
+    std::string test(100, 'a');
+    EXPECT_TRUE(stringTree.insert(std::move(test)));
+    EXPECT_TRUE(stringTree.emplace(3, 'b'));
+    EXPECT_FALSE(stringTree.insert(std::string(100, 'a')));
+    EXPECT_TRUE(stringTree.contains(std::string(100, 'a')));
+    EXPECT_TRUE(stringTree.contains("bbb"));
+    ASSERT_EQ(stringTree.size(), 2);
+}
+
+TEST(avlTreeIntTest, compareTests)
+{
+    // a reversed order iterates from the largest element down
+    AvlTree<int, std::greater<int>> reversed;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(reversed.insert(i));
+    }
+    EXPECT_FALSE(reversed.insert(50));
+    ASSERT_EQ(reversed.size(), 100);
+    int expected = 99;
+    for (int element : reversed) {
+        EXPECT_EQ(element, expected);
+        --expected;
+    }
+    EXPECT_TRUE(reversed.deleteElement(99));
+    EXPECT_TRUE(reversed.deleteElement(0));
+    EXPECT_FALSE(reversed.contains(99));
+    EXPECT_EQ(*reversed.begin(), 98);
+
+    // a search costs one comparison per level plus one at the bottom
+    AvlTree<int, CountingLess> counted;
+    for (int i = 0; i < 1000; ++i) {
+        counted.insert((i * 7919) % 1000);
+    }
+    size_t height = counted.height();
+    CountingLess::calls_ = 0;
+    EXPECT_TRUE(counted.contains(500));
+    EXPECT_LE(CountingLess::calls_, height + 1);
+
+    // three-way comparators work the same way
+    AvlTree<std::string, StringThreeWay> threeWay{StringThreeWay()};
+    EXPECT_TRUE(threeWay.insert("b"));
+    EXPECT_TRUE(threeWay.insert("a"));
+    EXPECT_TRUE(threeWay.insert("c"));
+    EXPECT_FALSE(threeWay.insert("b"));
+    EXPECT_TRUE(threeWay.contains("a"));
+    EXPECT_FALSE(threeWay.contains("d"));
+    ASSERT_EQ(threeWay.size(), 3);
+    EXPECT_TRUE(threeWay.deleteElement("b"));
+    EXPECT_EQ(*threeWay.begin(), "a");
+
+    // transparent comparators can look up keys of another type
+    AvlTree<std::string, LengthLess> byLength;
+    EXPECT_TRUE(byLength.insert("aa"));
+    EXPECT_TRUE(byLength.insert("bbbb"));
+    EXPECT_FALSE(byLength.insert("cc"));
+    EXPECT_TRUE(byLength.contains(size_t(4)));
+    EXPECT_FALSE(byLength.contains(size_t(3)));
+    EXPECT_TRUE(reversed.isBalanced());
+}
+
+TEST(avlTreeIntTest, orderStatisticTests)
+{
+    // select and rank agree with a sorted copy of the elements
+    AvlTree<int, std::less<int>, NodePool<int>, OrderStatistics> tree;
+    std::vector<int> sorted;
+    for (int i = 0; i < 1000; ++i) {
+        int element = (i * 7919) % 2000;
+        tree.insert(element);
+        sorted.push_back(element);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    // every third element is deleted again so the sizes have to be kept
+    // up to date through deletions and their rotations as well
+    for (size_t i = 0; i < sorted.size(); i += 3) {
+        EXPECT_TRUE(tree.deleteElement(sorted[i]));
+    }
+    std::vector<int> kept;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i % 3 != 0) {
+            kept.push_back(sorted[i]);
+        }
+    }
+    sorted = kept;
+    ASSERT_EQ(tree.size(), sorted.size());
+    for (size_t k = 0; k < sorted.size(); ++k) {
+        EXPECT_EQ(tree.select(k), sorted[k]);
+        EXPECT_EQ(tree.rank(sorted[k]), k);
+    }
+    // rank of a missing element counts everything below it
+    EXPECT_EQ(tree.rank(-1), 0);
+    EXPECT_EQ(tree.rank(2000), sorted.size());
+    size_t below = std::lower_bound(sorted.begin(), sorted.end(), 1001)
+                   - sorted.begin();
+    EXPECT_EQ(tree.rank(1001), below);
+
+    // count in range is half open
+    size_t inRange = std::lower_bound(sorted.begin(), sorted.end(), 1500)
+                     - std::lower_bound(sorted.begin(), sorted.end(), 500);
+    EXPECT_EQ(tree.countRange(500, 1500), inRange);
+    EXPECT_EQ(tree.countRange(1500, 500), 0);
+    EXPECT_EQ(tree.countRange(sorted[0], sorted[0]), 0);
+    EXPECT_EQ(tree.countRange(-1, 2000), sorted.size());
+
+    // copies keep the sizes
+    AvlTree<int, std::less<int>, NodePool<int>, OrderStatistics> copy{tree};
+    for (size_t k = 0; k < sorted.size(); k += 10) {
+        EXPECT_EQ(copy.select(k), sorted[k]);
+    }
+    AvlTree<int, std::less<int>, NodePool<int>, OrderStatistics> built{sorted.begin(), sorted.end()};
+    for (size_t k = 0; k < sorted.size(); k += 10) {
+        EXPECT_EQ(built.select(k), sorted[k]);
+        EXPECT_EQ(built.rank(sorted[k]), k);
+    }
+}
+
+TEST(avlTreeIntTest, boundTests)
+{
+    AvlTree<int> tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i * 3);
+    }
+    // lower_bound stops at an equal element, or the next one up
+    EXPECT_EQ(*tree.lower_bound(30), 30);
+    EXPECT_EQ(*tree.lower_bound(31), 33);
+    EXPECT_EQ(*tree.lower_bound(-5), 0);
+    EXPECT_TRUE(tree.lower_bound(298) == tree.end());
+
+    // upper_bound always moves past an equal element
+    EXPECT_EQ(*tree.upper_bound(30), 33);
+    EXPECT_EQ(*tree.upper_bound(31), 33);
+    EXPECT_TRUE(tree.upper_bound(297) == tree.end());
+
+    EXPECT_EQ(*tree.find(90), 90);
+    EXPECT_TRUE(tree.find(91) == tree.end());
+
+    auto equal = tree.equal_range(60);
+    EXPECT_EQ(*equal.first, 60);
+    EXPECT_EQ(*equal.second, 63);
+    equal = tree.equal_range(61);
+    EXPECT_TRUE(equal.first == equal.second);
+
+    // ranges are half open
+    std::vector<int> scanned;
+    for (int element : tree.range(9, 39)) {
+        scanned.push_back(element);
+    }
+    std::vector<int> expected;
+    for (int element = 9; element < 39; element += 3) {
+        expected.push_back(element);
+    }
+    EXPECT_EQ(scanned, expected);
+    EXPECT_TRUE(tree.range(40, 10).empty());
+    EXPECT_TRUE(tree.range(31, 32).empty());
+    size_t count = 0;
+    for (int element : tree.range(290, 1000)) {
+        EXPECT_GE(element, 290);
+        ++count;
+    }
+    EXPECT_EQ(count, 3);
+
+    // bounds follow the tree's order, not operator<
+    AvlTree<int, std::greater<int>> reversed;
+    for (int i = 0; i < 10; ++i) {
+        reversed.insert(i);
+    }
+    EXPECT_EQ(*reversed.lower_bound(5), 5);
+    EXPECT_EQ(*reversed.upper_bound(5), 4);
+    scanned.clear();
+    for (int element : reversed.range(8, 3)) {
+        scanned.push_back(element);
+    }
+    expected = {8, 7, 6, 5, 4};
+    EXPECT_EQ(scanned, expected);
+}
+
+TEST(avlTreeIntTest, splitJoinTests)
+{
+    // split needs the subtree sizes to size its halves
+    using CountedTree =
+        AvlTree<int, std::less<int>, NodePool<int>, OrderStatistics>;
+    CountedTree tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert((i * 7919) % 1000);
+    }
+    // the pivot itself goes to the upper half
+    CountedTree upper = tree.split(400);
+    ASSERT_EQ(tree.size(), 400);
+    ASSERT_EQ(upper.size(), 600);
+    EXPECT_TRUE(tree.isBalanced());
+    EXPECT_TRUE(upper.isBalanced());
+    int expected = 0;
+    for (int element : tree) {
+        EXPECT_EQ(element, expected);
+        ++expected;
+    }
+    for (int element : upper) {
+        EXPECT_EQ(element, expected);
+        ++expected;
+    }
+
+    // both halves keep working on their own, even once the other is gone
+    {
+        CountedTree top = upper.split(900);
+        ASSERT_EQ(top.size(), 100);
+        EXPECT_TRUE(top.contains(999));
+        EXPECT_TRUE(upper.insert(2000));
+        EXPECT_TRUE(upper.deleteElement(2000));
+        upper.join(top);
+        ASSERT_EQ(top.size(), 0);
+    }
+    ASSERT_EQ(upper.size(), 600);
+    EXPECT_TRUE(upper.isBalanced());
+
+    // joining trees of very different heights stays balanced
+    CountedTree small = tree.split(10);
+    tree.join(small);
+    EXPECT_TRUE(tree.isBalanced());
+    small = upper.split(990);
+    tree.join(upper);
+    tree.join(small);
+    ASSERT_EQ(tree.size(), 1000);
+    ASSERT_EQ(upper.size(), 0);
+    EXPECT_TRUE(tree.isBalanced());
+    expected = 0;
+    for (int element : tree) {
+        EXPECT_EQ(element, expected);
+        ++expected;
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(tree.deleteElement(i));
+    }
+    EXPECT_TRUE(tree.isBalanced());
+
+    // splitting past either end leaves one side empty
+    CountedTree all = tree.split(-1);
+    ASSERT_EQ(tree.size(), 0);
+    ASSERT_EQ(all.size(), 500);
+    CountedTree none = all.split(1000);
+    ASSERT_EQ(none.size(), 0);
+    ASSERT_EQ(all.size(), 500);
+    tree.join(all);
+    ASSERT_EQ(tree.size(), 500);
+
+    // subtree sizes survive splits and joins as well
+    CountedTree counted;
+    for (int i = 0; i < 1000; ++i) {
+        counted.insert((i * 7919) % 1000);
+    }
+    CountedTree rest = counted.split(123);
+    ASSERT_EQ(counted.size(), 123);
+    ASSERT_EQ(rest.size(), 877);
+    EXPECT_EQ(rest.select(0), 123);
+    EXPECT_EQ(rest.rank(500), 377);
+    counted.join(rest);
+    EXPECT_TRUE(counted.isBalanced());
+    for (size_t k = 0; k < 1000; ++k) {
+        EXPECT_EQ(counted.select(k), int(k));
+    }
+
+    // join doesn't need the sizes, so any tree can do it
+    AvlTree<int> lower;
+    AvlTree<int> higher;
+    for (int i = 0; i < 500; ++i) {
+        lower.insert(i);
+        higher.insert(i + 500);
+    }
+    lower.join(higher);
+    ASSERT_EQ(lower.size(), 1000);
+    ASSERT_EQ(higher.size(), 0);
+    EXPECT_TRUE(lower.isBalanced());
+    int next = 0;
+    for (int element : lower) {
+        EXPECT_EQ(element, next);
+        ++next;
+    }
+}
+
+TEST(avlTreeIntTest, setAlgebraTests)
+{
+    // big enough for the halves to be handed to other threads
+    std::vector<int> evens;
+    std::vector<int> threes;
+    for (int i = 0; i < 60000; i += 2) {
+        evens.push_back(i);
+    }
+    for (int i = 0; i < 60000; i += 3) {
+        threes.push_back(i);
+    }
+    std::vector<int> expected;
+    WorkStealingPool pool{4};
+
+    AvlTree<int> tree{evens.begin(), evens.end()};
+    AvlTree<int> other{threes.begin(), threes.end()};
+    tree.unionWith(other, pool);
+    std::set_union(evens.begin(), evens.end(), threes.begin(), threes.end(),
+                   std::back_inserter(expected));
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_EQ(other.size(), 0);
+    EXPECT_TRUE(tree.isBalanced());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin()));
+
+    tree.assignSorted(evens.begin(), evens.end());
+    other.assignSorted(threes.begin(), threes.end());
+    tree.intersect(other, pool);
+    expected.clear();
+    std::set_intersection(evens.begin(), evens.end(), threes.begin(),
+                          threes.end(), std::back_inserter(expected));
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_EQ(other.size(), 0);
+    EXPECT_TRUE(tree.isBalanced());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin()));
+
+    tree.assignSorted(evens.begin(), evens.end());
+    other.assignSorted(threes.begin(), threes.end());
+    tree.difference(other, pool);
+    expected.clear();
+    std::set_difference(evens.begin(), evens.end(), threes.begin(),
+                        threes.end(), std::back_inserter(expected));
+    ASSERT_EQ(tree.size(), expected.size());
+    EXPECT_TRUE(tree.isBalanced());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin()));
+
+    // very different sizes, and a single thread
+    WorkStealingPool single{1};
+    AvlTree<int> few;
+    few.insert(-5);
+    few.insert(7);
+    few.insert(70000);
+    size_t before = tree.size();
+    tree.unionWith(few, single);
+    ASSERT_EQ(tree.size(), before + 3);
+    EXPECT_TRUE(tree.contains(-5));
+    EXPECT_TRUE(tree.contains(70000));
+    EXPECT_TRUE(tree.isBalanced());
+    few.insert(4);
+    few.insert(5);
+    // few was emptied by the union
+    tree.intersect(few, single);
+    ASSERT_EQ(tree.size(), 1);
+    EXPECT_TRUE(tree.contains(4));
+    EXPECT_FALSE(tree.contains(5));
+
+    // a tree combined with itself or an empty tree
+    tree.unionWith(tree, pool);
+    ASSERT_EQ(tree.size(), 1);
+    tree.unionWith(few, pool);
+    ASSERT_EQ(tree.size(), 1);
+    tree.difference(tree, pool);
+    ASSERT_EQ(tree.size(), 0);
+    other.assignSorted(threes.begin(), threes.end());
+    tree.unionWith(other, pool);
+    ASSERT_EQ(tree.size(), threes.size());
+
+    // subtree sizes come out right as well
+    AvlTree<int, std::less<int>, NodePool<int>, OrderStatistics>
+        counted{evens.begin(), evens.end()};
+    AvlTree<int, std::less<int>, NodePool<int>, OrderStatistics>
+        counting{threes.begin(), threes.end()};
+    counted.difference(counting, pool);
+    EXPECT_TRUE(counted.isBalanced());
+    for (size_t k = 0; k < expected.size(); k += 97) {
+        EXPECT_EQ(counted.select(k), expected[k]);
+    }
+}
+
 TEST(avlTreeOtterTest, insertTests)
 {
     AvlTree<Otter> otterTree;
@@ -13,12 +13,13 @@
  *   destructor
  */
 
-#include "linkedlist.hpp"
+#include "linked_list.hpp"
 #include <iostream>
 //#include <cstddef>
 #include <iterator>      // std::advance()
 #include <stdlib.h>      // rand(), srand()
 #include <time.h>       // time
+#include <utility>
 #include <gtest/gtest.h>
 #include "otter.hpp"
 
@@ -116,6 +117,41 @@ TEST(linkedListStringTest, assignmentOperatorTests)
     ASSERT_EQ(stringList, stringList2);
 }
 
+TEST(linkedListStringTest, moveTests)
+{
+    LinkedList<string> stringList;
+    for (int i = 0; i < 100; ++i) {
+        stringList.insertBack(std::to_string(i));
+    }
+    LinkedList<string> copy{stringList};
+    // moving takes the nodes and leaves the original empty
+    LinkedList<string> stringList2{std::move(stringList)};
+    ASSERT_EQ(stringList2, copy);
+    ASSERT_EQ(stringList.size(), 0);
+    LinkedList<string> stringList3;
+    stringList3.insertFront("hello world");
+    stringList3 = std::move(stringList2);
+    ASSERT_EQ(stringList3, copy);
+    EXPECT_FALSE(stringList3.contains("hello world"));
+    // a moved from list can still be used
+    stringList.insertBack("hello");
+    ASSERT_EQ(stringList.size(), 1);
+
+    string test(100, 'a');
+    stringList3.insertFront(std::move(test));
+    stringList3.emplaceFront(3, 'b');
+    stringList3.emplaceBack(3, 'c');
+    stringList3.emplaceAfter(stringList3.begin(), "after");
+    ASSERT_EQ(stringList3.size(), 104);
+    LinkedList<string>::iterator i = stringList3.begin();
+    EXPECT_EQ(*i, "bbb");
+    ++i;
+    EXPECT_EQ(*i, "after");
+    ++i;
+    EXPECT_EQ(*i, string(100, 'a'));
+    EXPECT_EQ(stringList3.deleteBack(), "ccc");
+}
+
 TEST(linkedListStringTest, insertBackTests)
 {
     LinkedList<string> stringList;
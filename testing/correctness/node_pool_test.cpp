@@ -0,0 +1,145 @@
+/**
+ * \file node_pool_test.cpp
+ * \author Andrew Scott
+ *
+ * \brief Tests a NodePool for correctness, both on its own and as the
+ * allocator of the containers
+ *
+ */
+
+#include "node_pool.hpp"
+#include "avl_tree.hpp"
+#include "linked_list.hpp"
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+TEST(nodePoolTest, allocateTests)
+{
+    NodePool<std::string> pool;
+    ASSERT_EQ(pool.bytesReserved(), 0);
+    std::string* first = pool.allocate(1);
+    std::string* second = pool.allocate(1);
+    EXPECT_NE(first, second);
+    ASSERT_EQ(pool.slotsInUse(), 2);
+    size_t reserved = pool.bytesReserved();
+    EXPECT_GT(reserved, 0);
+    // freed slots are handed out again before any new memory
+    pool.deallocate(first, 1);
+    ASSERT_EQ(pool.slotsInUse(), 1);
+    EXPECT_EQ(pool.allocate(1), first);
+    pool.deallocate(first, 1);
+    pool.deallocate(second, 1);
+
+    std::vector<std::string*> slots;
+    for (int i = 0; i < 10000; ++i) {
+        slots.push_back(pool.allocate(1));
+    }
+    ASSERT_EQ(pool.slotsInUse(), 10000);
+    reserved = pool.bytesReserved();
+    EXPECT_GE(reserved, 10000 * sizeof(std::string));
+    for (size_t i = 0; i < slots.size(); ++i) {
+        pool.deallocate(slots[i], 1);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        slots[i] = pool.allocate(1);
+    }
+    // churn doesn't reserve anything more
+    ASSERT_EQ(pool.bytesReserved(), reserved);
+
+    // arrays don't come out of the slabs
+    std::string* array = pool.allocate(5);
+    ASSERT_EQ(pool.slotsInUse(), 10000);
+    pool.deallocate(array, 5);
+}
+
+TEST(nodePoolTest, moveTests)
+{
+    NodePool<int> pool;
+    int* slot = pool.allocate(1);
+    *slot = 5;
+    size_t reserved = pool.bytesReserved();
+    // copies start out empty, moves take the slabs along
+    NodePool<int> copy{pool};
+    ASSERT_EQ(copy.bytesReserved(), 0);
+    EXPECT_TRUE(copy != pool);
+    NodePool<int> moved{std::move(pool)};
+    ASSERT_EQ(moved.bytesReserved(), reserved);
+    ASSERT_EQ(pool.bytesReserved(), 0);
+    ASSERT_EQ(*slot, 5);
+    moved.deallocate(slot, 1);
+    swap(moved, copy);
+    ASSERT_EQ(copy.bytesReserved(), reserved);
+    ASSERT_EQ(moved.bytesReserved(), 0);
+}
+
+TEST(nodePoolTest, shareTests)
+{
+    NodePool<int>* pool = new NodePool<int>;
+    int* slot = pool->allocate(1);
+    *slot = 5;
+    NodePool<int> sharer;
+    sharer.share(*pool);
+    // the slabs outlive the pool that made them while they are shared
+    delete pool;
+    ASSERT_EQ(*slot, 5);
+    // and slots from them can be reused through the pool sharing them
+    sharer.deallocate(slot, 1);
+    EXPECT_EQ(sharer.allocate(1), slot);
+    sharer.deallocate(slot, 1);
+    ASSERT_EQ(sharer.bytesReserved(), 0);
+
+    // sharing passes on whatever the other pool shares too
+    NodePool<int>* first = new NodePool<int>;
+    NodePool<int> second;
+    NodePool<int> third;
+    int* firstSlot = first->allocate(1);
+    second.share(*first);
+    third.share(second);
+    delete first;
+    *firstSlot = 7;
+    third.deallocate(firstSlot, 1);
+    EXPECT_EQ(third.allocate(1), firstSlot);
+    third.deallocate(firstSlot, 1);
+}
+
+TEST(nodePoolTest, containerTests)
+{
+    AvlTree<int> pooled;
+    AvlTree<int, std::less<int>, std::allocator<int>> unpooled;
+    for (int i = 0; i < 1000; ++i) {
+        pooled.insert(i);
+        unpooled.insert(i);
+    }
+    // the trees behave the same whichever allocator they use
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(pooled.deleteElement(i));
+        EXPECT_TRUE(unpooled.deleteElement(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(pooled.contains(i), unpooled.contains(i));
+    }
+    AvlTree<int> pooledCopy{pooled};
+    ASSERT_EQ(pooledCopy, pooled);
+    AvlTree<int> pooledMove{std::move(pooledCopy)};
+    ASSERT_EQ(pooledMove, pooled);
+
+    std::ostringstream stats;
+    pooled.printStatistics(stats);
+    EXPECT_NE(stats.str().find("allocated memory"), std::string::npos);
+
+    LinkedList<std::string> pooledList;
+    LinkedList<std::string, std::allocator<std::string>> unpooledList;
+    for (int i = 0; i < 100; ++i) {
+        pooledList.insertBack(std::to_string(i));
+        unpooledList.insertBack(std::to_string(i));
+    }
+    LinkedList<std::string>::iterator i = pooledList.begin();
+    for (std::string element : unpooledList) {
+        EXPECT_EQ(*i, element);
+        ++i;
+    }
+}
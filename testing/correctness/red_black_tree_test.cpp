@@ -10,10 +10,15 @@
  *
  */
 
-#include "rbtree.hpp"
+#include "red_black_tree.hpp"
 #include <iostream>
 #include <stdlib.h>      // rand(), srand()
 #include <time.h>       // time
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <functional>
 #include <gtest/gtest.h>
 #include "otter.hpp"
 
@@ -133,6 +138,28 @@ TEST(rbTreeIntTest, iteratorTests)
     }
 }
 
+TEST(rbTreeIntTest, forEachTests)
+{
+    RBTree<int> intTree;
+    std::vector<int> visited;
+    intTree.forEach([&](const int& element) { visited.push_back(element); });
+    ASSERT_TRUE(visited.empty());
+    std::vector<int> elements;
+    for (int i = 0; i < 1000; ++i) {
+        elements.push_back(i * 3);
+    }
+    std::mt19937 generator{7};
+    std::shuffle(elements.begin(), elements.end(), generator);
+    for (int element : elements) {
+        intTree.insert(element);
+    }
+    intTree.forEach([&](const int& element) { visited.push_back(element); });
+    // the same elements, in the same order, as the iterators
+    ASSERT_EQ(visited.size(), intTree.size());
+    ASSERT_TRUE(std::equal(visited.begin(), visited.end(), intTree.begin()));
+    ASSERT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+}
+
 TEST(rbTreeIntTest, deleteElementTests) {
     RBTree<int> intTree;
     intTree.insert(5);
@@ -180,6 +207,243 @@ TEST(rbTreeIntTest, deleteElementTests) {
         intTree.print(std::cout);
     }*/
 }
+
+TEST(rbTreeIntTest, sortedConstructorTests)
+{
+    std::vector<int> sorted;
+    for (int i = 0; i < 1000; ++i) {
+        sorted.push_back(i);
+    }
+    RBTree<int> intTree{sorted.begin(), sorted.end()};
+    ASSERT_EQ(intTree.size(), 1000);
+    // a perfectly balanced tree with 1000 elements has 10 levels
+    ASSERT_EQ(intTree.height(), 10);
+    EXPECT_TRUE(intTree.hasRBProperties());
+    int num = 0;
+    for (RBTree<int>::iterator i = intTree.begin(); i != intTree.end(); ++i) {
+        ASSERT_EQ(num, *i);
+        ++num;
+    }
+    // the tree should keep working as usual after being built
+    for (int i = 1000; i < 1100; ++i) {
+        EXPECT_TRUE(intTree.insert(i));
+    }
+    for (int i = 0; i < 500; ++i) {
+        EXPECT_TRUE(intTree.deleteElement(i));
+        EXPECT_FALSE(intTree.contains(i));
+    }
+    ASSERT_EQ(intTree.size(), 600);
+
+    // unsorted input with repeated elements gets sorted first
+    std::vector<int> unsorted;
+    for (int i = 0; i < 500; ++i) {
+        unsorted.push_back(rand() % 100);
+    }
+    RBTree<int> intTree2{unsorted.begin(), unsorted.end()};
+    std::sort(unsorted.begin(), unsorted.end());
+    unsorted.erase(std::unique(unsorted.begin(), unsorted.end()),
+                   unsorted.end());
+    ASSERT_EQ(intTree2.size(), unsorted.size());
+    for (size_t i = 0; i < unsorted.size(); ++i) {
+        EXPECT_TRUE(intTree2.contains(unsorted[i]));
+    }
+
+    // assignSorted replaces whatever was in the tree before
+    intTree2.assignSorted(sorted.begin(), sorted.begin() + 7);
+    ASSERT_EQ(intTree2.size(), 7);
+    ASSERT_EQ(intTree2.height(), 3);
+    EXPECT_TRUE(intTree2.hasRBProperties());
+    EXPECT_FALSE(intTree2.contains(50));
+    intTree2.assignSorted(sorted.end(), sorted.end());
+    EXPECT_TRUE(intTree2.size() == 0);
+}
+
+TEST(rbTreeIntTest, copyShapeTests)
+{
+    RBTree<int> intTree;
+    for (int i = 0; i < 1000; ++i) {
+        intTree.insert(i * 5);
+    }
+    // copies keep the shape of the original rather than rebuilding it
+    RBTree<int> intTree2{intTree};
+    ASSERT_EQ(intTree, intTree2);
+    ASSERT_EQ(intTree.size(), intTree2.size());
+    ASSERT_EQ(intTree.height(), intTree2.height());
+    EXPECT_TRUE(intTree2.hasRBProperties());
+
+    // assigning over a bigger tree reuses its nodes and frees the rest
+    RBTree<int> intTree3;
+    for (int i = 0; i < 3000; ++i) {
+        intTree3.insert(i);
+    }
+    intTree3 = intTree;
+    ASSERT_EQ(intTree, intTree3);
+    ASSERT_EQ(intTree.height(), intTree3.height());
+
+    // assigning over a smaller tree allocates what is missing
+    RBTree<int> intTree4;
+    intTree4.insert(-1);
+    intTree4 = intTree;
+    ASSERT_EQ(intTree, intTree4);
+    ASSERT_EQ(intTree.size(), intTree4.size());
+
+    // self assignment leaves the tree alone
+    intTree4 = intTree4;
+    ASSERT_EQ(intTree, intTree4);
+
+    // the copies are independent of the original
+    for (int i = 0; i < 5000; i += 2) {
+        intTree2.deleteElement(i);
+    }
+    ASSERT_EQ(intTree, intTree3);
+    ASSERT_NE(intTree, intTree2);
+
+    RBTree<int> empty;
+    intTree4 = empty;
+    EXPECT_TRUE(intTree4.size() == 0);
+    EXPECT_FALSE(intTree4.contains(intTree.size()));
+}
+TEST(rbTreeIntTest, moveTests)
+{
+    RBTree<int> intTree;
+    for (int i = 0; i < 100; ++i) {
+        intTree.insert(i);
+    }
+    RBTree<int> copy{intTree};
+    // moving takes the nodes and leaves the original empty
+    RBTree<int> intTree2{std::move(intTree)};
+    ASSERT_EQ(intTree2, copy);
+    EXPECT_TRUE(intTree.size() == 0);
+    RBTree<int> intTree3;
+    intTree3.insert(5000);
+    intTree3 = std::move(intTree2);
+    ASSERT_EQ(intTree3, copy);
+    EXPECT_FALSE(intTree3.contains(5000));
+    // a moved from tree can still be used
+    EXPECT_TRUE(intTree.insert(3));
+    EXPECT_TRUE(intTree.contains(3));
+
+    int value = 7000;
+    EXPECT_TRUE(intTree3.insert(std::move(value)));
+    EXPECT_TRUE(intTree3.emplace(7001));
+    EXPECT_FALSE(intTree3.emplace(7001));
+    EXPECT_TRUE(intTree3.contains(7000));
+    EXPECT_TRUE(intTree3.contains(7001));
+    ASSERT_EQ(intTree3.size(), 102);
+
+    RBTree<std::string> stringTree;
+    std::string test(100, 'a');
+    EXPECT_TRUE(stringTree.insert(std::move(test)));
+    EXPECT_TRUE(stringTree.emplace(3, 'b'));
+    EXPECT_FALSE(stringTree.insert(std::string(100, 'a')));
+    EXPECT_TRUE(stringTree.contains(std::string(100, 'a')));
+    EXPECT_TRUE(stringTree.contains("bbb"));
+    ASSERT_EQ(stringTree.size(), 2);
+}
+
+TEST(rbTreeIntTest, orderStatisticTests)
+{
+    // select and rank agree with a sorted copy of the elements
+    RBTree<int, std::less<int>, NodePool<int>, OrderStatistics> tree;
+    std::vector<int> sorted;
+    for (int i = 0; i < 1000; ++i) {
+        int element = (i * 7919) % 2000;
+        tree.insert(element);
+        sorted.push_back(element);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_EQ(tree.size(), sorted.size());
+    for (size_t k = 0; k < sorted.size(); ++k) {
+        EXPECT_EQ(tree.select(k), sorted[k]);
+        EXPECT_EQ(tree.rank(sorted[k]), k);
+    }
+    // rank of a missing element counts everything below it
+    EXPECT_EQ(tree.rank(-1), 0);
+    EXPECT_EQ(tree.rank(2000), sorted.size());
+    size_t below = std::lower_bound(sorted.begin(), sorted.end(), 1001)
+                   - sorted.begin();
+    EXPECT_EQ(tree.rank(1001), below);
+
+    // count in range is half open
+    size_t inRange = std::lower_bound(sorted.begin(), sorted.end(), 1500)
+                     - std::lower_bound(sorted.begin(), sorted.end(), 500);
+    EXPECT_EQ(tree.countRange(500, 1500), inRange);
+    EXPECT_EQ(tree.countRange(1500, 500), 0);
+    EXPECT_EQ(tree.countRange(sorted[0], sorted[0]), 0);
+    EXPECT_EQ(tree.countRange(-1, 2000), sorted.size());
+
+    // copies keep the sizes
+    RBTree<int, std::less<int>, NodePool<int>, OrderStatistics> copy{tree};
+    for (size_t k = 0; k < sorted.size(); k += 10) {
+        EXPECT_EQ(copy.select(k), sorted[k]);
+    }
+    RBTree<int, std::less<int>, NodePool<int>, OrderStatistics> built{sorted.begin(), sorted.end()};
+    for (size_t k = 0; k < sorted.size(); k += 10) {
+        EXPECT_EQ(built.select(k), sorted[k]);
+        EXPECT_EQ(built.rank(sorted[k]), k);
+    }
+}
+
+TEST(rbTreeIntTest, boundTests)
+{
+    RBTree<int> tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i * 3);
+    }
+    // lower_bound stops at an equal element, or the next one up
+    EXPECT_EQ(*tree.lower_bound(30), 30);
+    EXPECT_EQ(*tree.lower_bound(31), 33);
+    EXPECT_EQ(*tree.lower_bound(-5), 0);
+    EXPECT_TRUE(tree.lower_bound(298) == tree.end());
+
+    // upper_bound always moves past an equal element
+    EXPECT_EQ(*tree.upper_bound(30), 33);
+    EXPECT_EQ(*tree.upper_bound(31), 33);
+    EXPECT_TRUE(tree.upper_bound(297) == tree.end());
+
+    EXPECT_EQ(*tree.find(90), 90);
+    EXPECT_TRUE(tree.find(91) == tree.end());
+
+    auto equal = tree.equal_range(60);
+    EXPECT_EQ(*equal.first, 60);
+    EXPECT_EQ(*equal.second, 63);
+    equal = tree.equal_range(61);
+    EXPECT_TRUE(equal.first == equal.second);
+
+    // ranges are half open
+    std::vector<int> scanned;
+    for (int element : tree.range(9, 39)) {
+        scanned.push_back(element);
+    }
+    std::vector<int> expected;
+    for (int element = 9; element < 39; element += 3) {
+        expected.push_back(element);
+    }
+    EXPECT_EQ(scanned, expected);
+    EXPECT_TRUE(tree.range(40, 10).empty());
+    EXPECT_TRUE(tree.range(31, 32).empty());
+    size_t count = 0;
+    for (int element : tree.range(290, 1000)) {
+        EXPECT_GE(element, 290);
+        ++count;
+    }
+    EXPECT_EQ(count, 3);
+
+    // bounds follow the tree's order, not operator<
+    RBTree<int, std::greater<int>> reversed;
+    for (int i = 0; i < 10; ++i) {
+        reversed.insert(i);
+    }
+    EXPECT_EQ(*reversed.lower_bound(5), 5);
+    EXPECT_EQ(*reversed.upper_bound(5), 4);
+    scanned.clear();
+    for (int element : reversed.range(8, 3)) {
+        scanned.push_back(element);
+    }
+    expected = {8, 7, 6, 5, 4};
+    EXPECT_EQ(scanned, expected);
+}
+
 /*
 TEST(rbTreeOtterTest, insertTests)
 {
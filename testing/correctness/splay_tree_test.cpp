@@ -14,9 +14,59 @@
 #include <iostream>
 #include <stdlib.h>      // rand(), srand()
 #include <time.h>       // time
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <functional>
 #include <gtest/gtest.h>
 #include "otter.hpp"
 
+/// counts every comparison, to check what a search costs
+struct CountingLess {
+    static size_t calls_;
+    bool operator()(int lhs, int rhs) const
+    {
+        ++calls_;
+        return lhs < rhs;
+    }
+};
+size_t CountingLess::calls_ = 0;
+
+/// orders ints up or down, chosen when it is made
+struct Direction {
+    bool ascending_;
+    bool operator()(int lhs, int rhs) const
+    {
+        return ascending_ ? lhs < rhs : rhs < lhs;
+    }
+};
+
+/// orders strings with a single three-way compare
+struct StringThreeWay : ThreeWayCompare {
+    int operator()(const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs.compare(rhs);
+    }
+};
+
+/// orders strings by length, and can look them up by a length directly
+struct LengthLess {
+    using is_transparent = void;
+    bool operator()(const std::string& lhs, const std::string& rhs) const
+    {
+        return lhs.size() < rhs.size();
+    }
+    bool operator()(const std::string& lhs, size_t rhs) const
+    {
+        return lhs.size() < rhs;
+    }
+    bool operator()(size_t lhs, const std::string& rhs) const
+    {
+        return lhs < rhs.size();
+    }
+};
+
 // This test just checks that insert and contains() return the proper values.
 // To check that the splaying inserts and lookups were working, the trees were
 // printed out
@@ -139,6 +189,40 @@ TEST(splayTreeIntTest, iteratorTests)
     }
 }
 
+TEST(splayTreeIntTest, forEachTests)
+{
+    SplayTree<int> intTree;
+    std::vector<int> visited;
+    intTree.forEach([&](const int& element) { visited.push_back(element); });
+    ASSERT_TRUE(visited.empty());
+    std::vector<int> elements;
+    for (int i = 0; i < 1000; ++i) {
+        elements.push_back(i * 3);
+    }
+    std::mt19937 generator{7};
+    std::shuffle(elements.begin(), elements.end(), generator);
+    for (int element : elements) {
+        intTree.insert(element);
+    }
+    intTree.forEach([&](const int& element) { visited.push_back(element); });
+    // the same elements, in the same order, as the iterators
+    ASSERT_EQ(visited.size(), intTree.size());
+    ASSERT_TRUE(std::equal(visited.begin(), visited.end(), intTree.begin()));
+    ASSERT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+
+    // inserting in order leaves a path far deeper than forEach's stack
+    SplayTree<int> path;
+    for (int i = 0; i < 10000; ++i) {
+        path.insert(i);
+    }
+    visited.clear();
+    path.forEach([&](const int& element) { visited.push_back(element); });
+    ASSERT_EQ(visited.size(), 10000);
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(visited[i], i);
+    }
+}
+
 TEST(splayTreeIntTest, deleteElementTests) {
     SplayTree<int> intTree;
     intTree.insert(5);
@@ -183,6 +267,280 @@ TEST(splayTreeIntTest, deleteElementTests) {
     }
 }
 
+TEST(splayTreeIntTest, sortedConstructorTests)
+{
+    std::vector<int> sorted;
+    for (int i = 0; i < 1000; ++i) {
+        sorted.push_back(i);
+    }
+    SplayTree<int> intTree{sorted.begin(), sorted.end()};
+    ASSERT_EQ(intTree.size(), 1000);
+    // a perfectly balanced tree with 1000 elements has 10 levels
+    ASSERT_EQ(intTree.height(), 10);
+    int num = 0;
+    for (SplayTree<int>::iterator i = intTree.begin(); i != intTree.end(); ++i) {
+        ASSERT_EQ(num, *i);
+        ++num;
+    }
+    // the tree should keep working as usual after being built
+    for (int i = 1000; i < 1100; ++i) {
+        EXPECT_TRUE(intTree.insert(i));
+    }
+    for (int i = 0; i < 500; ++i) {
+        EXPECT_TRUE(intTree.deleteElement(i));
+        EXPECT_FALSE(intTree.contains(i));
+    }
+    ASSERT_EQ(intTree.size(), 600);
+
+    // unsorted input with repeated elements gets sorted first
+    std::vector<int> unsorted;
+    for (int i = 0; i < 500; ++i) {
+        unsorted.push_back(rand() % 100);
+    }
+    SplayTree<int> intTree2{unsorted.begin(), unsorted.end()};
+    std::sort(unsorted.begin(), unsorted.end());
+    unsorted.erase(std::unique(unsorted.begin(), unsorted.end()),
+                   unsorted.end());
+    ASSERT_EQ(intTree2.size(), unsorted.size());
+    for (size_t i = 0; i < unsorted.size(); ++i) {
+        EXPECT_TRUE(intTree2.contains(unsorted[i]));
+    }
+
+    // assignSorted replaces whatever was in the tree before
+    intTree2.assignSorted(sorted.begin(), sorted.begin() + 7);
+    ASSERT_EQ(intTree2.size(), 7);
+    ASSERT_EQ(intTree2.height(), 3);
+    EXPECT_FALSE(intTree2.contains(50));
+    intTree2.assignSorted(sorted.end(), sorted.end());
+    EXPECT_TRUE(intTree2.size() == 0);
+}
+
+TEST(splayTreeIntTest, copyShapeTests)
+{
+    SplayTree<int> intTree;
+    for (int i = 0; i < 1000; ++i) {
+        intTree.insert(rand() % 5000);
+    }
+    // copies keep the shape of the original rather than rebuilding it
+    SplayTree<int> intTree2{intTree};
+    ASSERT_EQ(intTree, intTree2);
+    ASSERT_EQ(intTree.size(), intTree2.size());
+    ASSERT_EQ(intTree.height(), intTree2.height());
+
+    // assigning over a bigger tree reuses its nodes and frees the rest
+    SplayTree<int> intTree3;
+    for (int i = 0; i < 3000; ++i) {
+        intTree3.insert(i);
+    }
+    intTree3 = intTree;
+    ASSERT_EQ(intTree, intTree3);
+    ASSERT_EQ(intTree.height(), intTree3.height());
+
+    // assigning over a smaller tree allocates what is missing
+    SplayTree<int> intTree4;
+    intTree4.insert(-1);
+    intTree4 = intTree;
+    ASSERT_EQ(intTree, intTree4);
+    ASSERT_EQ(intTree.size(), intTree4.size());
+
+    // self assignment leaves the tree alone
+    intTree4 = intTree4;
+    ASSERT_EQ(intTree, intTree4);
+
+    // the copies are independent of the original
+    for (int i = 0; i < 5000; i += 2) {
+        intTree2.deleteElement(i);
+    }
+    ASSERT_EQ(intTree, intTree3);
+    ASSERT_NE(intTree, intTree2);
+
+    SplayTree<int> empty;
+    intTree4 = empty;
+    EXPECT_TRUE(intTree4.size() == 0);
+    EXPECT_FALSE(intTree4.contains(intTree.size()));
+}
+
+TEST(splayTreeIntTest, moveTests)
+{
+    SplayTree<int> intTree;
+    for (int i = 0; i < 100; ++i) {
+        intTree.insert(i);
+    }
+    SplayTree<int> copy{intTree};
+    // moving takes the nodes and leaves the original empty
+    SplayTree<int> intTree2{std::move(intTree)};
+    ASSERT_EQ(intTree2, copy);
+    EXPECT_TRUE(intTree.size() == 0);
+    SplayTree<int> intTree3;
+    intTree3.insert(5000);
+    intTree3 = std::move(intTree2);
+    ASSERT_EQ(intTree3, copy);
+    EXPECT_FALSE(intTree3.contains(5000));
+    // a moved from tree can still be used
+    EXPECT_TRUE(intTree.insert(3));
+    EXPECT_TRUE(intTree.contains(3));
+
+    int value = 7000;
+    EXPECT_TRUE(intTree3.insert(std::move(value)));
+    EXPECT_TRUE(intTree3.emplace(7001));
+    EXPECT_FALSE(intTree3.emplace(7001));
+    EXPECT_TRUE(intTree3.contains(7000));
+    EXPECT_TRUE(intTree3.contains(7001));
+    ASSERT_EQ(intTree3.size(), 102);
+
+    SplayTree<std::string> stringTree;
+    std::string test(100, 'a');
+    EXPECT_TRUE(stringTree.insert(std::move(test)));
+    EXPECT_TRUE(stringTree.emplace(3, 'b'));
+    EXPECT_FALSE(stringTree.insert(std::string(100, 'a')));
+    EXPECT_TRUE(stringTree.contains(std::string(100, 'a')));
+    EXPECT_TRUE(stringTree.contains("bbb"));
+    ASSERT_EQ(stringTree.size(), 2);
+
+    // the comparator moves along with the nodes it ordered
+    SplayTree<int, Direction> descending{Direction{false}};
+    for (int i = 0; i < 20; ++i) {
+        descending.insert(i);
+    }
+    SplayTree<int, Direction> ascending{Direction{true}};
+    ascending.insert(100);
+    ascending = std::move(descending);
+    ASSERT_EQ(ascending.size(), 20);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(ascending.contains(i));
+    }
+    EXPECT_FALSE(ascending.contains(100));
+    EXPECT_EQ(*ascending.begin(), 19);
+    EXPECT_TRUE(ascending.insert(20));
+    EXPECT_EQ(*ascending.begin(), 20);
+}
+
+TEST(splayTreeIntTest, deepTreeTests)
+{
+    // in-order inserts leave the tree as one long path
+    SplayTree<int>* intTree = new SplayTree<int>;
+    for (int i = 0; i < 1000000; ++i) {
+        intTree->insert(i);
+    }
+    ASSERT_EQ(intTree->height(), 1000000);
+    SplayTree<int> copy{*intTree};
+    ASSERT_EQ(copy.height(), 1000000);
+    // searching for the bottom element splays it back up
+    EXPECT_TRUE(intTree->contains(0));
+    EXPECT_TRUE(intTree->height() < 1000000);
+    delete intTree;
+}
+
+TEST(splayTreeIntTest, compareTests)
+{
+    // a reversed order iterates from the largest element down
+    SplayTree<int, std::greater<int>> reversed;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(reversed.insert(i));
+    }
+    EXPECT_FALSE(reversed.insert(50));
+    ASSERT_EQ(reversed.size(), 100);
+    int expected = 99;
+    for (int element : reversed) {
+        EXPECT_EQ(element, expected);
+        --expected;
+    }
+    EXPECT_TRUE(reversed.deleteElement(99));
+    EXPECT_TRUE(reversed.deleteElement(0));
+    EXPECT_FALSE(reversed.contains(99));
+    EXPECT_EQ(*reversed.begin(), 98);
+
+    // a search costs one comparison per level plus one at the bottom
+    SplayTree<int, CountingLess> counted;
+    for (int i = 0; i < 1000; ++i) {
+        counted.insert((i * 7919) % 1000);
+    }
+    size_t height = counted.height();
+    CountingLess::calls_ = 0;
+    EXPECT_TRUE(counted.contains(500));
+    EXPECT_LE(CountingLess::calls_, height + 1);
+
+    // three-way comparators work the same way
+    SplayTree<std::string, StringThreeWay> threeWay{StringThreeWay()};
+    EXPECT_TRUE(threeWay.insert("b"));
+    EXPECT_TRUE(threeWay.insert("a"));
+    EXPECT_TRUE(threeWay.insert("c"));
+    EXPECT_FALSE(threeWay.insert("b"));
+    EXPECT_TRUE(threeWay.contains("a"));
+    EXPECT_FALSE(threeWay.contains("d"));
+    ASSERT_EQ(threeWay.size(), 3);
+    EXPECT_TRUE(threeWay.deleteElement("b"));
+    EXPECT_EQ(*threeWay.begin(), "a");
+
+    // transparent comparators can look up keys of another type
+    SplayTree<std::string, LengthLess> byLength;
+    EXPECT_TRUE(byLength.insert("aa"));
+    EXPECT_TRUE(byLength.insert("bbbb"));
+    EXPECT_FALSE(byLength.insert("cc"));
+    EXPECT_TRUE(byLength.contains(size_t(4)));
+    EXPECT_FALSE(byLength.contains(size_t(3)));
+}
+
+TEST(splayTreeIntTest, boundTests)
+{
+    SplayTree<int> tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i * 3);
+    }
+    // lower_bound stops at an equal element, or the next one up
+    EXPECT_EQ(*tree.lower_bound(30), 30);
+    EXPECT_EQ(*tree.lower_bound(31), 33);
+    EXPECT_EQ(*tree.lower_bound(-5), 0);
+    EXPECT_TRUE(tree.lower_bound(298) == tree.end());
+
+    // upper_bound always moves past an equal element
+    EXPECT_EQ(*tree.upper_bound(30), 33);
+    EXPECT_EQ(*tree.upper_bound(31), 33);
+    EXPECT_TRUE(tree.upper_bound(297) == tree.end());
+
+    EXPECT_EQ(*tree.find(90), 90);
+    EXPECT_TRUE(tree.find(91) == tree.end());
+
+    auto equal = tree.equal_range(60);
+    EXPECT_EQ(*equal.first, 60);
+    EXPECT_EQ(*equal.second, 63);
+    equal = tree.equal_range(61);
+    EXPECT_TRUE(equal.first == equal.second);
+
+    // ranges are half open
+    std::vector<int> scanned;
+    for (int element : tree.range(9, 39)) {
+        scanned.push_back(element);
+    }
+    std::vector<int> expected;
+    for (int element = 9; element < 39; element += 3) {
+        expected.push_back(element);
+    }
+    EXPECT_EQ(scanned, expected);
+    EXPECT_TRUE(tree.range(40, 10).empty());
+    EXPECT_TRUE(tree.range(31, 32).empty());
+    size_t count = 0;
+    for (int element : tree.range(290, 1000)) {
+        EXPECT_GE(element, 290);
+        ++count;
+    }
+    EXPECT_EQ(count, 3);
+
+    // bounds follow the tree's order, not operator<
+    SplayTree<int, std::greater<int>> reversed;
+    for (int i = 0; i < 10; ++i) {
+        reversed.insert(i);
+    }
+    EXPECT_EQ(*reversed.lower_bound(5), 5);
+    EXPECT_EQ(*reversed.upper_bound(5), 4);
+    scanned.clear();
+    for (int element : reversed.range(8, 3)) {
+        scanned.push_back(element);
+    }
+    expected = {8, 7, 6, 5, 4};
+    EXPECT_EQ(scanned, expected);
+}
+
 TEST(splayTreeOtterTest, insertTests)
 {
     SplayTree<Otter> otterTree;
@@ -0,0 +1,146 @@
+/**
+ * \file trace_test.cpp
+ * \author Andrew Scott
+ *
+ * \brief Tests that traces read back what was written, and that a
+ * TracingTree records what it passes on
+ *
+ */
+
+#include "trace.hpp"
+#include "avl_tree.hpp"
+#include <climits>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+/// returns a file name for this test to use, unique to the encoding
+std::string tracePath(const char* name)
+{
+    return std::string("trace_test_") + name + ".trace";
+}
+
+/// reads every record out of a trace, count at a time
+std::vector<TraceRecord> readAll(TraceReader& reader, size_t count)
+{
+    std::vector<TraceRecord> all;
+    const TraceRecord* records = nullptr;
+    size_t read;
+    while ((read = reader.next(records, count)) != 0) {
+        all.insert(all.end(), records, records + read);
+    }
+    return all;
+}
+
+TEST(traceTest, roundTripTests)
+{
+    std::vector<TraceRecord> written;
+    const int32_t keys[] = {0, 1, -1, INT_MAX, INT_MIN, INT_MAX, 42, 43, 41};
+    for (int i = 0; i < 9; ++i) {
+        written.push_back(TraceRecord{TraceOperation(i % 4), keys[i]});
+    }
+    for (int i = 0; i < 10000; ++i) {
+        written.push_back(TraceRecord{TraceOperation::INSERT, i * 7 - 5000});
+    }
+    const char* names[] = {"raw", "delta"};
+    for (TraceEncoding encoding : {TraceEncoding::RAW, TraceEncoding::DELTA}) {
+        std::string path = tracePath(names[int(encoding)]);
+        {
+            TraceWriter writer{path, encoding};
+            for (const TraceRecord& record : written) {
+                writer.append(record.operation_, record.key_);
+            }
+            ASSERT_EQ(writer.records(), written.size());
+            ASSERT_TRUE(writer.close());
+        }
+        TraceReader reader{path};
+        ASSERT_TRUE(reader.good());
+        ASSERT_EQ(reader.encoding(), encoding);
+        ASSERT_EQ(reader.records(), written.size());
+        // whatever the chunks, the same records come out
+        for (size_t count : {size_t(1), size_t(3), size_t(4096)}) {
+            reader.rewind();
+            std::vector<TraceRecord> read = readAll(reader, count);
+            ASSERT_EQ(read.size(), written.size());
+            for (size_t i = 0; i < read.size(); ++i) {
+                EXPECT_EQ(read[i].operation_, written[i].operation_);
+                EXPECT_EQ(read[i].key_, written[i].key_);
+            }
+        }
+        EXPECT_TRUE(reader.good());
+        remove(path.c_str());
+    }
+}
+
+TEST(traceTest, badFileTests)
+{
+    TraceReader missing{tracePath("missing")};
+    EXPECT_FALSE(missing.good());
+    const TraceRecord* records = nullptr;
+    EXPECT_EQ(missing.next(records, 10), 0);
+
+    // not a trace at all
+    std::string path = tracePath("bad");
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fputs("this is not a trace, though it is long enough to be one", file);
+    fclose(file);
+    TraceReader garbage{path};
+    EXPECT_FALSE(garbage.good());
+
+    // a header promising more records than there are
+    {
+        TraceWriter writer{path, TraceEncoding::DELTA};
+        for (int i = 0; i < 100; ++i) {
+            writer.append(TraceOperation::READ, i * 1000);
+        }
+    }
+    file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fclose(file);
+    ASSERT_EQ(truncate(path.c_str(), length - 20), 0);
+    TraceReader cut{path};
+    ASSERT_TRUE(cut.good());
+    EXPECT_LT(readAll(cut, 1000).size(), 100);
+    EXPECT_FALSE(cut.good());
+    remove(path.c_str());
+}
+
+TEST(traceTest, tracingTreeTests)
+{
+    std::string path = tracePath("tree");
+    AvlTree<int> tree;
+    {
+        TraceWriter writer{path, TraceEncoding::DELTA};
+        TracingTree<int> traced{tree, writer};
+        AbstractTree<int>& abstract = traced;
+        EXPECT_TRUE(abstract.insert(5));
+        EXPECT_TRUE(abstract.insert(3));
+        EXPECT_FALSE(abstract.insert(5));
+        EXPECT_TRUE(abstract.contains(3));
+        EXPECT_FALSE(abstract.contains(4));
+        EXPECT_TRUE(abstract.deleteElement(5));
+        EXPECT_FALSE(abstract.deleteElement(5));
+        EXPECT_EQ(abstract.size(), 1);
+        EXPECT_EQ(writer.records(), 7);
+    }
+    // every call is there, whether it did anything or not
+    ASSERT_EQ(tree.size(), 1);
+    TraceReader reader{path};
+    ASSERT_TRUE(reader.good());
+    std::vector<TraceRecord> read = readAll(reader, 100);
+    const TraceOperation operations[] = {
+        TraceOperation::INSERT, TraceOperation::INSERT,
+        TraceOperation::INSERT, TraceOperation::READ, TraceOperation::READ,
+        TraceOperation::DELETE, TraceOperation::DELETE};
+    const int keys[] = {5, 3, 5, 3, 4, 5, 5};
+    ASSERT_EQ(read.size(), 7);
+    for (size_t i = 0; i < read.size(); ++i) {
+        EXPECT_EQ(read[i].operation_, operations[i]);
+        EXPECT_EQ(read[i].key_, keys[i]);
+    }
+    remove(path.c_str());
+}
@@ -10,10 +10,11 @@
  *
  */
 
-#include "twothreefourtree.hpp"
+#include "two_three_four_tree.hpp"
 #include <iostream>
 #include <stdlib.h>      // rand(), srand()
 #include <time.h>       // time
+#include <vector>
 #include <gtest/gtest.h>
 #include "otter.hpp"
 
@@ -29,7 +30,7 @@ TEST(twothreefourTreeIntTest, insertTests)
     int test2 = 1;
     inserted = intTree.insert(test2);
     EXPECT_TRUE(intTree.contains(test2));
-    EXPECT_TRUE(intTree.size() == 1);
+    EXPECT_TRUE(intTree.size() == 2);
     EXPECT_TRUE(inserted);
     //EXPECT_TRUE(intTree.hasRBProperties());
     // check that inserting again returns false
@@ -45,12 +46,119 @@ TEST(twothreefourTreeIntTest, insertTests)
     twothreefourTree<int> intTree2;
     for (int i = 0; i < 200; ++i) {
         int intToInsert = rand() % 200;
-        EXPECT_FALSE(intTree2.contains(intToInsert));
-        intTree2.insert(intToInsert);
+        // the same number can come up twice, and only goes in once
+        bool present = intTree2.contains(intToInsert);
+        EXPECT_EQ(!present, intTree2.insert(intToInsert));
         EXPECT_TRUE(intTree2.contains(intToInsert));
         //EXPECT_TRUE(intTree.hasRBProperties());
     }
 }
+
+TEST(twothreefourTreeIntTest, iteratorTests)
+{
+    twothreefourTree<int> intTree;
+    EXPECT_TRUE(intTree.begin() == intTree.end());
+
+    // one, two and three elements all fit in the root
+    for (int i = 1; i <= 3; ++i) {
+        intTree.insert(i * 10);
+        std::vector<int> forward;
+        twothreefourTree<int>::iterator last = intTree.begin();
+        for (twothreefourTree<int>::iterator j = intTree.begin();
+             j != intTree.end(); ++j) {
+            forward.push_back(*j);
+            last = j;
+        }
+        std::vector<int> backward;
+        for (twothreefourTree<int>::iterator j = last; j != intTree.end(); --j) {
+            backward.insert(backward.begin(), *j);
+        }
+        std::vector<int> expected;
+        for (int j = 1; j <= i; ++j) {
+            expected.push_back(j * 10);
+        }
+        EXPECT_EQ(expected, forward);
+        EXPECT_EQ(expected, backward);
+    }
+
+    // enough elements, in a scrambled order, to split nodes at every level
+    twothreefourTree<int> bigTree;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(bigTree.insert((i * 7919) % 1000));
+    }
+    ASSERT_EQ(bigTree.size(), 1000);
+    int expected = 0;
+    twothreefourTree<int>::iterator last = bigTree.begin();
+    for (twothreefourTree<int>::iterator i = bigTree.begin();
+         i != bigTree.end(); ++i) {
+        EXPECT_EQ(expected, *i);
+        ++expected;
+        last = i;
+    }
+    EXPECT_EQ(expected, 1000);
+    for (twothreefourTree<int>::iterator i = last; i != bigTree.end(); --i) {
+        --expected;
+        EXPECT_EQ(expected, *i);
+    }
+    EXPECT_EQ(expected, 0);
+}
+
+TEST(twothreefourTreeIntTest, boundTests)
+{
+    twothreefourTree<int> intTree;
+    EXPECT_TRUE(intTree.lower_bound(10) == intTree.end());
+    EXPECT_TRUE(intTree.upper_bound(10) == intTree.end());
+
+    // a single node first
+    intTree.insert(20);
+    intTree.insert(10);
+    intTree.insert(30);
+    // at each element
+    EXPECT_EQ(10, *intTree.lower_bound(10));
+    EXPECT_EQ(20, *intTree.upper_bound(10));
+    EXPECT_EQ(20, *intTree.lower_bound(20));
+    EXPECT_EQ(30, *intTree.upper_bound(20));
+    EXPECT_EQ(30, *intTree.lower_bound(30));
+    EXPECT_TRUE(intTree.upper_bound(30) == intTree.end());
+    // before, between and after the elements
+    EXPECT_EQ(10, *intTree.lower_bound(5));
+    EXPECT_EQ(10, *intTree.upper_bound(5));
+    EXPECT_EQ(20, *intTree.lower_bound(15));
+    EXPECT_EQ(20, *intTree.upper_bound(15));
+    EXPECT_EQ(30, *intTree.lower_bound(25));
+    EXPECT_EQ(30, *intTree.upper_bound(25));
+    EXPECT_TRUE(intTree.lower_bound(35) == intTree.end());
+    EXPECT_TRUE(intTree.upper_bound(35) == intTree.end());
+
+    // then the even numbers below 1000, over many nodes
+    for (int i = 0; i < 500; ++i) {
+        intTree.insert(((i * 7919) % 500) * 2);
+    }
+    for (int i = 0; i < 998; ++i) {
+        int even = i - i % 2;
+        EXPECT_EQ(even + 2, *intTree.upper_bound(i));
+        EXPECT_EQ(i % 2 == 0 ? i : i + 1, *intTree.lower_bound(i));
+        EXPECT_EQ(i % 2 == 0, intTree.find(i) != intTree.end());
+        EXPECT_EQ(i % 2 == 0, intTree.contains(i));
+    }
+    EXPECT_TRUE(intTree.lower_bound(999) == intTree.end());
+    EXPECT_TRUE(intTree.upper_bound(998) == intTree.end());
+
+    std::pair<twothreefourTree<int>::iterator,
+              twothreefourTree<int>::iterator> equal = intTree.equal_range(20);
+    EXPECT_EQ(20, *equal.first);
+    EXPECT_EQ(22, *equal.second);
+    equal = intTree.equal_range(15);
+    EXPECT_TRUE(equal.first == equal.second);
+
+    std::vector<int> inRange;
+    for (int element : intTree.range(15, 30)) {
+        inRange.push_back(element);
+    }
+    EXPECT_EQ((std::vector<int>{16, 18, 20, 22, 24, 26, 28}), inRange);
+    EXPECT_TRUE(intTree.range(30, 10).begin() == intTree.range(30, 10).end());
+}
+
 /*
 TEST(twothreefourTreeIntTest, basicEqualityTests)
 {
@@ -43,11 +43,15 @@ struct Pair {
     int64_t hash;
 };
 
-double distance( const Pair& card1, const Pair& card2)
-{
-    int64_t diff = card1.hash ^ card2.hash;
-    return double(__builtin_popcount(diff));
-}
+struct CardDistance {
+    typedef unsigned Distance;
+
+    unsigned operator()( const Pair& card1, const Pair& card2 ) const {
+        return Hamming64()( card1.hash, card2.hash );
+    }
+};
+
+CardDistance distance;
 
 struct HeapItem {
     HeapItem( int index, double dist) :
@@ -177,7 +181,7 @@ int main( int argc, char* argv[] ) {
     //     //if(points.size()>50000)break;
     // }
     std::cout << "creating tree" << std::endl;
-    VpTree<Pair, distance> tree;
+    VpTree<Pair, CardDistance> tree;
     // uint64_t start, end;
     // QueryPerformanceCounter( &start );
 
@@ -192,7 +196,7 @@ int main( int argc, char* argv[] ) {
     // point.latitude = 43.466438;
     // point.longitude = -80.519185;
     std::vector<Pair> results;
-    std::vector<double> distances;
+    std::vector<unsigned> distances;
 
     // QueryPerformanceCounter( &start );
     tree.search( test, 8, &results, &distances );
@@ -0,0 +1,361 @@
+/**
+ * \file vp_tree_test.cpp
+ * \author Andrew Scott
+ *
+ * \brief Tests that a VpTree finds the same neighbours as looking at every
+ * item
+ *
+ */
+
+#include "vp-tree.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+/// how many times operator new has been called
+size_t allocations = 0;
+
+void* operator new(size_t bytes)
+{
+    ++allocations;
+    void* memory = malloc(bytes == 0 ? 1 : bytes);
+    if (memory == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+struct Hashed {
+    int id;
+    uint64_t hash;
+};
+
+/// counts the differing bits one at a time, to check the tree's metric by
+unsigned hammingDistance(const Hashed& lhs, const Hashed& rhs)
+{
+    uint64_t diff = lhs.hash ^ rhs.hash;
+    unsigned bits = 0;
+    for (; diff != 0; diff &= diff - 1) {
+        ++bits;
+    }
+    return bits;
+}
+
+struct HashedHamming {
+    typedef unsigned Distance;
+
+    unsigned operator()(const Hashed& lhs, const Hashed& rhs) const
+    {
+        return Hamming64()(lhs.hash, rhs.hash);
+    }
+};
+
+using HashTree = VpTree<Hashed, HashedHamming>;
+
+/// returns count items with random hashes, ids being their positions
+std::vector<Hashed> randomItems(size_t count, std::mt19937_64& rng)
+{
+    std::vector<Hashed> items;
+    for (size_t i = 0; i < count; ++i) {
+        items.push_back(Hashed{int(i), rng()});
+    }
+    return items;
+}
+
+/// returns the distances of the k nearest items, nearest first
+std::vector<unsigned> nearestDistances(const std::vector<Hashed>& items,
+                                     const Hashed& target, size_t k)
+{
+    std::vector<unsigned> distances;
+    for (const Hashed& item : items) {
+        distances.push_back(hammingDistance(item, target));
+    }
+    std::sort(distances.begin(), distances.end());
+    distances.resize(std::min(k, distances.size()));
+    return distances;
+}
+
+TEST(vpTreeTest, emptyTests)
+{
+    HashTree tree;
+    std::vector<Hashed> results;
+    std::vector<unsigned> distances;
+    tree.search(Hashed{0, 0}, 4, &results, &distances);
+    EXPECT_TRUE(results.empty());
+    EXPECT_TRUE(distances.empty());
+
+    tree.create({});
+    tree.search(Hashed{0, 0}, 4, &results, &distances);
+    EXPECT_TRUE(results.empty());
+}
+
+TEST(vpTreeTest, searchTests)
+{
+    std::mt19937_64 rng{7};
+    srand(7);
+    for (size_t size : {1, 2, 3, 10, 100, 5000}) {
+        std::vector<Hashed> items = randomItems(size, rng);
+        HashTree tree;
+        tree.create(items);
+        for (size_t k : {1, 3, 8, 20}) {
+            for (int query = 0; query < 20; ++query) {
+                Hashed target{-1, rng()};
+                std::vector<Hashed> results;
+                std::vector<unsigned> distances;
+                tree.search(target, k, &results, &distances);
+                EXPECT_EQ(nearestDistances(items, target, k), distances);
+                ASSERT_EQ(distances.size(), results.size());
+                for (size_t i = 0; i < results.size(); ++i) {
+                    // every result is one of the items, at the distance given
+                    ASSERT_LE(0, results[i].id);
+                    ASSERT_GT(int(size), results[i].id);
+                    EXPECT_EQ(items[results[i].id].hash, results[i].hash);
+                    EXPECT_EQ(hammingDistance(results[i], target),
+                              distances[i]);
+                }
+            }
+        }
+    }
+}
+
+TEST(vpTreeTest, leafSizeTests)
+{
+    std::mt19937_64 rng{9};
+    std::vector<Hashed> items = randomItems(3000, rng);
+    // sizes below one or past the largest bucket allowed are clamped
+    for (int leafSize : {-3, 0, 1, 2, 5, 16, 64, 1000}) {
+        HashTree tree{leafSize};
+        tree.create(items);
+        for (int query = 0; query < 20; ++query) {
+            Hashed target{-1, rng()};
+            std::vector<Hashed> results;
+            std::vector<unsigned> distances;
+            tree.search(target, 10, &results, &distances);
+            EXPECT_EQ(nearestDistances(items, target, 10), distances);
+            for (size_t i = 0; i < results.size(); ++i) {
+                EXPECT_EQ(hammingDistance(results[i], target), distances[i]);
+            }
+        }
+    }
+}
+
+/// returns the ids of the items at most radius from target, in order
+std::vector<int> idsInRadius(const std::vector<Hashed>& items,
+                             const Hashed& target, unsigned radius)
+{
+    std::vector<int> ids;
+    for (const Hashed& item : items) {
+        if (hammingDistance(item, target) <= radius) {
+            ids.push_back(item.id);
+        }
+    }
+    return ids;
+}
+
+/// counts what it is shown, and checks the distances it is given
+struct RadiusCounter {
+    size_t* count_;
+    const Hashed* target_;
+
+    void operator()(const Hashed& item, unsigned distance)
+    {
+        EXPECT_EQ(hammingDistance(item, *target_), distance);
+        ++*count_;
+    }
+};
+
+TEST(vpTreeTest, queryTests)
+{
+    std::mt19937_64 rng{19};
+    std::vector<Hashed> items = randomItems(4000, rng);
+    HashTree tree;
+    tree.create(items);
+    HashTree::Query query;
+    // both sides of the small heap's limit
+    for (size_t k : {1, 2, 15, 16, 17, 40}) {
+        std::vector<const Hashed*> results(k);
+        std::vector<unsigned> distances(k);
+        for (int search = 0; search < 20; ++search) {
+            Hashed target{-1, rng()};
+            size_t allocated = allocations;
+            size_t count = tree.search(target, k, query, results.data(),
+                                       distances.data());
+            // the first big search grows the query, and nothing else does
+            if (k <= 16 || search > 0) {
+                EXPECT_EQ(allocated, allocations);
+            }
+            ASSERT_EQ(k, count);
+            EXPECT_EQ(nearestDistances(items, target, k), distances);
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(hammingDistance(*results[i], target),
+                          distances[i]);
+            }
+        }
+    }
+
+    // fewer items than asked for, or none
+    HashTree small;
+    small.create(randomItems(5, rng));
+    const Hashed* results[40];
+    unsigned distances[40];
+    EXPECT_EQ(5u, small.search(Hashed{-1, 0}, 40, query, results, distances));
+    EXPECT_EQ(5u, small.search(Hashed{-1, 0}, 8, query, results, distances));
+    EXPECT_TRUE(std::is_sorted(distances, distances + 5));
+    EXPECT_EQ(0u, small.search(Hashed{-1, 0}, 0, query, results, distances));
+    HashTree empty;
+    EXPECT_EQ(0u, empty.search(Hashed{-1, 0}, 8, query, results, distances));
+}
+
+TEST(vpTreeTest, searchRadiusTests)
+{
+    std::mt19937_64 rng{17};
+    // near copies of a few hashes, so that small radii find something
+    std::vector<Hashed> items;
+    for (int seed = 0; seed < 40; ++seed) {
+        uint64_t hash = rng();
+        for (int copy = 0; copy < 50; ++copy) {
+            items.push_back(Hashed{int(items.size()),
+                                   hash ^ (uint64_t(1) << (rng() % 64)) ^
+                                       (uint64_t(1) << (rng() % 64))});
+        }
+    }
+    for (int leafSize : {1, 16}) {
+        HashTree tree{leafSize};
+        tree.create(items);
+        for (unsigned radius : {0u, 1u, 2u, 4u, 20u, 64u}) {
+            Hashed target{-1, items[rng() % items.size()].hash};
+            std::vector<int> expected = idsInRadius(items, target, radius);
+            std::vector<Hashed> results;
+            std::vector<unsigned> distances;
+            EXPECT_TRUE(tree.searchRadius(target, radius, &results,
+                                          &distances));
+            ASSERT_EQ(results.size(), distances.size());
+            std::vector<int> ids;
+            for (size_t i = 0; i < results.size(); ++i) {
+                EXPECT_EQ(hammingDistance(results[i], target), distances[i]);
+                ids.push_back(results[i].id);
+            }
+            std::sort(ids.begin(), ids.end());
+            EXPECT_EQ(expected, ids);
+
+            size_t count = 0;
+            EXPECT_TRUE(tree.forEachInRadius(target, radius,
+                                             RadiusCounter{&count, &target}));
+            EXPECT_EQ(expected.size(), count);
+
+            // a cap only says false when there were more to find
+            size_t limit = expected.size() / 2;
+            bool more = limit < expected.size();
+            EXPECT_EQ(!more, tree.searchRadius(target, radius, &results,
+                                               &distances, limit));
+            EXPECT_EQ(limit, results.size());
+            EXPECT_TRUE(tree.searchRadius(target, radius, &results,
+                                          &distances, expected.size()));
+            EXPECT_EQ(expected.size(), results.size());
+        }
+    }
+
+    HashTree empty;
+    std::vector<Hashed> results;
+    std::vector<unsigned> distances;
+    EXPECT_TRUE(empty.searchRadius(Hashed{0, 0}, 64, &results, &distances, 0));
+    EXPECT_TRUE(results.empty());
+}
+
+TEST(vpTreeTest, hammingTests)
+{
+    EXPECT_EQ(0u, Hamming64()(0, 0));
+    EXPECT_EQ(64u, Hamming64()(0, ~uint64_t(0)));
+    // the high half counts too
+    EXPECT_EQ(1u, Hamming64()(0, uint64_t(1) << 63));
+    EXPECT_EQ(32u, Hamming64()(0, 0xffffffff00000000ull));
+    EXPECT_EQ(128u, Hamming128()(Hash128{0, 0}, Hash128{~uint64_t(0),
+                                                       ~uint64_t(0)}));
+    EXPECT_EQ(2u, Hamming128()(Hash128{1, 0}, Hash128{0, 1}));
+
+    std::mt19937_64 rng{13};
+    std::vector<Hash128> items;
+    for (int i = 0; i < 2000; ++i) {
+        items.push_back(Hash128{rng(), rng()});
+    }
+    VpTree<Hash128, Hamming128> tree;
+    tree.create(items);
+    for (int query = 0; query < 20; ++query) {
+        Hash128 target{rng(), rng()};
+        std::vector<unsigned> expected;
+        for (const Hash128& item : items) {
+            expected.push_back(Hamming128()(item, target));
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.resize(5);
+        std::vector<Hash128> results;
+        std::vector<unsigned> distances;
+        tree.search(target, 5, &results, &distances);
+        EXPECT_EQ(expected, distances);
+    }
+}
+
+/// a metric with state, the distance along a line scaled by a factor
+struct ScaledDistance {
+    typedef double Distance;
+
+    double scale_;
+
+    double operator()(double lhs, double rhs) const
+    {
+        return scale_ * (lhs < rhs ? rhs - lhs : lhs - rhs);
+    }
+};
+
+TEST(vpTreeTest, statefulMetricTests)
+{
+    std::vector<double> items;
+    for (int i = 0; i < 1000; ++i) {
+        items.push_back(i * 0.5);
+    }
+    VpTree<double, ScaledDistance> tree{4, ScaledDistance{3.0}};
+    tree.create(items);
+    std::vector<double> results;
+    std::vector<double> distances;
+    tree.search(100.1, 3, &results, &distances);
+    ASSERT_EQ(3u, results.size());
+    EXPECT_DOUBLE_EQ(100.0, results[0]);
+    EXPECT_DOUBLE_EQ(100.5, results[1]);
+    EXPECT_DOUBLE_EQ(99.5, results[2]);
+    EXPECT_NEAR(0.3, distances[0], 1e-9);
+    EXPECT_NEAR(1.2, distances[1], 1e-9);
+}
+
+TEST(vpTreeTest, recreateTests)
+{
+    std::mt19937_64 rng{11};
+    HashTree tree;
+    tree.create(randomItems(1000, rng));
+    std::vector<Hashed> items = randomItems(50, rng);
+    tree.create(items);
+    Hashed target{-1, rng()};
+    std::vector<Hashed> results;
+    std::vector<unsigned> distances;
+    tree.search(target, 100, &results, &distances);
+    EXPECT_EQ(nearestDistances(items, target, 100), distances);
+
+    // copies have their own nodes
+    HashTree copy = tree;
+    tree.create({});
+    copy.search(target, 100, &results, &distances);
+    EXPECT_EQ(nearestDistances(items, target, 100), distances);
+}
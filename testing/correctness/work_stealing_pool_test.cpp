@@ -0,0 +1,113 @@
+/**
+ * \file work_stealing_pool_test.cpp
+ * \author Andrew Scott
+ *
+ * \brief Tests a WorkStealingPool for correctness
+ *
+ */
+
+#include "work_stealing_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+/// adds up [lower, upper) by splitting it in half until the pieces are small
+long long parallelSum(WorkStealingPool& pool, const std::vector<int>& numbers,
+                      size_t lower, size_t upper)
+{
+    if (upper - lower < 64) {
+        long long sum = 0;
+        for (size_t i = lower; i < upper; ++i) {
+            sum += numbers[i];
+        }
+        return sum;
+    }
+    size_t middle = lower + (upper - lower) / 2;
+    long long left = 0;
+    long long right = 0;
+    pool.invoke([&] { left = parallelSum(pool, numbers, lower, middle); },
+                [&] { right = parallelSum(pool, numbers, middle, upper); });
+    return left + right;
+}
+
+TEST(workStealingPoolTest, invokeTests)
+{
+    std::vector<int> numbers;
+    for (int i = 0; i < 100000; ++i) {
+        numbers.push_back(i);
+    }
+    long long expected = 100000LL * 99999 / 2;
+    for (size_t threads : {1, 2, 4, 8}) {
+        WorkStealingPool pool{threads};
+        ASSERT_EQ(pool.threads(), threads);
+        EXPECT_EQ(parallelSum(pool, numbers, 0, numbers.size()), expected);
+    }
+    // zero threads still leaves the caller
+    WorkStealingPool none{0};
+    ASSERT_EQ(none.threads(), 1);
+    EXPECT_EQ(parallelSum(none, numbers, 0, numbers.size()), expected);
+    EXPECT_GE(WorkStealingPool::shared().threads(), 1);
+}
+
+TEST(workStealingPoolTest, stealTests)
+{
+    // right blocks until left sees it has started, which can only happen if
+    // another thread stole it
+    WorkStealingPool pool{2};
+    std::atomic<bool> started{false};
+    std::thread::id leftThread;
+    std::thread::id rightThread;
+    pool.invoke(
+        [&] {
+            leftThread = std::this_thread::get_id();
+            while (!started) {
+                std::this_thread::yield();
+            }
+        },
+        [&] {
+            rightThread = std::this_thread::get_id();
+            started = true;
+        });
+    EXPECT_NE(leftThread, rightThread);
+
+    // several outside threads can share a pool
+    std::vector<int> numbers(50000, 1);
+    std::vector<std::thread> callers;
+    std::atomic<int> correct{0};
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&] {
+            if (parallelSum(pool, numbers, 0, numbers.size()) == 50000) {
+                ++correct;
+            }
+        });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    EXPECT_EQ(correct, 4);
+}
+
+TEST(workStealingPoolTest, exceptionTests)
+{
+    WorkStealingPool pool{4};
+    bool ranLeft = false;
+    bool ranRight = false;
+    EXPECT_THROW(pool.invoke([&] { ranLeft = true; },
+                             [&] {
+                                 ranRight = true;
+                                 throw std::runtime_error("right");
+                             }),
+                 std::runtime_error);
+    EXPECT_TRUE(ranLeft);
+    EXPECT_TRUE(ranRight);
+    // right still runs, and is finished, when left throws
+    ranRight = false;
+    EXPECT_THROW(pool.invoke([] { throw std::logic_error("left"); },
+                             [&] { ranRight = true; }),
+                 std::logic_error);
+    EXPECT_TRUE(ranRight);
+}
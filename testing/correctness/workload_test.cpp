@@ -0,0 +1,151 @@
+/**
+ * \file workload_test.cpp
+ * \author Andrew Scott
+ *
+ * \brief Tests that the benchmark's workloads have the mix and skew they
+ * are asked for
+ *
+ */
+
+#include "workload.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+
+/// returns the fraction of reads that went to the ten most read keys
+double topTenShare(const std::vector<Request>& requests)
+{
+    std::map<int, size_t> reads;
+    size_t total = 0;
+    for (const Request& request : requests) {
+        if (request.operation_ == Operation::READ) {
+            ++reads[request.key_];
+            ++total;
+        }
+    }
+    std::vector<size_t> counts;
+    for (const std::pair<const int, size_t>& read : reads) {
+        counts.push_back(read.second);
+    }
+    std::sort(counts.begin(), counts.end(), std::greater<size_t>());
+    size_t top = 0;
+    for (size_t i = 0; i < counts.size() && i < 10; ++i) {
+        top += counts[i];
+    }
+    return double(top) / total;
+}
+
+TEST(zipfianGeneratorTest, rankTests)
+{
+    pcg32 rng{42, 1};
+    ZipfianGenerator zipf{1000, 0.99};
+    EXPECT_EQ(1000u, zipf.items());
+    std::vector<size_t> counts(1000);
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t rank = zipf.next(rng);
+        ASSERT_LT(rank, 1000u);
+        ++counts[rank];
+    }
+    // rank 0 is the most likely, and far more likely than the middle ranks
+    EXPECT_EQ(counts.begin(), std::max_element(counts.begin(), counts.end()));
+    EXPECT_GT(counts[0], 50 * counts[500]);
+
+    zipf.grow(2000);
+    EXPECT_EQ(2000u, zipf.items());
+    zipf.grow(10);
+    EXPECT_EQ(2000u, zipf.items());
+    uint64_t largest = 0;
+    for (int i = 0; i < 100000; ++i) {
+        largest = std::max(largest, zipf.next(rng));
+    }
+    EXPECT_LT(largest, 2000u);
+    EXPECT_GE(largest, 1000u);
+}
+
+TEST(workloadGeneratorTest, insertTests)
+{
+    WorkloadSpec spec;
+    spec.initialRecords_ = 1000;
+    WorkloadGenerator generator{spec, 42, 1};
+    std::vector<int> initial = generator.initialKeys();
+    std::set<int> keys(initial.begin(), initial.end());
+    EXPECT_EQ(1000u, keys.size());
+
+    // inserts add keys nobody has seen, and everything else uses old ones
+    for (const Request& request : generator.next(10000)) {
+        if (request.operation_ == Operation::INSERT) {
+            EXPECT_TRUE(keys.insert(request.key_).second);
+        } else {
+            EXPECT_EQ(1u, keys.count(request.key_));
+        }
+    }
+    EXPECT_EQ(keys.size(), generator.records());
+    EXPECT_GT(generator.records(), 1000u);
+}
+
+TEST(workloadGeneratorTest, zipfianSkewTests)
+{
+    WorkloadSpec readOnly;
+    readOnly.mix_ = OperationMix{100, 0, 0, 0};
+    WorkloadGenerator readGenerator{readOnly, 42, 1};
+    double readOnlyShare = topTenShare(readGenerator.next(100000));
+    EXPECT_GT(readOnlyShare, 0.15);
+
+    // inserts mustn't move the popular records around, which would spread
+    // the reads out until they were nearly uniform
+    WorkloadSpec production;
+    WorkloadGenerator generator{production, 42, 1};
+    std::vector<Request> requests = generator.next(100000);
+    EXPECT_GT(generator.records(), production.initialRecords_);
+    EXPECT_GT(topTenShare(requests), 0.8 * readOnlyShare);
+
+    // and the uniform distribution has no hot set to speak of
+    WorkloadSpec uniform;
+    uniform.distribution_ = KeyDistribution::UNIFORM;
+    WorkloadGenerator uniformGenerator{uniform, 42, 1};
+    EXPECT_LT(topTenShare(uniformGenerator.next(100000)), 0.01);
+}
+
+TEST(workloadGeneratorTest, latestTests)
+{
+    WorkloadSpec spec;
+    spec.distribution_ = KeyDistribution::LATEST;
+    spec.scrambleKeys_ = false;
+    spec.initialRecords_ = 1000;
+    WorkloadGenerator generator{spec, 42, 1};
+    // most reads go to the newest tenth of the records, counting the ones
+    // inserted since
+    size_t reads = 0;
+    size_t recent = 0;
+    for (int i = 0; i < 10000; ++i) {
+        Request request = generator.next(1).front();
+        if (request.operation_ == Operation::READ) {
+            ++reads;
+            // keys are the records themselves when they aren't scrambled
+            recent += uint64_t(request.key_) >= generator.records() * 9 / 10;
+        }
+    }
+    EXPECT_GT(recent, reads / 2);
+}
+
+TEST(workloadGeneratorTest, parseTests)
+{
+    OperationMix mix;
+    EXPECT_TRUE(parseOperationMix("production", mix));
+    EXPECT_EQ(90, mix.read_);
+    EXPECT_TRUE(parseOperationMix("read=1,scan=3", mix));
+    EXPECT_EQ(1, mix.read_);
+    EXPECT_EQ(0, mix.insert_);
+    EXPECT_EQ(3, mix.scan_);
+    EXPECT_FALSE(parseOperationMix("read=0", mix));
+    EXPECT_FALSE(parseOperationMix("read=-1", mix));
+    EXPECT_FALSE(parseOperationMix("write=5", mix));
+
+    KeyDistribution distribution;
+    EXPECT_TRUE(parseKeyDistribution("latest", distribution));
+    EXPECT_EQ(KeyDistribution::LATEST, distribution);
+    EXPECT_FALSE(parseKeyDistribution("normal", distribution));
+}
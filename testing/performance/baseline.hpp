@@ -0,0 +1,65 @@
+/**
+ * \file baseline.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief Reading an earlier run of the benchmark back in and telling
+ * whether a phase got faster or slower since
+ *
+ * \details A baseline is the JSON the benchmark writes with -f json. Every
+ * result in it is one cell, a phase of a workload on a container, key type,
+ * size and thread count, with the time each repetition took. Two runs of a
+ * cell are compared with a two-sided Mann-Whitney U test on those times,
+ * which needs no assumption about how the times are spread. The p-value is
+ * exact for small samples without ties, and otherwise comes from the normal
+ * approximation with a correction for ties.
+ */
+
+#ifndef BASELINE_HPP_INCLUDED
+#define BASELINE_HPP_INCLUDED 1
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief one result of an earlier run
+ */
+struct BaselineCell {
+    std::string container_;
+    std::string key_;             ///> "int" for runs from before key types
+    std::string workload_;
+    size_t size_;
+    size_t threads_;
+    std::string phase_;
+    double medianMicros_;
+    std::vector<double> micros_;  ///> one time per repetition, may be empty
+};
+
+/**
+ * \brief reads the cells of the benchmark JSON at path
+ *
+ * \returns false, with why in error, if it couldn't be read or isn't
+ * benchmark results
+ */
+bool readBaseline(const std::string& path, std::vector<BaselineCell>& cells,
+                  std::string& error);
+
+/**
+ * \brief returns the two-sided Mann-Whitney U test's p-value for samples
+ * before and after coming from the same distribution
+ *
+ * \note returns 1 if either sample is empty
+ */
+double mannWhitneyP(const std::vector<double>& before,
+                    const std::vector<double>& after);
+
+#include "baseline_private.hpp"
+
+#endif // BASELINE_HPP_INCLUDED
@@ -0,0 +1,370 @@
+/**
+ * \file baseline_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of reading baselines and comparing samples
+ */
+
+// ----- Reading JSON -----
+
+/**
+ * \brief a parsed JSON value, just enough of JSON for benchmark results
+ */
+struct JsonValue {
+    enum Type {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Type type_;
+    double number_;     ///> also 1 or 0 for BOOLEAN
+    std::string string_;
+    std::vector<JsonValue> items_;
+    std::vector<std::pair<std::string, JsonValue>> members_;
+
+    /**
+    * \brief returns the member called name, or nullptr if there isn't one
+    */
+    const JsonValue* member(const std::string& name) const;
+};
+
+inline const JsonValue* JsonValue::member(const std::string& name) const
+{
+    for (const std::pair<std::string, JsonValue>& member : members_) {
+        if (member.first == name) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * \class JsonParser
+ * \brief A recursive descent parser over a whole document
+ */
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text);
+
+    /**
+    * \brief parses the document into value
+    *
+    * \returns false if it isn't one JSON value
+    */
+    bool parse(JsonValue& value);
+
+private:
+    bool parseValue(JsonValue& value);
+    bool parseString(std::string& string);
+    bool parseNumber(double& number);
+    bool parseWord(const char* word);
+    bool next(char expected);
+    void skipSpace();
+
+    const std::string& text_;
+    size_t position_;
+};
+
+inline JsonParser::JsonParser(const std::string& text)
+    : text_(text), position_{0}
+{
+    // nothing else to do
+}
+
+inline bool JsonParser::parse(JsonValue& value)
+{
+    position_ = 0;
+    if (!parseValue(value)) {
+        return false;
+    }
+    skipSpace();
+    return position_ == text_.size();
+}
+
+inline bool JsonParser::parseValue(JsonValue& value)
+{
+    value = JsonValue{JsonValue::NUL, 0, "", {}, {}};
+    skipSpace();
+    if (position_ == text_.size()) {
+        return false;
+    }
+    char first = text_[position_];
+    if (first == '{') {
+        value.type_ = JsonValue::OBJECT;
+        ++position_;
+        if (next('}')) {
+            return true;
+        }
+        do {
+            std::string name;
+            JsonValue member;
+            skipSpace();
+            if (!parseString(name) || !next(':') || !parseValue(member)) {
+                return false;
+            }
+            value.members_.emplace_back(std::move(name), std::move(member));
+        } while (next(','));
+        return next('}');
+    }
+    if (first == '[') {
+        value.type_ = JsonValue::ARRAY;
+        ++position_;
+        if (next(']')) {
+            return true;
+        }
+        do {
+            JsonValue item;
+            if (!parseValue(item)) {
+                return false;
+            }
+            value.items_.push_back(std::move(item));
+        } while (next(','));
+        return next(']');
+    }
+    if (first == '"') {
+        value.type_ = JsonValue::STRING;
+        return parseString(value.string_);
+    }
+    if (first == 't' || first == 'f') {
+        value.type_ = JsonValue::BOOLEAN;
+        value.number_ = first == 't';
+        return parseWord(first == 't' ? "true" : "false");
+    }
+    if (first == 'n') {
+        return parseWord("null");
+    }
+    value.type_ = JsonValue::NUMBER;
+    return parseNumber(value.number_);
+}
+
+inline bool JsonParser::parseString(std::string& string)
+{
+    if (position_ == text_.size() || text_[position_] != '"') {
+        return false;
+    }
+    ++position_;
+    while (position_ < text_.size()) {
+        char c = text_[position_++];
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\') {
+            string.push_back(c);
+            continue;
+        }
+        if (position_ == text_.size()) {
+            return false;
+        }
+        char escaped = text_[position_++];
+        switch (escaped) {
+        case 'b':
+            string.push_back('\b');
+            break;
+        case 'f':
+            string.push_back('\f');
+            break;
+        case 'n':
+            string.push_back('\n');
+            break;
+        case 'r':
+            string.push_back('\r');
+            break;
+        case 't':
+            string.push_back('\t');
+            break;
+        case 'u':
+            // the benchmark only writes ASCII, anything else is kept out
+            if (text_.size() - position_ < 4) {
+                return false;
+            }
+            string.push_back('?');
+            position_ += 4;
+            break;
+        default:
+            string.push_back(escaped);
+        }
+    }
+    return false;
+}
+
+inline bool JsonParser::parseNumber(double& number)
+{
+    const char* start = text_.c_str() + position_;
+    char* end = nullptr;
+    number = strtod(start, &end);
+    if (end == start) {
+        return false;
+    }
+    position_ += size_t(end - start);
+    return true;
+}
+
+inline bool JsonParser::parseWord(const char* word)
+{
+    size_t length = strlen(word);
+    if (text_.compare(position_, length, word) != 0) {
+        return false;
+    }
+    position_ += length;
+    return true;
+}
+
+inline bool JsonParser::next(char expected)
+{
+    skipSpace();
+    if (position_ < text_.size() && text_[position_] == expected) {
+        ++position_;
+        return true;
+    }
+    return false;
+}
+
+inline void JsonParser::skipSpace()
+{
+    while (position_ < text_.size() &&
+           (text_[position_] == ' ' || text_[position_] == '\n' ||
+            text_[position_] == '\r' || text_[position_] == '\t')) {
+        ++position_;
+    }
+}
+
+// ----- Baselines -----
+
+inline bool readBaseline(const std::string& path,
+                         std::vector<BaselineCell>& cells,
+                         std::string& error)
+{
+    std::ifstream in{path};
+    if (!in) {
+        error = "can't read " + path;
+        return false;
+    }
+    std::string text{std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>()};
+    JsonValue document;
+    if (!JsonParser{text}.parse(document)) {
+        error = path + " isn't JSON";
+        return false;
+    }
+    const JsonValue* results = document.member("results");
+    if (results == nullptr || results->type_ != JsonValue::ARRAY) {
+        error = path + " has no benchmark results";
+        return false;
+    }
+    for (const JsonValue& result : results->items_) {
+        const JsonValue* container = result.member("container");
+        const JsonValue* key = result.member("key");
+        const JsonValue* workload = result.member("workload");
+        const JsonValue* size = result.member("size");
+        const JsonValue* threads = result.member("threads");
+        const JsonValue* phase = result.member("phase");
+        const JsonValue* median = result.member("median_us");
+        const JsonValue* samples = result.member("samples_us");
+        if (container == nullptr || workload == nullptr || size == nullptr ||
+            threads == nullptr || phase == nullptr || median == nullptr) {
+            error = path + " has a result without its container, workload, "
+                    "size, threads, phase or median";
+            return false;
+        }
+        BaselineCell cell{container->string_,
+                          key == nullptr ? "int" : key->string_,
+                          workload->string_,
+                          size_t(size->number_),
+                          size_t(threads->number_),
+                          phase->string_,
+                          median->number_,
+                          {}};
+        if (samples != nullptr) {
+            for (const JsonValue& sample : samples->items_) {
+                cell.micros_.push_back(sample.number_);
+            }
+        }
+        cells.push_back(std::move(cell));
+    }
+    return true;
+}
+
+// ----- Comparing -----
+
+/**
+ * \brief returns how many ways there are for each U with samples of n and
+ * m values and no ties, the coefficients of the Gaussian binomial
+ * [n + m choose n]
+ */
+inline std::vector<double> mannWhitneyCounts(size_t n, size_t m)
+{
+    std::vector<double> counts(n * m + 1, 0.0);
+    counts[0] = 1;
+    // multiply by (1 - q^(m + i)) / (1 - q^i) for each i, which divides
+    // exactly at every step
+    for (size_t i = 1; i <= n; ++i) {
+        for (size_t k = n * m; k >= m + i; --k) {
+            counts[k] -= counts[k - m - i];
+        }
+        for (size_t k = i; k <= n * m; ++k) {
+            counts[k] += counts[k - i];
+        }
+    }
+    return counts;
+}
+
+inline double mannWhitneyP(const std::vector<double>& before,
+                           const std::vector<double>& after)
+{
+    size_t n = before.size();
+    size_t m = after.size();
+    if (n == 0 || m == 0) {
+        return 1;
+    }
+    // rank everything together, sharing ranks between ties
+    std::vector<std::pair<double, bool>> values;
+    for (double value : before) {
+        values.emplace_back(value, true);
+    }
+    for (double value : after) {
+        values.emplace_back(value, false);
+    }
+    std::sort(values.begin(), values.end());
+    double beforeRanks = 0;
+    double tieTerm = 0;     ///> the sum of t^3 - t over groups of t ties
+    for (size_t first = 0; first < values.size();) {
+        size_t last = first;
+        while (last + 1 < values.size() &&
+               values[last + 1].first == values[first].first) {
+            ++last;
+        }
+        double rank = (first + last) / 2.0 + 1;
+        for (size_t i = first; i <= last; ++i) {
+            beforeRanks += values[i].second ? rank : 0;
+        }
+        double tied = double(last - first + 1);
+        tieTerm += tied * tied * tied - tied;
+        first = last + 1;
+    }
+    double u = beforeRanks - n * (n + 1) / 2.0;
+
+    if (tieTerm == 0 && n + m <= 50) {
+        std::vector<double> counts = mannWhitneyCounts(n, m);
+        double total = 0;
+        double below = 0;     ///> the ways of getting at most u
+        for (size_t k = 0; k < counts.size(); ++k) {
+            total += counts[k];
+            below += k <= size_t(u) ? counts[k] : 0;
+        }
+        double above = total - below + counts[size_t(u)];
+        return std::min(1.0, 2 * std::min(below, above) / total);
+    }
+    double size = double(n + m);
+    double variance = n * m / 12.0 *
+                      ((size + 1) - tieTerm / (size * (size - 1)));
+    if (variance <= 0) {
+        // every value the same
+        return 1;
+    }
+    double distance = std::max(0.0, std::fabs(u - n * m / 2.0) - 0.5);
+    return std::erfc(distance / std::sqrt(2 * variance));
+}
@@ -1,27 +1,91 @@
 /**
  * \file bench.cpp
  * \author Andrew Scott
- * \brief The program benchmarks insertions and erases in
- * std::orderedset, RandomTree, SplayTree, AvlTree and RBTree
+ * \brief Benchmarks std::set, RandomTree, SplayTree, AvlTree, RBTree and
+ * LinkedList
+ *
+ * \details Every combination of the chosen containers, workloads and sizes
+ * is run several times. Each phase of a workload, such as building the
+ * container and then erasing from it, is timed on its own, and the median
+ * and 99th percentile over the repetitions are reported. Every container
+ * sees the same keys for a given seed and repetition.
+ *
+ * The iterate workload walks the whole container forwards with its
+ * iterators, backwards with them, and with forEach, the tight loop the
+ * trees have for full scans.
+ *
+ * The mixed workload replays a YCSB-style stream of reads, inserts,
+ * deletes and scans from workload.hpp, warming up before the timed run.
+ *
+ * With --latency N every Nth operation is also timed on its own, and the
+ * percentiles of those times are reported next to the phase totals.
+ * With --counters each phase also runs under hardware performance
+ * counters, reported per operation.
+ *
+ * The scale workload is meant for sizes far past the last level cache. It
+ * computes its keys as it goes instead of keeping them, builds the
+ * container and then only looks keys up, and reports how much heap the
+ * container took next to the cache size. -n scale picks sizes from a
+ * thousand to a billion keys.
+ *
+ * Every workload can run with keys other than ints, from key_types.hpp,
+ * to show how the size of a node and the cost of a comparison play out
+ * in each container.
+ *
+ * The trace workload replays a trace file from trace.hpp, mapped into
+ * memory, and --write-trace saves the mixed workload as one.
+ *
+ * With --baseline FILE the run is compared with an earlier one saved with
+ * -f json. Each cell whose times differ significantly by more than the
+ * threshold is reported as regressed or improved, and any regression makes
+ * the exit status 4.
+ *
+ * --memory runs nothing timed. It fills each container and empties it
+ * again in a child process, counting the heap through a replaced operator
+ * new, and reports bytes per key, allocations per insert and delete, and
+ * how far the peak resident set grew.
+ *
+ * Usage: ./bench [options], see ./bench --help
  */
 
-#include "linkedlist.hpp"
-#include "randomtree.hpp"
-#include "splaytree.hpp"
-#include "avltree.hpp"
-#include "rbtree.hpp"
-#include "stdset.hpp"
+#include "linked_list.hpp"
+#include "random_tree.hpp"
+#include "splay_tree.hpp"
+#include "avl_tree.hpp"
+#include "red_black_tree.hpp"
+#include "std_set.hpp"
+#include "work_stealing_pool.hpp"
 #include "pcg-cpp-0.98/include/pcg_random.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+#include "workload.hpp"
+#include "key_types.hpp"
+#include "baseline.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
-#include <list>
-#include <vector>
+#include <fstream>
+#include <iostream>
 #include <iterator>
-#include <random>
-#include <chrono>
-#include <set>
 #include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 enum class Container {
@@ -33,294 +97,2378 @@ enum class Container {
     RB_TREE
 };
 
+enum class Workload {
+    INSERT_INORDER,
+    INSERT_RANDOM,
+    ERASE_INORDER,
+    ERASE_RANDOM,
+    FIND_RANDOM,
+    RANGE_SCAN,
+    ITERATE,
+    UNION,
+    INTERSECT,
+    DIFFERENCE,
+    MIXED,
+    TRACE,
+    SCALE
+};
+
+enum class KeyType {
+    INT,
+    UINT64,
+    UINT128,
+    SHORT_STRING,
+    LONG_STRING,
+    STRUCT64,
+    STRUCT256
+};
+
+enum class Format {
+    TABLE,
+    CSV,
+    JSON
+};
+
+static const char* containerNames[] = {"linked-list", "std-set", "random",
+                                       "splay", "avl", "rb"};
+static const char* workloadNames[] = {"insert-inorder", "insert-random",
+                                      "erase-inorder", "erase-random",
+                                      "find-random", "range-scan", "iterate",
+                                      "union",
+                                      "intersect", "difference", "mixed",
+                                      "trace", "scale"};
+static const char* keyTypeNames[] = {"int", "uint64", "uint128",
+                                     "short-string", "long-string",
+                                     "struct64", "struct256"};
+static const char* formatNames[] = {"table", "csv", "json"};
+static const char* optionNames[] = {"-c", "--container", "-w", "--workload",
+                                    "-k", "--key",
+                                    "-n", "--size", "-r", "--reps",
+                                    "-t", "--threads", "-l", "--scan-length",
+                                    "-s", "--seed", "-f", "--format",
+                                    "-m", "--mix", "-d", "--distribution",
+                                    "--theta", "--hot-keys",
+                                    "--hot-operations", "--key-order",
+                                    "-o", "--operations", "--warmup",
+                                    "--latency", "--histogram", "--trace",
+                                    "--write-trace", "--trace-encoding",
+                                    "--lookups", "--baseline", "--threshold",
+                                    "--alpha"};
+/// options that don't take a value
+static const char* flagNames[] = {"--counters", "--memory"};
+static const char* keyOrderNames[] = {"scrambled", "ordered"};
+static const char* traceEncodingNames[] = {"raw", "delta"};
+
+/// the exit status when a cell is slower than in the baseline
+static const int REGRESSION_EXIT = 4;
+
+/// stands for an operation count that depends on the size
+static const size_t DEFAULT_COUNT = SIZE_MAX;
+
+/**
+ * \brief what to run, as read from the command line
+ */
+struct Options {
+    std::vector<Container> containers_;
+    std::vector<Workload> workloads_;
+    std::vector<KeyType> keyTypes_;
+    std::vector<size_t> sizes_;
+    std::vector<size_t> threads_;  ///> only used by the set operations
+    size_t repetitions_;
+    size_t scanLength_;            ///> keys per range scan
+    uint64_t seed_;
+    Format format_;
+    WorkloadSpec mixed_;           ///> the mixed workload, but for counts
+    size_t operations_;            ///> timed mixed operations
+    size_t warmup_;                ///> untimed mixed operations before them
+    size_t latencySample_;         ///> time every nth operation, 0 for none
+    std::string histogramFile_;    ///> where to write the histograms
+    bool counters_;                ///> run phases under perf counters
+    bool memory_;                  ///> measure memory instead of time
+    std::string traceFile_;        ///> the trace to replay
+    uint64_t traceRecords_;        ///> how many records it has
+    std::string writeTraceFile_;   ///> where to save the mixed workload
+    TraceEncoding traceEncoding_;
+    size_t lookups_;               ///> lookups after the scale build
+    std::string baselineFile_;     ///> an earlier run to compare with
+    double threshold_;             ///> the smallest change that counts
+    double alpha_;                 ///> the significance level
+};
+
+/**
+ * \brief the time one phase of a workload took in every repetition
+ */
+struct PhaseTimes {
+    std::string phase_;
+    size_t operations_;           ///> operations per repetition
+    std::vector<double> micros_;  ///> one time per repetition
+    LatencyHistogram latency_;    ///> sampled operations, in nanoseconds
+    PerfCounters::Counts counts_; ///> summed over the repetitions
+};
 
-enum class Test {
-  INSERT_INORDER,
-  INSERT_RANDOM,
-  ERASE_INORDER,
-  ERASE_RANDOM
+/**
+ * \brief one row of the report
+ */
+struct Result {
+    Container container_;
+    KeyType keyType_;
+    Workload workload_;
+    size_t size_;
+    size_t threads_;
+    std::string phase_;
+    size_t operations_;
+    size_t repetitions_;
+    double medianMicros_;
+    double p99Micros_;
+    double minMicros_;
+    double meanMicros_;
+    std::vector<double> micros_;  ///> one time per repetition
+    LatencyHistogram latency_;
+    PerfCounters::Counts countsPerOperation_;  ///> negative if not counted
+    long long heapBytes_;         ///> the container's heap, -1 if not known
 };
 
-static int testSizes[] = {100, 1000, 10000, 100000};
-size_t numTestSizes = 4;
-static int randomNums[100000];
-pcg32 rng(pcg_extras::seed_seq_from<std::random_device>{});
+using Clock = std::chrono::steady_clock;
+
+/**
+ * \brief returns the microseconds since start
+ */
+double elapsedMicros(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start)
+        .count();
+}
+
+/**
+ * \brief collects the phase times of every repetition of one run
+ */
+class Recorder {
+public:
+    /**
+    * \param sampleEvery time every nth operation on its own, 0 for none
+    * \param countEvents run each phase under the performance counters
+    */
+    Recorder(size_t sampleEvery, bool countEvents);
+
+    /**
+    * \brief starts the counters for the next phase, just before its clock
+    */
+    void start();
+
+    /**
+    * \brief stops the counters for a while in the middle of a phase
+    */
+    void pause();
+
+    void resume();
+
+    /**
+    * \brief stops the counters and adds one repetition's time for phase,
+    * and the latencies of the operations sampled in it
+    */
+    void record(const std::string& phase, size_t operations, double micros,
+                const LatencyHistogram& latency = LatencyHistogram{});
+
+    size_t sampleEvery() const;
+
+    /**
+    * \brief notes how much heap the container took, keeping the largest
+    */
+    void noteHeapBytes(long long bytes);
+
+    long long heapBytes() const;
+
+    /**
+    * \brief returns the phases in the order they first ran
+    */
+    const std::vector<PhaseTimes>& phases() const;
 
+private:
+    size_t sampleEvery_;
+    std::unique_ptr<PerfCounters> counters_;   ///> nullptr if not counting
+    long long heapBytes_;
+    std::vector<PhaseTimes> phases_;
+};
 
-/*struct TestInfo {
-    //Test testType_;
-    //Container containerType_;
-    //size_t testSize_;
-    float runtime_;
-    TestInfo(Test testType, Container containerType, size_t testSize, float runtime)
-        : testType_{testType}, containerType_{containerType}, testSize_{testSize}, 
-          runtime_{runtime}
-    {}
-    TestInfo(float runtime)
-        : runtime_{runtime}
-    {}
-};*/
+Recorder::Recorder(size_t sampleEvery, bool countEvents)
+    : sampleEvery_{sampleEvery},
+      counters_{countEvents ? new PerfCounters : nullptr}, heapBytes_{-1},
+      phases_{}
+{
+    // nothing else to do
+}
 
-/*void linkedListTest(Test testType, size_t testSize)
+void Recorder::start()
 {
-    LinkedList<int> testList;
-    if (testType == Test::INSERT_INORDER) {
-        for (size_t i = 0; i < testSize; ++i) {
-            testList.insert(i);
-            if (!testList.contains(i)) {
-                std::cerr << "Correctness error: list should contain " << i << std::endl;
-            }
-        }
-    } else if (testType == INSERT_RANDOM) {
-        for (size_t i = 0; i < testSize; ++i) {
-            int randInsert = rand();
-            testList.insert(i);
-            if (!testList.contains(i)) {
-                std::cerr << "Correctness error: list should contain " << i << std::endl;
-            }
-        }
+    if (counters_ != nullptr) {
+        counters_->start();
     }
-}*/
+}
 
-void makeRandomArray()
+void Recorder::pause()
 {
-    for (int i = 0; i < testSizes[numTestSizes - 1]; ++i) {
-        randomNums[i] = rng(testSizes[numTestSizes - 1]);
+    if (counters_ != nullptr) {
+        counters_->pause();
     }
 }
 
-size_t singleTreeTest(Test testType, Container treeType, int testSize)
+void Recorder::resume()
 {
-    using clock = std::chrono::high_resolution_clock;
-    clock::time_point startTime = clock::now();
-    clock::time_point stopTime = clock::now();
-    std::string testName;
-    AbstractTree<int>* testTree;
-    if (treeType == Container::RANDOM_TREE) {
-        testTree = new RandomTree<int>;
-    } else if (treeType == Container::SPLAY_TREE) {
-        testTree = new SplayTree<int>;
-    } else if (treeType == Container::AVL_TREE) {
-        testTree = new AvlTree<int>;
-    } else if (treeType == Container::RB_TREE) {
-        testTree = new RBTree<int>;
-    } else if (treeType == Container::STD_SET) {
-        testTree = new StdSet<int>;
+    if (counters_ != nullptr) {
+        counters_->resume();
     }
-    if (testType == Test::INSERT_INORDER) {
-        startTime = clock::now();
-        for (int i = 0; i < testSize; ++i) {
-            testTree->insert(i);
-            assert(testTree->contains(i));
-        }
-        stopTime = clock::now();
-    } 
+}
 
-    else if (testType == Test::INSERT_RANDOM) {
-        startTime = clock::now();
-        for (int i = 0; i < testSize; ++i) {
-            int numToInsert = randomNums[i];
-            testTree->insert(numToInsert);
-            assert(testTree->contains(numToInsert));
+void Recorder::record(const std::string& phase, size_t operations,
+                      double micros, const LatencyHistogram& latency)
+{
+    PerfCounters::Counts counts = counters_ != nullptr ? counters_->stop() :
+                                                         PerfCounters::none();
+    for (PhaseTimes& times : phases_) {
+        if (times.phase_ == phase) {
+            times.micros_.push_back(micros);
+            times.latency_.merge(latency);
+            for (size_t i = 0; i < counts.size(); ++i) {
+                // an event missed once is missing from the sum
+                times.counts_[i] = counts[i] < 0 || times.counts_[i] < 0 ?
+                                   -1 : times.counts_[i] + counts[i];
+            }
+            return;
         }
-        stopTime = clock::now();
-    } 
+    }
+    phases_.push_back(PhaseTimes{phase, operations, {micros}, latency,
+                                 counts});
+}
 
-    else if (testType == Test::ERASE_INORDER) {
-        for (int i = 0; i < testSize; ++i) {
-            testTree->insert(i);
-        }
-    } 
+size_t Recorder::sampleEvery() const
+{
+    return sampleEvery_;
+}
 
-    else if (testType == Test::ERASE_RANDOM) {
-        for (int i = 0; i < testSize; ++i) {
-            int numToInsert = rand() % testSize;
-            testTree->insert(numToInsert);
-        }
+void Recorder::noteHeapBytes(long long bytes)
+{
+    heapBytes_ = std::max(heapBytes_, bytes);
+}
+
+long long Recorder::heapBytes() const
+{
+    return heapBytes_;
+}
+
+const std::vector<PhaseTimes>& Recorder::phases() const
+{
+    return phases_;
+}
+
+/**
+ * \brief returns the value with fraction of the values at or below it,
+ * using the nearest rank, so the 99th percentile of a handful of
+ * repetitions is the slowest one
+ */
+double percentile(std::vector<double> values, double fraction)
+{
+    std::sort(values.begin(), values.end());
+    size_t rank = size_t(fraction * values.size() + 0.999999);
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * \brief stops the run if a workload didn't do what it was asked to, which
+ * is checked after each timed loop rather than inside it
+ */
+void check(bool ok, const char* what)
+{
+    if (!ok) {
+        std::cerr << "Correctness error: " << what << std::endl;
+        exit(3);
     }
-    clock::duration elapsed = stopTime - startTime;
-    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
 }
 
-void runTest(Test testType, Container treeType)
+// ----- Counting the heap -----
+
+/**
+ * \brief what operator new and delete have seen since tracking started,
+ * in the bytes malloc really set aside for each request
+ */
+struct HeapCounters {
+    std::atomic<bool> tracking_;
+    std::atomic<size_t> allocations_;
+    std::atomic<size_t> frees_;
+    std::atomic<long long> liveBytes_;   ///> negative if older memory went
+    std::atomic<long long> peakBytes_;
+};
+
+static HeapCounters heap;
+
+size_t usableBytes(void* pointer)
+{
+#ifdef __APPLE__
+    return malloc_size(pointer);
+#else
+    return malloc_usable_size(pointer);
+#endif
+}
+
+/**
+ * \brief zeroes the counters and starts counting
+ */
+void startHeapTracking()
 {
-    // using clock = std::chrono::high_resolution_clock;
+    heap.allocations_ = 0;
+    heap.frees_ = 0;
+    heap.liveBytes_ = 0;
+    heap.peakBytes_ = 0;
+    heap.tracking_ = true;
+}
 
-    std::vector<size_t> testStatistics;
-    std::string testName;
+void stopHeapTracking()
+{
+    heap.tracking_ = false;
+}
 
-    if (testType == Test::INSERT_INORDER) {
-        testName = "insert inorder";
-    } else if (testType == Test::INSERT_RANDOM) {
-        testName = "insert random";
-    } else if (testType == Test::ERASE_INORDER) {
-        testName = "erase inorder";
-    } else if (testType == Test::ERASE_RANDOM) {
-        testName = "erase random";
+void* operator new(size_t bytes)
+{
+    void* pointer = malloc(bytes == 0 ? 1 : bytes);
+    if (pointer == nullptr) {
+        throw std::bad_alloc{};
+    }
+    if (heap.tracking_.load(std::memory_order_relaxed)) {
+        ++heap.allocations_;
+        long long live = heap.liveBytes_ += usableBytes(pointer);
+        long long peak = heap.peakBytes_;
+        while (live > peak &&
+               !heap.peakBytes_.compare_exchange_weak(peak, live)) {
+            // peak was reloaded, try again
+        }
     }
+    return pointer;
+}
 
-    for (size_t i = 0; i < numTestSizes; ++i) {
-        
-        testStatistics.push_back(singleTreeTest(testType, treeType, testSizes[i]));
-        //testStatistics.push_back(ticks);
+void operator delete(void* pointer) noexcept
+{
+    if (pointer == nullptr) {
+        return;
+    }
+    if (heap.tracking_.load(std::memory_order_relaxed)) {
+        ++heap.frees_;
+        heap.liveBytes_ -= usableBytes(pointer);
     }
+    free(pointer);
+}
+
+void* operator new[](size_t bytes)
+{
+    return operator new(bytes);
+}
 
-    std::cout << testName << "\t";
-    for (size_t i = 0; i < testStatistics.size(); ++i) {
-        printf("\t%d", testStatistics[i]);
+void operator delete[](void* pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+    try {
+        return operator new(bytes);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
     }
-    std::cout << std::endl;
 }
 
-void runTreeTests(Container treeType)
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept
 {
-    printf("test size:\t");
-    for (size_t i = 0; i < numTestSizes; ++i) {
-        printf("\t%d", testSizes[i]);
+    try {
+        return operator new(bytes);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
     }
-    printf("\n");
-    runTest(Test::INSERT_INORDER, treeType);
-    runTest(Test::INSERT_RANDOM, treeType);
-    runTest(Test::ERASE_INORDER, treeType);
-    runTest(Test::ERASE_RANDOM, treeType);
-    std::cout << std::endl;
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer);
 }
 
 /**
- * \brief Option Processing
- * \details
- *   Sets various configuration variables by modifying variables passed
- *   by reference.
- *
- *   Will return with an exit error of 2 if receives a usage problem.
+ * \brief returns what malloc has handed out and not had back, or -1 if
+ * the C library won't say
  *
- * \param options       Input of options from command line.
- * \param testType      Which kind of container to test
- * \param testType      Which test to run
- * \param insertions    How many insertions to perform.
+ * \details unlike the counters above this costs nothing while the
+ * container is built, so it is used around timed phases
  */
-/*
-void processOptions(std::list<std::string> options,
-                    Container&             containerType,
-                    Test&                  testType,
-                    size_t&                insertions)
+long long mallocBytes()
 {
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (long long)(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
 
-    // Set the defaults
-    testType = Test::INSERT_FRONT;
-    containerType = Container::VECTOR;
-    insertions = 100000;
+/**
+ * \brief returns the size of the last level cache, or -1 if not known
+ */
+long long lastLevelCacheBytes()
+{
+    long long bytes = -1;
+#if defined(_SC_LEVEL3_CACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (bytes <= 0) {
+        bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
+#endif
+    return bytes > 0 ? bytes : -1;
+}
+
+/**
+ * \brief returns the most this process has had resident so far
+ */
+long long peakResidentBytes()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    // in kilobytes everywhere else
+    return usage.ru_maxrss * 1024LL;
+#endif
+}
 
-    // Loop through the options. If they start with a dash
-    // try to interpret them as a flag; if not, assume it's
-    // the number of insertions.
-    while (!options.empty()) {
-        std::string option = options.front();
-        options.pop_front();
+// ----- Adapting the containers -----
 
-        if (option.empty()) {
-            std::cerr << "Empty argument" << std::endl;
-            exit(2);
-        };
+/// whether a container keeps its elements sorted and can scan ranges
+template <typename Tree>
+struct IsOrdered : std::true_type {};
 
-        // If we've gotten this far, the argument has at least one
-        // character, so it's safe to ask whether that character is
-        // a dash or not.
-        if (option[0] >= '0' && option[0] <= '9') {
-            // Starts with a digit, so try to interpret it as a number of
-            // insertions, using the C++11 string-to-unsigned-long converter
-            insertions = std::stoul(option);
+template <typename T>
+struct IsOrdered<LinkedList<T>> : std::false_type {};
 
-        } else if (option == "-v" || option == "--vector") {
-            containerType = Container::VECTOR;            
+/// whether a container has the parallel set operations
+template <typename Tree>
+struct HasSetOperations : std::false_type {};
 
-        } else if (option == "-l" || option == "--intlist") {
-            containerType = Container::INTLIST;            
+template <typename T>
+struct HasSetOperations<AvlTree<T>> : std::true_type {};
 
-        } else if (option == "-f" || option == "--front") {
-            testType = Test::INSERT_FRONT;
+template <typename T>
+struct HasSetOperations<RandomTree<T>> : std::true_type {};
 
-        } else if (option == "-b" || option == "--back") {
-            testType = Test::INSERT_BACK;
+template <typename Tree, typename Key>
+bool benchInsert(Tree& tree, const Key& key)
+{
+    return tree.insert(key);
+}
 
-        } else if (option == "-m" || option == "--middle") {
-            testType = Test::INSERT_MIDDLE;
+/// the list doesn't look for repeats, which the keys never have anyway
+template <typename Key>
+bool benchInsert(LinkedList<Key>& list, const Key& key)
+{
+    list.insertBack(key);
+    return true;
+}
 
-        } else {
-            std::cerr << "Unrecognized option: " << option << std::endl;
-            std::cerr << "Usage: ./bench [-v|-l|-f|-b|-m] [num]" << std::endl;
-            exit(2);
-        }
+/**
+ * \brief returns the number of elements in [lower, upper)
+ */
+template <typename Tree, typename Key>
+size_t scanRange(Tree& tree, const Key& lower, const Key& upper,
+                 std::true_type)
+{
+    size_t scanned = 0;
+    for (const Key& element : tree.range(lower, upper)) {
+        scanned += !(element < lower);
     }
-}*/
+    return scanned;
+}
 
-int main(int argc, const char* argv[])
+template <typename Tree, typename Key>
+size_t scanRange(Tree&, const Key&, const Key&, std::false_type)
 {
-    // These three variables will be set by processOptions.
-    Container containerType;
-    Test testType;
-    size_t insertions;
-    //srand(time(NULL));
-    makeRandomArray();
+    // never called, unsupported workloads are skipped
+    return 0;
+}
 
-    // Turn the command line (an array of C-style strings)
-    // into a nice C++ list of C++ strings, and pass them to
-    // processOptions. (Note that the arguments to the
-    // list constructor are pointers into the array, being
-    // used as start and end iterators.)
+/**
+ * \brief returns the number of elements visited walking up to length of
+ * them from the first one not less than lower
+ */
+template <typename Tree, typename Key>
+size_t scanFrom(Tree& tree, const Key& lower, size_t length, std::true_type)
+{
+    size_t scanned = 0;
+    auto end = tree.end();
+    for (auto i = tree.lower_bound(lower); i != end && scanned < length;
+         ++i) {
+        scanned += !(*i < lower);
+    }
+    return scanned;
+}
+
+template <typename Tree, typename Key>
+size_t scanFrom(Tree&, const Key&, size_t, std::false_type)
+{
+    // never called, mixes with scans are skipped
+    return 0;
+}
+
+/**
+ * \brief times walking all of tree, whose largest key is last, forwards
+ * and backwards with its iterators and with forEach
+ */
+template <typename Tree, typename Key>
+void timeIteration(const Tree& tree, const Key& last, Recorder& recorder,
+                   std::true_type)
+{
+    // add up every key, so that each walk has to read them all
+    uint64_t forward = 0;
+    recorder.start();
+    Clock::time_point start = Clock::now();
+    for (const Key& key : tree) {
+        forward += keyDigest(key);
+    }
+    recorder.record("forward", tree.size(), elapsedMicros(start));
+
+    uint64_t reverse = 0;
+    recorder.start();
+    start = Clock::now();
+    auto first = tree.begin();
+    for (auto i = tree.find(last); i != tree.end(); --i) {
+        reverse += keyDigest(*i);
+        if (i == first) {
+            break;
+        }
+    }
+    recorder.record("reverse", tree.size(), elapsedMicros(start));
 
-    //std::list<std::string> options(argv + 1, argv + argc);
-    //processOptions(options, containerType, testType, insertions);
+    uint64_t visited = 0;
+    recorder.start();
+    start = Clock::now();
+    tree.forEach([&](const Key& key) { visited += keyDigest(key); });
+    recorder.record("for-each", tree.size(), elapsedMicros(start));
+
+    check(forward == reverse && forward == visited,
+          "the walks didn't all see the same keys");
+}
 
+template <typename Tree, typename Key>
+void timeIteration(const Tree&, const Key&, Recorder&, std::false_type)
+{
+    // never called, unsupported workloads are skipped
+}
 
-    // linked list benchmarks
+template <typename Tree>
+void combine(Tree& tree, Tree& other, Workload workload,
+             WorkStealingPool& pool, std::true_type)
+{
+    if (workload == Workload::UNION) {
+        tree.unionWith(other, pool);
+    } else if (workload == Workload::INTERSECT) {
+        tree.intersect(other, pool);
+    } else {
+        tree.difference(other, pool);
+    }
+}
 
-    // for reference: std::list
-    std::cout << "std::set benchmarks" << std::endl;
-    runTreeTests(Container::STD_SET);
+template <typename Tree>
+void combine(Tree&, Tree&, Workload, WorkStealingPool&, std::false_type)
+{
+    // never called, unsupported workloads are skipped
+}
 
-    // random tree benchmarks
-    std::cout << "random tree benchmarks" << std::endl;
-    runTreeTests(Container::RANDOM_TREE);
+bool isSetOperation(Workload workload)
+{
+    return workload == Workload::UNION || workload == Workload::INTERSECT ||
+           workload == Workload::DIFFERENCE;
+}
 
-    // splay tree benchmarks
-    std::cout << "splay tree benchmarks" << std::endl;
-    runTreeTests(Container::SPLAY_TREE);
+/**
+ * \brief returns true if Tree can run workload
+ */
+template <typename Tree>
+bool supports(Workload workload, const Options& options)
+{
+    if (isSetOperation(workload)) {
+        return HasSetOperations<Tree>::value;
+    }
+    if (workload == Workload::RANGE_SCAN || workload == Workload::ITERATE) {
+        return IsOrdered<Tree>::value;
+    }
+    if (workload == Workload::MIXED && options.mixed_.mix_.scan_ > 0) {
+        return IsOrdered<Tree>::value;
+    }
+    if (workload == Workload::TRACE) {
+        // any trace might scan
+        return IsOrdered<Tree>::value;
+    }
+    if (workload == Workload::SCALE) {
+        // the list would take years
+        return IsOrdered<Tree>::value;
+    }
+    return true;
+}
 
-    // avl tree benchmarks
-    std::cout << "avl tree benchmarks" << std::endl;
-    runTreeTests(Container::AVL_TREE);
+// ----- The workloads -----
 
-    // red black tree benchmarks
-    std::cout << "red-black tree benchmarks" << std::endl;
-    runTreeTests(Container::RB_TREE);
+/// returns 0, stride, 2 * stride, ... for n keys
+std::vector<int> inorderKeys(size_t n, int stride = 1)
+{
+    std::vector<int> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(int(i) * stride);
+    }
+    return keys;
+}
 
-    // for reference: std::set
+/// returns the same keys as inorderKeys in a random order
+std::vector<int> shuffledKeys(size_t n, pcg32& rng, int stride = 1)
+{
+    std::vector<int> keys = inorderKeys(n, stride);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
 
+/// returns the Keys made from each index, made before anything is timed
+template <typename Keys>
+std::vector<typename Keys::Key> makeKeys(const std::vector<int>& indices)
+{
+    std::vector<typename Keys::Key> keys;
+    keys.reserve(indices.size());
+    for (int index : indices) {
+        keys.push_back(Keys::make(index));
+    }
+    return keys;
+}
 
-    /*clock::time_point startTime = clock::now();
+/// returns the Keys made from each request's key
+template <typename Keys>
+std::vector<typename Keys::Key> requestKeys(
+    const std::vector<Request>& requests)
+{
+    std::vector<typename Keys::Key> keys;
+    keys.reserve(requests.size());
+    for (const Request& request : requests) {
+        keys.push_back(Keys::make(request.key_));
+    }
+    return keys;
+}
 
-    if (containerType == Container::LINKED_LIST) {
-      vectorTest(testType, insertions);
-    } else if (containerType == Container::INTLIST) {
-      intlistTest(testType, insertions);
+/**
+ * \brief calls work(i) for every i below count, also timing every
+ * sampleEvery'th call on its own into latency unless sampleEvery is 0
+ *
+ * \returns the microseconds all the calls took
+ */
+template <typename Work>
+double timeEach(size_t count, size_t sampleEvery, LatencyHistogram& latency,
+                Work&& work)
+{
+    Clock::time_point start = Clock::now();
+    if (sampleEvery == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            work(i);
+        }
     } else {
-      std::cerr << "Unknown container type!" << std::endl;
-      exit(4);
+        size_t nextSample = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (i != nextSample) {
+                work(i);
+                continue;
+            }
+            uint64_t before = LatencyClock::now();
+            work(i);
+            latency.record(LatencyClock::nanosSince(before));
+            nextSample += sampleEvery;
+        }
+    }
+    return elapsedMicros(start);
+}
+
+/**
+ * \brief calls work(i) for every i below count, timed as phase
+ *
+ * \details if the recorder samples, every sampled call is timed on its own
+ * as well. That adds the clock's cost to the phase's total, so the totals
+ * are best taken from a run without sampling.
+ */
+template <typename Work>
+void timeOperations(size_t count, const char* phase, Recorder& recorder,
+                    Work&& work)
+{
+    LatencyHistogram latency;
+    recorder.start();
+    double micros = timeEach(count, recorder.sampleEvery(), latency,
+                             std::forward<Work>(work));
+    recorder.record(phase, count, micros, latency);
+}
+
+/**
+ * \brief calls work(keys, i) for every i below count, timed as phase,
+ * with make(first, n, keys) filling keys a chunk at a time with the clock
+ * and counters stopped
+ *
+ * \details for streams too long to make all at once, or that come from
+ * somewhere else. make returns how many it made, and stops everything by
+ * making none.
+ */
+template <typename Key, typename Make, typename Work>
+void timeChunks(size_t count, const char* phase, Recorder& recorder,
+                Make&& make, Work&& work)
+{
+    const size_t CHUNK = 1 << 16;
+    std::vector<Key> keys;
+    keys.reserve(std::min(count, CHUNK));
+    LatencyHistogram latency;
+    double micros = 0;
+    recorder.start();
+    recorder.pause();
+    for (size_t first = 0; first < count; first += CHUNK) {
+        keys.clear();
+        size_t made = make(first, std::min(CHUNK, count - first), keys);
+        if (made == 0) {
+            break;
+        }
+        recorder.resume();
+        micros += timeEach(made, recorder.sampleEvery(), latency,
+                           [&](size_t i) { work(keys, i); });
+        recorder.pause();
     }
+    recorder.record(phase, count, micros, latency);
+}
 
-    clock::time_point stopTime = clock::now();
+/**
+ * \brief inserts every key, timed as phase
+ */
+template <typename Tree, typename Key>
+void timeInserts(Tree& tree, const std::vector<Key>& keys,
+                 const char* phase, Recorder& recorder)
+{
+    size_t inserted = 0;
+    timeOperations(keys.size(), phase, recorder, [&](size_t i) {
+        inserted += benchInsert(tree, keys[i]);
+    });
+    check(inserted == keys.size(), "not every key was inserted");
+}
 
-    // Compute the elapsed duration, convert that to microseconds, and display
+/**
+ * \brief what replaying a stream of requests did
+ */
+struct ReplayCounts {
+    size_t reads_;
+    size_t found_;
+    size_t inserted_;
+    size_t deleted_;
+    size_t scanned_;
+};
+
+/**
+ * \brief carries out operation on key
+ */
+template <typename Tree, typename Key>
+void replay(Tree& tree, Operation operation, const Key& key,
+            size_t scanLength, ReplayCounts& counts)
+{
+    switch (operation) {
+    case Operation::READ:
+        ++counts.reads_;
+        counts.found_ += tree.contains(key);
+        break;
+    case Operation::INSERT:
+        counts.inserted_ += benchInsert(tree, key);
+        break;
+    case Operation::DELETE:
+        counts.deleted_ += tree.deleteElement(key);
+        break;
+    case Operation::SCAN:
+        counts.scanned_ += scanFrom(tree, key, scanLength, IsOrdered<Tree>{});
+        break;
+    }
+}
+
+/**
+ * \brief times replaying requests, on the keys made for them, as phase and
+ * checks the inserts went in
+ */
+template <typename Tree, typename Key>
+void timeReplay(Tree& tree, const std::vector<Request>& requests,
+                const std::vector<Key>& keys, const char* phase,
+                size_t scanLength, Recorder& recorder)
+{
+    size_t before = tree.size();
+    ReplayCounts counts{0, 0, 0, 0, 0};
+    timeOperations(requests.size(), phase, recorder, [&](size_t i) {
+        replay(tree, requests[i].operation_, keys[i], scanLength, counts);
+    });
+    size_t inserts = 0;
+    for (const Request& request : requests) {
+        inserts += request.operation_ == Operation::INSERT;
+    }
+    check(counts.inserted_ == inserts, "a new record was already there");
+    check(tree.size() == before + counts.inserted_ - counts.deleted_,
+          "the size doesn't match the inserts and deletes");
+    check(counts.found_ <= counts.reads_, "found more than was read");
+}
+
+/**
+ * \brief replays the whole trace, timed as one phase
+ *
+ * \details the trace is read a chunk at a time with the clock and
+ * counters stopped, so neither includes decoding DELTA traces or making
+ * keys. RAW records are used where they are mapped.
+ */
+template <typename Tree, typename Keys>
+void timeTrace(Tree& tree, TraceReader& reader, size_t scanLength,
+               Recorder& recorder)
+{
+    using Key = typename Keys::Key;
+    ReplayCounts counts{0, 0, 0, 0, 0};
+    const TraceRecord* records = nullptr;
+    reader.rewind();
+    timeChunks<Key>(
+        size_t(reader.records()), "replay", recorder,
+        [&](size_t, size_t count, std::vector<Key>& keys) {
+            count = reader.next(records, count);
+            for (size_t i = 0; i < count; ++i) {
+                keys.push_back(Keys::make(records[i].key_));
+            }
+            return count;
+        },
+        [&](const std::vector<Key>& keys, size_t i) {
+            replay(tree, records[i].operation_, keys[i], scanLength, counts);
+        });
+    check(reader.good(), "the trace is cut short");
+    check(tree.size() == counts.inserted_ - counts.deleted_,
+          "the size doesn't match the inserts and deletes");
+}
+
+/**
+ * \brief returns the mixed workload for a container of size records
+ */
+WorkloadSpec mixedSpec(const Options& options, size_t size)
+{
+    WorkloadSpec spec = options.mixed_;
+    spec.initialRecords_ = size;
+    spec.operations_ = options.operations_ == DEFAULT_COUNT ?
+                       size : options.operations_;
+    spec.warmupOperations_ = options.warmup_ == DEFAULT_COUNT ?
+                             spec.operations_ / 10 : options.warmup_;
+    return spec;
+}
+
+/**
+ * \brief runs a single repetition of workload on a fresh container
+ */
+template <typename Tree, typename Keys>
+void runOnce(Workload workload, size_t size, size_t threads,
+             const Options& options, pcg32& rng, Recorder& recorder)
+{
+    using Key = typename Keys::Key;
+    // allocated so that tearing it down can be timed too
+    std::unique_ptr<Tree> tree{new Tree};
+    if (workload == Workload::INSERT_INORDER ||
+        workload == Workload::INSERT_RANDOM) {
+        std::vector<Key> keys = makeKeys<Keys>(
+            workload == Workload::INSERT_INORDER ? inorderKeys(size) :
+                                                   shuffledKeys(size, rng));
+        timeInserts(*tree, keys, "insert", recorder);
+        recorder.start();
+        Clock::time_point start = Clock::now();
+        tree.reset();
+        recorder.record("destroy", size, elapsedMicros(start));
+
+    } else if (workload == Workload::ERASE_INORDER ||
+               workload == Workload::ERASE_RANDOM) {
+        bool inorder = workload == Workload::ERASE_INORDER;
+        timeInserts(*tree, makeKeys<Keys>(inorder ? inorderKeys(size) :
+                                                    shuffledKeys(size, rng)),
+                    "build", recorder);
+        std::vector<Key> keys = makeKeys<Keys>(
+            inorder ? inorderKeys(size) : shuffledKeys(size, rng));
+        size_t erased = 0;
+        timeOperations(size, "erase", recorder, [&](size_t i) {
+            erased += tree->deleteElement(keys[i]);
+        });
+        check(erased == size, "not every key was erased");
+
+    } else if (workload == Workload::FIND_RANDOM) {
+        // only the even keys go in, so about half the lookups miss
+        timeInserts(*tree, makeKeys<Keys>(shuffledKeys(size, rng, 2)),
+                    "build", recorder);
+        std::vector<int> indices;
+        indices.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            indices.push_back(int(rng(uint32_t(size * 2))));
+        }
+        std::vector<Key> keys = makeKeys<Keys>(indices);
+        size_t found = 0;
+        timeOperations(size, "find", recorder, [&](size_t i) {
+            found += tree->contains(keys[i]);
+        });
+        size_t expected = 0;
+        for (int index : indices) {
+            expected += index % 2 == 0;
+        }
+        check(found == expected, "lookups found the wrong keys");
+
+    } else if (workload == Workload::RANGE_SCAN) {
+        // even keys again, so each scan covers at most scanLength keys
+        timeInserts(*tree, makeKeys<Keys>(shuffledKeys(size, rng, 2)),
+                    "build", recorder);
+        size_t scans = std::max<size_t>(size / 10, 1);
+        int span = int(options.scanLength_) * 2;
+        std::vector<int> indices;
+        indices.reserve(scans);
+        for (size_t i = 0; i < scans; ++i) {
+            indices.push_back(int(rng(uint32_t(size * 2))));
+        }
+        std::vector<Key> starts = makeKeys<Keys>(indices);
+        for (int& index : indices) {
+            index += span;
+        }
+        std::vector<Key> ends = makeKeys<Keys>(indices);
+        // count what we scan so the loop can't be thrown away
+        size_t scanned = 0;
+        timeOperations(scans, "scan", recorder, [&](size_t i) {
+            scanned += scanRange(*tree, starts[i], ends[i],
+                                 IsOrdered<Tree>{});
+        });
+        check(scanned <= scans * options.scanLength_,
+              "range scans found too many keys");
+
+    } else if (workload == Workload::ITERATE) {
+        timeInserts(*tree, makeKeys<Keys>(shuffledKeys(size, rng)), "build",
+                    recorder);
+        timeIteration(*tree, Keys::make(int(size) - 1), recorder,
+                      IsOrdered<Tree>{});
+
+    } else if (workload == Workload::MIXED) {
+        WorkloadSpec spec = mixedSpec(options, size);
+        // the whole stream is made before anything is timed
+        WorkloadGenerator generator{spec, options.seed_, rng()};
+        std::vector<Request> warmup = generator.next(spec.warmupOperations_);
+        std::vector<Request> requests = generator.next(spec.operations_);
+        std::vector<Key> warmupKeys = requestKeys<Keys>(warmup);
+        std::vector<Key> keys = requestKeys<Keys>(requests);
+        timeInserts(*tree, makeKeys<Keys>(generator.initialKeys()), "load",
+                    recorder);
+        if (!warmup.empty()) {
+            timeReplay(*tree, warmup, warmupKeys, "warmup",
+                       options.scanLength_, recorder);
+        }
+        timeReplay(*tree, requests, keys, "run", options.scanLength_,
+                   recorder);
+
+    } else if (workload == Workload::SCALE) {
+        // keys are made a chunk at a time, a billion of them won't fit
+        // next to the tree
+        long long heapBefore = mallocBytes();
+        size_t inserted = 0;
+        timeChunks<Key>(
+            size, "build", recorder,
+            [](size_t first, size_t count, std::vector<Key>& keys) {
+                for (size_t i = first; i < first + count; ++i) {
+                    keys.push_back(Keys::make(scrambledKey(i)));
+                }
+                return count;
+            },
+            [&](const std::vector<Key>& keys, size_t i) {
+                inserted += benchInsert(*tree, keys[i]);
+            });
+        check(inserted == size, "not every key was inserted");
+        long long heapAfter = mallocBytes();
+        if (heapBefore >= 0 && heapAfter >= 0) {
+            recorder.noteHeapBytes(heapAfter - heapBefore);
+        }
+        // every lookup hits, on a key drawn uniformly from the tree
+        size_t lookups = options.lookups_ == DEFAULT_COUNT ?
+                         std::min<size_t>(size, 10000000) : options.lookups_;
+        uint32_t bound = uint32_t(size);
+        size_t found = 0;
+        timeChunks<Key>(
+            lookups, "lookup", recorder,
+            [&](size_t, size_t count, std::vector<Key>& keys) {
+                for (size_t i = 0; i < count; ++i) {
+                    keys.push_back(Keys::make(scrambledKey(rng(bound))));
+                }
+                return count;
+            },
+            [&](const std::vector<Key>& keys, size_t i) {
+                found += tree->contains(keys[i]);
+            });
+        check(found == lookups, "lookups missed keys that were inserted");
+
+    } else if (workload == Workload::TRACE) {
+        TraceReader reader{options.traceFile_};
+        check(reader.good(), "the trace can't be read");
+        timeTrace<Tree, Keys>(*tree, reader, options.scanLength_, recorder);
+
+    } else {
+        // multiples of 2 against multiples of 3, built without timing
+        for (const Key& key : makeKeys<Keys>(shuffledKeys(size, rng, 2))) {
+            benchInsert(*tree, key);
+        }
+        Tree other;
+        for (const Key& key : makeKeys<Keys>(shuffledKeys(size, rng, 3))) {
+            benchInsert(other, key);
+        }
+        WorkStealingPool pool{threads};
+        // the counters only follow this thread, not the pool's
+        recorder.start();
+        Clock::time_point start = Clock::now();
+        combine(*tree, other, workload, pool, HasSetOperations<Tree>{});
+        recorder.record(workloadNames[int(workload)], size * 2,
+                        elapsedMicros(start));
+        check(other.size() == 0, "set operation left the other tree");
+    }
+}
+
+/**
+ * \brief runs every repetition of workload on Tree and adds a result for
+ * each phase
+ */
+template <typename Tree, typename Keys>
+void runWorkload(Container container, KeyType keyType, Workload workload,
+                 size_t size, size_t threads, const Options& options,
+                 std::vector<Result>& results)
+{
+    Recorder recorder{options.latencySample_, options.counters_};
+    for (size_t repetition = 0; repetition < options.repetitions_;
+         ++repetition) {
+        // the same keys for every container
+        pcg32 rng{options.seed_, repetition};
+        runOnce<Tree, Keys>(workload, size, threads, options, rng,
+                            recorder);
+    }
+    for (const PhaseTimes& times : recorder.phases()) {
+        double total = 0;
+        for (double micros : times.micros_) {
+            total += micros;
+        }
+        PerfCounters::Counts perOperation = times.counts_;
+        double operations = double(times.operations_) * times.micros_.size();
+        for (double& count : perOperation) {
+            if (count >= 0 && operations > 0) {
+                count /= operations;
+            }
+        }
+        results.push_back(Result{
+            container, keyType, workload, size, threads, times.phase_,
+            times.operations_, times.micros_.size(),
+            percentile(times.micros_, 0.5), percentile(times.micros_, 0.99),
+            *std::min_element(times.micros_.begin(), times.micros_.end()),
+            total / times.micros_.size(), times.micros_, times.latency_,
+            perOperation,
+            recorder.heapBytes()});
+    }
+}
+
+template <typename Tree, typename Keys>
+void runContainer(Container container, KeyType keyType,
+                  const Options& options, std::vector<Result>& results)
+{
+    for (Workload workload : options.workloads_) {
+        if (!supports<Tree>(workload, options)) {
+            std::cerr << "skipping " << workloadNames[int(workload)]
+                      << " on " << containerNames[int(container)]
+                      << ", which doesn't support it" << std::endl;
+            continue;
+        }
+        // only the set operations run on more than one thread
+        std::vector<size_t> threadCounts{1};
+        if (isSetOperation(workload)) {
+            threadCounts = options.threads_;
+        }
+        // a trace is as big as it is
+        std::vector<size_t> sizes = options.sizes_;
+        if (workload == Workload::TRACE) {
+            sizes = {size_t(options.traceRecords_)};
+        }
+        for (size_t size : sizes) {
+            for (size_t threads : threadCounts) {
+                runWorkload<Tree, Keys>(container, keyType, workload, size,
+                                        threads, options, results);
+            }
+        }
+    }
+}
+
+/**
+ * \brief calls visitor.visit<Tree, Keys>() with the Tree for container
+ * holding Keys
+ */
+template <typename Keys, typename Visitor>
+void visitContainer(Container container, Visitor& visitor)
+{
+    using Key = typename Keys::Key;
+    switch (container) {
+    case Container::LINKED_LIST:
+        visitor.template visit<LinkedList<Key>, Keys>();
+        break;
+    case Container::STD_SET:
+        visitor.template visit<StdSet<Key>, Keys>();
+        break;
+    case Container::RANDOM_TREE:
+        visitor.template visit<RandomTree<Key>, Keys>();
+        break;
+    case Container::SPLAY_TREE:
+        visitor.template visit<SplayTree<Key>, Keys>();
+        break;
+    case Container::AVL_TREE:
+        visitor.template visit<AvlTree<Key>, Keys>();
+        break;
+    case Container::RB_TREE:
+        visitor.template visit<RBTree<Key>, Keys>();
+        break;
+    }
+}
+
+/**
+ * \brief calls visitor.visit<Tree, Keys>() with the Keys for keyType and
+ * the Tree for container
+ */
+template <typename Visitor>
+void visit(Container container, KeyType keyType, Visitor& visitor)
+{
+    switch (keyType) {
+    case KeyType::INT:
+        visitContainer<IntKeys>(container, visitor);
+        break;
+    case KeyType::UINT64:
+        visitContainer<Uint64Keys>(container, visitor);
+        break;
+    case KeyType::UINT128:
+        visitContainer<Uint128Keys>(container, visitor);
+        break;
+    case KeyType::SHORT_STRING:
+        visitContainer<ShortStringKeys>(container, visitor);
+        break;
+    case KeyType::LONG_STRING:
+        visitContainer<LongStringKeys>(container, visitor);
+        break;
+    case KeyType::STRUCT64:
+        visitContainer<FatKeys<64>>(container, visitor);
+        break;
+    case KeyType::STRUCT256:
+        visitContainer<FatKeys<256>>(container, visitor);
+        break;
+    }
+}
+
+/**
+ * \brief runs every workload on one container and key type
+ */
+struct BenchmarkVisitor {
+    Container container_;
+    KeyType keyType_;
+    const Options& options_;
+    std::vector<Result>& results_;
+
+    template <typename Tree, typename Keys>
+    void visit()
+    {
+        runContainer<Tree, Keys>(container_, keyType_, options_, results_);
+    }
+};
+
+void runBenchmarks(const Options& options, std::vector<Result>& results)
+{
+    for (KeyType keyType : options.keyTypes_) {
+        for (Container container : options.containers_) {
+            BenchmarkVisitor visitor{container, keyType, options, results};
+            visit(container, keyType, visitor);
+        }
+    }
+}
+
+// ----- Writing traces -----
+
+/**
+ * \brief saves the mixed workload that the first repetition at the first
+ * size runs, load and warm-up included, as a trace
+ */
+void writeTrace(const Options& options)
+{
+    WorkloadSpec spec = mixedSpec(options, options.sizes_.front());
+    // the same stream as runWorkload's first repetition
+    pcg32 rng{options.seed_, 0};
+    WorkloadGenerator generator{spec, options.seed_, rng()};
+    std::vector<Request> warmup = generator.next(spec.warmupOperations_);
+    std::vector<Request> requests = generator.next(spec.operations_);
+    TraceWriter writer{options.writeTraceFile_, options.traceEncoding_};
+    for (int key : generator.initialKeys()) {
+        writer.append(TraceOperation::INSERT, key);
+    }
+    for (const Request& request : warmup) {
+        writer.append(request.operation_, request.key_);
+    }
+    for (const Request& request : requests) {
+        writer.append(request.operation_, request.key_);
+    }
+    uint64_t records = writer.records();
+    if (!writer.close()) {
+        std::cerr << "Couldn't write " << options.writeTraceFile_
+                  << std::endl;
+        exit(1);
+    }
+    std::cerr << "wrote " << records << " records to "
+              << options.writeTraceFile_ << std::endl;
+}
+
+// ----- Measuring memory -----
+
+/**
+ * \brief one row of the memory report
+ */
+struct MemoryResult {
+    Container container_;
+    KeyType keyType_;
+    size_t size_;
+    long long peakBytes_;         ///> the most the heap held while filling
+    long long liveBytes_;         ///> what the heap held once full
+    size_t liveAllocations_;      ///> the blocks it held once full
+    double insertAllocations_;    ///> allocations per insert
+    double eraseAllocations_;     ///> allocations per delete
+    double eraseFrees_;           ///> frees per delete
+    long long retainedBytes_;     ///> still held once empty again
+    long long residentGrowth_;    ///> peak resident set growth, -1 if unknown
+};
+
+/**
+ * \brief fills a Tree with size keys and then deletes them again, in the
+ * order they went in, counting the heap all the way
+ */
+template <typename Tree, typename Keys>
+MemoryResult measureHere(Container container, KeyType keyType, size_t size,
+                         const Options& options)
+{
+    pcg32 rng{options.seed_};
+    std::vector<typename Keys::Key> keys =
+        makeKeys<Keys>(shuffledKeys(size, rng));
+    long long residentBefore = peakResidentBytes();
+    MemoryResult result{container, keyType, size, 0, 0, 0, 0, 0, 0, 0, -1};
+
+    startHeapTracking();
+    std::unique_ptr<Tree> tree{new Tree};
+    size_t inserted = 0;
+    for (const typename Keys::Key& key : keys) {
+        inserted += benchInsert(*tree, key);
+    }
+    result.peakBytes_ = heap.peakBytes_;
+    result.liveBytes_ = heap.liveBytes_;
+    result.liveAllocations_ = heap.allocations_ - heap.frees_;
+    result.insertAllocations_ = double(heap.allocations_) / size;
+    result.residentGrowth_ = peakResidentBytes() - residentBefore;
+
+    size_t allocations = heap.allocations_;
+    size_t frees = heap.frees_;
+    size_t erased = 0;
+    for (const typename Keys::Key& key : keys) {
+        erased += tree->deleteElement(key);
+    }
+    result.eraseAllocations_ = double(heap.allocations_ - allocations) / size;
+    result.eraseFrees_ = double(heap.frees_ - frees) / size;
+    result.retainedBytes_ = heap.liveBytes_;
+    tree.reset();
+    stopHeapTracking();
+
+    check(inserted == size && erased == size,
+          "not every key was inserted and erased");
+    return result;
+}
+
+/**
+ * \brief measures Tree in a child process, so that the peak resident set
+ * and the heap belong to this container alone
+ */
+template <typename Tree, typename Keys>
+MemoryResult measureMemory(Container container, KeyType keyType, size_t size,
+                           const Options& options)
+{
+    int channel[2];
+    if (pipe(channel) != 0) {
+        MemoryResult result =
+            measureHere<Tree, Keys>(container, keyType, size, options);
+        result.residentGrowth_ = -1;
+        return result;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(channel[0]);
+        MemoryResult result =
+            measureHere<Tree, Keys>(container, keyType, size, options);
+        bool sent = write(channel[1], &result, sizeof(result)) ==
+                    ssize_t(sizeof(result));
+        _exit(sent ? 0 : 1);
+    }
+    close(channel[1]);
+    MemoryResult result;
+    bool received = child != -1 &&
+                    read(channel[0], &result, sizeof(result)) ==
+                        ssize_t(sizeof(result));
+    close(channel[0]);
+    int status = 0;
+    if (child != -1) {
+        waitpid(child, &status, 0);
+    }
+    if (child != -1 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+        // the child already said what went wrong
+        exit(WIFEXITED(status) ? WEXITSTATUS(status) : 3);
+    }
+    if (!received) {
+        // couldn't fork, so the resident set isn't this container's alone
+        result =
+            measureHere<Tree, Keys>(container, keyType, size, options);
+        result.residentGrowth_ = -1;
+    }
+    return result;
+}
+
+/**
+ * \brief measures one container and key type at every size
+ */
+struct MemoryVisitor {
+    Container container_;
+    KeyType keyType_;
+    const Options& options_;
+    std::vector<MemoryResult>& results_;
+
+    template <typename Tree, typename Keys>
+    void visit()
+    {
+        for (size_t size : options_.sizes_) {
+            results_.push_back(measureMemory<Tree, Keys>(
+                container_, keyType_, size, options_));
+        }
+    }
+};
+
+void measureContainers(const Options& options,
+                       std::vector<MemoryResult>& results)
+{
+    for (KeyType keyType : options.keyTypes_) {
+        for (Container container : options.containers_) {
+            MemoryVisitor visitor{container, keyType, options, results};
+            visit(container, keyType, visitor);
+        }
+    }
+}
+
+// ----- Reporting -----
+
+double nanosPerOperation(const Result& result)
+{
+    return result.operations_ == 0 ? 0.0 :
+           result.medianMicros_ * 1000.0 / result.operations_;
+}
+
+/// the latency percentiles reported when operations are sampled
+static const double latencyFractions[] = {0.5, 0.9, 0.99, 0.999};
+static const char* latencyNames[] = {"p50", "p90", "p99", "p999"};
+
+/// the short names of the counters in the table
+static const char* counterColumns[] = {"cyc/op", "ins/op", "llc/op",
+                                       "br/op", "dtlb/op"};
+
+/// whether the report gets the heap and cache columns
+bool reportsHeap(const Options& options)
+{
+    return std::find(options.workloads_.begin(), options.workloads_.end(),
+                     Workload::SCALE) != options.workloads_.end();
+}
+
+void printTable(const std::vector<Result>& results, const Options& options)
+{
+    bool sampled = options.latencySample_ != 0;
+    bool heap = reportsHeap(options);
+    long long cache = lastLevelCacheBytes();
+    printf("%-12s %-12s %-15s %10s %7s %-12s %5s %12s %12s %10s",
+           "container", "key", "workload", "size", "threads", "phase", "reps",
+           "median us", "p99 us", "ns/op");
+    if (heap) {
+        printf(" %10s %10s %8s", "Mops/s", "heap MB", "x LLC");
+    }
+    if (sampled) {
+        printf(" %9s %9s %9s %9s %9s", "p50 ns", "p90 ns", "p99 ns",
+               "p99.9 ns", "max ns");
+    }
+    if (options.counters_) {
+        for (const char* column : counterColumns) {
+            printf(" %9s", column);
+        }
+    }
+    printf("\n");
+    for (const Result& result : results) {
+        printf("%-12s %-12s %-15s %10zu %7zu %-12s %5zu %12.1f %12.1f "
+               "%10.1f",
+               containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)],
+               workloadNames[int(result.workload_)], result.size_,
+               result.threads_, result.phase_.c_str(), result.repetitions_,
+               result.medianMicros_, result.p99Micros_,
+               nanosPerOperation(result));
+        if (heap) {
+            double nanos = nanosPerOperation(result);
+            printf(" %10.2f", nanos > 0 ? 1000.0 / nanos : 0.0);
+            if (result.heapBytes_ < 0) {
+                printf(" %10s %8s", "-", "-");
+            } else if (cache < 0) {
+                printf(" %10.1f %8s", result.heapBytes_ / 1048576.0, "-");
+            } else {
+                printf(" %10.1f %8.2f", result.heapBytes_ / 1048576.0,
+                       double(result.heapBytes_) / cache);
+            }
+        }
+        if (sampled && result.latency_.count() == 0) {
+            for (size_t j = 0; j < 4; ++j) {
+                printf(" %9s", "-");
+            }
+            printf(" %9s", "-");
+        } else if (sampled) {
+            for (double fraction : latencyFractions) {
+                printf(" %9llu", (unsigned long long)
+                                 result.latency_.percentile(fraction));
+            }
+            printf(" %9llu", (unsigned long long)result.latency_.max());
+        }
+        if (options.counters_) {
+            for (double count : result.countsPerOperation_) {
+                if (count < 0) {
+                    printf(" %9s", "-");
+                } else {
+                    printf(" %9.2f", count);
+                }
+            }
+        }
+        printf("\n");
+    }
+}
+
+void printCsv(const std::vector<Result>& results, const Options& options)
+{
+    bool sampled = options.latencySample_ != 0;
+    bool heap = reportsHeap(options);
+    long long cache = lastLevelCacheBytes();
+    printf("container,key,workload,size,threads,phase,operations,"
+           "repetitions,median_us,p99_us,min_us,mean_us,median_ns_per_op");
+    if (heap) {
+        printf(",heap_bytes,llc_bytes");
+    }
+    if (sampled) {
+        printf(",samples,p50_ns,p90_ns,p99_ns,p999_ns,max_ns");
+    }
+    if (options.counters_) {
+        for (int event = 0; event < PerfCounters::EVENTS; ++event) {
+            printf(",%s_per_op", PerfCounters::name(PerfCounters::Event(event)));
+        }
+    }
+    printf("\n");
+    for (const Result& result : results) {
+        printf("%s,%s,%s,%zu,%zu,%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f",
+               containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)],
+               workloadNames[int(result.workload_)], result.size_,
+               result.threads_, result.phase_.c_str(), result.operations_,
+               result.repetitions_, result.medianMicros_, result.p99Micros_,
+               result.minMicros_, result.meanMicros_,
+               nanosPerOperation(result));
+        if (heap) {
+            // left empty if not known
+            printf(",");
+            if (result.heapBytes_ >= 0) {
+                printf("%lld", result.heapBytes_);
+            }
+            printf(",");
+            if (cache >= 0) {
+                printf("%lld", cache);
+            }
+        }
+        if (sampled) {
+            printf(",%llu", (unsigned long long)result.latency_.count());
+            // left empty if not sampled
+            if (result.latency_.count() == 0) {
+                printf(",,,,,");
+            } else {
+                for (double fraction : latencyFractions) {
+                    printf(",%llu", (unsigned long long)
+                                    result.latency_.percentile(fraction));
+                }
+                printf(",%llu", (unsigned long long)result.latency_.max());
+            }
+        }
+        if (options.counters_) {
+            // left empty if not counted
+            for (double count : result.countsPerOperation_) {
+                if (count < 0) {
+                    printf(",");
+                } else {
+                    printf(",%.4f", count);
+                }
+            }
+        }
+        printf("\n");
+    }
+}
+
+void printJson(const std::vector<Result>& results, const Options& options)
+{
+    bool sampled = options.latencySample_ != 0;
+    bool heap = reportsHeap(options);
+    printf("{\n  \"seed\": %llu,\n", (unsigned long long)options.seed_);
+    if (heap) {
+        printf("  \"llc_bytes\": %lld,\n", lastLevelCacheBytes());
+    }
+    printf("  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        printf("%s\n    {\"container\": \"%s\", \"key\": \"%s\", "
+               "\"workload\": \"%s\", \"size\": %zu, \"threads\": %zu, "
+               "\"phase\": \"%s\", \"operations\": %zu, "
+               "\"repetitions\": %zu, \"median_us\": %.3f, "
+               "\"p99_us\": %.3f, \"min_us\": %.3f, \"mean_us\": %.3f, "
+               "\"median_ns_per_op\": %.3f",
+               i == 0 ? "" : ",", containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)], workloadNames[int(result.workload_)], result.size_,
+               result.threads_, result.phase_.c_str(), result.operations_,
+               result.repetitions_, result.medianMicros_, result.p99Micros_,
+               result.minMicros_, result.meanMicros_,
+               nanosPerOperation(result));
+        printf(", \"samples_us\": [");
+        for (size_t j = 0; j < result.micros_.size(); ++j) {
+            printf("%s%.3f", j == 0 ? "" : ", ", result.micros_[j]);
+        }
+        printf("]");
+        if (heap) {
+            if (result.heapBytes_ < 0) {
+                printf(", \"heap_bytes\": null");
+            } else {
+                printf(", \"heap_bytes\": %lld", result.heapBytes_);
+            }
+        }
+        if (sampled) {
+            printf(", \"latency_ns\": {\"samples\": %llu",
+                   (unsigned long long)result.latency_.count());
+            for (size_t j = 0; j < 4; ++j) {
+                printf(", \"%s\": ", latencyNames[j]);
+                if (result.latency_.count() == 0) {
+                    printf("null");
+                } else {
+                    printf("%llu", (unsigned long long)
+                                   result.latency_.percentile(
+                                       latencyFractions[j]));
+                }
+            }
+            if (result.latency_.count() == 0) {
+                printf(", \"max\": null}");
+            } else {
+                printf(", \"max\": %llu}",
+                       (unsigned long long)result.latency_.max());
+            }
+        }
+        if (options.counters_) {
+            printf(", \"counters_per_op\": {");
+            for (int event = 0; event < PerfCounters::EVENTS; ++event) {
+                double count = result.countsPerOperation_[event];
+                printf("%s\"%s\": ", event == 0 ? "" : ", ",
+                       PerfCounters::name(PerfCounters::Event(event)));
+                if (count < 0) {
+                    printf("null");
+                } else {
+                    printf("%.4f", count);
+                }
+            }
+            printf("}");
+        }
+        printf("}");
+    }
+    printf("\n  ]\n}\n");
+}
+
+void printMemoryTable(const std::vector<MemoryResult>& results)
+{
+    printf("%-12s %-12s %10s %14s %10s %12s %10s %10s %10s %14s %14s\n",
+           "container", "key", "size", "peak bytes", "bytes/key",
+           "live allocs", "allocs/ins", "allocs/del", "frees/del", "retained",
+           "rss growth");
+    for (const MemoryResult& result : results) {
+        printf("%-12s %-12s %10zu %14lld %10.1f %12zu %10.3f %10.3f %10.3f "
+               "%14lld ",
+               containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)], result.size_,
+               result.peakBytes_, double(result.liveBytes_) / result.size_,
+               result.liveAllocations_, result.insertAllocations_,
+               result.eraseAllocations_, result.eraseFrees_,
+               result.retainedBytes_);
+        if (result.residentGrowth_ < 0) {
+            printf("%14s\n", "-");
+        } else {
+            printf("%14lld\n", result.residentGrowth_);
+        }
+    }
+}
+
+void printMemoryCsv(const std::vector<MemoryResult>& results)
+{
+    printf("container,key,size,peak_bytes,live_bytes,bytes_per_key,"
+           "live_allocations,allocations_per_insert,allocations_per_delete,"
+           "frees_per_delete,retained_bytes,peak_rss_growth_bytes\n");
+    for (const MemoryResult& result : results) {
+        printf("%s,%s,%zu,%lld,%lld,%.3f,%zu,%.4f,%.4f,%.4f,%lld,",
+               containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)], result.size_,
+               result.peakBytes_, result.liveBytes_,
+               double(result.liveBytes_) / result.size_,
+               result.liveAllocations_, result.insertAllocations_,
+               result.eraseAllocations_, result.eraseFrees_,
+               result.retainedBytes_);
+        if (result.residentGrowth_ >= 0) {
+            printf("%lld", result.residentGrowth_);
+        }
+        printf("\n");
+    }
+}
+
+void printMemoryJson(const std::vector<MemoryResult>& results,
+                     const Options& options)
+{
+    printf("{\n  \"seed\": %llu,\n  \"memory\": [",
+           (unsigned long long)options.seed_);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const MemoryResult& result = results[i];
+        printf("%s\n    {\"container\": \"%s\", \"key\": \"%s\", "
+               "\"size\": %zu, \"peak_bytes\": %lld, \"live_bytes\": %lld, "
+               "\"bytes_per_key\": %.3f, \"live_allocations\": %zu, "
+               "\"allocations_per_insert\": %.4f, "
+               "\"allocations_per_delete\": %.4f, "
+               "\"frees_per_delete\": %.4f, \"retained_bytes\": %lld, "
+               "\"peak_rss_growth_bytes\": ",
+               i == 0 ? "" : ",", containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)], result.size_,
+               result.peakBytes_, result.liveBytes_,
+               double(result.liveBytes_) / result.size_,
+               result.liveAllocations_, result.insertAllocations_,
+               result.eraseAllocations_, result.eraseFrees_,
+               result.retainedBytes_);
+        if (result.residentGrowth_ < 0) {
+            printf("null}");
+        } else {
+            printf("%lld}", result.residentGrowth_);
+        }
+    }
+    printf("\n  ]\n}\n");
+}
+
+/**
+ * \brief writes every histogram's buckets as CSV, for plotting
+ */
+void writeHistograms(const std::vector<Result>& results,
+                     const std::string& file)
+{
+    std::ofstream out{file};
+    if (!out) {
+        std::cerr << "Couldn't write " << file << std::endl;
+        exit(1);
+    }
+    out << "container,key,workload,size,threads,phase,lower_ns,upper_ns,"
+           "count,cumulative_fraction\n";
+    for (const Result& result : results) {
+        uint64_t seen = 0;
+        for (const LatencyHistogram::Bucket& bucket :
+             result.latency_.buckets()) {
+            seen += bucket.count_;
+            out << containerNames[int(result.container_)] << ','
+                << keyTypeNames[int(result.keyType_)] << ','
+                << workloadNames[int(result.workload_)] << ','
+                << result.size_ << ',' << result.threads_ << ','
+                << result.phase_ << ',' << bucket.lower_ << ','
+                << bucket.upper_ << ',' << bucket.count_ << ','
+                << double(seen) / result.latency_.count() << '\n';
+        }
+    }
+}
+
+// ----- Comparing with a baseline -----
+
+enum class Verdict {
+    SAME,
+    IMPROVED,
+    REGRESSED,
+    NEW        ///> not in the baseline
+};
+
+static const char* verdictNames[] = {"same", "improved", "regressed", "new"};
+
+/**
+ * \brief how one result compares with the baseline
+ */
+struct Comparison {
+    const Result* result_;
+    const BaselineCell* baseline_;  ///> nullptr for NEW
+    double change_;                 ///> relative change in the median
+    double p_;                      ///> Mann-Whitney p-value, -1 if untested
+    Verdict verdict_;
+};
+
+/**
+ * \brief returns the baseline's cell for result, or nullptr if it has none
+ */
+const BaselineCell* findCell(const std::vector<BaselineCell>& cells,
+                             const Result& result)
+{
+    for (const BaselineCell& cell : cells) {
+        if (cell.container_ == containerNames[int(result.container_)] &&
+            cell.key_ == keyTypeNames[int(result.keyType_)] &&
+            cell.workload_ == workloadNames[int(result.workload_)] &&
+            cell.size_ == result.size_ && cell.threads_ == result.threads_ &&
+            cell.phase_ == result.phase_) {
+            return &cell;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * \brief compares every result with its cell in the baseline
+ *
+ * \details a cell only counts as changed if the repetitions' times differ
+ * significantly at options.alpha_ and the median moved by more than
+ * options.threshold_
+ */
+std::vector<Comparison> compare(const std::vector<Result>& results,
+                                const std::vector<BaselineCell>& cells,
+                                const Options& options)
+{
+    std::vector<Comparison> comparisons;
+    bool untested = false;
+    for (const Result& result : results) {
+        const BaselineCell* cell = findCell(cells, result);
+        if (cell == nullptr) {
+            comparisons.push_back(
+                Comparison{&result, nullptr, 0, -1, Verdict::NEW});
+            continue;
+        }
+        double change = cell->medianMicros_ > 0 ?
+                        result.medianMicros_ / cell->medianMicros_ - 1 : 0;
+        double p = -1;
+        Verdict verdict = Verdict::SAME;
+        if (cell->micros_.empty()) {
+            untested = true;
+        } else {
+            p = mannWhitneyP(cell->micros_, result.micros_);
+            if (p < options.alpha_ && change > options.threshold_) {
+                verdict = Verdict::REGRESSED;
+            } else if (p < options.alpha_ && change < -options.threshold_) {
+                verdict = Verdict::IMPROVED;
+            }
+        }
+        comparisons.push_back(Comparison{&result, cell, change, p, verdict});
+    }
+    if (untested) {
+        std::cerr << "the baseline has no times per repetition for some "
+                     "cells, they can't be tested" << std::endl;
+    }
+    return comparisons;
+}
+
+void printComparisonTable(const std::vector<Comparison>& comparisons)
+{
+    printf("%-12s %-12s %-15s %10s %7s %-12s %12s %12s %9s %8s %-9s\n",
+           "container", "key", "workload", "size", "threads", "phase",
+           "base us", "median us", "change", "p", "verdict");
+    for (const Comparison& comparison : comparisons) {
+        const Result& result = *comparison.result_;
+        printf("%-12s %-12s %-15s %10zu %7zu %-12s ",
+               containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)],
+               workloadNames[int(result.workload_)], result.size_,
+               result.threads_, result.phase_.c_str());
+        if (comparison.baseline_ == nullptr) {
+            printf("%12s ", "-");
+        } else {
+            printf("%12.1f ", comparison.baseline_->medianMicros_);
+        }
+        printf("%12.1f ", result.medianMicros_);
+        if (comparison.baseline_ == nullptr) {
+            printf("%9s ", "-");
+        } else {
+            printf("%+8.1f%% ", comparison.change_ * 100);
+        }
+        if (comparison.p_ < 0) {
+            printf("%8s ", "-");
+        } else {
+            printf("%8.4f ", comparison.p_);
+        }
+        printf("%-9s\n", verdictNames[int(comparison.verdict_)]);
+    }
+}
+
+void printComparisonCsv(const std::vector<Comparison>& comparisons)
+{
+    printf("container,key,workload,size,threads,phase,baseline_median_us,"
+           "median_us,change,p_value,verdict\n");
+    for (const Comparison& comparison : comparisons) {
+        const Result& result = *comparison.result_;
+        printf("%s,%s,%s,%zu,%zu,%s,",
+               containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)],
+               workloadNames[int(result.workload_)], result.size_,
+               result.threads_, result.phase_.c_str());
+        // left empty if not known
+        if (comparison.baseline_ != nullptr) {
+            printf("%.3f", comparison.baseline_->medianMicros_);
+        }
+        printf(",%.3f,", result.medianMicros_);
+        if (comparison.baseline_ != nullptr) {
+            printf("%.4f", comparison.change_);
+        }
+        printf(",");
+        if (comparison.p_ >= 0) {
+            printf("%.6f", comparison.p_);
+        }
+        printf(",%s\n", verdictNames[int(comparison.verdict_)]);
+    }
+}
+
+void printComparisonJson(const std::vector<Comparison>& comparisons,
+                         const Options& options)
+{
+    size_t regressions = 0;
+    for (const Comparison& comparison : comparisons) {
+        regressions += comparison.verdict_ == Verdict::REGRESSED;
+    }
+    printf("{\n  \"seed\": %llu,\n  \"baseline\": \"%s\",\n"
+           "  \"threshold\": %.4f,\n  \"alpha\": %.4f,\n"
+           "  \"regressions\": %zu,\n  \"comparisons\": [",
+           (unsigned long long)options.seed_, options.baselineFile_.c_str(),
+           options.threshold_, options.alpha_, regressions);
+    for (size_t i = 0; i < comparisons.size(); ++i) {
+        const Comparison& comparison = comparisons[i];
+        const Result& result = *comparison.result_;
+        printf("%s\n    {\"container\": \"%s\", \"key\": \"%s\", "
+               "\"workload\": \"%s\", \"size\": %zu, \"threads\": %zu, "
+               "\"phase\": \"%s\", \"median_us\": %.3f",
+               i == 0 ? "" : ",", containerNames[int(result.container_)],
+               keyTypeNames[int(result.keyType_)],
+               workloadNames[int(result.workload_)], result.size_,
+               result.threads_, result.phase_.c_str(), result.medianMicros_);
+        if (comparison.baseline_ == nullptr) {
+            printf(", \"baseline_median_us\": null, \"change\": null");
+        } else {
+            printf(", \"baseline_median_us\": %.3f, \"change\": %.4f",
+                   comparison.baseline_->medianMicros_, comparison.change_);
+        }
+        if (comparison.p_ < 0) {
+            printf(", \"p_value\": null");
+        } else {
+            printf(", \"p_value\": %.6f", comparison.p_);
+        }
+        printf(", \"verdict\": \"%s\"}",
+               verdictNames[int(comparison.verdict_)]);
+    }
+    printf("\n  ]\n}\n");
+}
+
+// ----- Option Processing -----
+
+void usage(std::ostream& out)
+{
+    out << "Usage: ./bench [options]\n"
+        << "  -c, --container LIST  containers to run, from: all";
+    for (const char* name : containerNames) {
+        out << ", " << name;
+    }
+    out << "\n"
+        << "                        (default: every tree)\n"
+        << "  -w, --workload LIST   workloads to run, from: all";
+    for (const char* name : workloadNames) {
+        out << ", " << name;
+    }
+    out << "\n"
+        << "                        (default: the inserts, erases and "
+           "finds)\n"
+        << "  -k, --key LIST        key types to run with, from: all";
+    for (const char* name : keyTypeNames) {
+        out << ", " << name;
+    }
+    out << "\n"
+        << "                        (default: int)\n"
+        << "  -n, --size LIST       container sizes (default: "
+           "1000,10000,100000),\n"
+        << "                        or scale for 1000, 3000, 10000, ... "
+           "up to 1000000000\n"
+        << "  -r, --reps N          repetitions of each run (default: 5)\n"
+        << "  -t, --threads LIST    threads for the set operations\n"
+        << "                        (default: 1, 2, 4, ... up to the cores)\n"
+        << "  -l, --scan-length N   keys per range scan (default: 10)\n"
+        << "  -s, --seed N          seed for the keys (default: 42)\n"
+        << "  -f, --format FORMAT   table, csv or json (default: table)\n"
+        << "The mixed workload loads size records and then runs:\n"
+        << "  -m, --mix MIX         a preset, from: " << mixPresetNames[0];
+    for (size_t i = 1; i < sizeof(mixPresetNames) / sizeof(mixPresetNames[0]);
+         ++i) {
+        out << ", " << mixPresetNames[i];
+    }
+    out << "\n"
+        << "                        or weights like read=90,insert=8,"
+           "delete=2,scan=0\n"
+        << "                        (default: production, which is that)\n"
+        << "  -d, --distribution D  keys to use, from: "
+        << keyDistributionNames[0];
+    for (size_t i = 1; i < sizeof(keyDistributionNames) /
+                               sizeof(keyDistributionNames[0]); ++i) {
+        out << ", " << keyDistributionNames[i];
+    }
+    out << "\n"
+        << "                        (default: zipfian)\n"
+        << "  --theta X             Zipfian skew, in (0, 1) (default: 0.99)\n"
+        << "  --hot-keys X          fraction of hot records (default: 0.2)\n"
+        << "  --hot-operations X    fraction of operations on them "
+           "(default: 0.8)\n"
+        << "  --key-order ORDER     scrambled or ordered record keys "
+           "(default: scrambled)\n"
+        << "  -o, --operations N    timed operations (default: the size)\n"
+        << "  --warmup N            operations before them (default: a "
+           "tenth as many)\n"
+        << "The scale workload builds and then runs:\n"
+        << "  --lookups N           lookups of keys in the container "
+           "(default: the size,\n"
+        << "                        at most 10000000)\n"
+        << "Latencies:\n"
+        << "  --latency N           also time every Nth operation on its "
+           "own and report\n"
+        << "                        p50, p90, p99, p99.9 and max "
+           "(default: 0, none)\n"
+        << "  --histogram FILE      write the latency histograms to FILE "
+           "as CSV\n"
+        << "  --counters            count cycles, instructions, cache, "
+           "branch and dTLB\n"
+        << "                        misses per operation with "
+           "perf_event_open (Linux)\n"
+        << "Traces:\n"
+        << "  --trace FILE          the trace the trace workload replays\n"
+        << "  --write-trace FILE    save the mixed workload at the first size "
+           "as a trace\n"
+        << "                        and exit\n"
+        << "  --trace-encoding E    raw or delta, for --write-trace "
+           "(default: delta)\n"
+        << "Comparing:\n"
+        << "  --baseline FILE       compare with an earlier run saved with "
+           "-f json, and exit\n"
+        << "                        with " << REGRESSION_EXIT
+        << " if anything regressed\n"
+        << "  --threshold X         the smallest relative change reported "
+           "(default: 0.05)\n"
+        << "  --alpha X             the significance level (default: 0.05)\n"
+        << "Memory:\n"
+        << "  --memory              instead of timing, fill and empty each "
+           "container and\n"
+        << "                        report its heap use, allocations and "
+           "resident set\n"
+        << "  -h, --help            print this message\n"
+        << "LISTs are comma separated, long options can also be given as "
+           "--option=value"
+        << std::endl;
+}
+
+void usageError(const std::string& message)
+{
+    std::cerr << message << std::endl;
+    usage(std::cerr);
+    exit(2);
+}
+
+/// splits a comma separated list
+std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) {
+            comma = list.size();
+        }
+        items.push_back(list.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+size_t parseCount(const std::string& value, const std::string& option)
+{
+    if (value.empty() ||
+        value.find_first_not_of("0123456789") != std::string::npos) {
+        usageError("Expected a number for " + option + ", got '" + value +
+                   "'");
+    }
+    return std::stoull(value);
+}
+
+/**
+ * \brief parses a number in [0, 1]
+ */
+double parseFraction(const std::string& value, const std::string& option)
+{
+    char* end = nullptr;
+    double fraction = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !(fraction >= 0 && fraction <= 1)) {
+        usageError("Expected a fraction for " + option + ", got '" + value +
+                   "'");
+    }
+    return fraction;
+}
+
+/**
+ * \brief looks each name in list up in names, "all" picking every one
+ */
+template <typename Choice, size_t N>
+std::vector<Choice> parseChoices(const std::string& list,
+                                 const char* (&names)[N],
+                                 const std::string& option)
+{
+    std::vector<Choice> choices;
+    for (const std::string& item : splitList(list)) {
+        if (item == "all") {
+            for (size_t i = 0; i < N; ++i) {
+                choices.push_back(Choice(i));
+            }
+            continue;
+        }
+        size_t i = std::find(names, names + N, item) - names;
+        if (i == N) {
+            usageError("Unknown " + option + " '" + item + "'");
+        }
+        choices.push_back(Choice(i));
+    }
+    return choices;
+}
+
+/**
+ * \brief Option Processing
+ * \details
+ *   Fills in options from the command line.
+ *
+ *   Will return with an exit error of 2 if receives a usage problem.
+ *
+ * \param arguments     Input of options from command line.
+ * \param options       What to run.
+ */
+void processOptions(std::list<std::string> arguments, Options& options)
+{
+    // Set the defaults
+    options.containers_ = {Container::STD_SET, Container::RANDOM_TREE,
+                           Container::SPLAY_TREE, Container::AVL_TREE,
+                           Container::RB_TREE};
+    options.workloads_ = {Workload::INSERT_INORDER, Workload::INSERT_RANDOM,
+                          Workload::ERASE_INORDER, Workload::ERASE_RANDOM,
+                          Workload::FIND_RANDOM};
+    options.keyTypes_ = {KeyType::INT};
+    options.sizes_ = {1000, 10000, 100000};
+    options.threads_.clear();
+    for (size_t threads = 1; threads <= WorkStealingPool::defaultThreads();
+         threads *= 2) {
+        options.threads_.push_back(threads);
+    }
+    options.repetitions_ = 5;
+    options.scanLength_ = 10;
+    options.seed_ = 42;
+    options.format_ = Format::TABLE;
+    options.mixed_ = WorkloadSpec{};
+    options.operations_ = DEFAULT_COUNT;
+    options.warmup_ = DEFAULT_COUNT;
+    options.latencySample_ = 0;
+    options.histogramFile_.clear();
+    options.counters_ = false;
+    options.memory_ = false;
+    options.traceFile_.clear();
+    options.traceRecords_ = 0;
+    options.writeTraceFile_.clear();
+    options.traceEncoding_ = TraceEncoding::DELTA;
+    options.lookups_ = DEFAULT_COUNT;
+    options.baselineFile_.clear();
+    options.threshold_ = 0.05;
+    options.alpha_ = 0.05;
+
+    while (!arguments.empty()) {
+        std::string option = arguments.front();
+        arguments.pop_front();
+        if (option == "-h" || option == "--help") {
+            usage(std::cout);
+            exit(0);
+        }
+        if (std::find(std::begin(flagNames), std::end(flagNames), option) !=
+            std::end(flagNames)) {
+            if (option == "--counters") {
+                options.counters_ = true;
+            } else {
+                options.memory_ = true;
+            }
+            continue;
+        }
+        // the value either follows an = or is the next argument
+        std::string value;
+        size_t equals = option.find('=');
+        bool joined = option.compare(0, 2, "--") == 0 &&
+                      equals != std::string::npos;
+        if (joined) {
+            value = option.substr(equals + 1);
+            option = option.substr(0, equals);
+        }
+        if (std::find(std::begin(optionNames), std::end(optionNames),
+                      option) == std::end(optionNames)) {
+            usageError("Unrecognized option: " + option);
+        } else if (joined) {
+            // already have the value
+        } else if (!arguments.empty()) {
+            value = arguments.front();
+            arguments.pop_front();
+        } else {
+            usageError("Missing value for " + option);
+        }
+
+        if (option == "-c" || option == "--container") {
+            options.containers_ =
+                parseChoices<Container>(value, containerNames, "container");
+        } else if (option == "-w" || option == "--workload") {
+            options.workloads_ =
+                parseChoices<Workload>(value, workloadNames, "workload");
+        } else if (option == "-k" || option == "--key") {
+            options.keyTypes_ =
+                parseChoices<KeyType>(value, keyTypeNames, "key type");
+        } else if (option == "-n" || option == "--size") {
+            options.sizes_.clear();
+            if (value == "scale") {
+                // about three steps to each factor of ten
+                for (size_t size = 1000; size <= 1000000000; size *= 10) {
+                    options.sizes_.push_back(size);
+                    if (size < 1000000000) {
+                        options.sizes_.push_back(size * 3);
+                    }
+                }
+                continue;
+            }
+            for (const std::string& item : splitList(value)) {
+                size_t size = parseCount(item, option);
+                if (size == 0 || size > INT_MAX) {
+                    usageError("Size out of range: " + item);
+                }
+                options.sizes_.push_back(size);
+            }
+        } else if (option == "-r" || option == "--reps") {
+            options.repetitions_ = parseCount(value, option);
+            if (options.repetitions_ == 0) {
+                usageError("Need at least one repetition");
+            }
+        } else if (option == "-t" || option == "--threads") {
+            options.threads_.clear();
+            for (const std::string& item : splitList(value)) {
+                options.threads_.push_back(
+                    std::max<size_t>(parseCount(item, option), 1));
+            }
+        } else if (option == "-l" || option == "--scan-length") {
+            options.scanLength_ = parseCount(value, option);
+        } else if (option == "-s" || option == "--seed") {
+            options.seed_ = parseCount(value, option);
+        } else if (option == "-f" || option == "--format") {
+            std::vector<Format> formats =
+                parseChoices<Format>(value, formatNames, "format");
+            if (formats.size() != 1) {
+                usageError("Expected a single format");
+            }
+            options.format_ = formats.front();
+        } else if (option == "-m" || option == "--mix") {
+            if (!parseOperationMix(value, options.mixed_.mix_)) {
+                usageError("Unknown mix '" + value + "'");
+            }
+        } else if (option == "-d" || option == "--distribution") {
+            if (!parseKeyDistribution(value, options.mixed_.distribution_)) {
+                usageError("Unknown distribution '" + value + "'");
+            }
+        } else if (option == "--theta") {
+            options.mixed_.zipfTheta_ = parseFraction(value, option);
+            if (options.mixed_.zipfTheta_ == 0 ||
+                options.mixed_.zipfTheta_ == 1) {
+                usageError("Theta has to be strictly between 0 and 1");
+            }
+        } else if (option == "--hot-keys") {
+            options.mixed_.hotKeys_ = parseFraction(value, option);
+        } else if (option == "--hot-operations") {
+            options.mixed_.hotOperations_ = parseFraction(value, option);
+        } else if (option == "--key-order") {
+            std::vector<size_t> orders =
+                parseChoices<size_t>(value, keyOrderNames, "key order");
+            if (orders.size() != 1) {
+                usageError("Expected a single key order");
+            }
+            options.mixed_.scrambleKeys_ = orders.front() == 0;
+        } else if (option == "-o" || option == "--operations") {
+            options.operations_ = parseCount(value, option);
+        } else if (option == "--warmup") {
+            options.warmup_ = parseCount(value, option);
+        } else if (option == "--latency") {
+            options.latencySample_ = parseCount(value, option);
+        } else if (option == "--histogram") {
+            options.histogramFile_ = value;
+        } else if (option == "--lookups") {
+            options.lookups_ = parseCount(value, option);
+        } else if (option == "--baseline") {
+            options.baselineFile_ = value;
+        } else if (option == "--threshold") {
+            options.threshold_ = parseFraction(value, option);
+        } else if (option == "--alpha") {
+            options.alpha_ = parseFraction(value, option);
+        } else if (option == "--trace") {
+            options.traceFile_ = value;
+        } else if (option == "--write-trace") {
+            options.writeTraceFile_ = value;
+        } else if (option == "--trace-encoding") {
+            std::vector<TraceEncoding> encodings = parseChoices<TraceEncoding>(
+                value, traceEncodingNames, "trace encoding");
+            if (encodings.size() != 1) {
+                usageError("Expected a single trace encoding");
+            }
+            options.traceEncoding_ = encodings.front();
+        }
+    }
+    if (!options.histogramFile_.empty() && options.latencySample_ == 0) {
+        usageError("--histogram needs --latency");
+    }
+    if (!options.baselineFile_.empty()) {
+        // the fewest repetitions that can differ significantly at all
+        std::vector<double> lower(options.repetitions_, 0.0);
+        std::vector<double> higher(options.repetitions_, 1.0);
+        for (size_t i = 0; i < options.repetitions_; ++i) {
+            lower[i] = double(i);
+            higher[i] = double(options.repetitions_ + i);
+        }
+        if (mannWhitneyP(lower, higher) >= options.alpha_) {
+            usageError("Too few repetitions to tell runs apart at that "
+                       "alpha, use more with -r");
+        }
+    }
+    bool tracing = std::find(options.workloads_.begin(),
+                             options.workloads_.end(),
+                             Workload::TRACE) != options.workloads_.end();
+    if (tracing) {
+        if (options.traceFile_.empty()) {
+            usageError("The trace workload needs --trace");
+        }
+        TraceReader reader{options.traceFile_};
+        if (!reader.good()) {
+            usageError("Not a readable trace: " + options.traceFile_);
+        }
+        options.traceRecords_ = reader.records();
+    }
+    size_t largest = *std::max_element(options.sizes_.begin(),
+                                       options.sizes_.end());
+    for (Workload workload : options.workloads_) {
+        if (workload == Workload::MIXED) {
+            // every insert adds a record, and so a key
+            size_t operations = options.operations_ == DEFAULT_COUNT ?
+                                largest : options.operations_;
+            size_t warmup = options.warmup_ == DEFAULT_COUNT ?
+                            operations / 10 : options.warmup_;
+            if (uint64_t(largest) + warmup + operations > INT_MAX) {
+                usageError("Too many mixed operations for int keys");
+            }
+        } else if (workload != Workload::SCALE &&
+                   workload != Workload::TRACE && largest > INT_MAX / 3) {
+            // the other workloads use keys up to three times the size
+            usageError("Only the scale and mixed workloads go past " +
+                       std::to_string(INT_MAX / 3) + " keys");
+        }
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    // Turn the command line (an array of C-style strings)
+    // into a nice C++ list of C++ strings, and pass them to
+    // processOptions. (Note that the arguments to the
+    // list constructor are pointers into the array, being
+    // used as start and end iterators.)
+    Options options;
+    std::list<std::string> arguments(argv + 1, argv + argc);
+    processOptions(arguments, options);
+
+    if (!options.writeTraceFile_.empty()) {
+        writeTrace(options);
+        return 0;
+    }
+    if (options.memory_) {
+        std::vector<MemoryResult> results;
+        measureContainers(options, results);
+        if (options.format_ == Format::CSV) {
+            printMemoryCsv(results);
+        } else if (options.format_ == Format::JSON) {
+            printMemoryJson(results, options);
+        } else {
+            printMemoryTable(results);
+        }
+        return 0;
+    }
+    if (options.latencySample_ != 0) {
+        LatencyClock::calibrate();
+    }
+    if (options.counters_) {
+        PerfCounters probe;
+        for (int event = 0; event < PerfCounters::EVENTS; ++event) {
+            if (!probe.available(PerfCounters::Event(event))) {
+                std::cerr << "can't count "
+                          << PerfCounters::name(PerfCounters::Event(event))
+                          << " here, leaving it out" << std::endl;
+            }
+        }
+    }
+    std::vector<BaselineCell> baseline;
+    if (!options.baselineFile_.empty()) {
+        // read first, so a bad baseline doesn't waste a whole run
+        std::string error;
+        if (!readBaseline(options.baselineFile_, baseline, error)) {
+            std::cerr << "Couldn't load the baseline: " << error << std::endl;
+            return 1;
+        }
+    }
+    std::vector<Result> results;
+    runBenchmarks(options, results);
+
+    if (!options.baselineFile_.empty()) {
+        std::vector<Comparison> comparisons =
+            compare(results, baseline, options);
+        if (options.format_ == Format::CSV) {
+            printComparisonCsv(comparisons);
+        } else if (options.format_ == Format::JSON) {
+            printComparisonJson(comparisons, options);
+        } else {
+            printComparisonTable(comparisons);
+        }
+        if (!options.histogramFile_.empty()) {
+            writeHistograms(results, options.histogramFile_);
+        }
+        for (const Comparison& comparison : comparisons) {
+            if (comparison.verdict_ == Verdict::REGRESSED) {
+                return REGRESSION_EXIT;
+            }
+        }
+        return 0;
+    }
+    if (options.format_ == Format::CSV) {
+        printCsv(results, options);
+    } else if (options.format_ == Format::JSON) {
+        printJson(results, options);
+    } else {
+        printTable(results, options);
+    }
+    if (!options.histogramFile_.empty()) {
+        writeHistograms(results, options.histogramFile_);
+    }
 
-    clock::duration elapsed = stopTime - startTime;
-    size_t ticks = 
-      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
-    const std::string micro = "\u00B5";  // unicode micro symbol
-    std::cout << ticks << " " << micro << "s total" << std::endl;
-    std::cout << float(ticks) / insertions << " "
-              << micro << "s per insertion" << std::endl;
-    */
     // Unix "success" value
     return 0;
 }
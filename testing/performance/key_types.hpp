@@ -0,0 +1,106 @@
+/**
+ * \file key_types.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief The kinds of keys the benchmark can run its workloads with
+ *
+ * \details The workloads pick their keys as int32_t indices. Each kind of
+ * key below turns an index into a Key with make(), keeping the order of
+ * the indices and never giving two indices the same Key, so every
+ * workload's checks hold whatever the key. The kinds differ in what a
+ * comparison costs and in how much a node has to carry:
+ *
+ *  - IntKeys and Uint64Keys compare in one instruction.
+ *  - Uint128Keys are 16 byte ids, pcg's 128 bit integer.
+ *  - ShortStringKeys fit the small string buffer of std::string, so they
+ *    live in the node. LongStringKeys don't, so every key is a heap
+ *    allocation of its own, and they share a long prefix, so comparisons
+ *    read a fair way into both keys.
+ *  - FatKeys<64> and FatKeys<256> are structs compared on their first
+ *    eight bytes, the rest being payload carried around in the node.
+ */
+
+#ifndef KEY_TYPES_HPP_INCLUDED
+#define KEY_TYPES_HPP_INCLUDED 1
+#include "pcg-cpp-0.98/include/pcg_random.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * \brief turns an index into an unsigned number with the same order
+ */
+uint32_t orderedBits(int32_t index);
+
+/**
+ * \brief the low bits that follow an index around, so that wide keys
+ * aren't mostly zeroes
+ */
+uint64_t fillerBits(int32_t index);
+
+struct IntKeys {
+    using Key = int;
+    static Key make(int32_t index);
+};
+
+struct Uint64Keys {
+    using Key = uint64_t;
+    static Key make(int32_t index);
+};
+
+struct Uint128Keys {
+    using Key = pcg_extras::pcg128_t;
+    static Key make(int32_t index);
+};
+
+struct ShortStringKeys {
+    using Key = std::string;
+    static Key make(int32_t index);
+};
+
+struct LongStringKeys {
+    using Key = std::string;
+    static Key make(int32_t index);
+};
+
+/**
+ * \brief a Bytes byte struct ordered by its id
+ */
+template <size_t Bytes>
+struct FatKey {
+    static_assert(Bytes > sizeof(uint64_t), "room for the payload");
+
+    uint64_t id_;
+    unsigned char payload_[Bytes - sizeof(uint64_t)];
+
+    bool operator==(const FatKey& rhs) const;
+    bool operator!=(const FatKey& rhs) const;
+    bool operator<(const FatKey& rhs) const;
+    bool operator>(const FatKey& rhs) const;
+    bool operator<=(const FatKey& rhs) const;
+    bool operator>=(const FatKey& rhs) const;
+};
+
+template <size_t Bytes>
+struct FatKeys {
+    using Key = FatKey<Bytes>;
+    static Key make(int32_t index);
+};
+
+/**
+ * \brief returns a number read from key, for scans to add up so that they
+ * have to look at every key
+ */
+uint64_t keyDigest(int key);
+uint64_t keyDigest(uint64_t key);
+uint64_t keyDigest(const pcg_extras::pcg128_t& key);
+uint64_t keyDigest(const std::string& key);
+
+template <size_t Bytes>
+uint64_t keyDigest(const FatKey<Bytes>& key);
+
+#include "key_types_private.hpp"
+
+#endif // KEY_TYPES_HPP_INCLUDED
@@ -0,0 +1,141 @@
+/**
+ * \file key_types_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the benchmark's key kinds
+ */
+
+inline uint32_t orderedBits(int32_t index)
+{
+    // flipping the sign bit puts the negative indices first
+    return uint32_t(index) ^ 0x80000000u;
+}
+
+inline uint64_t fillerBits(int32_t index)
+{
+    // splitmix64's finalizer
+    uint64_t x = uint64_t(orderedBits(index)) + 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * \brief writes the index as eight hex digits, which sort as it does
+ */
+inline void appendHex(std::string& key, int32_t index)
+{
+    static const char digits[] = "0123456789abcdef";
+    uint32_t bits = orderedBits(index);
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        key.push_back(digits[(bits >> shift) & 0xf]);
+    }
+}
+
+inline IntKeys::Key IntKeys::make(int32_t index)
+{
+    return index;
+}
+
+inline Uint64Keys::Key Uint64Keys::make(int32_t index)
+{
+    // the index decides the order, the filler only breaks up the zeroes
+    return uint64_t(orderedBits(index)) << 32 |
+           (fillerBits(index) & 0xffffffff);
+}
+
+inline Uint128Keys::Key Uint128Keys::make(int32_t index)
+{
+    using pcg_extras::pcg128_t;
+    uint64_t high = Uint64Keys::make(index);
+    return PCG_128BIT_CONSTANT(high, fillerBits(index));
+}
+
+inline ShortStringKeys::Key ShortStringKeys::make(int32_t index)
+{
+    // nine characters, well inside any small string buffer
+    std::string key = "k";
+    appendHex(key, index);
+    return key;
+}
+
+inline LongStringKeys::Key LongStringKeys::make(int32_t index)
+{
+    // like a path or URL, keys only differ after the shared prefix
+    std::string key = "/accounts/production/users/profiles/";
+    appendHex(key, index);
+    return key;
+}
+
+template <size_t Bytes>
+bool FatKey<Bytes>::operator==(const FatKey& rhs) const
+{
+    return id_ == rhs.id_;
+}
+
+template <size_t Bytes>
+bool FatKey<Bytes>::operator!=(const FatKey& rhs) const
+{
+    return id_ != rhs.id_;
+}
+
+template <size_t Bytes>
+bool FatKey<Bytes>::operator<(const FatKey& rhs) const
+{
+    return id_ < rhs.id_;
+}
+
+template <size_t Bytes>
+bool FatKey<Bytes>::operator>(const FatKey& rhs) const
+{
+    return id_ > rhs.id_;
+}
+
+template <size_t Bytes>
+bool FatKey<Bytes>::operator<=(const FatKey& rhs) const
+{
+    return id_ <= rhs.id_;
+}
+
+template <size_t Bytes>
+bool FatKey<Bytes>::operator>=(const FatKey& rhs) const
+{
+    return id_ >= rhs.id_;
+}
+
+template <size_t Bytes>
+typename FatKeys<Bytes>::Key FatKeys<Bytes>::make(int32_t index)
+{
+    Key key;
+    key.id_ = Uint64Keys::make(index);
+    // the payload is never looked at, but it has to be copied
+    memset(key.payload_, int(index & 0xff), sizeof(key.payload_));
+    return key;
+}
+
+inline uint64_t keyDigest(int key)
+{
+    return uint32_t(key);
+}
+
+inline uint64_t keyDigest(uint64_t key)
+{
+    return key;
+}
+
+inline uint64_t keyDigest(const pcg_extras::pcg128_t& key)
+{
+    return uint64_t(key >> 64) ^ uint64_t(key);
+}
+
+inline uint64_t keyDigest(const std::string& key)
+{
+    // the last character is the one on the heap for long strings
+    return key.size() + uint64_t(key.empty() ? 0 : key.back());
+}
+
+template <size_t Bytes>
+uint64_t keyDigest(const FatKey<Bytes>& key)
+{
+    return key.id_;
+}
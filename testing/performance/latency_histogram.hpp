@@ -0,0 +1,119 @@
+/**
+ * \file latency_histogram.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief Log-bucketed latency histograms and a cheap clock to fill them
+ *
+ * \details The histogram works like HdrHistogram. Values below 128 get a
+ * bucket each. Above that, every power of two is split into 64 equal
+ * buckets, so a value is known to within 1/64 of itself whatever its size,
+ * and the whole range of a uint64_t fits in a few thousand counters.
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP_INCLUDED
+#define LATENCY_HISTOGRAM_HPP_INCLUDED 1
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * \class LatencyHistogram
+ * \brief Counts values, usually nanoseconds, in logarithmic buckets
+ */
+class LatencyHistogram {
+public:
+    /**
+    * \brief a range of values and how many fell into it
+    */
+    struct Bucket {
+        uint64_t lower_;
+        uint64_t upper_;   ///> the last value in the bucket, not one past it
+        uint64_t count_;
+    };
+
+    LatencyHistogram();
+
+    void record(uint64_t value);
+
+    /**
+    * \brief adds in everything other has recorded
+    */
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const;
+    uint64_t min() const;
+    uint64_t max() const;
+    double mean() const;
+
+    /**
+    * \brief returns a value with fraction of the recorded values at or
+    * below it, the top of its bucket but never more than max()
+    *
+    * \returns 0 if nothing was recorded
+    */
+    uint64_t percentile(double fraction) const;
+
+    /**
+    * \brief returns the buckets holding anything, smallest values first
+    */
+    std::vector<Bucket> buckets() const;
+
+private:
+    /// the values in [2^n, 2^(n+1)) are split into 2^(SUB_BUCKET_BITS - 1)
+    static const unsigned SUB_BUCKET_BITS = 7;
+
+    std::vector<uint64_t> counts_;   ///> grows to the largest bucket used
+    uint64_t count_;
+    uint64_t min_;
+    uint64_t max_;
+    double total_;
+
+    static size_t indexOf(uint64_t value);
+    static uint64_t lowerOf(size_t index);
+    static uint64_t upperOf(size_t index);
+};
+
+/**
+ * \class LatencyClock
+ * \brief Reads the time stamp counter where there is one, otherwise
+ * steady_clock, and converts the ticks to nanoseconds
+ *
+ * \details Both the tick length and the cost of reading the clock twice
+ * are measured the first time they are asked for, which takes a few
+ * milliseconds. The overhead is subtracted from each timed operation.
+ */
+class LatencyClock {
+public:
+    static uint64_t now();
+
+    /**
+    * \brief measures the tick length and overhead now, so that it doesn't
+    * happen in the middle of something being timed
+    */
+    static void calibrate();
+
+    /**
+    * \brief returns the ticks between two back to back calls to now()
+    */
+    static uint64_t overhead();
+
+    static uint64_t toNanos(uint64_t ticks);
+
+    /**
+    * \brief returns the nanoseconds since before, less the overhead
+    */
+    static uint64_t nanosSince(uint64_t before);
+
+private:
+    static double nanosPerTick();
+};
+
+#include "latency_histogram_private.hpp"
+
+#endif // LATENCY_HISTOGRAM_HPP_INCLUDED
@@ -0,0 +1,194 @@
+/**
+ * \file latency_histogram_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of LatencyHistogram and LatencyClock
+ */
+
+// ----- LatencyHistogram -----
+
+inline LatencyHistogram::LatencyHistogram()
+    : counts_{}, count_{0}, min_{UINT64_MAX}, max_{0}, total_{0}
+{
+    // nothing else to do
+}
+
+inline void LatencyHistogram::record(uint64_t value)
+{
+    size_t index = indexOf(value);
+    if (index >= counts_.size()) {
+        counts_.resize(index + 1, 0);
+    }
+    ++counts_[index];
+    ++count_;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    total_ += value;
+}
+
+inline void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (other.counts_.size() > counts_.size()) {
+        counts_.resize(other.counts_.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    total_ += other.total_;
+}
+
+inline uint64_t LatencyHistogram::count() const
+{
+    return count_;
+}
+
+inline uint64_t LatencyHistogram::min() const
+{
+    return count_ == 0 ? 0 : min_;
+}
+
+inline uint64_t LatencyHistogram::max() const
+{
+    return max_;
+}
+
+inline double LatencyHistogram::mean() const
+{
+    return count_ == 0 ? 0.0 : total_ / count_;
+}
+
+inline uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (count_ == 0) {
+        return 0;
+    }
+    // the nearest rank, as for the phase times
+    uint64_t rank = uint64_t(fraction * count_ + 0.999999);
+    rank = std::max<uint64_t>(std::min(rank, count_), 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(upperOf(i), max_);
+        }
+    }
+    return max_;
+}
+
+inline std::vector<LatencyHistogram::Bucket> LatencyHistogram::buckets() const
+{
+    std::vector<Bucket> buckets;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] != 0) {
+            buckets.push_back(Bucket{lowerOf(i), upperOf(i), counts_[i]});
+        }
+    }
+    return buckets;
+}
+
+inline size_t LatencyHistogram::indexOf(uint64_t value)
+{
+    const uint64_t LINEAR = uint64_t(1) << SUB_BUCKET_BITS;
+    if (value < LINEAR) {
+        return size_t(value);
+    }
+    // keep the top SUB_BUCKET_BITS bits, the first of which is always set
+    unsigned highest = 63 - __builtin_clzll(value);
+    unsigned shift = highest - (SUB_BUCKET_BITS - 1);
+    uint64_t top = value >> shift;
+    return size_t(LINEAR + (shift - 1) * (LINEAR / 2) + (top - LINEAR / 2));
+}
+
+inline uint64_t LatencyHistogram::lowerOf(size_t index)
+{
+    const uint64_t LINEAR = uint64_t(1) << SUB_BUCKET_BITS;
+    if (index < LINEAR) {
+        return index;
+    }
+    uint64_t shift = (index - LINEAR) / (LINEAR / 2) + 1;
+    uint64_t top = (index - LINEAR) % (LINEAR / 2) + LINEAR / 2;
+    return top << shift;
+}
+
+inline uint64_t LatencyHistogram::upperOf(size_t index)
+{
+    const uint64_t LINEAR = uint64_t(1) << SUB_BUCKET_BITS;
+    if (index < LINEAR) {
+        return index;
+    }
+    uint64_t shift = (index - LINEAR) / (LINEAR / 2) + 1;
+    return lowerOf(index) + ((uint64_t(1) << shift) - 1);
+}
+
+// ----- LatencyClock -----
+
+inline uint64_t LatencyClock::now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+inline void LatencyClock::calibrate()
+{
+    overhead();
+    nanosPerTick();
+}
+
+inline uint64_t LatencyClock::overhead()
+{
+    // the cheapest of many tries, anything slower was interrupted
+    static const uint64_t OVERHEAD = [] {
+        uint64_t cheapest = UINT64_MAX;
+        for (int i = 0; i < 10000; ++i) {
+            uint64_t before = now();
+            uint64_t after = now();
+            cheapest = std::min(cheapest, after - before);
+        }
+        return cheapest;
+    }();
+    return OVERHEAD;
+}
+
+inline uint64_t LatencyClock::toNanos(uint64_t ticks)
+{
+    return uint64_t(ticks * nanosPerTick() + 0.5);
+}
+
+inline uint64_t LatencyClock::nanosSince(uint64_t before)
+{
+    uint64_t ticks = now() - before;
+    uint64_t cost = overhead();
+    return toNanos(ticks > cost ? ticks - cost : 0);
+}
+
+inline double LatencyClock::nanosPerTick()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // count ticks across 20ms of steady_clock
+    static const double NANOS_PER_TICK = [] {
+        using Steady = std::chrono::steady_clock;
+        Steady::time_point start = Steady::now();
+        uint64_t startTicks = now();
+        Steady::time_point end = start + std::chrono::milliseconds(20);
+        Steady::time_point current;
+        do {
+            current = Steady::now();
+        } while (current < end);
+        uint64_t ticks = now() - startTicks;
+        double nanos = std::chrono::duration<double, std::nano>(
+                           current - start).count();
+        return ticks == 0 ? 1.0 : nanos / ticks;
+    }();
+    return NANOS_PER_TICK;
+#else
+    return 1.0;
+#endif
+}
@@ -0,0 +1,98 @@
+/**
+ * \file perf_counters.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief Hardware performance counters around the benchmark's timed phases
+ *
+ * \details On Linux the counters are opened with perf_event_open as one
+ * group, so they all count over exactly the same instructions. Counters
+ * the machine or the kernel won't give us (no PMU in a virtual machine,
+ * perf_event_paranoid set too high, ...) are simply left out, and
+ * everywhere else nothing is counted at all.
+ */
+
+#ifndef PERF_COUNTERS_HPP_INCLUDED
+#define PERF_COUNTERS_HPP_INCLUDED 1
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \class PerfCounters
+ * \brief A group of counters for the calling thread, counting user space
+ * only
+ */
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,    ///> last level cache misses
+        BRANCH_MISSES,
+        DTLB_MISSES,     ///> data TLB misses on loads
+        EVENTS
+    };
+
+    /// one count per event, negative for events that weren't counted
+    using Counts = std::array<double, EVENTS>;
+
+    /**
+    * \brief opens whichever counters it can
+    */
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+    * \brief returns true if event is being counted
+    */
+    bool available(Event event) const;
+
+    /**
+    * \brief zeroes the counters and starts them
+    */
+    void start();
+
+    /**
+    * \brief stops counting for a while, keeping what was counted
+    */
+    void pause();
+
+    /**
+    * \brief carries on counting after pause
+    */
+    void resume();
+
+    /**
+    * \brief stops the counters and returns what they counted since start,
+    * scaled up if the kernel had to share the hardware with someone else
+    */
+    Counts stop();
+
+    /**
+    * \brief returns counts with nothing counted
+    */
+    static Counts none();
+
+    static const char* name(Event event);
+
+private:
+    int files_[EVENTS];     ///> -1 for events that couldn't be opened
+    uint64_t ids_[EVENTS];  ///> how the kernel tells the events apart
+    int leader_;            ///> the file that controls the group
+};
+
+#include "perf_counters_private.hpp"
+
+#endif // PERF_COUNTERS_HPP_INCLUDED
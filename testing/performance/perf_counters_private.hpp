@@ -0,0 +1,142 @@
+/**
+ * \file perf_counters_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of PerfCounters
+ */
+
+inline PerfCounters::PerfCounters() : files_{}, ids_{}, leader_{-1}
+{
+    for (int event = 0; event < EVENTS; ++event) {
+        files_[event] = -1;
+    }
+#ifdef __linux__
+    const uint32_t types[EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                    PERF_TYPE_HW_CACHE};
+    const uint64_t configs[EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    for (int event = 0; event < EVENTS; ++event) {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = types[event];
+        attributes.config = configs[event];
+        // the rest of the group follows the leader
+        attributes.disabled = leader_ == -1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                                 PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                 PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int file = int(syscall(SYS_perf_event_open, &attributes, 0, -1,
+                               leader_, 0));
+        if (file == -1) {
+            continue;
+        }
+        if (ioctl(file, PERF_EVENT_IOC_ID, &ids_[event]) == -1) {
+            close(file);
+            continue;
+        }
+        files_[event] = file;
+        if (leader_ == -1) {
+            leader_ = file;
+        }
+    }
+#endif
+}
+
+inline PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int file : files_) {
+        if (file != -1) {
+            close(file);
+        }
+    }
+#endif
+}
+
+inline bool PerfCounters::available(Event event) const
+{
+    return files_[event] != -1;
+}
+
+inline void PerfCounters::start()
+{
+#ifdef __linux__
+    if (leader_ != -1) {
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+inline void PerfCounters::pause()
+{
+#ifdef __linux__
+    if (leader_ != -1) {
+        ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+inline void PerfCounters::resume()
+{
+#ifdef __linux__
+    if (leader_ != -1) {
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+inline PerfCounters::Counts PerfCounters::stop()
+{
+    Counts counts = none();
+#ifdef __linux__
+    if (leader_ == -1) {
+        return counts;
+    }
+    ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // the number of events, the times enabled and running, then a value
+    // and id for each event
+    uint64_t buffer[3 + 2 * EVENTS];
+    ssize_t length = read(leader_, buffer, sizeof(buffer));
+    if (length < ssize_t(3 * sizeof(uint64_t))) {
+        return counts;
+    }
+    uint64_t enabled = buffer[1];
+    uint64_t running = buffer[2];
+    if (running == 0) {
+        // never got onto the hardware
+        return counts;
+    }
+    double scale = double(enabled) / running;
+    for (uint64_t i = 0; i < buffer[0] && i < EVENTS; ++i) {
+        for (int event = 0; event < EVENTS; ++event) {
+            if (files_[event] != -1 && ids_[event] == buffer[4 + 2 * i]) {
+                counts[event] = buffer[3 + 2 * i] * scale;
+            }
+        }
+    }
+#endif
+    return counts;
+}
+
+inline PerfCounters::Counts PerfCounters::none()
+{
+    Counts counts;
+    counts.fill(-1);
+    return counts;
+}
+
+inline const char* PerfCounters::name(Event event)
+{
+    static const char* names[EVENTS] = {"cycles", "instructions",
+                                        "cache_misses", "branch_misses",
+                                        "dtlb_misses"};
+    return names[event];
+}
@@ -0,0 +1,194 @@
+/**
+ * \file workload.hpp
+ *
+ * \author Andrew Scott
+ *
+ * \brief YCSB-style operation streams for the benchmark harness
+ *
+ * \details A workload starts with a number of records already loaded and
+ * then runs a mix of reads, inserts, deletes and range scans. The key each
+ * operation touches follows one of several distributions. Record i is
+ * stored under key(i), either i itself or a scrambled version of i so that
+ * records are spread over the key space in insertion order. Inserts always
+ * add the next record, as in YCSB. The whole stream is generated up front
+ * from a pcg32, so replaying it costs nothing but the operations.
+ */
+
+#ifndef WORKLOAD_HPP_INCLUDED
+#define WORKLOAD_HPP_INCLUDED 1
+#include "pcg-cpp-0.98/include/pcg_random.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/// generated workloads and recorded traces are replayed the same way
+using Operation = TraceOperation;
+
+enum class KeyDistribution {
+    UNIFORM,     ///> every record equally likely
+    ZIPFIAN,     ///> a few popular records, scattered over the key space,
+                 ///> which stay popular as records are inserted
+    LATEST,      ///> the most recently inserted records are the popular ones
+    HOT_SET,     ///> a fixed fraction of the records gets most operations
+    SEQUENTIAL   ///> one record after another, wrapping around
+};
+
+/**
+ * \brief how likely each operation is, the weights needn't add up to one
+ */
+struct OperationMix {
+    double read_;
+    double insert_;
+    double delete_;
+    double scan_;
+};
+
+/**
+ * \brief everything needed to generate a workload
+ */
+struct WorkloadSpec {
+    OperationMix mix_;
+    KeyDistribution distribution_;
+    double zipfTheta_;         ///> skew for ZIPFIAN and LATEST, in (0, 1)
+    double hotKeys_;           ///> the fraction of records that are hot
+    double hotOperations_;     ///> the fraction of operations on hot records
+    bool scrambleKeys_;        ///> spread records over the key space
+    size_t initialRecords_;    ///> records loaded before anything runs
+    size_t warmupOperations_;
+    size_t operations_;
+
+    /**
+    * \brief 90% reads, 8% inserts and 2% deletes with Zipfian skew
+    */
+    WorkloadSpec();
+};
+
+/// one operation of a workload, scans start at key
+using Request = TraceRecord;
+
+/**
+ * \class ZipfianGenerator
+ * \brief Draws ranks in [0, items) with rank 0 the most likely, as in
+ * Gray et al., "Quickly Generating Billion-Record Synthetic Databases"
+ *
+ * \note setting up costs O(items), growing costs O(new items)
+ */
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(uint64_t items, double theta);
+
+    /**
+    * \brief returns the next rank
+    */
+    uint64_t next(pcg32& rng);
+
+    /**
+    * \brief widens the range to [0, items), which can't shrink
+    */
+    void grow(uint64_t items);
+
+    uint64_t items() const;
+
+private:
+    uint64_t items_;
+    double theta_;
+    double alpha_;
+    double zetaN_;   ///> the sum of 1 / i^theta for i up to items_
+    double zeta2_;
+    double eta_;
+
+    void updateEta();
+};
+
+/**
+ * \class WorkloadGenerator
+ * \brief Turns a WorkloadSpec into the requests to replay
+ */
+class WorkloadGenerator {
+public:
+    WorkloadGenerator(const WorkloadSpec& spec, uint64_t seed,
+                      uint64_t stream);
+
+    /**
+    * \brief returns the keys of the records loaded before the workload runs
+    */
+    std::vector<int> initialKeys() const;
+
+    /**
+    * \brief returns the next count requests, later calls carry on where
+    * the last one stopped
+    */
+    std::vector<Request> next(size_t count);
+
+    /**
+    * \brief returns the key record i is stored under
+    */
+    int key(uint64_t record) const;
+
+    /**
+    * \brief returns the number of records inserted so far, counting the
+    * initial ones
+    */
+    uint64_t records() const;
+
+private:
+    WorkloadSpec spec_;
+    pcg32 rng_;
+    ZipfianGenerator zipf_;
+    uint64_t records_;
+    uint64_t nextSequential_;
+
+    Operation nextOperation();
+    uint64_t nextRecord();
+
+    /// returns how many records ZIPFIAN spreads its ranks over, the initial
+    /// ones and room for the inserts
+    static uint64_t scrambledItems(const WorkloadSpec& spec);
+
+    /// returns rank hashed, the same every time
+    static uint64_t scrambledRank(uint64_t rank);
+
+    /// returns a uniformly distributed double in [0, 1)
+    double nextUnit();
+};
+
+/**
+ * \brief returns a key for record that no other record below 2^31 has,
+ * spread over [0, 2^31) in a random looking order
+ */
+int scrambledKey(uint64_t record);
+
+/**
+ * \brief parses a mix, either a preset name or weights such as
+ * "read=90,insert=8,delete=2"
+ *
+ * \returns false if mix isn't valid
+ */
+bool parseOperationMix(const std::string& mix, OperationMix& parsed);
+
+/**
+ * \brief parses the name of a distribution
+ *
+ * \returns false if there is no such distribution
+ */
+bool parseKeyDistribution(const std::string& name,
+                          KeyDistribution& distribution);
+
+/// the presets parseOperationMix knows
+const char* const mixPresetNames[] = {"production", "read-only",
+                                      "read-latest", "scan-short",
+                                      "write-heavy"};
+
+/// the names parseKeyDistribution knows, in the order of KeyDistribution
+const char* const keyDistributionNames[] = {"uniform", "zipfian", "latest",
+                                            "hot-set", "sequential"};
+
+#include "workload_private.hpp"
+
+#endif // WORKLOAD_HPP_INCLUDED
@@ -0,0 +1,275 @@
+/**
+ * \file workload_private.hpp
+ * \author Andrew Scott
+ *
+ * \brief implementation of the workload generator
+ */
+
+inline WorkloadSpec::WorkloadSpec()
+    : mix_{90, 8, 2, 0}, distribution_{KeyDistribution::ZIPFIAN},
+      zipfTheta_{0.99}, hotKeys_{0.2}, hotOperations_{0.8},
+      scrambleKeys_{true}, initialRecords_{100000},
+      warmupOperations_{10000}, operations_{100000}
+{
+    // nothing else to do
+}
+
+// ----- ZipfianGenerator -----
+
+inline ZipfianGenerator::ZipfianGenerator(uint64_t items, double theta)
+    : items_{0}, theta_{theta}, alpha_{1.0 / (1.0 - theta)}, zetaN_{0},
+      zeta2_{1.0 + std::pow(0.5, theta)}, eta_{0}
+{
+    assert(theta > 0 && theta < 1);
+    grow(items > 0 ? items : 1);
+}
+
+inline uint64_t ZipfianGenerator::next(pcg32& rng)
+{
+    double unit = rng() * (1.0 / 4294967296.0);
+    double scaled = unit * zetaN_;
+    if (scaled < 1.0) {
+        return 0;
+    }
+    if (scaled < zeta2_) {
+        return 1;
+    }
+    uint64_t rank = uint64_t(items_ *
+                             std::pow(eta_ * unit - eta_ + 1.0, alpha_));
+    return rank < items_ ? rank : items_ - 1;
+}
+
+inline void ZipfianGenerator::grow(uint64_t items)
+{
+    for (uint64_t i = items_ + 1; i <= items; ++i) {
+        zetaN_ += 1.0 / std::pow(double(i), theta_);
+    }
+    if (items > items_) {
+        items_ = items;
+        updateEta();
+    }
+}
+
+inline uint64_t ZipfianGenerator::items() const
+{
+    return items_;
+}
+
+inline void ZipfianGenerator::updateEta()
+{
+    // only used once there are more than two items
+    eta_ = (1.0 - std::pow(2.0 / items_, 1.0 - theta_)) /
+           (1.0 - zeta2_ / zetaN_);
+}
+
+// ----- WorkloadGenerator -----
+
+inline WorkloadGenerator::WorkloadGenerator(const WorkloadSpec& spec,
+                                            uint64_t seed, uint64_t stream)
+    : spec_(spec), rng_{seed, stream},
+      zipf_{spec.distribution_ == KeyDistribution::ZIPFIAN ?
+                scrambledItems(spec) :
+                std::max<uint64_t>(spec.initialRecords_, 1),
+            spec.zipfTheta_},
+      records_{spec.initialRecords_}, nextSequential_{0}
+{
+    assert(spec.initialRecords_ > 0);
+}
+
+inline std::vector<int> WorkloadGenerator::initialKeys() const
+{
+    std::vector<int> keys;
+    keys.reserve(spec_.initialRecords_);
+    for (uint64_t record = 0; record < spec_.initialRecords_; ++record) {
+        keys.push_back(key(record));
+    }
+    return keys;
+}
+
+inline std::vector<Request> WorkloadGenerator::next(size_t count)
+{
+    std::vector<Request> requests;
+    requests.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Operation operation = nextOperation();
+        if (operation == Operation::INSERT) {
+            // always a record nobody has seen yet
+            requests.push_back(Request{operation, key(records_)});
+            ++records_;
+            if (spec_.distribution_ == KeyDistribution::LATEST) {
+                zipf_.grow(records_);
+            }
+        } else {
+            requests.push_back(Request{operation, key(nextRecord())});
+        }
+    }
+    return requests;
+}
+
+inline int WorkloadGenerator::key(uint64_t record) const
+{
+    assert(record <= 0x7fffffff);
+    return spec_.scrambleKeys_ ? scrambledKey(record) : int(record);
+}
+
+inline uint64_t WorkloadGenerator::records() const
+{
+    return records_;
+}
+
+inline Operation WorkloadGenerator::nextOperation()
+{
+    const OperationMix& mix = spec_.mix_;
+    double pick = nextUnit() *
+                  (mix.read_ + mix.insert_ + mix.delete_ + mix.scan_);
+    if (pick < mix.read_) {
+        return Operation::READ;
+    }
+    pick -= mix.read_;
+    if (pick < mix.insert_) {
+        return Operation::INSERT;
+    }
+    pick -= mix.insert_;
+    if (pick < mix.delete_) {
+        return Operation::DELETE;
+    }
+    return mix.scan_ > 0 ? Operation::SCAN : Operation::READ;
+}
+
+inline uint64_t WorkloadGenerator::nextRecord()
+{
+    switch (spec_.distribution_) {
+    case KeyDistribution::UNIFORM:
+        break;
+    case KeyDistribution::ZIPFIAN: {
+        // the ranks are hashed over a space that doesn't change as records
+        // are inserted, so a popular record stays popular, and ranks that
+        // land on records not inserted yet are drawn again, as in YCSB
+        uint64_t record;
+        do {
+            record = scrambledRank(zipf_.next(rng_)) % zipf_.items();
+        } while (record >= records_);
+        return record;
+    }
+    case KeyDistribution::LATEST:
+        return records_ - 1 - zipf_.next(rng_);
+    case KeyDistribution::HOT_SET: {
+        uint64_t hot = std::max<uint64_t>(
+            uint64_t(records_ * spec_.hotKeys_), 1);
+        if (hot >= records_ || nextUnit() < spec_.hotOperations_) {
+            return rng_(uint32_t(std::min(hot, records_)));
+        }
+        return hot + rng_(uint32_t(records_ - hot));
+    }
+    case KeyDistribution::SEQUENTIAL:
+        return nextSequential_++ % records_;
+    }
+    return rng_(uint32_t(records_));
+}
+
+inline uint64_t WorkloadGenerator::scrambledItems(const WorkloadSpec& spec)
+{
+    // YCSB allows for twice the inserts the mix expects
+    const OperationMix& mix = spec.mix_;
+    double inserts = (spec.warmupOperations_ + spec.operations_) *
+                     mix.insert_ /
+                     (mix.read_ + mix.insert_ + mix.delete_ + mix.scan_);
+    return std::max<uint64_t>(spec.initialRecords_ + uint64_t(2 * inserts),
+                              1);
+}
+
+inline uint64_t WorkloadGenerator::scrambledRank(uint64_t rank)
+{
+    // FNV-1a, so the popular records aren't all next to each other
+    uint64_t hash = 0xcbf29ce484222325;
+    for (int i = 0; i < 8; ++i) {
+        hash = (hash ^ ((rank >> (i * 8)) & 0xff)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+inline double WorkloadGenerator::nextUnit()
+{
+    return rng_() * (1.0 / 4294967296.0);
+}
+
+inline int scrambledKey(uint64_t record)
+{
+    const uint64_t MASK = 0x7fffffff;
+    assert(record <= MASK);
+    // odd multipliers and right shifts are both one to one on 31 bits, so
+    // different records never share a key
+    uint64_t x = record;
+    x = (x * 0x5bd1e995) & MASK;
+    x ^= x >> 16;
+    x = (x * 0x2c1b3c6d) & MASK;
+    x ^= x >> 13;
+    return int(x);
+}
+
+// ----- Parsing -----
+
+inline bool parseOperationMix(const std::string& mix, OperationMix& parsed)
+{
+    const OperationMix presets[] = {{90, 8, 2, 0}, {100, 0, 0, 0},
+                                    {95, 5, 0, 0}, {0, 5, 0, 95},
+                                    {50, 25, 25, 0}};
+    for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); ++i) {
+        if (mix == mixPresetNames[i]) {
+            parsed = presets[i];
+            return true;
+        }
+    }
+    // otherwise name=weight pairs, anything left out doesn't happen
+    OperationMix weights{0, 0, 0, 0};
+    size_t start = 0;
+    while (start <= mix.size()) {
+        size_t comma = mix.find(',', start);
+        if (comma == std::string::npos) {
+            comma = mix.size();
+        }
+        std::string item = mix.substr(start, comma - start);
+        start = comma + 1;
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string name = item.substr(0, equals);
+        std::string number = item.substr(equals + 1);
+        char* end = nullptr;
+        double weight = std::strtod(number.c_str(), &end);
+        if (number.empty() || *end != '\0' || !(weight >= 0)) {
+            return false;
+        }
+        if (name == "read") {
+            weights.read_ = weight;
+        } else if (name == "insert") {
+            weights.insert_ = weight;
+        } else if (name == "delete") {
+            weights.delete_ = weight;
+        } else if (name == "scan") {
+            weights.scan_ = weight;
+        } else {
+            return false;
+        }
+    }
+    if (weights.read_ + weights.insert_ + weights.delete_ + weights.scan_ <=
+        0) {
+        return false;
+    }
+    parsed = weights;
+    return true;
+}
+
+inline bool parseKeyDistribution(const std::string& name,
+                                 KeyDistribution& distribution)
+{
+    for (size_t i = 0; i < sizeof(keyDistributionNames) /
+                               sizeof(keyDistributionNames[0]); ++i) {
+        if (name == keyDistributionNames[i]) {
+            distribution = KeyDistribution(i);
+            return true;
+        }
+    }
+    return false;
+}